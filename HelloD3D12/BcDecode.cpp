@@ -0,0 +1,609 @@
+#include "BcDecode.h"
+#include <algorithm>
+#include <cstring>
+
+#if defined(_M_X64) || defined(__x86_64__)
+#include <emmintrin.h>
+#define BC_DECODE_SSE2 1
+#endif
+
+namespace
+{
+	inline uint32_t Load32(const uint8_t* p)
+	{
+		uint32_t value;
+		memcpy(&value, p, sizeof(value));
+		return value;
+	}
+
+	inline void Store32(uint8_t* p, uint32_t value)
+	{
+		memcpy(p, &value, sizeof(value));
+	}
+
+	// Interpolation divides by 2, 3, 5 or 7 rounding to nearest. The vector path
+	// divides by multiplying with these and keeping the high 16 bits, which is exact
+	// for every sum the formats can produce.
+	const uint32_t Reciprocal3 = 21846;
+	const uint32_t Reciprocal5 = 13108;
+	const uint32_t Reciprocal7 = 9363;
+
+	inline uint32_t Divide(uint32_t value, uint32_t reciprocal)
+	{
+		return (value * reciprocal) >> 16;
+	}
+
+	inline uint32_t Expand5(uint32_t v) { return (v << 3) | (v >> 2); }
+	inline uint32_t Expand6(uint32_t v) { return (v << 2) | (v >> 4); }
+
+	// Four RGBA8 colors (red in the low byte). BC2 and BC3 always use four colors.
+	void ColorPalette(const uint8_t* block, bool alwaysFourColors, uint32_t palette[4])
+	{
+		const uint32_t c0 = block[0] | (block[1] << 8);
+		const uint32_t c1 = block[2] | (block[3] << 8);
+		const uint32_t r[2] = { Expand5(c0 >> 11), Expand5(c1 >> 11) };
+		const uint32_t g[2] = { Expand6((c0 >> 5) & 63), Expand6((c1 >> 5) & 63) };
+		const uint32_t b[2] = { Expand5(c0 & 31), Expand5(c1 & 31) };
+
+		palette[0] = r[0] | (g[0] << 8) | (b[0] << 16) | 0xFF000000u;
+		palette[1] = r[1] | (g[1] << 8) | (b[1] << 16) | 0xFF000000u;
+		if (alwaysFourColors || c0 > c1)
+		{
+			palette[2] = Divide(2 * r[0] + r[1] + 1, Reciprocal3) |
+				(Divide(2 * g[0] + g[1] + 1, Reciprocal3) << 8) |
+				(Divide(2 * b[0] + b[1] + 1, Reciprocal3) << 16) | 0xFF000000u;
+			palette[3] = Divide(r[0] + 2 * r[1] + 1, Reciprocal3) |
+				(Divide(g[0] + 2 * g[1] + 1, Reciprocal3) << 8) |
+				(Divide(b[0] + 2 * b[1] + 1, Reciprocal3) << 16) | 0xFF000000u;
+		}
+		else
+		{
+			palette[2] = ((r[0] + r[1] + 1) >> 1) | (((g[0] + g[1] + 1) >> 1) << 8) |
+				(((b[0] + b[1] + 1) >> 1) << 16) | 0xFF000000u;
+			palette[3] = 0;
+		}
+	}
+
+	// Eight values of a BC3 alpha / BC4 / BC5 channel block
+	void AlphaPalette(const uint8_t* block, bool isSigned, int32_t palette[8])
+	{
+		int32_t a0, a1;
+		if (isSigned)
+		{
+			// -128 decodes as -127 so the range stays symmetric
+			a0 = std::max<int32_t>(static_cast<int8_t>(block[0]), -127);
+			a1 = std::max<int32_t>(static_cast<int8_t>(block[1]), -127);
+		}
+		else
+		{
+			a0 = block[0];
+			a1 = block[1];
+		}
+
+		auto interpolate = [](int32_t sum, uint32_t divisor)
+		{
+			const uint32_t magnitude = static_cast<uint32_t>(sum < 0 ? -sum : sum);
+			const int32_t quotient = static_cast<int32_t>(divisor == 7 ?
+				Divide(magnitude + 3, Reciprocal7) : Divide(magnitude + 2, Reciprocal5));
+			return sum < 0 ? -quotient : quotient;
+		};
+
+		palette[0] = a0;
+		palette[1] = a1;
+		if (a0 > a1)
+		{
+			for (int32_t i = 1; i < 7; i++)
+			{
+				palette[1 + i] = interpolate((7 - i) * a0 + i * a1, 7);
+			}
+		}
+		else
+		{
+			for (int32_t i = 1; i < 5; i++)
+			{
+				palette[1 + i] = interpolate((5 - i) * a0 + i * a1, 5);
+			}
+			palette[6] = isSigned ? -127 : 0;
+			palette[7] = isSigned ? 127 : 255;
+		}
+	}
+
+	inline uint64_t AlphaIndices(const uint8_t* block)
+	{
+		uint64_t bits = 0;
+		for (int i = 5; i >= 0; i--)
+		{
+			bits = (bits << 8) | block[2 + i];
+		}
+		return bits;
+	}
+
+	void DecodeColorBlock(const uint8_t* block, bool alwaysFourColors, uint32_t texels[16])
+	{
+		uint32_t palette[4];
+		ColorPalette(block, alwaysFourColors, palette);
+		const uint32_t indices = Load32(block + 4);
+		for (int t = 0; t < 16; t++)
+		{
+			texels[t] = palette[(indices >> (2 * t)) & 3];
+		}
+	}
+
+	void DecodeAlphaBlock(const uint8_t* block, bool isSigned, uint8_t values[16])
+	{
+		int32_t palette[8];
+		AlphaPalette(block, isSigned, palette);
+		const uint64_t indices = AlphaIndices(block);
+		for (int t = 0; t < 16; t++)
+		{
+			values[t] = static_cast<uint8_t>(palette[(indices >> (3 * t)) & 7]);
+		}
+	}
+
+#ifdef BC_DECODE_SSE2
+	inline __m128i Load128(const uint8_t* p)
+	{
+		return _mm_loadu_si128(reinterpret_cast<const __m128i*>(p));
+	}
+
+	inline void Store128(uint8_t* p, __m128i value)
+	{
+		_mm_storeu_si128(reinterpret_cast<__m128i*>(p), value);
+	}
+
+	inline __m128i Select(__m128i mask, __m128i a, __m128i b)
+	{
+		return _mm_or_si128(_mm_and_si128(mask, a), _mm_andnot_si128(mask, b));
+	}
+
+	// Splits four 8-byte blocks into their first and second dwords, one block per lane
+	inline void LoadHalfBlocks(const uint8_t* blocks, __m128i& low, __m128i& high)
+	{
+		const __m128 a = _mm_castsi128_ps(Load128(blocks));
+		const __m128 b = _mm_castsi128_ps(Load128(blocks + 16));
+		low = _mm_castps_si128(_mm_shuffle_ps(a, b, _MM_SHUFFLE(2, 0, 2, 0)));
+		high = _mm_castps_si128(_mm_shuffle_ps(a, b, _MM_SHUFFLE(3, 1, 3, 1)));
+	}
+
+	// Splits four 16-byte blocks into their four dwords, one block per lane
+	inline void LoadFullBlocks(const uint8_t* blocks, __m128i dwords[4])
+	{
+		__m128 r0 = _mm_castsi128_ps(Load128(blocks));
+		__m128 r1 = _mm_castsi128_ps(Load128(blocks + 16));
+		__m128 r2 = _mm_castsi128_ps(Load128(blocks + 32));
+		__m128 r3 = _mm_castsi128_ps(Load128(blocks + 48));
+		_MM_TRANSPOSE4_PS(r0, r1, r2, r3);
+		dwords[0] = _mm_castps_si128(r0);
+		dwords[1] = _mm_castps_si128(r1);
+		dwords[2] = _mm_castps_si128(r2);
+		dwords[3] = _mm_castps_si128(r3);
+	}
+
+	inline __m128i Expand5(__m128i v)
+	{
+		return _mm_or_si128(_mm_slli_epi32(v, 3), _mm_srli_epi32(v, 2));
+	}
+
+	inline __m128i Expand6(__m128i v)
+	{
+		return _mm_or_si128(_mm_slli_epi32(v, 2), _mm_srli_epi32(v, 4));
+	}
+
+	// ColorPalette for four blocks; colors holds each block's two endpoints
+	void ColorPalette4(__m128i colors, bool alwaysFourColors, __m128i palette[4])
+	{
+		const __m128i mask5 = _mm_set1_epi32(31);
+		const __m128i mask6 = _mm_set1_epi32(63);
+		const __m128i one = _mm_set1_epi32(1);
+		const __m128i third = _mm_set1_epi32(Reciprocal3);
+
+		const __m128i c0 = _mm_and_si128(colors, _mm_set1_epi32(0xFFFF));
+		const __m128i c1 = _mm_srli_epi32(colors, 16);
+		const __m128i r0 = Expand5(_mm_srli_epi32(c0, 11));
+		const __m128i r1 = Expand5(_mm_srli_epi32(c1, 11));
+		const __m128i g0 = Expand6(_mm_and_si128(_mm_srli_epi32(c0, 5), mask6));
+		const __m128i g1 = Expand6(_mm_and_si128(_mm_srli_epi32(c1, 5), mask6));
+		const __m128i b0 = Expand5(_mm_and_si128(c0, mask5));
+		const __m128i b1 = Expand5(_mm_and_si128(c1, mask5));
+
+		auto twoThirds = [&](__m128i a, __m128i b)
+		{
+			return _mm_mulhi_epu16(_mm_add_epi32(_mm_add_epi32(_mm_add_epi32(a, a), b), one), third);
+		};
+		auto half = [&](__m128i a, __m128i b)
+		{
+			return _mm_srli_epi32(_mm_add_epi32(_mm_add_epi32(a, b), one), 1);
+		};
+		auto pack = [](__m128i r, __m128i g, __m128i b)
+		{
+			return _mm_or_si128(_mm_or_si128(r, _mm_slli_epi32(g, 8)),
+				_mm_or_si128(_mm_slli_epi32(b, 16), _mm_set1_epi32(static_cast<int>(0xFF000000u))));
+		};
+
+		palette[0] = pack(r0, g0, b0);
+		palette[1] = pack(r1, g1, b1);
+		const __m128i p2 = pack(twoThirds(r0, r1), twoThirds(g0, g1), twoThirds(b0, b1));
+		const __m128i p3 = pack(twoThirds(r1, r0), twoThirds(g1, g0), twoThirds(b1, b0));
+		if (alwaysFourColors)
+		{
+			palette[2] = p2;
+			palette[3] = p3;
+			return;
+		}
+		const __m128i fourColors = _mm_cmpgt_epi32(c0, c1);
+		palette[2] = Select(fourColors, p2, pack(half(r0, r1), half(g0, g1), half(b0, b1)));
+		palette[3] = _mm_and_si128(fourColors, p3);
+	}
+
+	inline __m128i ColorTexel4(const __m128i palette[4], __m128i indices, int t)
+	{
+		const __m128i index = _mm_and_si128(_mm_srli_epi32(indices, 2 * t), _mm_set1_epi32(3));
+		__m128i texel = _mm_and_si128(_mm_cmpeq_epi32(index, _mm_setzero_si128()), palette[0]);
+		for (int i = 1; i < 4; i++)
+		{
+			texel = _mm_or_si128(texel, _mm_and_si128(_mm_cmpeq_epi32(index, _mm_set1_epi32(i)), palette[i]));
+		}
+		return texel;
+	}
+
+	// Weighted sum of two lanes of small signed values; mullo only forms the low 16 bits
+	inline __m128i WeightedSum(__m128i a, int32_t wa, __m128i b, int32_t wb)
+	{
+		__m128i sum = _mm_add_epi16(_mm_mullo_epi16(a, _mm_set1_epi32(wa)), _mm_mullo_epi16(b, _mm_set1_epi32(wb)));
+		return _mm_srai_epi32(_mm_slli_epi32(sum, 16), 16);
+	}
+
+	inline __m128i RoundedDivide(__m128i sum, int32_t bias, uint32_t reciprocal)
+	{
+		// Divide the magnitude and restore the sign, so ties round away from zero
+		const __m128i sign = _mm_srai_epi32(sum, 31);
+		const __m128i magnitude = _mm_sub_epi32(_mm_xor_si128(sum, sign), sign);
+		const __m128i quotient = _mm_mulhi_epu16(_mm_add_epi32(magnitude, _mm_set1_epi32(bias)),
+			_mm_set1_epi32(static_cast<int>(reciprocal)));
+		return _mm_sub_epi32(_mm_xor_si128(quotient, sign), sign);
+	}
+
+	// AlphaPalette for four blocks, each value repeated in the four bytes of its lane.
+	// low and high are each block's first and second dwords; indices receives the 24
+	// index bits of texels 0-7 and 8-15.
+	void AlphaPalette4(__m128i low, __m128i high, bool isSigned, __m128i palette[8], __m128i indices[2])
+	{
+		__m128i a0, a1;
+		if (isSigned)
+		{
+			a0 = _mm_srai_epi32(_mm_slli_epi32(low, 24), 24);
+			a1 = _mm_srai_epi32(_mm_slli_epi32(low, 16), 24);
+			const __m128i minimum = _mm_set1_epi32(-128);
+			a0 = _mm_sub_epi32(a0, _mm_cmpeq_epi32(a0, minimum));
+			a1 = _mm_sub_epi32(a1, _mm_cmpeq_epi32(a1, minimum));
+		}
+		else
+		{
+			const __m128i mask = _mm_set1_epi32(0xFF);
+			a0 = _mm_and_si128(low, mask);
+			a1 = _mm_and_si128(_mm_srli_epi32(low, 8), mask);
+		}
+
+		indices[0] = _mm_or_si128(_mm_srli_epi32(low, 16), _mm_slli_epi32(_mm_and_si128(high, _mm_set1_epi32(0xFF)), 16));
+		indices[1] = _mm_srli_epi32(high, 8);
+
+		const __m128i eightValues = _mm_cmpgt_epi32(a0, a1);
+		palette[0] = a0;
+		palette[1] = a1;
+		for (int32_t i = 1; i < 7; i++)
+		{
+			const __m128i seven = RoundedDivide(WeightedSum(a0, 7 - i, a1, i), 3, Reciprocal7);
+			__m128i five;
+			if (i < 5)
+			{
+				five = RoundedDivide(WeightedSum(a0, 5 - i, a1, i), 2, Reciprocal5);
+			}
+			else if (i == 5)
+			{
+				five = _mm_set1_epi32(isSigned ? -127 : 0);
+			}
+			else
+			{
+				five = _mm_set1_epi32(isSigned ? 127 : 255);
+			}
+			palette[1 + i] = Select(eightValues, seven, five);
+		}
+
+		// Repeat each value in all four bytes so a whole block row is looked up at once
+		for (int i = 0; i < 8; i++)
+		{
+			const __m128i value = _mm_and_si128(palette[i], _mm_set1_epi32(0xFF));
+			const __m128i pair = _mm_or_si128(value, _mm_slli_epi32(value, 8));
+			palette[i] = _mm_or_si128(pair, _mm_slli_epi32(pair, 16));
+		}
+	}
+
+	// Row y of four channel blocks, its four values packed in each lane
+	inline __m128i AlphaRow4(const __m128i palette[8], const __m128i indices[2], int y)
+	{
+		// Spread the row's four 3-bit indices to one per byte
+		const __m128i bits = _mm_srli_epi32(indices[y >> 1], 12 * (y & 1));
+		__m128i index = _mm_and_si128(bits, _mm_set1_epi32(0x7));
+		index = _mm_or_si128(index, _mm_and_si128(_mm_slli_epi32(bits, 5), _mm_set1_epi32(0x700)));
+		index = _mm_or_si128(index, _mm_and_si128(_mm_slli_epi32(bits, 10), _mm_set1_epi32(0x70000)));
+		index = _mm_or_si128(index, _mm_and_si128(_mm_slli_epi32(bits, 15), _mm_set1_epi32(0x7000000)));
+
+		__m128i row = _mm_and_si128(_mm_cmpeq_epi8(index, _mm_setzero_si128()), palette[0]);
+		for (int i = 1; i < 8; i++)
+		{
+			row = _mm_or_si128(row, _mm_and_si128(_mm_cmpeq_epi8(index, _mm_set1_epi8(static_cast<char>(i))), palette[i]));
+		}
+		return row;
+	}
+
+	// Writes row y of four RGBA blocks given texels 4y..4y+3, one block per lane
+	inline void StoreRgbaRow(uint8_t* dest, __m128i t0, __m128i t1, __m128i t2, __m128i t3)
+	{
+		__m128 r0 = _mm_castsi128_ps(t0);
+		__m128 r1 = _mm_castsi128_ps(t1);
+		__m128 r2 = _mm_castsi128_ps(t2);
+		__m128 r3 = _mm_castsi128_ps(t3);
+		_MM_TRANSPOSE4_PS(r0, r1, r2, r3);
+		Store128(dest, _mm_castps_si128(r0));
+		Store128(dest + 16, _mm_castps_si128(r1));
+		Store128(dest + 32, _mm_castps_si128(r2));
+		Store128(dest + 48, _mm_castps_si128(r3));
+	}
+
+	// Decodes four horizontally adjacent blocks, all inside the surface
+	void DecodeFourBlocks(BcFormat format, const uint8_t* blocks, uint8_t* dest, size_t destPitch)
+	{
+		switch (format)
+		{
+		case BcFormat_BC1:
+		case BcFormat_BC2:
+		case BcFormat_BC3:
+		{
+			__m128i colors, colorIndices;
+			__m128i dwords[4];
+			if (format == BcFormat_BC1)
+			{
+				LoadHalfBlocks(blocks, colors, colorIndices);
+			}
+			else
+			{
+				LoadFullBlocks(blocks, dwords);
+				colors = dwords[2];
+				colorIndices = dwords[3];
+			}
+
+			__m128i palette[4];
+			ColorPalette4(colors, format != BcFormat_BC1, palette);
+
+			__m128i alphaPalette[8];
+			__m128i alphaIndices[2];
+			if (format == BcFormat_BC3)
+			{
+				AlphaPalette4(dwords[0], dwords[1], false, alphaPalette, alphaIndices);
+			}
+
+			const __m128i colorMask = _mm_set1_epi32(0x00FFFFFF);
+			const __m128i alphaMask = _mm_set1_epi32(static_cast<int>(0xFF000000u));
+			for (int y = 0; y < 4; y++)
+			{
+				const __m128i alphaRow = (format == BcFormat_BC3) ? AlphaRow4(alphaPalette, alphaIndices, y) : _mm_setzero_si128();
+				__m128i row[4];
+				for (int x = 0; x < 4; x++)
+				{
+					const int t = 4 * y + x;
+					row[x] = ColorTexel4(palette, colorIndices, t);
+					if (format == BcFormat_BC2)
+					{
+						const __m128i nibble = _mm_and_si128(_mm_srli_epi32(dwords[t >> 3], 4 * (t & 7)), _mm_set1_epi32(15));
+						const __m128i alpha = _mm_or_si128(nibble, _mm_slli_epi32(nibble, 4));
+						row[x] = _mm_or_si128(_mm_and_si128(row[x], colorMask), _mm_slli_epi32(alpha, 24));
+					}
+					else if (format == BcFormat_BC3)
+					{
+						// Byte x of the alpha row moves to the top byte
+						const __m128i alpha = _mm_and_si128(_mm_slli_epi32(alphaRow, 24 - 8 * x), alphaMask);
+						row[x] = _mm_or_si128(_mm_and_si128(row[x], colorMask), alpha);
+					}
+				}
+				StoreRgbaRow(dest + y * destPitch, row[0], row[1], row[2], row[3]);
+			}
+		} break;
+
+		case BcFormat_BC4Unorm:
+		case BcFormat_BC4Snorm:
+		{
+			__m128i low, high;
+			LoadHalfBlocks(blocks, low, high);
+			__m128i palette[8];
+			__m128i indices[2];
+			AlphaPalette4(low, high, format == BcFormat_BC4Snorm, palette, indices);
+
+			// Four one-byte texels fill a lane, so the lanes are already in row order
+			for (int y = 0; y < 4; y++)
+			{
+				Store128(dest + y * destPitch, AlphaRow4(palette, indices, y));
+			}
+		} break;
+
+		case BcFormat_BC5Unorm:
+		case BcFormat_BC5Snorm:
+		{
+			__m128i dwords[4];
+			LoadFullBlocks(blocks, dwords);
+			const bool isSigned = format == BcFormat_BC5Snorm;
+			__m128i red[8], green[8];
+			__m128i redIndices[2], greenIndices[2];
+			AlphaPalette4(dwords[0], dwords[1], isSigned, red, redIndices);
+			AlphaPalette4(dwords[2], dwords[3], isSigned, green, greenIndices);
+
+			// Interleaving the bytes of the red and green rows gives two blocks' rows each
+			for (int y = 0; y < 4; y++)
+			{
+				const __m128i redRow = AlphaRow4(red, redIndices, y);
+				const __m128i greenRow = AlphaRow4(green, greenIndices, y);
+				Store128(dest + y * destPitch, _mm_unpacklo_epi8(redRow, greenRow));
+				Store128(dest + y * destPitch + 16, _mm_unpackhi_epi8(redRow, greenRow));
+			}
+		} break;
+		}
+	}
+#endif
+
+	bool DecodeSurface(BcFormat format, const uint8_t* src, size_t srcSize,
+		uint32_t width, uint32_t height, uint8_t* dest, size_t destPitch, bool vectorized)
+	{
+		if (!src || !dest || width == 0 || height == 0 || srcSize < BcSurfaceBytes(format, width, height))
+		{
+			return false;
+		}
+
+		const uint32_t blocksWide = std::max(1u, (width + 3) / 4);
+		const uint32_t blocksHigh = std::max(1u, (height + 3) / 4);
+		const size_t blockBytes = BcBlockBytes(format);
+		const size_t texelBytes = BcTexelBytes(format);
+
+		for (uint32_t by = 0; by < blocksHigh; by++)
+		{
+			const uint8_t* row = src + by * blocksWide * blockBytes;
+			uint8_t* destRow = dest + by * 4 * destPitch;
+			const uint32_t rows = std::min(4u, height - by * 4);
+			uint32_t bx = 0;
+
+#ifdef BC_DECODE_SSE2
+			if (vectorized && rows == 4)
+			{
+				for (; (bx + 4) * 4 <= width; bx += 4)
+				{
+					DecodeFourBlocks(format, row + bx * blockBytes, destRow + bx * 4 * texelBytes, destPitch);
+				}
+			}
+#else
+			(void)vectorized;
+#endif
+
+			for (; bx < blocksWide; bx++)
+			{
+				const uint32_t columns = std::min(4u, width - bx * 4);
+				uint8_t* destBlock = destRow + bx * 4 * texelBytes;
+				if (rows == 4 && columns == 4)
+				{
+					DecodeBcBlock(format, row + bx * blockBytes, destBlock, destPitch);
+					continue;
+				}
+
+				// Edge blocks go through a full block and are clipped
+				uint8_t texels[4 * 4 * 4];
+				DecodeBcBlock(format, row + bx * blockBytes, texels, 4 * texelBytes);
+				for (uint32_t y = 0; y < rows; y++)
+				{
+					memcpy(destBlock + y * destPitch, texels + y * 4 * texelBytes, columns * texelBytes);
+				}
+			}
+		}
+		return true;
+	}
+}
+
+size_t BcBlockBytes(BcFormat format)
+{
+	return (format == BcFormat_BC1 || format == BcFormat_BC4Unorm || format == BcFormat_BC4Snorm) ? 8 : 16;
+}
+
+size_t BcTexelBytes(BcFormat format)
+{
+	switch (format)
+	{
+	case BcFormat_BC4Unorm:
+	case BcFormat_BC4Snorm:
+		return 1;
+	case BcFormat_BC5Unorm:
+	case BcFormat_BC5Snorm:
+		return 2;
+	default:
+		return 4;
+	}
+}
+
+size_t BcSurfaceBytes(BcFormat format, uint32_t width, uint32_t height)
+{
+	const size_t blocksWide = std::max(1u, (width + 3) / 4);
+	const size_t blocksHigh = std::max(1u, (height + 3) / 4);
+	return blocksWide * blocksHigh * BcBlockBytes(format);
+}
+
+void DecodeBcBlock(BcFormat format, const uint8_t* block, uint8_t* dest, size_t destPitch)
+{
+	switch (format)
+	{
+	case BcFormat_BC1:
+	case BcFormat_BC2:
+	case BcFormat_BC3:
+	{
+		uint32_t texels[16];
+		DecodeColorBlock(format == BcFormat_BC1 ? block : block + 8, format != BcFormat_BC1, texels);
+		if (format == BcFormat_BC2)
+		{
+			for (int t = 0; t < 16; t++)
+			{
+				const uint32_t alpha = (block[t >> 1] >> (4 * (t & 1))) & 15;
+				texels[t] = (texels[t] & 0x00FFFFFFu) | ((alpha * 17) << 24);
+			}
+		}
+		else if (format == BcFormat_BC3)
+		{
+			uint8_t alpha[16];
+			DecodeAlphaBlock(block, false, alpha);
+			for (int t = 0; t < 16; t++)
+			{
+				texels[t] = (texels[t] & 0x00FFFFFFu) | (static_cast<uint32_t>(alpha[t]) << 24);
+			}
+		}
+		for (int y = 0; y < 4; y++)
+		{
+			for (int x = 0; x < 4; x++)
+			{
+				Store32(dest + y * destPitch + x * 4, texels[4 * y + x]);
+			}
+		}
+	} break;
+
+	case BcFormat_BC4Unorm:
+	case BcFormat_BC4Snorm:
+	{
+		uint8_t values[16];
+		DecodeAlphaBlock(block, format == BcFormat_BC4Snorm, values);
+		for (int y = 0; y < 4; y++)
+		{
+			memcpy(dest + y * destPitch, values + 4 * y, 4);
+		}
+	} break;
+
+	case BcFormat_BC5Unorm:
+	case BcFormat_BC5Snorm:
+	{
+		uint8_t red[16], green[16];
+		DecodeAlphaBlock(block, format == BcFormat_BC5Snorm, red);
+		DecodeAlphaBlock(block + 8, format == BcFormat_BC5Snorm, green);
+		for (int y = 0; y < 4; y++)
+		{
+			for (int x = 0; x < 4; x++)
+			{
+				dest[y * destPitch + x * 2] = red[4 * y + x];
+				dest[y * destPitch + x * 2 + 1] = green[4 * y + x];
+			}
+		}
+	} break;
+	}
+}
+
+bool DecodeBcSurface(BcFormat format, const uint8_t* src, size_t srcSize,
+	uint32_t width, uint32_t height, uint8_t* dest, size_t destPitch)
+{
+	return DecodeSurface(format, src, srcSize, width, height, dest, destPitch, true);
+}
+
+bool DecodeBcSurfaceScalar(BcFormat format, const uint8_t* src, size_t srcSize,
+	uint32_t width, uint32_t height, uint8_t* dest, size_t destPitch)
+{
+	return DecodeSurface(format, src, srcSize, width, height, dest, destPitch, false);
+}
@@ -0,0 +1,36 @@
+#pragma once
+#include <cstddef>
+#include <cstdint>
+
+// Block compressed formats the CPU decoder understands, with the texels it writes
+enum BcFormat : uint32_t
+{
+	BcFormat_BC1,      // RGBA8; transparent black where the block uses it
+	BcFormat_BC2,      // RGBA8
+	BcFormat_BC3,      // RGBA8
+	BcFormat_BC4Unorm, // R8
+	BcFormat_BC4Snorm, // R8 holding a two's complement value
+	BcFormat_BC5Unorm, // RG8
+	BcFormat_BC5Snorm, // RG8 holding two's complement values
+};
+
+size_t BcBlockBytes(BcFormat format);
+size_t BcTexelBytes(BcFormat format);
+
+// Bytes of one width x height surface; the surfaces of a DDS file's bitData follow one
+// another in this size, mips of the first array slice first
+size_t BcSurfaceBytes(BcFormat format, uint32_t width, uint32_t height);
+
+// Reference decoder for one 4x4 block, writing four rows destPitch bytes apart.
+// Interpolated values round to nearest (ties away from zero for signed formats).
+void DecodeBcBlock(BcFormat format, const uint8_t* block, uint8_t* dest, size_t destPitch);
+
+// Decodes a width x height surface into dest, dropping the texels of edge blocks that
+// fall outside it. Runs of four blocks are decoded together with SSE2 when available;
+// the result is bit exact with DecodeBcBlock. Returns false when src is too small.
+bool DecodeBcSurface(BcFormat format, const uint8_t* src, size_t srcSize,
+	uint32_t width, uint32_t height, uint8_t* dest, size_t destPitch);
+
+// DecodeBcSurface using DecodeBcBlock only
+bool DecodeBcSurfaceScalar(BcFormat format, const uint8_t* src, size_t srcSize,
+	uint32_t width, uint32_t height, uint8_t* dest, size_t destPitch);
@@ -0,0 +1,860 @@
+#include "BcEncode.h"
+#include "BcDecode.h"
+#include "Parallel.h"
+#include <algorithm>
+#include <cmath>
+#include <cstring>
+
+namespace
+{
+	const int Bc7Weights[16] = { 0, 4, 9, 13, 17, 21, 26, 30, 34, 38, 43, 47, 51, 55, 60, 64 };
+	const uint32_t RefineIterations = 2;
+
+	inline int Clamp(int value, int low, int high)
+	{
+		return std::min(std::max(value, low), high);
+	}
+
+	inline int RoundToInt(float value)
+	{
+		return static_cast<int>(std::floor(value + 0.5f));
+	}
+
+	// Two endpoints spanning the texels' first channelCount channels
+	struct Line
+	{
+		float Start[4];
+		float End[4];
+	};
+
+	// Bounding box corners, with the diagonal flipped per channel to follow the sign of
+	// its covariance with the widest channel. Shrunk by 1/16 of the range at each end,
+	// since the extremes are rarely worth reproducing exactly.
+	Line BoundingBoxLine(const float points[16][4], int channelCount)
+	{
+		float low[4], high[4], mean[4];
+		for (int c = 0; c < channelCount; c++)
+		{
+			low[c] = high[c] = points[0][c];
+			mean[c] = 0.0f;
+			for (int t = 0; t < 16; t++)
+			{
+				low[c] = std::min(low[c], points[t][c]);
+				high[c] = std::max(high[c], points[t][c]);
+				mean[c] += points[t][c] / 16.0f;
+			}
+		}
+
+		int widest = 0;
+		for (int c = 1; c < channelCount; c++)
+		{
+			if (high[c] - low[c] > high[widest] - low[widest])
+			{
+				widest = c;
+			}
+		}
+
+		Line line;
+		for (int c = 0; c < channelCount; c++)
+		{
+			float covariance = 0.0f;
+			for (int t = 0; t < 16; t++)
+			{
+				covariance += (points[t][widest] - mean[widest]) * (points[t][c] - mean[c]);
+			}
+			const float inset = (high[c] - low[c]) / 16.0f;
+			const bool flip = covariance < 0.0f;
+			line.Start[c] = flip ? high[c] - inset : low[c] + inset;
+			line.End[c] = flip ? low[c] + inset : high[c] - inset;
+		}
+		return line;
+	}
+
+	// Extent of the texels along their principal axis, found by power iteration
+	Line PrincipalLine(const float points[16][4], int channelCount)
+	{
+		float mean[4] = {};
+		for (int t = 0; t < 16; t++)
+		{
+			for (int c = 0; c < channelCount; c++)
+			{
+				mean[c] += points[t][c] / 16.0f;
+			}
+		}
+
+		float covariance[4][4] = {};
+		for (int t = 0; t < 16; t++)
+		{
+			for (int i = 0; i < channelCount; i++)
+			{
+				for (int j = 0; j < channelCount; j++)
+				{
+					covariance[i][j] += (points[t][i] - mean[i]) * (points[t][j] - mean[j]);
+				}
+			}
+		}
+
+		// Start from the row of the channel that varies most
+		int widest = 0;
+		for (int c = 1; c < channelCount; c++)
+		{
+			if (covariance[c][c] > covariance[widest][widest])
+			{
+				widest = c;
+			}
+		}
+		float axis[4] = {};
+		for (int c = 0; c < channelCount; c++)
+		{
+			axis[c] = covariance[widest][c];
+		}
+
+		for (int iteration = 0; iteration < 8; iteration++)
+		{
+			float next[4] = {};
+			float largest = 0.0f;
+			for (int i = 0; i < channelCount; i++)
+			{
+				for (int j = 0; j < channelCount; j++)
+				{
+					next[i] += covariance[i][j] * axis[j];
+				}
+				largest = std::max(largest, std::fabs(next[i]));
+			}
+			if (largest == 0.0f)
+			{
+				break;
+			}
+			for (int c = 0; c < channelCount; c++)
+			{
+				axis[c] = next[c] / largest;
+			}
+		}
+
+		float lengthSquared = 0.0f;
+		for (int c = 0; c < channelCount; c++)
+		{
+			lengthSquared += axis[c] * axis[c];
+		}
+		Line line;
+		if (lengthSquared == 0.0f)
+		{
+			// Every texel is the same
+			for (int c = 0; c < channelCount; c++)
+			{
+				line.Start[c] = line.End[c] = mean[c];
+			}
+			return line;
+		}
+		const float scale = 1.0f / std::sqrt(lengthSquared);
+		for (int c = 0; c < channelCount; c++)
+		{
+			axis[c] *= scale;
+		}
+
+		float low = 0.0f, high = 0.0f;
+		for (int t = 0; t < 16; t++)
+		{
+			float projection = 0.0f;
+			for (int c = 0; c < channelCount; c++)
+			{
+				projection += (points[t][c] - mean[c]) * axis[c];
+			}
+			low = std::min(low, projection);
+			high = std::max(high, projection);
+		}
+		for (int c = 0; c < channelCount; c++)
+		{
+			line.Start[c] = mean[c] + axis[c] * low;
+			line.End[c] = mean[c] + axis[c] * high;
+		}
+		return line;
+	}
+
+	// Least squares endpoints for fixed indices, given each texel's position along the
+	// line (0 at Start, 1 at End). Returns false when the positions do not pin them down.
+	bool RefineLine(const float points[16][4], int channelCount, const float positions[16], Line& line)
+	{
+		float aa = 0.0f, bb = 0.0f, ab = 0.0f;
+		float ax[4] = {}, bx[4] = {};
+		for (int t = 0; t < 16; t++)
+		{
+			const float b = positions[t];
+			const float a = 1.0f - b;
+			aa += a * a;
+			bb += b * b;
+			ab += a * b;
+			for (int c = 0; c < channelCount; c++)
+			{
+				ax[c] += a * points[t][c];
+				bx[c] += b * points[t][c];
+			}
+		}
+
+		const float determinant = aa * bb - ab * ab;
+		if (std::fabs(determinant) < 1e-6f)
+		{
+			return false;
+		}
+		for (int c = 0; c < channelCount; c++)
+		{
+			line.Start[c] = (ax[c] * bb - bx[c] * ab) / determinant;
+			line.End[c] = (bx[c] * aa - ax[c] * ab) / determinant;
+		}
+		return true;
+	}
+
+	void LoadPoints(const uint8_t texels[64], float points[16][4])
+	{
+		for (int t = 0; t < 16; t++)
+		{
+			for (int c = 0; c < 4; c++)
+			{
+				points[t][c] = texels[t * 4 + c];
+			}
+		}
+	}
+
+	// ---- BC1 color block ----
+
+	inline uint32_t Quantize565(const float color[3])
+	{
+		const int r = Clamp(RoundToInt(color[0] * 31.0f / 255.0f), 0, 31);
+		const int g = Clamp(RoundToInt(color[1] * 63.0f / 255.0f), 0, 63);
+		const int b = Clamp(RoundToInt(color[2] * 31.0f / 255.0f), 0, 31);
+		return static_cast<uint32_t>((r << 11) | (g << 5) | b);
+	}
+
+	// Four-color palette, matching DecodeBcBlock
+	void ColorPalette(uint32_t c0, uint32_t c1, int palette[4][3])
+	{
+		const uint32_t c[2] = { c0, c1 };
+		for (int i = 0; i < 2; i++)
+		{
+			const int r = (c[i] >> 11) & 31, g = (c[i] >> 5) & 63, b = c[i] & 31;
+			palette[i][0] = (r << 3) | (r >> 2);
+			palette[i][1] = (g << 2) | (g >> 4);
+			palette[i][2] = (b << 3) | (b >> 2);
+		}
+		for (int ch = 0; ch < 3; ch++)
+		{
+			palette[2][ch] = (2 * palette[0][ch] + palette[1][ch] + 1) / 3;
+			palette[3][ch] = (palette[0][ch] + 2 * palette[1][ch] + 1) / 3;
+		}
+	}
+
+	// Picks the nearest palette entry per texel; returns the total squared error
+	uint32_t FitColorIndices(const uint8_t texels[64], const int palette[4][3], uint8_t indices[16])
+	{
+		uint32_t total = 0;
+		for (int t = 0; t < 16; t++)
+		{
+			uint32_t best = ~0u;
+			for (int i = 0; i < 4; i++)
+			{
+				uint32_t error = 0;
+				for (int ch = 0; ch < 3; ch++)
+				{
+					const int d = texels[t * 4 + ch] - palette[i][ch];
+					error += d * d;
+				}
+				if (error < best)
+				{
+					best = error;
+					indices[t] = static_cast<uint8_t>(i);
+				}
+			}
+			total += best;
+		}
+		return total;
+	}
+
+	void EncodeColorBlock(const uint8_t texels[64], BcQuality quality, uint8_t* block)
+	{
+		float points[16][4];
+		LoadPoints(texels, points);
+		Line line = (quality == BcQuality_Fast) ? BoundingBoxLine(points, 3) : PrincipalLine(points, 3);
+
+		uint32_t c0 = Quantize565(line.End);
+		uint32_t c1 = Quantize565(line.Start);
+		int palette[4][3];
+		ColorPalette(c0, c1, palette);
+		uint8_t indices[16];
+		uint32_t error = FitColorIndices(texels, palette, indices);
+
+		if (quality == BcQuality_High)
+		{
+			// Index i puts the texel this far from c0 towards c1
+			const float positionOf[4] = { 0.0f, 1.0f, 1.0f / 3.0f, 2.0f / 3.0f };
+			for (uint32_t iteration = 0; iteration < RefineIterations && error > 0; iteration++)
+			{
+				float positions[16];
+				for (int t = 0; t < 16; t++)
+				{
+					positions[t] = positionOf[indices[t]];
+				}
+				Line refined;
+				if (!RefineLine(points, 3, positions, refined))
+				{
+					break;
+				}
+				const uint32_t r0 = Quantize565(refined.Start);
+				const uint32_t r1 = Quantize565(refined.End);
+				int refinedPalette[4][3];
+				ColorPalette(r0, r1, refinedPalette);
+				uint8_t refinedIndices[16];
+				const uint32_t refinedError = FitColorIndices(texels, refinedPalette, refinedIndices);
+				if (refinedError >= error)
+				{
+					break;
+				}
+				c0 = r0;
+				c1 = r1;
+				error = refinedError;
+				memcpy(indices, refinedIndices, sizeof(indices));
+			}
+		}
+
+		// BC1 only decodes four colors when c0 > c1; swapping the endpoints swaps
+		// indices 0/1 and 2/3
+		if (c0 < c1)
+		{
+			std::swap(c0, c1);
+			for (int t = 0; t < 16; t++)
+			{
+				indices[t] ^= 1;
+			}
+		}
+		else if (c0 == c1)
+		{
+			memset(indices, 0, sizeof(indices));
+		}
+
+		uint32_t bits = 0;
+		for (int t = 0; t < 16; t++)
+		{
+			bits |= static_cast<uint32_t>(indices[t]) << (2 * t);
+		}
+		block[0] = static_cast<uint8_t>(c0);
+		block[1] = static_cast<uint8_t>(c0 >> 8);
+		block[2] = static_cast<uint8_t>(c1);
+		block[3] = static_cast<uint8_t>(c1 >> 8);
+		memcpy(block + 4, &bits, sizeof(bits));
+	}
+
+	// ---- BC3 alpha / BC5 channel block ----
+
+	// Palette matching DecodeBcBlock for unsigned channels
+	void ChannelPalette(int a0, int a1, int palette[8])
+	{
+		palette[0] = a0;
+		palette[1] = a1;
+		if (a0 > a1)
+		{
+			for (int i = 1; i < 7; i++)
+			{
+				palette[1 + i] = ((7 - i) * a0 + i * a1 + 3) / 7;
+			}
+		}
+		else
+		{
+			for (int i = 1; i < 5; i++)
+			{
+				palette[1 + i] = ((5 - i) * a0 + i * a1 + 2) / 5;
+			}
+			palette[6] = 0;
+			palette[7] = 255;
+		}
+	}
+
+	uint32_t FitChannelIndices(const uint8_t values[16], const int palette[8], uint8_t indices[16])
+	{
+		uint32_t total = 0;
+		for (int t = 0; t < 16; t++)
+		{
+			uint32_t best = ~0u;
+			for (int i = 0; i < 8; i++)
+			{
+				const int d = values[t] - palette[i];
+				const uint32_t error = static_cast<uint32_t>(d * d);
+				if (error < best)
+				{
+					best = error;
+					indices[t] = static_cast<uint8_t>(i);
+				}
+			}
+			total += best;
+		}
+		return total;
+	}
+
+	void EncodeChannelBlock(const uint8_t values[16], BcQuality quality, uint8_t* block)
+	{
+		int low = 255, high = 0;
+		for (int t = 0; t < 16; t++)
+		{
+			low = std::min<int>(low, values[t]);
+			high = std::max<int>(high, values[t]);
+		}
+
+		int a0 = high, a1 = low;
+		uint8_t indices[16] = {};
+		uint32_t error = 0;
+		if (low != high)
+		{
+			int palette[8];
+			ChannelPalette(a0, a1, palette);
+			error = FitChannelIndices(values, palette, indices);
+		}
+
+		if (quality == BcQuality_High && error > 0)
+		{
+			auto consider = [&](int c0, int c1)
+			{
+				int palette[8];
+				uint8_t candidate[16];
+				ChannelPalette(c0, c1, palette);
+				const uint32_t candidateError = FitChannelIndices(values, palette, candidate);
+				if (candidateError < error)
+				{
+					a0 = c0;
+					a1 = c1;
+					error = candidateError;
+					memcpy(indices, candidate, sizeof(indices));
+				}
+			};
+
+			// Least squares on the eight value mode
+			const float positionOf[8] = { 0.0f, 1.0f, 1 / 7.0f, 2 / 7.0f, 3 / 7.0f, 4 / 7.0f, 5 / 7.0f, 6 / 7.0f };
+			float points[16][4];
+			float positions[16];
+			for (int t = 0; t < 16; t++)
+			{
+				points[t][0] = values[t];
+				positions[t] = positionOf[indices[t]];
+			}
+			Line refined;
+			if (RefineLine(points, 1, positions, refined))
+			{
+				const int r0 = Clamp(RoundToInt(refined.Start[0]), 0, 255);
+				const int r1 = Clamp(RoundToInt(refined.End[0]), 0, 255);
+				if (r0 > r1)
+				{
+					consider(r0, r1);
+				}
+			}
+
+			// The six value mode spends two entries on 0 and 255, so its endpoints only
+			// need to cover the values in between
+			int innerLow = 255, innerHigh = 0;
+			for (int t = 0; t < 16; t++)
+			{
+				if (values[t] != 0 && values[t] != 255)
+				{
+					innerLow = std::min<int>(innerLow, values[t]);
+					innerHigh = std::max<int>(innerHigh, values[t]);
+				}
+			}
+			if (innerLow <= innerHigh)
+			{
+				consider(innerLow, innerHigh);
+			}
+			else
+			{
+				consider(0, 0);
+			}
+		}
+
+		uint64_t bits = 0;
+		for (int t = 15; t >= 0; t--)
+		{
+			bits = (bits << 3) | indices[t];
+		}
+		block[0] = static_cast<uint8_t>(a0);
+		block[1] = static_cast<uint8_t>(a1);
+		for (int i = 0; i < 6; i++)
+		{
+			block[2 + i] = static_cast<uint8_t>(bits >> (8 * i));
+		}
+	}
+
+	// ---- BC7 mode 6 ----
+
+	struct Bc7Endpoints
+	{
+		// Eight bit values: the seven stored bits and the endpoint's p-bit as the LSB
+		int Value[2][4];
+	};
+
+	void Bc7Palette(const Bc7Endpoints& endpoints, int palette[16][4])
+	{
+		for (int i = 0; i < 16; i++)
+		{
+			for (int c = 0; c < 4; c++)
+			{
+				palette[i][c] = ((64 - Bc7Weights[i]) * endpoints.Value[0][c] + Bc7Weights[i] * endpoints.Value[1][c] + 32) >> 6;
+			}
+		}
+	}
+
+	uint32_t FitBc7Indices(const uint8_t texels[64], const int palette[16][4], uint8_t indices[16])
+	{
+		uint32_t total = 0;
+		for (int t = 0; t < 16; t++)
+		{
+			uint32_t best = ~0u;
+			for (int i = 0; i < 16; i++)
+			{
+				uint32_t error = 0;
+				for (int c = 0; c < 4; c++)
+				{
+					const int d = texels[t * 4 + c] - palette[i][c];
+					error += d * d;
+				}
+				if (error < best)
+				{
+					best = error;
+					indices[t] = static_cast<uint8_t>(i);
+				}
+			}
+			total += best;
+		}
+		return total;
+	}
+
+	// Rounds an endpoint to seven bits plus the given p-bit
+	void QuantizeBc7Endpoint(const float color[4], int pBit, int value[4])
+	{
+		for (int c = 0; c < 4; c++)
+		{
+			value[c] = Clamp(RoundToInt((color[c] - pBit) / 2.0f), 0, 127) * 2 + pBit;
+		}
+	}
+
+	// The p-bit that reproduces an endpoint most closely on its own
+	int BestPBit(const float color[4])
+	{
+		float errors[2] = {};
+		for (int p = 0; p < 2; p++)
+		{
+			int value[4];
+			QuantizeBc7Endpoint(color, p, value);
+			for (int c = 0; c < 4; c++)
+			{
+				errors[p] += (color[c] - value[c]) * (color[c] - value[c]);
+			}
+		}
+		return errors[1] < errors[0] ? 1 : 0;
+	}
+
+	// Best quantization of a line; tries every p-bit pair for the high preset
+	uint32_t QuantizeBc7Line(const uint8_t texels[64], const Line& line, BcQuality quality,
+		Bc7Endpoints& endpoints, uint8_t indices[16])
+	{
+		uint32_t best = ~0u;
+		for (int p = 0; p < 4; p++)
+		{
+			int p0 = p & 1, p1 = p >> 1;
+			if (quality == BcQuality_Fast)
+			{
+				if (p > 0)
+				{
+					break;
+				}
+				p0 = BestPBit(line.Start);
+				p1 = BestPBit(line.End);
+			}
+
+			Bc7Endpoints candidate;
+			QuantizeBc7Endpoint(line.Start, p0, candidate.Value[0]);
+			QuantizeBc7Endpoint(line.End, p1, candidate.Value[1]);
+			int palette[16][4];
+			Bc7Palette(candidate, palette);
+			uint8_t candidateIndices[16];
+			const uint32_t error = FitBc7Indices(texels, palette, candidateIndices);
+			if (error < best)
+			{
+				best = error;
+				endpoints = candidate;
+				memcpy(indices, candidateIndices, 16);
+			}
+		}
+		return best;
+	}
+
+	struct BitWriter
+	{
+		uint8_t* Bytes;
+		uint32_t Position = 0;
+
+		void Write(uint32_t value, uint32_t count)
+		{
+			for (uint32_t i = 0; i < count; i++, Position++)
+			{
+				Bytes[Position >> 3] |= static_cast<uint8_t>(((value >> i) & 1) << (Position & 7));
+			}
+		}
+	};
+
+	struct BitReader
+	{
+		const uint8_t* Bytes;
+		uint32_t Position = 0;
+
+		uint32_t Read(uint32_t count)
+		{
+			uint32_t value = 0;
+			for (uint32_t i = 0; i < count; i++, Position++)
+			{
+				value |= ((Bytes[Position >> 3] >> (Position & 7)) & 1u) << i;
+			}
+			return value;
+		}
+	};
+
+	void EncodeBc7Block(const uint8_t texels[64], BcQuality quality, uint8_t* block)
+	{
+		float points[16][4];
+		LoadPoints(texels, points);
+		const Line line = (quality == BcQuality_Fast) ? BoundingBoxLine(points, 4) : PrincipalLine(points, 4);
+
+		Bc7Endpoints endpoints;
+		uint8_t indices[16];
+		uint32_t error = QuantizeBc7Line(texels, line, quality, endpoints, indices);
+
+		if (quality == BcQuality_High)
+		{
+			for (uint32_t iteration = 0; iteration < RefineIterations && error > 0; iteration++)
+			{
+				float positions[16];
+				for (int t = 0; t < 16; t++)
+				{
+					positions[t] = Bc7Weights[indices[t]] / 64.0f;
+				}
+				Line refined;
+				if (!RefineLine(points, 4, positions, refined))
+				{
+					break;
+				}
+				Bc7Endpoints refinedEndpoints;
+				uint8_t refinedIndices[16];
+				const uint32_t refinedError = QuantizeBc7Line(texels, refined, quality, refinedEndpoints, refinedIndices);
+				if (refinedError >= error)
+				{
+					break;
+				}
+				error = refinedError;
+				endpoints = refinedEndpoints;
+				memcpy(indices, refinedIndices, sizeof(indices));
+			}
+		}
+
+		// The first texel's index is stored without its top bit, which must be zero
+		if (indices[0] & 8)
+		{
+			for (int c = 0; c < 4; c++)
+			{
+				std::swap(endpoints.Value[0][c], endpoints.Value[1][c]);
+			}
+			for (int t = 0; t < 16; t++)
+			{
+				indices[t] = static_cast<uint8_t>(15 - indices[t]);
+			}
+		}
+
+		memset(block, 0, 16);
+		BitWriter writer = { block };
+		writer.Write(1 << 6, 7);
+		for (int c = 0; c < 4; c++)
+		{
+			writer.Write(endpoints.Value[0][c] >> 1, 7);
+			writer.Write(endpoints.Value[1][c] >> 1, 7);
+		}
+		writer.Write(endpoints.Value[0][0] & 1, 1);
+		writer.Write(endpoints.Value[1][0] & 1, 1);
+		writer.Write(indices[0], 3);
+		for (int t = 1; t < 16; t++)
+		{
+			writer.Write(indices[t], 4);
+		}
+	}
+
+	void DecodeBc7Block(const uint8_t* block, uint8_t texels[64])
+	{
+		BitReader reader = { block };
+		if (reader.Read(7) != (1 << 6))
+		{
+			// Not mode 6; decoded as opaque black rather than guessed at
+			for (int t = 0; t < 16; t++)
+			{
+				texels[t * 4 + 0] = texels[t * 4 + 1] = texels[t * 4 + 2] = 0;
+				texels[t * 4 + 3] = 255;
+			}
+			return;
+		}
+
+		Bc7Endpoints endpoints;
+		for (int c = 0; c < 4; c++)
+		{
+			endpoints.Value[0][c] = reader.Read(7) << 1;
+			endpoints.Value[1][c] = reader.Read(7) << 1;
+		}
+		const int p0 = reader.Read(1), p1 = reader.Read(1);
+		for (int c = 0; c < 4; c++)
+		{
+			endpoints.Value[0][c] |= p0;
+			endpoints.Value[1][c] |= p1;
+		}
+
+		int palette[16][4];
+		Bc7Palette(endpoints, palette);
+		for (int t = 0; t < 16; t++)
+		{
+			const uint32_t index = reader.Read(t == 0 ? 3 : 4);
+			for (int c = 0; c < 4; c++)
+			{
+				texels[t * 4 + c] = static_cast<uint8_t>(palette[index][c]);
+			}
+		}
+	}
+
+	// Copies the 4x4 block at (bx, by), repeating the last row and column past the edges
+	void GatherBlock(const uint8_t* rgba, size_t rgbaPitch, uint32_t width, uint32_t height,
+		uint32_t bx, uint32_t by, uint8_t texels[64])
+	{
+		for (uint32_t y = 0; y < 4; y++)
+		{
+			const uint8_t* row = rgba + std::min(by * 4 + y, height - 1) * rgbaPitch;
+			for (uint32_t x = 0; x < 4; x++)
+			{
+				memcpy(texels + (y * 4 + x) * 4, row + std::min(bx * 4 + x, width - 1) * 4, 4);
+			}
+		}
+	}
+}
+
+size_t BcEncodeBlockBytes(BcEncodeFormat format)
+{
+	return (format == BcEncodeFormat_BC1) ? 8 : 16;
+}
+
+void EncodeBcBlock(BcEncodeFormat format, BcQuality quality, const uint8_t texels[64], uint8_t* block)
+{
+	switch (format)
+	{
+	case BcEncodeFormat_BC1:
+		EncodeColorBlock(texels, quality, block);
+		break;
+
+	case BcEncodeFormat_BC3:
+	{
+		uint8_t alpha[16];
+		for (int t = 0; t < 16; t++)
+		{
+			alpha[t] = texels[t * 4 + 3];
+		}
+		EncodeChannelBlock(alpha, quality, block);
+		EncodeColorBlock(texels, quality, block + 8);
+	} break;
+
+	case BcEncodeFormat_BC5:
+	{
+		uint8_t red[16], green[16];
+		for (int t = 0; t < 16; t++)
+		{
+			red[t] = texels[t * 4];
+			green[t] = texels[t * 4 + 1];
+		}
+		EncodeChannelBlock(red, quality, block);
+		EncodeChannelBlock(green, quality, block + 8);
+	} break;
+
+	case BcEncodeFormat_BC7:
+		EncodeBc7Block(texels, quality, block);
+		break;
+	}
+}
+
+void DecodeEncodedBlock(BcEncodeFormat format, const uint8_t* block, uint8_t texels[64])
+{
+	switch (format)
+	{
+	case BcEncodeFormat_BC1:
+		DecodeBcBlock(BcFormat_BC1, block, texels, 16);
+		break;
+
+	case BcEncodeFormat_BC3:
+		DecodeBcBlock(BcFormat_BC3, block, texels, 16);
+		break;
+
+	case BcEncodeFormat_BC5:
+	{
+		uint8_t rg[32];
+		DecodeBcBlock(BcFormat_BC5Unorm, block, rg, 8);
+		for (int t = 0; t < 16; t++)
+		{
+			texels[t * 4 + 0] = rg[t * 2];
+			texels[t * 4 + 1] = rg[t * 2 + 1];
+			texels[t * 4 + 2] = 0;
+			texels[t * 4 + 3] = 255;
+		}
+	} break;
+
+	case BcEncodeFormat_BC7:
+		DecodeBc7Block(block, texels);
+		break;
+	}
+}
+
+void EncodeBcSurface(BcEncodeFormat format, BcQuality quality, const uint8_t* rgba, size_t rgbaPitch,
+	uint32_t width, uint32_t height, uint8_t* blocks, unsigned threadCount)
+{
+	const uint32_t blocksWide = std::max(1u, (width + 3) / 4);
+	const uint32_t blocksHigh = std::max(1u, (height + 3) / 4);
+	const size_t blockBytes = BcEncodeBlockBytes(format);
+
+	ParallelFor(blocksHigh, threadCount, [&](size_t by)
+	{
+		uint8_t texels[64];
+		for (uint32_t bx = 0; bx < blocksWide; bx++)
+		{
+			GatherBlock(rgba, rgbaPitch, width, height, bx, static_cast<uint32_t>(by), texels);
+			EncodeBcBlock(format, quality, texels, blocks + (by * blocksWide + bx) * blockBytes);
+		}
+	});
+}
+
+double BcSurfacePsnr(BcEncodeFormat format, const uint8_t* rgba, size_t rgbaPitch,
+	uint32_t width, uint32_t height, const uint8_t* blocks)
+{
+	const uint32_t blocksWide = std::max(1u, (width + 3) / 4);
+	const size_t blockBytes = BcEncodeBlockBytes(format);
+	const int channelCount = (format == BcEncodeFormat_BC1) ? 3 : (format == BcEncodeFormat_BC5) ? 2 : 4;
+
+	uint64_t squaredError = 0;
+	uint8_t texels[64];
+	for (uint32_t y = 0; y < height; y++)
+	{
+		for (uint32_t x = 0; x < width; x++)
+		{
+			if ((x & 3) == 0)
+			{
+				DecodeEncodedBlock(format, blocks + ((y / 4) * blocksWide + x / 4) * blockBytes, texels);
+			}
+			const uint8_t* decoded = texels + ((y & 3) * 4 + (x & 3)) * 4;
+			const uint8_t* source = rgba + y * rgbaPitch + x * 4;
+			for (int c = 0; c < channelCount; c++)
+			{
+				const int d = decoded[c] - source[c];
+				squaredError += d * d;
+			}
+		}
+	}
+
+	if (squaredError == 0)
+	{
+		return 99.0;
+	}
+	const double meanSquaredError = static_cast<double>(squaredError) / (static_cast<double>(width) * height * channelCount);
+	return 10.0 * std::log10(255.0 * 255.0 / meanSquaredError);
+}
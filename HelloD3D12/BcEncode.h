@@ -0,0 +1,43 @@
+#pragma once
+#include <cstddef>
+#include <cstdint>
+
+// Block compressed formats the CPU encoder writes. BC1 is opaque RGB, BC3 adds
+// interpolated alpha, BC5 keeps red and green (normal maps) and BC7 uses mode 6:
+// one RGBA endpoint pair per block with 4-bit indices.
+enum BcEncodeFormat : uint32_t
+{
+	BcEncodeFormat_BC1,
+	BcEncodeFormat_BC3,
+	BcEncodeFormat_BC5,
+	BcEncodeFormat_BC7,
+};
+
+enum BcQuality : uint32_t
+{
+	// Endpoints from the bounding box diagonal, no refinement
+	BcQuality_Fast,
+	// Endpoints along the principal axis, refined by least squares and the
+	// alternative encodings of each block tried
+	BcQuality_High,
+};
+
+size_t BcEncodeBlockBytes(BcEncodeFormat format);
+
+// Encodes one 4x4 block of RGBA8 texels (rows of four, red in the low byte)
+void EncodeBcBlock(BcEncodeFormat format, BcQuality quality, const uint8_t texels[64], uint8_t* block);
+
+// Decodes a block written by EncodeBcBlock back to RGBA8 texels (BC5 gives blue 0 and
+// alpha 255). BC7 blocks must use mode 6.
+void DecodeEncodedBlock(BcEncodeFormat format, const uint8_t* block, uint8_t texels[64]);
+
+// Encodes a width x height RGBA8 surface, rows rgbaPitch bytes apart, into block rows
+// laid out as in a DDS file. Edge blocks repeat the last row and column. Block rows
+// are spread over up to threadCount threads (0 picks one per core).
+void EncodeBcSurface(BcEncodeFormat format, BcQuality quality, const uint8_t* rgba, size_t rgbaPitch,
+	uint32_t width, uint32_t height, uint8_t* blocks, unsigned threadCount = 0);
+
+// Peak signal to noise ratio of the encoded surface against its source, in dB over
+// the channels the format keeps
+double BcSurfacePsnr(BcEncodeFormat format, const uint8_t* rgba, size_t rgbaPitch,
+	uint32_t width, uint32_t height, const uint8_t* blocks);
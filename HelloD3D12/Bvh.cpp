@@ -0,0 +1,591 @@
+#include "Bvh.h"
+#include <algorithm>
+#include <cassert>
+#include <cmath>
+#include <cstring>
+#include <limits>
+
+#if (defined(_M_X64) || defined(__x86_64__)) && !defined(HELLOD3D12_NO_SIMD)
+#include <emmintrin.h>
+#define BVH_SSE2 1
+#endif
+
+namespace
+{
+	const uint32_t BinCount = 12;
+	const uint32_t MaxLeafTriangles = 8;
+	const uint32_t MaxLeafInstances = 1;
+	// Cost of visiting a node, in units of one primitive group test
+	const float TraversalCost = 1.0f;
+	const uint32_t MaxStackDepth = 64;
+	// Below this depth nodes are split at the object median, which takes at most 32 more
+	// levels for 2^32 primitives, so no leaf is deeper than the traversal stack
+	const uint32_t MedianSplitDepth = MaxStackDepth - 32;
+	const float Infinity = std::numeric_limits<float>::infinity();
+
+	struct Aabb
+	{
+		float Min[3] = { Infinity, Infinity, Infinity };
+		float Max[3] = { -Infinity, -Infinity, -Infinity };
+
+		void Grow(const float p[3])
+		{
+			for (int a = 0; a < 3; a++)
+			{
+				Min[a] = std::min(Min[a], p[a]);
+				Max[a] = std::max(Max[a], p[a]);
+			}
+		}
+
+		void Grow(const Aabb& b)
+		{
+			Grow(b.Min);
+			Grow(b.Max);
+		}
+
+		float HalfArea() const
+		{
+			const float x = Max[0] - Min[0], y = Max[1] - Min[1], z = Max[2] - Min[2];
+			return (x < 0.0f) ? 0.0f : x * y + y * z + z * x;
+		}
+	};
+
+	struct BuildItem
+	{
+		uint32_t Node;
+		uint32_t First;
+		uint32_t Count;
+		uint32_t Depth;
+	};
+
+	inline uint32_t GroupCount(uint32_t count, uint32_t width)
+	{
+		return (count + width - 1) / width;
+	}
+
+	// Partitions the item's range of order at the cheapest binned SAH split and returns the
+	// size of the left side, or 0 if the item is better off as a leaf
+	uint32_t SahSplit(const BuildItem& item, const Aabb& box, const Aabb& centroidBox, std::vector<uint32_t>& order,
+		const std::vector<Aabb>& bounds, const std::vector<float>& centroids, uint32_t maxLeafSize, uint32_t groupWidth)
+	{
+		// Best bin boundary over the three axes
+		float bestCost = std::numeric_limits<float>::max();
+		int bestAxis = -1;
+		uint32_t bestSplit = 0;
+		for (int axis = 0; axis < 3; axis++)
+		{
+			const float extent = centroidBox.Max[axis] - centroidBox.Min[axis];
+			if (extent <= 0.0f)
+			{
+				continue;
+			}
+			const float binScale = BinCount / extent;
+
+			Aabb bins[BinCount];
+			uint32_t binCounts[BinCount] = {};
+			for (uint32_t i = item.First; i < item.First + item.Count; i++)
+			{
+				const uint32_t p = order[i];
+				const uint32_t b = std::min(BinCount - 1, static_cast<uint32_t>((centroids[p * 3 + axis] - centroidBox.Min[axis]) * binScale));
+				bins[b].Grow(bounds[p]);
+				binCounts[b]++;
+			}
+
+			float leftArea[BinCount - 1];
+			uint32_t leftCount[BinCount - 1];
+			Aabb left;
+			uint32_t count = 0;
+			for (uint32_t b = 0; b < BinCount - 1; b++)
+			{
+				left.Grow(bins[b]);
+				count += binCounts[b];
+				leftArea[b] = left.HalfArea();
+				leftCount[b] = count;
+			}
+
+			Aabb right;
+			count = 0;
+			for (uint32_t b = BinCount - 1; b > 0; b--)
+			{
+				right.Grow(bins[b]);
+				count += binCounts[b];
+				const uint32_t leftN = leftCount[b - 1];
+				if (leftN == 0 || count == 0)
+				{
+					continue;
+				}
+				const float cost = leftArea[b - 1] * GroupCount(leftN, groupWidth) + right.HalfArea() * GroupCount(count, groupWidth);
+				if (cost < bestCost)
+				{
+					bestCost = cost;
+					bestAxis = axis;
+					bestSplit = b;
+				}
+			}
+		}
+
+		if (bestAxis < 0)
+		{
+			// Every centroid in the same spot: no split helps, only the leaf size limit
+			return (item.Count <= maxLeafSize) ? 0 : item.Count / 2;
+		}
+
+		const float area = box.HalfArea();
+		const float leafCost = area * GroupCount(item.Count, groupWidth);
+		if (item.Count <= maxLeafSize && bestCost + area * TraversalCost >= leafCost)
+		{
+			return 0;
+		}
+
+		const float binScale = BinCount / (centroidBox.Max[bestAxis] - centroidBox.Min[bestAxis]);
+		uint32_t* begin = order.data() + item.First;
+		uint32_t* middle = std::partition(begin, begin + item.Count, [&](uint32_t p)
+		{
+			return std::min(BinCount - 1, static_cast<uint32_t>((centroids[p * 3 + bestAxis] - centroidBox.Min[bestAxis]) * binScale)) < bestSplit;
+		});
+		return static_cast<uint32_t>(middle - begin);
+	}
+
+	// Binned SAH over primitive bounds; leaves index ranges of order. Costs count
+	// groups of groupWidth primitives since that many are tested at once. Skewed inputs
+	// such as geometrically spaced primitives would peel one off per level, so deep
+	// nodes fall back to median splits.
+	void BuildNodes(std::vector<BvhNode>& nodes, std::vector<uint32_t>& order, const std::vector<Aabb>& bounds,
+		uint32_t maxLeafSize, uint32_t groupWidth)
+	{
+		const uint32_t primitiveCount = static_cast<uint32_t>(bounds.size());
+		std::vector<float> centroids(primitiveCount * 3);
+		for (uint32_t i = 0; i < primitiveCount; i++)
+		{
+			for (int a = 0; a < 3; a++)
+			{
+				centroids[i * 3 + a] = (bounds[i].Min[a] + bounds[i].Max[a]) * 0.5f;
+			}
+		}
+
+		order.resize(primitiveCount);
+		for (uint32_t i = 0; i < primitiveCount; i++)
+		{
+			order[i] = i;
+		}
+
+		nodes.clear();
+		nodes.reserve(primitiveCount * 2);
+		nodes.push_back({});
+		if (primitiveCount == 0)
+		{
+			return;
+		}
+
+		std::vector<BuildItem> stack;
+		stack.push_back({ 0, 0, primitiveCount, 0 });
+		while (!stack.empty())
+		{
+			const BuildItem item = stack.back();
+			stack.pop_back();
+
+			Aabb box, centroidBox;
+			for (uint32_t i = item.First; i < item.First + item.Count; i++)
+			{
+				box.Grow(bounds[order[i]]);
+				centroidBox.Grow(&centroids[order[i] * 3]);
+			}
+			BvhNode& node = nodes[item.Node];
+			memcpy(node.Min, box.Min, sizeof(node.Min));
+			memcpy(node.Max, box.Max, sizeof(node.Max));
+			node.LeftFirst = item.First;
+			node.Count = item.Count;
+
+			if (item.Count <= 1)
+			{
+				continue;
+			}
+
+			assert(item.Depth <= MaxStackDepth);
+			uint32_t leftCount;
+			if (item.Depth >= MedianSplitDepth)
+			{
+				if (item.Count <= maxLeafSize)
+				{
+					continue;
+				}
+				int axis = 0;
+				for (int a = 1; a < 3; a++)
+				{
+					if (centroidBox.Max[a] - centroidBox.Min[a] > centroidBox.Max[axis] - centroidBox.Min[axis])
+					{
+						axis = a;
+					}
+				}
+				leftCount = item.Count / 2;
+				uint32_t* begin = order.data() + item.First;
+				std::nth_element(begin, begin + leftCount, begin + item.Count, [&](uint32_t a, uint32_t b)
+				{
+					return centroids[a * 3 + axis] < centroids[b * 3 + axis];
+				});
+			}
+			else
+			{
+				leftCount = SahSplit(item, box, centroidBox, order, bounds, centroids, maxLeafSize, groupWidth);
+				if (leftCount == 0)
+				{
+					continue;
+				}
+			}
+
+			const uint32_t leftChild = static_cast<uint32_t>(nodes.size());
+			nodes[item.Node].LeftFirst = leftChild;
+			nodes[item.Node].Count = 0;
+			nodes.push_back({});
+			nodes.push_back({});
+			stack.push_back({ leftChild + 1, item.First + leftCount, item.Count - leftCount, item.Depth + 1 });
+			stack.push_back({ leftChild, item.First, leftCount, item.Depth + 1 });
+		}
+	}
+
+	struct PreparedRay
+	{
+		float Origin[4];
+		float InverseDirection[4];
+	};
+
+	PreparedRay PrepareRay(const BvhRay& ray)
+	{
+		PreparedRay prepared;
+		const float* origin = &ray.Origin.x;
+		const float* direction = &ray.Direction.x;
+		for (int a = 0; a < 3; a++)
+		{
+			// Keep the slabs finite for axis aligned rays
+			const float d = (fabsf(direction[a]) < 1e-30f) ? copysignf(1e-30f, direction[a]) : direction[a];
+			prepared.Origin[a] = origin[a];
+			prepared.InverseDirection[a] = 1.0f / d;
+		}
+		prepared.Origin[3] = 0.0f;
+		prepared.InverseDirection[3] = 0.0f;
+		return prepared;
+	}
+
+	// Entry distance into the node's box, or +infinity when the ray misses it before maxDistance
+	inline float IntersectNode(const BvhNode& node, const PreparedRay& ray, float maxDistance)
+	{
+#if BVH_SSE2
+		const __m128 origin = _mm_loadu_ps(ray.Origin);
+		const __m128 inverse = _mm_loadu_ps(ray.InverseDirection);
+		const __m128 t0 = _mm_mul_ps(_mm_sub_ps(_mm_loadu_ps(node.Min), origin), inverse);
+		const __m128 t1 = _mm_mul_ps(_mm_sub_ps(_mm_loadu_ps(node.Max), origin), inverse);
+
+		// The fourth lane holds LeftFirst/Count; replace it with the [0, maxDistance] ray interval
+		const __m128 xyz = _mm_castsi128_ps(_mm_set_epi32(0, -1, -1, -1));
+		__m128 enter = _mm_and_ps(_mm_min_ps(t0, t1), xyz);
+		__m128 exit = _mm_or_ps(_mm_and_ps(_mm_max_ps(t0, t1), xyz), _mm_andnot_ps(xyz, _mm_set1_ps(maxDistance)));
+		enter = _mm_max_ps(enter, _mm_shuffle_ps(enter, enter, _MM_SHUFFLE(1, 0, 3, 2)));
+		enter = _mm_max_ps(enter, _mm_shuffle_ps(enter, enter, _MM_SHUFFLE(2, 3, 0, 1)));
+		exit = _mm_min_ps(exit, _mm_shuffle_ps(exit, exit, _MM_SHUFFLE(1, 0, 3, 2)));
+		exit = _mm_min_ps(exit, _mm_shuffle_ps(exit, exit, _MM_SHUFFLE(2, 3, 0, 1)));
+		const float tEnter = _mm_cvtss_f32(enter);
+		const float tExit = _mm_cvtss_f32(exit);
+#else
+		float tEnter = 0.0f;
+		float tExit = maxDistance;
+		for (int a = 0; a < 3; a++)
+		{
+			const float t0 = (node.Min[a] - ray.Origin[a]) * ray.InverseDirection[a];
+			const float t1 = (node.Max[a] - ray.Origin[a]) * ray.InverseDirection[a];
+			tEnter = std::max(tEnter, std::min(t0, t1));
+			tExit = std::min(tExit, std::max(t0, t1));
+		}
+#endif
+		return (tEnter <= tExit) ? tEnter : Infinity;
+	}
+
+	// Closest child first; leaf(first, count, maxDistance) returns whether it found a closer hit
+	// and lowers maxDistance
+	template<typename LeafFn>
+	bool Traverse(const std::vector<BvhNode>& nodes, const BvhRay& ray, float& maxDistance, LeafFn&& leaf)
+	{
+		// A build over nothing leaves a single empty root
+		if (nodes.empty() || (nodes.size() == 1 && nodes[0].Count == 0))
+		{
+			return false;
+		}
+
+		const PreparedRay prepared = PrepareRay(ray);
+		if (IntersectNode(nodes[0], prepared, maxDistance) == Infinity)
+		{
+			return false;
+		}
+
+		bool found = false;
+		uint32_t stack[MaxStackDepth];
+		uint32_t depth = 0;
+		uint32_t current = 0;
+		for (;;)
+		{
+			const BvhNode& node = nodes[current];
+			if (node.Count != 0)
+			{
+				found |= leaf(node.LeftFirst, node.Count, maxDistance);
+			}
+			else
+			{
+				uint32_t nearChild = node.LeftFirst;
+				uint32_t farChild = node.LeftFirst + 1;
+				float nearT = IntersectNode(nodes[nearChild], prepared, maxDistance);
+				float farT = IntersectNode(nodes[farChild], prepared, maxDistance);
+				if (farT < nearT)
+				{
+					std::swap(nearChild, farChild);
+					std::swap(nearT, farT);
+				}
+				if (nearT != Infinity)
+				{
+					if (farT != Infinity)
+					{
+						// The build keeps every leaf within MaxStackDepth levels
+						assert(depth < MaxStackDepth);
+						stack[depth++] = farChild;
+					}
+					current = nearChild;
+					continue;
+				}
+			}
+
+			// Pop until a node that can still beat the closest hit
+			for (;;)
+			{
+				if (depth == 0)
+				{
+					return found;
+				}
+				current = stack[--depth];
+				if (IntersectNode(nodes[current], prepared, maxDistance) != Infinity)
+				{
+					break;
+				}
+			}
+		}
+	}
+
+	// Moller-Trumbore against the four triangles of a packet
+	inline bool IntersectPacket(const BvhTrianglePacket& packet, const BvhRay& ray, float& maxDistance, BvhHit& hit)
+	{
+		float t[4], u[4], v[4];
+		int mask;
+#if BVH_SSE2
+		const __m128 ox = _mm_set1_ps(ray.Origin.x), oy = _mm_set1_ps(ray.Origin.y), oz = _mm_set1_ps(ray.Origin.z);
+		const __m128 dx = _mm_set1_ps(ray.Direction.x), dy = _mm_set1_ps(ray.Direction.y), dz = _mm_set1_ps(ray.Direction.z);
+		const __m128 e1x = _mm_loadu_ps(packet.E1[0]), e1y = _mm_loadu_ps(packet.E1[1]), e1z = _mm_loadu_ps(packet.E1[2]);
+		const __m128 e2x = _mm_loadu_ps(packet.E2[0]), e2y = _mm_loadu_ps(packet.E2[1]), e2z = _mm_loadu_ps(packet.E2[2]);
+
+		const __m128 px = _mm_sub_ps(_mm_mul_ps(dy, e2z), _mm_mul_ps(dz, e2y));
+		const __m128 py = _mm_sub_ps(_mm_mul_ps(dz, e2x), _mm_mul_ps(dx, e2z));
+		const __m128 pz = _mm_sub_ps(_mm_mul_ps(dx, e2y), _mm_mul_ps(dy, e2x));
+		const __m128 det = _mm_add_ps(_mm_add_ps(_mm_mul_ps(e1x, px), _mm_mul_ps(e1y, py)), _mm_mul_ps(e1z, pz));
+		const __m128 inv = _mm_div_ps(_mm_set1_ps(1.0f), det);
+
+		const __m128 sx = _mm_sub_ps(ox, _mm_loadu_ps(packet.V0[0]));
+		const __m128 sy = _mm_sub_ps(oy, _mm_loadu_ps(packet.V0[1]));
+		const __m128 sz = _mm_sub_ps(oz, _mm_loadu_ps(packet.V0[2]));
+		const __m128 uu = _mm_mul_ps(_mm_add_ps(_mm_add_ps(_mm_mul_ps(sx, px), _mm_mul_ps(sy, py)), _mm_mul_ps(sz, pz)), inv);
+
+		const __m128 qx = _mm_sub_ps(_mm_mul_ps(sy, e1z), _mm_mul_ps(sz, e1y));
+		const __m128 qy = _mm_sub_ps(_mm_mul_ps(sz, e1x), _mm_mul_ps(sx, e1z));
+		const __m128 qz = _mm_sub_ps(_mm_mul_ps(sx, e1y), _mm_mul_ps(sy, e1x));
+		const __m128 vv = _mm_mul_ps(_mm_add_ps(_mm_add_ps(_mm_mul_ps(dx, qx), _mm_mul_ps(dy, qy)), _mm_mul_ps(dz, qz)), inv);
+		const __m128 tt = _mm_mul_ps(_mm_add_ps(_mm_add_ps(_mm_mul_ps(e2x, qx), _mm_mul_ps(e2y, qy)), _mm_mul_ps(e2z, qz)), inv);
+
+		const __m128 zero = _mm_setzero_ps();
+		__m128 accept = _mm_cmpneq_ps(det, zero);
+		accept = _mm_and_ps(accept, _mm_cmpge_ps(uu, zero));
+		accept = _mm_and_ps(accept, _mm_cmpge_ps(vv, zero));
+		accept = _mm_and_ps(accept, _mm_cmple_ps(_mm_add_ps(uu, vv), _mm_set1_ps(1.0f)));
+		accept = _mm_and_ps(accept, _mm_cmpge_ps(tt, zero));
+		accept = _mm_and_ps(accept, _mm_cmplt_ps(tt, _mm_set1_ps(maxDistance)));
+		mask = _mm_movemask_ps(accept);
+		if (mask == 0)
+		{
+			return false;
+		}
+		_mm_storeu_ps(t, tt);
+		_mm_storeu_ps(u, uu);
+		_mm_storeu_ps(v, vv);
+#else
+		mask = 0;
+		const float* o = &ray.Origin.x;
+		const float* d = &ray.Direction.x;
+		for (int i = 0; i < 4; i++)
+		{
+			const float e1[3] = { packet.E1[0][i], packet.E1[1][i], packet.E1[2][i] };
+			const float e2[3] = { packet.E2[0][i], packet.E2[1][i], packet.E2[2][i] };
+			const float p[3] = { d[1] * e2[2] - d[2] * e2[1], d[2] * e2[0] - d[0] * e2[2], d[0] * e2[1] - d[1] * e2[0] };
+			const float det = e1[0] * p[0] + e1[1] * p[1] + e1[2] * p[2];
+			if (det == 0.0f)
+			{
+				continue;
+			}
+			const float inv = 1.0f / det;
+			const float s[3] = { o[0] - packet.V0[0][i], o[1] - packet.V0[1][i], o[2] - packet.V0[2][i] };
+			const float q[3] = { s[1] * e1[2] - s[2] * e1[1], s[2] * e1[0] - s[0] * e1[2], s[0] * e1[1] - s[1] * e1[0] };
+			u[i] = (s[0] * p[0] + s[1] * p[1] + s[2] * p[2]) * inv;
+			v[i] = (d[0] * q[0] + d[1] * q[1] + d[2] * q[2]) * inv;
+			t[i] = (e2[0] * q[0] + e2[1] * q[1] + e2[2] * q[2]) * inv;
+			if (u[i] >= 0.0f && v[i] >= 0.0f && u[i] + v[i] <= 1.0f && t[i] >= 0.0f && t[i] < maxDistance)
+			{
+				mask |= 1 << i;
+			}
+		}
+		if (mask == 0)
+		{
+			return false;
+		}
+#endif
+		int closest = -1;
+		for (int i = 0; i < 4; i++)
+		{
+			if ((mask & (1 << i)) && (closest < 0 || t[i] < t[closest]))
+			{
+				closest = i;
+			}
+		}
+		maxDistance = t[closest];
+		hit.Distance = t[closest];
+		hit.Triangle = packet.Triangle[closest];
+		hit.U = u[closest];
+		hit.V = v[closest];
+		return true;
+	}
+
+	void TransformPoint(const float m[16], const MeshFloat3& p, MeshFloat3& out)
+	{
+		out.x = p.x * m[0] + p.y * m[4] + p.z * m[8] + m[12];
+		out.y = p.x * m[1] + p.y * m[5] + p.z * m[9] + m[13];
+		out.z = p.x * m[2] + p.y * m[6] + p.z * m[10] + m[14];
+	}
+
+	void TransformVector(const float m[16], const MeshFloat3& v, MeshFloat3& out)
+	{
+		out.x = v.x * m[0] + v.y * m[4] + v.z * m[8];
+		out.y = v.x * m[1] + v.y * m[5] + v.z * m[9];
+		out.z = v.x * m[2] + v.y * m[6] + v.z * m[10];
+	}
+}
+
+void BuildMeshBvh(MeshBvh& bvh, const uint32_t* indices, size_t indexCount, const MeshVertex* vertices, size_t vertexCount)
+{
+	const uint32_t triangleCount = static_cast<uint32_t>(indexCount / 3);
+	std::vector<Aabb> bounds(triangleCount);
+	for (uint32_t t = 0; t < triangleCount; t++)
+	{
+		for (uint32_t k = 0; k < 3; k++)
+		{
+			const uint32_t index = indices[t * 3 + k];
+			if (index < vertexCount)
+			{
+				bounds[t].Grow(&vertices[index].Position.x);
+			}
+		}
+	}
+
+	std::vector<uint32_t> order;
+	BuildNodes(bvh.Nodes, order, bounds, MaxLeafTriangles, BvhPacketWidth);
+
+	// Leaves switch from triangle ranges to packet ranges
+	bvh.Packets.clear();
+	bvh.Packets.reserve(GroupCount(triangleCount, BvhPacketWidth) + bvh.Nodes.size() / 2);
+	for (BvhNode& node : bvh.Nodes)
+	{
+		if (node.Count == 0)
+		{
+			continue;
+		}
+		const uint32_t first = node.LeftFirst;
+		const uint32_t count = node.Count;
+		node.LeftFirst = static_cast<uint32_t>(bvh.Packets.size());
+		node.Count = GroupCount(count, BvhPacketWidth);
+
+		for (uint32_t i = 0; i < count; i += BvhPacketWidth)
+		{
+			BvhTrianglePacket packet = {};
+			for (uint32_t lane = 0; lane < BvhPacketWidth; lane++)
+			{
+				packet.Triangle[lane] = ~0u;
+				if (i + lane >= count)
+				{
+					continue;
+				}
+				const uint32_t t = order[first + i + lane];
+				const MeshFloat3& p0 = vertices[indices[t * 3 + 0]].Position;
+				const MeshFloat3& p1 = vertices[indices[t * 3 + 1]].Position;
+				const MeshFloat3& p2 = vertices[indices[t * 3 + 2]].Position;
+				packet.V0[0][lane] = p0.x; packet.V0[1][lane] = p0.y; packet.V0[2][lane] = p0.z;
+				packet.E1[0][lane] = p1.x - p0.x; packet.E1[1][lane] = p1.y - p0.y; packet.E1[2][lane] = p1.z - p0.z;
+				packet.E2[0][lane] = p2.x - p0.x; packet.E2[1][lane] = p2.y - p0.y; packet.E2[2][lane] = p2.z - p0.z;
+				packet.Triangle[lane] = t;
+			}
+			bvh.Packets.push_back(packet);
+		}
+	}
+}
+
+bool IntersectMeshBvh(const MeshBvh& bvh, const BvhRay& ray, float maxDistance, BvhHit& hit)
+{
+	return Traverse(bvh.Nodes, ray, maxDistance, [&](uint32_t first, uint32_t count, float& distance)
+	{
+		bool found = false;
+		for (uint32_t p = first; p < first + count; p++)
+		{
+			found |= IntersectPacket(bvh.Packets[p], ray, distance, hit);
+		}
+		return found;
+	});
+}
+
+void BuildSceneBvh(SceneBvh& scene, const BvhInstance* instances, size_t instanceCount, const MeshBvh* meshes)
+{
+	// World bounds from the eight corners of each mesh's root box
+	std::vector<Aabb> bounds(instanceCount);
+	for (size_t i = 0; i < instanceCount; i++)
+	{
+		const MeshBvh& mesh = meshes[instances[i].Mesh];
+		if (mesh.Nodes.empty() || mesh.Packets.empty())
+		{
+			continue;
+		}
+		const BvhNode& root = mesh.Nodes[0];
+		for (uint32_t corner = 0; corner < 8; corner++)
+		{
+			const MeshFloat3 p = { (corner & 1) ? root.Max[0] : root.Min[0], (corner & 2) ? root.Max[1] : root.Min[1], (corner & 4) ? root.Max[2] : root.Min[2] };
+			MeshFloat3 world;
+			TransformPoint(instances[i].World, p, world);
+			bounds[i].Grow(&world.x);
+		}
+	}
+
+	BuildNodes(scene.Nodes, scene.Instances, bounds, MaxLeafInstances, 1);
+}
+
+bool IntersectSceneBvh(const SceneBvh& scene, const BvhInstance* instances, const MeshBvh* meshes,
+	const BvhRay& ray, float maxDistance, SceneHit& hit)
+{
+	return Traverse(scene.Nodes, ray, maxDistance, [&](uint32_t first, uint32_t count, float& distance)
+	{
+		bool found = false;
+		for (uint32_t i = first; i < first + count; i++)
+		{
+			const uint32_t instance = scene.Instances[i];
+
+			// An unnormalised model space direction keeps distances comparable across instances
+			BvhRay local;
+			TransformPoint(instances[instance].InverseWorld, ray.Origin, local.Origin);
+			TransformVector(instances[instance].InverseWorld, ray.Direction, local.Direction);
+			if (IntersectMeshBvh(meshes[instances[instance].Mesh], local, distance, hit.Hit))
+			{
+				distance = hit.Hit.Distance;
+				hit.Instance = instance;
+				found = true;
+			}
+		}
+		return found;
+	});
+}
@@ -0,0 +1,86 @@
+#pragma once
+#include "Mesh.h"
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+
+// Interior nodes have Count == 0 and their children at LeftFirst and LeftFirst + 1;
+// leaves cover Count primitives (triangle packets or instances) from LeftFirst
+struct BvhNode
+{
+	float Min[3];
+	uint32_t LeftFirst;
+	float Max[3];
+	uint32_t Count;
+};
+
+static_assert(sizeof(BvhNode) == 32, "BvhNode is loaded as two 16-byte halves");
+
+// Four triangles of a leaf as vertex 0 and two edges, one array per component so a
+// ray is tested against all four at once. Unused slots are degenerate and never hit.
+struct BvhTrianglePacket
+{
+	float V0[3][4];
+	float E1[3][4];
+	float E2[3][4];
+	uint32_t Triangle[4];
+};
+
+const uint32_t BvhPacketWidth = 4;
+
+struct MeshBvh
+{
+	std::vector<BvhNode> Nodes;
+	std::vector<BvhTrianglePacket> Packets;
+};
+
+struct BvhRay
+{
+	MeshFloat3 Origin;
+	// Need not be unit length; distances are in multiples of it
+	MeshFloat3 Direction;
+};
+
+// Barycentrics are of the triangle's second and third vertices; the first one gets
+// 1 - U - V
+struct BvhHit
+{
+	float Distance;
+	uint32_t Triangle;
+	float U;
+	float V;
+};
+
+// Binned surface area heuristic build over indexCount / 3 triangles
+void BuildMeshBvh(MeshBvh& bvh, const uint32_t* indices, size_t indexCount, const MeshVertex* vertices, size_t vertexCount);
+
+// Closest hit closer than maxDistance, from either side of the triangle
+bool IntersectMeshBvh(const MeshBvh& bvh, const BvhRay& ray, float maxDistance, BvhHit& hit);
+
+// A placed copy of a mesh. Matrices are row-major for row vectors (DirectXMath convention).
+struct BvhInstance
+{
+	float World[16];
+	float InverseWorld[16];
+	uint32_t Mesh;
+};
+
+// Top level structure over instances of per-mesh BVHs
+struct SceneBvh
+{
+	std::vector<BvhNode> Nodes;
+	std::vector<uint32_t> Instances;
+};
+
+struct SceneHit
+{
+	uint32_t Instance;
+	BvhHit Hit;
+};
+
+// meshes are indexed by BvhInstance::Mesh; instances are referenced, not copied
+void BuildSceneBvh(SceneBvh& scene, const BvhInstance* instances, size_t instanceCount, const MeshBvh* meshes);
+
+// The ray is in world space; the hit distance is along the world space ray
+bool IntersectSceneBvh(const SceneBvh& scene, const BvhInstance* instances, const MeshBvh* meshes,
+	const BvhRay& ray, float maxDistance, SceneHit& hit);
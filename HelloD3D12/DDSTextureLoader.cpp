@@ -21,9 +21,14 @@
 #include <assert.h>
 #include <algorithm>
 #include <memory>
+#include <vector>
 #include <wrl.h>
 
 #include "DDSTextureLoader.h" 
+#include "DdsMips.h"
+#include "MappedFile.h"
+#include "TextureFootprint12.h"
+#include "TextureUpload12.h"
 
 using namespace Microsoft::WRL;
 
@@ -124,12 +129,6 @@ struct DDS_HEADER_DXT10
 namespace
 {
 
-struct handle_closer { void operator()(HANDLE h) { if (h) CloseHandle(h); } };
-
-typedef public std::unique_ptr<void, handle_closer> ScopedHandle;
-
-inline HANDLE safe_handle( HANDLE h ) { return (h == INVALID_HANDLE_VALUE) ? 0 : h; }
-
 template<UINT TNameLength>
 inline void SetDebugObjectName(_In_ ID3D11DeviceChild* resource, _In_ const char (&name)[TNameLength])
 {
@@ -143,11 +142,14 @@ inline void SetDebugObjectName(_In_ ID3D11DeviceChild* resource, _In_ const char
 
 };
 
+//--------------------------------------------------------------------------------------
+// Maps the file instead of reading it into a heap copy; header and bitData point into
+// the mapping, which must stay open until the texture data has been copied out
 //--------------------------------------------------------------------------------------
 static HRESULT LoadTextureDataFromFile( _In_z_ const wchar_t* fileName,
-                                        std::unique_ptr<uint8_t[]>& ddsData,
-                                        DDS_HEADER** header,
-                                        uint8_t** bitData,
+                                        MappedFile& ddsFile,
+                                        const DDS_HEADER** header,
+                                        const uint8_t** bitData,
                                         size_t* bitSize
                                       )
 {
@@ -156,86 +158,31 @@ static HRESULT LoadTextureDataFromFile( _In_z_ const wchar_t* fileName,
         return E_POINTER;
     }
 
-    // open the file
-#if (_WIN32_WINNT >= _WIN32_WINNT_WIN8)
-    ScopedHandle hFile( safe_handle( CreateFile2( fileName,
-                                                  GENERIC_READ,
-                                                  FILE_SHARE_READ,
-                                                  OPEN_EXISTING,
-                                                  nullptr ) ) );
-#else
-    ScopedHandle hFile( safe_handle( CreateFileW( fileName,
-                                                  GENERIC_READ,
-                                                  FILE_SHARE_READ,
-                                                  nullptr,
-                                                  OPEN_EXISTING,
-                                                  FILE_ATTRIBUTE_NORMAL,
-                                                  nullptr ) ) );
-#endif
-
-    if ( !hFile )
+    // map the file; there is no size limit beyond the address space
+    SetLastError( ERROR_SUCCESS );
+    if (!ddsFile.Open( fileName ))
     {
-        return HRESULT_FROM_WIN32( GetLastError() );
+        DWORD error = GetLastError();
+        return (error != ERROR_SUCCESS) ? HRESULT_FROM_WIN32( error ) : E_FAIL;
     }
 
-    // Get the file size
-    LARGE_INTEGER FileSize = { 0 };
-
-#if (_WIN32_WINNT >= _WIN32_WINNT_VISTA)
-    FILE_STANDARD_INFO fileInfo;
-    if ( !GetFileInformationByHandleEx( hFile.get(), FileStandardInfo, &fileInfo, sizeof(fileInfo) ) )
-    {
-        return HRESULT_FROM_WIN32( GetLastError() );
-    }
-    FileSize = fileInfo.EndOfFile;
-#else
-    GetFileSizeEx( hFile.get(), &FileSize );
-#endif
-
-    // File is too big for 32-bit allocation, so reject read
-    if (FileSize.HighPart > 0)
-    {
-        return E_FAIL;
-    }
+    const uint8_t* ddsData = ddsFile.Data();
+    const uint64_t fileSize = ddsFile.Size();
 
     // Need at least enough data to fill the header and magic number to be a valid DDS
-    if (FileSize.LowPart < ( sizeof(DDS_HEADER) + sizeof(uint32_t) ) )
-    {
-        return E_FAIL;
-    }
-
-    // create enough space for the file data
-    ddsData.reset( new (std::nothrow) uint8_t[ FileSize.LowPart ] );
-    if (!ddsData)
-    {
-        return E_OUTOFMEMORY;
-    }
-
-    // read the data in
-    DWORD BytesRead = 0;
-    if (!ReadFile( hFile.get(),
-                   ddsData.get(),
-                   FileSize.LowPart,
-                   &BytesRead,
-                   nullptr
-                 ))
-    {
-        return HRESULT_FROM_WIN32( GetLastError() );
-    }
-
-    if (BytesRead < FileSize.LowPart)
+    if (fileSize < ( sizeof(DDS_HEADER) + sizeof(uint32_t) ) )
     {
         return E_FAIL;
     }
 
     // DDS files always start with the same magic number ("DDS ")
-    uint32_t dwMagicNumber = *( const uint32_t* )( ddsData.get() );
+    uint32_t dwMagicNumber = *( const uint32_t* )( ddsData );
     if (dwMagicNumber != DDS_MAGIC)
     {
         return E_FAIL;
     }
 
-    auto hdr = reinterpret_cast<DDS_HEADER*>( ddsData.get() + sizeof( uint32_t ) );
+    auto hdr = reinterpret_cast<const DDS_HEADER*>( ddsData + sizeof( uint32_t ) );
 
     // Verify header to validate DDS file
     if (hdr->size != sizeof(DDS_HEADER) ||
@@ -250,7 +197,7 @@ static HRESULT LoadTextureDataFromFile( _In_z_ const wchar_t* fileName,
         (MAKEFOURCC( 'D', 'X', '1', '0' ) == hdr->ddspf.fourCC))
     {
         // Must be long enough for both headers and magic value
-        if (FileSize.LowPart < ( sizeof(DDS_HEADER) + sizeof(uint32_t) + sizeof(DDS_HEADER_DXT10) ) )
+        if (fileSize < ( sizeof(DDS_HEADER) + sizeof(uint32_t) + sizeof(DDS_HEADER_DXT10) ) )
         {
             return E_FAIL;
         }
@@ -262,8 +209,8 @@ static HRESULT LoadTextureDataFromFile( _In_z_ const wchar_t* fileName,
     *header = hdr;
     ptrdiff_t offset = sizeof( uint32_t ) + sizeof( DDS_HEADER )
                        + (bDXT10Header ? sizeof( DDS_HEADER_DXT10 ) : 0);
-    *bitData = ddsData.get() + offset;
-    *bitSize = FileSize.LowPart - offset;
+    *bitData = ddsData + offset;
+    *bitSize = static_cast<size_t>( fileSize - offset );
 
     return S_OK;
 }
@@ -1241,7 +1188,10 @@ static HRESULT CreateD3DResources12(
 	_In_ bool isCubeMap,
 	_In_reads_opt_(mipCount*arraySize) D3D12_SUBRESOURCE_DATA* initData,
 	ComPtr<ID3D12Resource>& texture,
-	ComPtr<ID3D12Resource>& textureUploadHeap
+	ComPtr<ID3D12Resource>& textureUploadHeap,
+	_In_opt_ UploadRing12* uploadRing,
+	_In_opt_ TextureHeap12* textureHeap,
+	_In_ size_t residentMip
 	)
 {
 	if (device == nullptr)
@@ -1269,14 +1219,21 @@ static HRESULT CreateD3DResources12(
 		texDesc.Layout = D3D12_TEXTURE_LAYOUT_UNKNOWN;
 		texDesc.Flags = D3D12_RESOURCE_FLAG_NONE;
 
-		hr = device->CreateCommittedResource(
-			&CD3DX12_HEAP_PROPERTIES(D3D12_HEAP_TYPE_DEFAULT),
-			D3D12_HEAP_FLAG_NONE,
-			&texDesc,
-			D3D12_RESOURCE_STATE_COMMON,
-			nullptr,
-			IID_PPV_ARGS(&texture)
-			);
+		if (textureHeap)
+		{
+			hr = textureHeap->CreateTexture(texDesc, D3D12_RESOURCE_STATE_COMMON, texture);
+		}
+		else
+		{
+			hr = device->CreateCommittedResource(
+				&CD3DX12_HEAP_PROPERTIES(D3D12_HEAP_TYPE_DEFAULT),
+				D3D12_HEAP_FLAG_NONE,
+				&texDesc,
+				D3D12_RESOURCE_STATE_COMMON,
+				nullptr,
+				IID_PPV_ARGS(&texture)
+				);
+		}
 
 		if (FAILED(hr))
 		{
@@ -1285,8 +1242,25 @@ static HRESULT CreateD3DResources12(
 		}
 		else
 		{
-			const UINT num2DSubresources = texDesc.DepthOrArraySize * texDesc.MipLevels;
-			const UINT64 uploadBufferSize = GetRequiredIntermediateSize(texture.Get(), 0, num2DSubresources);
+			// Mips above residentMip (single textures only) are left for streaming to fill in
+			const UINT firstSubresource = static_cast<UINT>(residentMip);
+			const UINT num2DSubresources = texDesc.DepthOrArraySize * texDesc.MipLevels - firstSubresource;
+			const UINT64 uploadBufferSize = GetRequiredIntermediateSize12(texture.Get(), firstSubresource, num2DSubresources);
+
+			// Stage through the shared ring when it has room; textureUploadHeap stays empty
+			UploadRing12::Allocation staging;
+			if (uploadRing && uploadRing->Allocate(uploadBufferSize, D3D12_TEXTURE_DATA_PLACEMENT_ALIGNMENT, staging))
+			{
+				cmdList->ResourceBarrier(1, &CD3DX12_RESOURCE_BARRIER::Transition(texture.Get(),
+					D3D12_RESOURCE_STATE_COMMON, D3D12_RESOURCE_STATE_COPY_DEST));
+
+				UpdateSubresources12(cmdList, texture.Get(), staging.Resource, staging.Offset, staging.CpuAddress,
+					firstSubresource, num2DSubresources, initData + firstSubresource, ThreadScratchArena());
+
+				cmdList->ResourceBarrier(1, &CD3DX12_RESOURCE_BARRIER::Transition(texture.Get(),
+					D3D12_RESOURCE_STATE_COPY_DEST, D3D12_RESOURCE_STATE_PIXEL_SHADER_RESOURCE));
+				return S_OK;
+			}
 
 			hr = device->CreateCommittedResource(
 				&CD3DX12_HEAP_PROPERTIES(D3D12_HEAP_TYPE_UPLOAD),
@@ -1305,8 +1279,8 @@ static HRESULT CreateD3DResources12(
 				cmdList->ResourceBarrier(1, &CD3DX12_RESOURCE_BARRIER::Transition(texture.Get(),
 					D3D12_RESOURCE_STATE_COMMON, D3D12_RESOURCE_STATE_COPY_DEST));
 
-				// Use Heap-allocating UpdateSubresources implementation for variable number of subresources (which is the case for textures).
-				UpdateSubresources(cmdList, texture.Get(), textureUploadHeap.Get(), 0, 0, num2DSubresources, initData);
+				UpdateSubresources12(cmdList, texture.Get(), textureUploadHeap.Get(), 0, nullptr,
+					firstSubresource, num2DSubresources, initData + firstSubresource, ThreadScratchArena());
 
 				cmdList->ResourceBarrier(1, &CD3DX12_RESOURCE_BARRIER::Transition(texture.Get(),
 					D3D12_RESOURCE_STATE_COPY_DEST, D3D12_RESOURCE_STATE_PIXEL_SHADER_RESOURCE));
@@ -1678,7 +1652,11 @@ static HRESULT CreateTextureFromDDS12(
 	_In_ size_t maxsize,
 	_In_ bool forceSRGB,
 	ComPtr<ID3D12Resource>& texture,
-	ComPtr<ID3D12Resource>& textureUploadHeap)
+	ComPtr<ID3D12Resource>& textureUploadHeap,
+	_In_opt_ UploadRing12* uploadRing = nullptr,
+	_In_opt_ TextureHeap12* textureHeap = nullptr,
+	_Out_opt_ std::vector<D3D12_SUBRESOURCE_DATA>* streamMips = nullptr,
+	_Out_opt_ size_t* residentMip = nullptr)
 {
 	HRESULT hr = S_OK;
 
@@ -1835,11 +1813,33 @@ static HRESULT CreateTextureFromDDS12(
 		return HRESULT_FROM_WIN32(ERROR_NOT_SUPPORTED);
 	}
 
-	// Create the texture
-	std::unique_ptr<D3D12_SUBRESOURCE_DATA[]> initData(
-		new (std::nothrow) D3D12_SUBRESOURCE_DATA[mipCount * arraySize]
-		);
+	// Textures shipped with only their top level get a box filtered mip chain built on
+	// the CPU. Streaming hands out pointers into the file, so it keeps what the file has.
+	// The filter stays on this thread: the batch loader already runs one load per core.
+	std::vector<uint8_t> generatedMips;
+	if (!streamMips)
+	{
+		DdsInfo info = {};
+		info.Width = width;
+		info.Height = height;
+		info.Depth = depth;
+		info.MipCount = static_cast<uint32_t>(mipCount);
+		info.ArraySize = arraySize;
+		info.Format = format;
+		info.Dimension = static_cast<DdsDimension>(resDim);
+		info.IsCubeMap = isCubeMap;
+		if (ExpandDdsMips(info, bitData, bitSize, generatedMips, 1))
+		{
+			mipCount = info.MipCount;
+		}
+	}
 
+	// Create the texture. The subresource table comes from this thread's scratch arena,
+	// which the upload below also uses, so loader threads do not meet in the heap.
+	ScratchArena& scratch = ThreadScratchArena();
+	ScratchArena::Scope scratchScope(scratch);
+	std::unique_ptr<uint8_t[]> heapInitData;
+	D3D12_SUBRESOURCE_DATA* initData = AllocateUploadScratch<D3D12_SUBRESOURCE_DATA>(scratch, mipCount * arraySize, heapInitData);
 	if (!initData)
 	{
 		return E_OUTOFMEMORY;
@@ -1852,9 +1852,29 @@ static HRESULT CreateTextureFromDDS12(
 
 	hr = FillInitData12(
 		width, height, depth, mipCount, arraySize, format, maxsize, bitSize, bitData,
-		twidth, theight, tdepth, skipMip, initData.get()
+		twidth, theight, tdepth, skipMip, initData
 		);
 
+	size_t firstMip = 0;
+	if (SUCCEEDED(hr) && streamMips)
+	{
+		// Streaming keeps every mip in the resource and only uploads the ones maxsize
+		// allows; the others are described in streamMips for later
+		if (resDim != D3D12_RESOURCE_DIMENSION_TEXTURE2D || arraySize != 1)
+		{
+			return HRESULT_FROM_WIN32(ERROR_NOT_SUPPORTED);
+		}
+		firstMip = skipMip;
+		hr = FillInitData12(
+			width, height, depth, mipCount, arraySize, format, 0, bitSize, bitData,
+			twidth, theight, tdepth, skipMip, initData
+			);
+		if (SUCCEEDED(hr))
+		{
+			streamMips->assign(initData, initData + mipCount);
+		}
+	}
+
 	if (SUCCEEDED(hr))
 	{
 		hr = CreateD3DResources12(
@@ -1863,11 +1883,19 @@ static HRESULT CreateTextureFromDDS12(
 			mipCount - skipMip,
 			arraySize,
 			format,
-			false, // forceSRGB
+			forceSRGB,
 			isCubeMap,
-			initData.get(),
+			initData,
 			texture, 
-			textureUploadHeap);
+			textureUploadHeap,
+			uploadRing,
+			textureHeap,
+			firstMip);
+	}
+
+	if (SUCCEEDED(hr) && residentMip)
+	{
+		*residentMip = firstMip;
 	}
 
 	return hr;
@@ -1926,7 +1954,10 @@ HRESULT DirectX::CreateDDSTextureFromMemory12(
 	ComPtr<ID3D12Resource>& texture,
 	ComPtr<ID3D12Resource>& textureUploadHeap,
 	_In_ size_t maxsize,
-	_Out_opt_ DDS_ALPHA_MODE* alphaMode
+	_Out_opt_ DDS_ALPHA_MODE* alphaMode,
+	_In_ bool forceSRGB,
+	_In_opt_ UploadRing12* uploadRing,
+	_In_opt_ TextureHeap12* textureHeap
 	)
 {
 	if (alphaMode)
@@ -1937,6 +1968,12 @@ HRESULT DirectX::CreateDDSTextureFromMemory12(
 		return E_INVALIDARG;
 	}
 
+	// Validate DDS file in memory
+	if (ddsDataSize < (sizeof(uint32_t) + sizeof(DDS_HEADER)))
+	{
+		return E_FAIL;
+	}
+
 	uint32_t dwMagicNumber = *(const uint32_t*)(ddsData);
 	if (dwMagicNumber != DDS_MAGIC)
 	{
@@ -1977,9 +2014,11 @@ HRESULT DirectX::CreateDDSTextureFromMemory12(
 		ddsData + offset,
 		ddsDataSize - offset,
 		maxsize,
-		false,
+		forceSRGB,
 		texture,
-		textureUploadHeap
+		textureUploadHeap,
+		uploadRing,
+		textureHeap
 		);
 
 	if (SUCCEEDED(hr))
@@ -2140,7 +2179,9 @@ HRESULT DirectX::CreateDDSTextureFromFile12(_In_ ID3D12Device* device,
 	_Out_ ComPtr<ID3D12Resource>& texture,
 	_Out_ ComPtr<ID3D12Resource>& textureUploadHeap,
 	_In_ size_t maxsize,
-	_Out_opt_ DDS_ALPHA_MODE* alphaMode)
+	_Out_opt_ DDS_ALPHA_MODE* alphaMode,
+	_In_opt_ UploadRing12* uploadRing,
+	_In_opt_ TextureHeap12* textureHeap)
 {
 	if (texture)
 	{
@@ -2160,19 +2201,21 @@ HRESULT DirectX::CreateDDSTextureFromFile12(_In_ ID3D12Device* device,
 		return E_INVALIDARG;
 	}
 
-	DDS_HEADER* header = nullptr;
-	uint8_t* bitData = nullptr;
+	const DDS_HEADER* header = nullptr;
+	const uint8_t* bitData = nullptr;
 	size_t bitSize = 0;
 
-	std::unique_ptr<uint8_t[]> ddsData;
-	HRESULT hr = LoadTextureDataFromFile(szFileName, ddsData, &header, &bitData, &bitSize);
+	MappedFile ddsFile;
+	HRESULT hr = LoadTextureDataFromFile(szFileName, ddsFile, &header, &bitData, &bitSize);
 	if (FAILED(hr))
 	{
 		return hr;
 	}
 
+	// UpdateSubresources12 copies every subresource into the upload heap while recording,
+	// so the mapping is not needed once this returns
 	hr = CreateTextureFromDDS12(device, cmdList, header,
-		bitData, bitSize, maxsize, false, texture, textureUploadHeap);
+		bitData, bitSize, maxsize, false, texture, textureUploadHeap, uploadRing, textureHeap);
 
 	if (SUCCEEDED(hr))
 	{
@@ -2225,6 +2268,50 @@ HRESULT DirectX::CreateDDSTextureFromFile12(_In_ ID3D12Device* device,
 			*alphaMode = GetAlphaMode(header);
 	}
 
+	ddsFile.Close();
+	return hr;
+}
+
+HRESULT DirectX::CreateDDSTextureFromFile12Streaming(_In_ ID3D12Device* device,
+	_In_ ID3D12GraphicsCommandList* cmdList,
+	_In_z_ const wchar_t* szFileName,
+	_In_ size_t residentSize,
+	_Out_ MappedFile& ddsFile,
+	_Out_ ComPtr<ID3D12Resource>& texture,
+	_Out_ ComPtr<ID3D12Resource>& textureUploadHeap,
+	_Out_ std::vector<D3D12_SUBRESOURCE_DATA>& mips,
+	_Out_ size_t& residentMip,
+	_In_opt_ UploadRing12* uploadRing,
+	_In_opt_ TextureHeap12* textureHeap)
+{
+	texture = nullptr;
+	textureUploadHeap = nullptr;
+	mips.clear();
+	residentMip = 0;
+
+	if (!device || !szFileName)
+	{
+		return E_INVALIDARG;
+	}
+
+	const DDS_HEADER* header = nullptr;
+	const uint8_t* bitData = nullptr;
+	size_t bitSize = 0;
+
+	HRESULT hr = LoadTextureDataFromFile(szFileName, ddsFile, &header, &bitData, &bitSize);
+	if (SUCCEEDED(hr))
+	{
+		hr = CreateTextureFromDDS12(device, cmdList, header,
+			bitData, bitSize, residentSize, false, texture, textureUploadHeap, uploadRing, textureHeap,
+			&mips, &residentMip);
+	}
+
+	// On success mips points into the mapping, so it stays open
+	if (FAILED(hr))
+	{
+		mips.clear();
+		ddsFile.Close();
+	}
 	return hr;
 }
 
@@ -2292,13 +2379,13 @@ HRESULT DirectX::CreateDDSTextureFromFileEx( ID3D11Device* d3dDevice,
         return E_INVALIDARG;
     }
 
-    DDS_HEADER* header = nullptr;
-    uint8_t* bitData = nullptr;
+    const DDS_HEADER* header = nullptr;
+    const uint8_t* bitData = nullptr;
     size_t bitSize = 0;
 
-    std::unique_ptr<uint8_t[]> ddsData;
+    MappedFile ddsFile;
     HRESULT hr = LoadTextureDataFromFile( fileName,
-                                          ddsData,
+                                          ddsFile,
                                           &header,
                                           &bitData,
                                           &bitSize
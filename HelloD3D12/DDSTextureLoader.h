@@ -25,6 +25,9 @@
 #include <wrl.h>
 #include <d3d11_1.h>
 #include "d3dx12.h"
+#include "MappedFile.h"
+#include "TextureHeap12.h"
+#include "UploadRing12.h"
 
 #pragma warning(push)
 #pragma warning(disable : 4005)
@@ -32,6 +35,8 @@
 
 #pragma warning(pop)
 
+#include <vector>
+
 #if defined(_MSC_VER) && (_MSC_VER<1610) && !defined(_In_reads_)
 #define _In_reads_(exp)
 #define _Out_writes_(exp)
@@ -72,7 +77,11 @@ namespace DirectX
 		                                 _Out_ Microsoft::WRL::ComPtr<ID3D12Resource>& texture,
 		                                 _Out_ Microsoft::WRL::ComPtr<ID3D12Resource>& textureUploadHeap,
 		                                 _In_ size_t maxsize = 0,
-		                                 _Out_opt_ DDS_ALPHA_MODE* alphaMode = nullptr
+		                                 _Out_opt_ DDS_ALPHA_MODE* alphaMode = nullptr,
+		                                 // Views the texture with the _SRGB variant of its format
+		                                 _In_ bool forceSRGB = false,
+		                                 _In_opt_ UploadRing12* uploadRing = nullptr,
+		                                 _In_opt_ TextureHeap12* textureHeap = nullptr
 		                                 );
 
     HRESULT CreateDDSTextureFromFile( _In_ ID3D11Device* d3dDevice,
@@ -89,9 +98,32 @@ namespace DirectX
 		                               _Out_ Microsoft::WRL::ComPtr<ID3D12Resource>& texture,
 		                               _Out_ Microsoft::WRL::ComPtr<ID3D12Resource>& textureUploadHeap,
 		                               _In_ size_t maxsize = 0,
-		                               _Out_opt_ DDS_ALPHA_MODE* alphaMode = nullptr
+		                               _Out_opt_ DDS_ALPHA_MODE* alphaMode = nullptr,
+		                               // When given and it has room, the upload is staged in
+		                               // the ring and textureUploadHeap is left empty
+		                               _In_opt_ UploadRing12* uploadRing = nullptr,
+		                               // When given, the texture is placed in one of its heaps
+		                               // instead of being a committed resource
+		                               _In_opt_ TextureHeap12* textureHeap = nullptr
 		                               );
 
+	// Creates a single 2D texture with all its mips but uploads only those no larger than
+	// residentSize, leaving the file mapped in ddsFile. mips describes every mip (pointing
+	// into the mapping) so the rest can be uploaded later; residentMip is the most
+	// detailed one uploaded. Arrays, cube maps and volumes are not supported.
+	HRESULT CreateDDSTextureFromFile12Streaming(_In_ ID3D12Device* device,
+		                                        _In_ ID3D12GraphicsCommandList* cmdList,
+		                                        _In_z_ const wchar_t* szFileName,
+		                                        _In_ size_t residentSize,
+		                                        _Out_ MappedFile& ddsFile,
+		                                        _Out_ Microsoft::WRL::ComPtr<ID3D12Resource>& texture,
+		                                        _Out_ Microsoft::WRL::ComPtr<ID3D12Resource>& textureUploadHeap,
+		                                        _Out_ std::vector<D3D12_SUBRESOURCE_DATA>& mips,
+		                                        _Out_ size_t& residentMip,
+		                                        _In_opt_ UploadRing12* uploadRing = nullptr,
+		                                        _In_opt_ TextureHeap12* textureHeap = nullptr
+		                                        );
+
     // Standard version with optional auto-gen mipmap support
     HRESULT CreateDDSTextureFromMemory( _In_ ID3D11Device* d3dDevice,
                                         _In_opt_ ID3D11DeviceContext* d3dContext,
@@ -0,0 +1,712 @@
+#include "DdsFormat.h"
+#include <algorithm>
+#include <cstring>
+
+#ifdef _WIN32
+#include <dxgiformat.h>
+#else
+// The values of dxgiformat.h, which only comes with the Windows SDK
+enum DXGI_FORMAT
+{
+	DXGI_FORMAT_UNKNOWN = 0,
+	DXGI_FORMAT_R32G32B32A32_TYPELESS, DXGI_FORMAT_R32G32B32A32_FLOAT, DXGI_FORMAT_R32G32B32A32_UINT, DXGI_FORMAT_R32G32B32A32_SINT,
+	DXGI_FORMAT_R32G32B32_TYPELESS, DXGI_FORMAT_R32G32B32_FLOAT, DXGI_FORMAT_R32G32B32_UINT, DXGI_FORMAT_R32G32B32_SINT,
+	DXGI_FORMAT_R16G16B16A16_TYPELESS, DXGI_FORMAT_R16G16B16A16_FLOAT, DXGI_FORMAT_R16G16B16A16_UNORM, DXGI_FORMAT_R16G16B16A16_UINT,
+	DXGI_FORMAT_R16G16B16A16_SNORM, DXGI_FORMAT_R16G16B16A16_SINT,
+	DXGI_FORMAT_R32G32_TYPELESS, DXGI_FORMAT_R32G32_FLOAT, DXGI_FORMAT_R32G32_UINT, DXGI_FORMAT_R32G32_SINT,
+	DXGI_FORMAT_R32G8X24_TYPELESS, DXGI_FORMAT_D32_FLOAT_S8X24_UINT, DXGI_FORMAT_R32_FLOAT_X8X24_TYPELESS, DXGI_FORMAT_X32_TYPELESS_G8X24_UINT,
+	DXGI_FORMAT_R10G10B10A2_TYPELESS, DXGI_FORMAT_R10G10B10A2_UNORM, DXGI_FORMAT_R10G10B10A2_UINT,
+	DXGI_FORMAT_R11G11B10_FLOAT,
+	DXGI_FORMAT_R8G8B8A8_TYPELESS, DXGI_FORMAT_R8G8B8A8_UNORM, DXGI_FORMAT_R8G8B8A8_UNORM_SRGB, DXGI_FORMAT_R8G8B8A8_UINT,
+	DXGI_FORMAT_R8G8B8A8_SNORM, DXGI_FORMAT_R8G8B8A8_SINT,
+	DXGI_FORMAT_R16G16_TYPELESS, DXGI_FORMAT_R16G16_FLOAT, DXGI_FORMAT_R16G16_UNORM, DXGI_FORMAT_R16G16_UINT,
+	DXGI_FORMAT_R16G16_SNORM, DXGI_FORMAT_R16G16_SINT,
+	DXGI_FORMAT_R32_TYPELESS, DXGI_FORMAT_D32_FLOAT, DXGI_FORMAT_R32_FLOAT, DXGI_FORMAT_R32_UINT, DXGI_FORMAT_R32_SINT,
+	DXGI_FORMAT_R24G8_TYPELESS, DXGI_FORMAT_D24_UNORM_S8_UINT, DXGI_FORMAT_R24_UNORM_X8_TYPELESS, DXGI_FORMAT_X24_TYPELESS_G8_UINT,
+	DXGI_FORMAT_R8G8_TYPELESS, DXGI_FORMAT_R8G8_UNORM, DXGI_FORMAT_R8G8_UINT, DXGI_FORMAT_R8G8_SNORM, DXGI_FORMAT_R8G8_SINT,
+	DXGI_FORMAT_R16_TYPELESS, DXGI_FORMAT_R16_FLOAT, DXGI_FORMAT_D16_UNORM, DXGI_FORMAT_R16_UNORM, DXGI_FORMAT_R16_UINT,
+	DXGI_FORMAT_R16_SNORM, DXGI_FORMAT_R16_SINT,
+	DXGI_FORMAT_R8_TYPELESS, DXGI_FORMAT_R8_UNORM, DXGI_FORMAT_R8_UINT, DXGI_FORMAT_R8_SNORM, DXGI_FORMAT_R8_SINT,
+	DXGI_FORMAT_A8_UNORM,
+	DXGI_FORMAT_R1_UNORM,
+	DXGI_FORMAT_R9G9B9E5_SHAREDEXP,
+	DXGI_FORMAT_R8G8_B8G8_UNORM, DXGI_FORMAT_G8R8_G8B8_UNORM,
+	DXGI_FORMAT_BC1_TYPELESS, DXGI_FORMAT_BC1_UNORM, DXGI_FORMAT_BC1_UNORM_SRGB,
+	DXGI_FORMAT_BC2_TYPELESS, DXGI_FORMAT_BC2_UNORM, DXGI_FORMAT_BC2_UNORM_SRGB,
+	DXGI_FORMAT_BC3_TYPELESS, DXGI_FORMAT_BC3_UNORM, DXGI_FORMAT_BC3_UNORM_SRGB,
+	DXGI_FORMAT_BC4_TYPELESS, DXGI_FORMAT_BC4_UNORM, DXGI_FORMAT_BC4_SNORM,
+	DXGI_FORMAT_BC5_TYPELESS, DXGI_FORMAT_BC5_UNORM, DXGI_FORMAT_BC5_SNORM,
+	DXGI_FORMAT_B5G6R5_UNORM, DXGI_FORMAT_B5G5R5A1_UNORM, DXGI_FORMAT_B8G8R8A8_UNORM, DXGI_FORMAT_B8G8R8X8_UNORM,
+	DXGI_FORMAT_R10G10B10_XR_BIAS_A2_UNORM,
+	DXGI_FORMAT_B8G8R8A8_TYPELESS, DXGI_FORMAT_B8G8R8A8_UNORM_SRGB, DXGI_FORMAT_B8G8R8X8_TYPELESS, DXGI_FORMAT_B8G8R8X8_UNORM_SRGB,
+	DXGI_FORMAT_BC6H_TYPELESS, DXGI_FORMAT_BC6H_UF16, DXGI_FORMAT_BC6H_SF16,
+	DXGI_FORMAT_BC7_TYPELESS, DXGI_FORMAT_BC7_UNORM, DXGI_FORMAT_BC7_UNORM_SRGB,
+	DXGI_FORMAT_AYUV, DXGI_FORMAT_Y410, DXGI_FORMAT_Y416, DXGI_FORMAT_NV12, DXGI_FORMAT_P010, DXGI_FORMAT_P016,
+	DXGI_FORMAT_420_OPAQUE, DXGI_FORMAT_YUY2, DXGI_FORMAT_Y210, DXGI_FORMAT_Y216, DXGI_FORMAT_NV11,
+	DXGI_FORMAT_AI44, DXGI_FORMAT_IA44, DXGI_FORMAT_P8, DXGI_FORMAT_A8P8,
+	DXGI_FORMAT_B4G4R4A4_UNORM,
+};
+static_assert(DXGI_FORMAT_BC7_UNORM == 98 && DXGI_FORMAT_B4G4R4A4_UNORM == 115, "DXGI_FORMAT values are out of step");
+#endif
+
+namespace
+{
+	const uint32_t DdsMagic = 0x20534444; // "DDS "
+
+	constexpr uint32_t FourCC(char a, char b, char c, char d)
+	{
+		return static_cast<uint32_t>(static_cast<uint8_t>(a)) | (static_cast<uint32_t>(static_cast<uint8_t>(b)) << 8) |
+			(static_cast<uint32_t>(static_cast<uint8_t>(c)) << 16) | (static_cast<uint32_t>(static_cast<uint8_t>(d)) << 24);
+	}
+
+	// DDS_PIXELFORMAT flags
+	const uint32_t DdsFourCCFlag = 0x00000004;
+	const uint32_t DdsRgbFlag = 0x00000040;
+	const uint32_t DdsLuminanceFlag = 0x00020000;
+	const uint32_t DdsAlphaFlag = 0x00000002;
+
+	// DDS_HEADER flags and caps2
+	const uint32_t DdsHeightFlag = 0x00000002;
+	const uint32_t DdsVolumeFlag = 0x00800000;
+	const uint32_t DdsCubeMap = 0x00000200;
+	const uint32_t DdsCubeMapAllFaces = 0x0000fe00;
+
+	// D3D11_RESOURCE_MISC_TEXTURECUBE
+	const uint32_t MiscTextureCube = 0x4;
+
+	// The D3D12_REQ_* limits CreateTextureFromDDS12 checks against
+	const uint32_t MaxMipLevels = 15;
+	const uint32_t MaxTexture1DArraySize = 2048;
+	const uint32_t MaxTexture1DSize = 16384;
+	const uint32_t MaxTexture2DArraySize = 2048;
+	const uint32_t MaxTexture2DSize = 16384;
+	const uint32_t MaxTextureCubeSize = 16384;
+	const uint32_t MaxTexture3DSize = 2048;
+
+#pragma pack(push, 1)
+	struct DdsPixelFormat
+	{
+		uint32_t Size;
+		uint32_t Flags;
+		uint32_t FourCC;
+		uint32_t RGBBitCount;
+		uint32_t RBitMask;
+		uint32_t GBitMask;
+		uint32_t BBitMask;
+		uint32_t ABitMask;
+	};
+
+	struct DdsHeader
+	{
+		uint32_t Size;
+		uint32_t Flags;
+		uint32_t Height;
+		uint32_t Width;
+		uint32_t PitchOrLinearSize;
+		uint32_t Depth;
+		uint32_t MipMapCount;
+		uint32_t Reserved1[11];
+		DdsPixelFormat PixelFormat;
+		uint32_t Caps;
+		uint32_t Caps2;
+		uint32_t Caps3;
+		uint32_t Caps4;
+		uint32_t Reserved2;
+	};
+
+	struct DdsHeaderDxt10
+	{
+		uint32_t DxgiFormat;
+		uint32_t ResourceDimension;
+		uint32_t MiscFlag;
+		uint32_t ArraySize;
+		uint32_t MiscFlags2;
+	};
+#pragma pack(pop)
+
+	static_assert(sizeof(uint32_t) + sizeof(DdsHeader) + sizeof(DdsHeaderDxt10) == DdsMaxHeaderBytes, "DDS headers have the wrong size");
+
+	// GetDXGIFormat in DDSTextureLoader
+	uint32_t FormatFromPixelFormat(const DdsPixelFormat& pf)
+	{
+		auto isBitMask = [&](uint32_t r, uint32_t g, uint32_t b, uint32_t a)
+		{
+			return pf.RBitMask == r && pf.GBitMask == g && pf.BBitMask == b && pf.ABitMask == a;
+		};
+
+		if (pf.Flags & DdsRgbFlag)
+		{
+			switch (pf.RGBBitCount)
+			{
+			case 32:
+				if (isBitMask(0x000000ff, 0x0000ff00, 0x00ff0000, 0xff000000)) return DXGI_FORMAT_R8G8B8A8_UNORM;
+				if (isBitMask(0x00ff0000, 0x0000ff00, 0x000000ff, 0xff000000)) return DXGI_FORMAT_B8G8R8A8_UNORM;
+				if (isBitMask(0x00ff0000, 0x0000ff00, 0x000000ff, 0x00000000)) return DXGI_FORMAT_B8G8R8X8_UNORM;
+				// The swapped masks D3DX writes for 10:10:10:2
+				if (isBitMask(0x3ff00000, 0x000ffc00, 0x000003ff, 0xc0000000)) return DXGI_FORMAT_R10G10B10A2_UNORM;
+				if (isBitMask(0x0000ffff, 0xffff0000, 0x00000000, 0x00000000)) return DXGI_FORMAT_R16G16_UNORM;
+				if (isBitMask(0xffffffff, 0x00000000, 0x00000000, 0x00000000)) return DXGI_FORMAT_R32_FLOAT;
+				break;
+
+			case 16:
+				if (isBitMask(0x7c00, 0x03e0, 0x001f, 0x8000)) return DXGI_FORMAT_B5G5R5A1_UNORM;
+				if (isBitMask(0xf800, 0x07e0, 0x001f, 0x0000)) return DXGI_FORMAT_B5G6R5_UNORM;
+				if (isBitMask(0x0f00, 0x00f0, 0x000f, 0xf000)) return DXGI_FORMAT_B4G4R4A4_UNORM;
+				break;
+			}
+		}
+		else if (pf.Flags & DdsLuminanceFlag)
+		{
+			if (pf.RGBBitCount == 8 && isBitMask(0x000000ff, 0x00000000, 0x00000000, 0x00000000)) return DXGI_FORMAT_R8_UNORM;
+			if (pf.RGBBitCount == 16)
+			{
+				if (isBitMask(0x0000ffff, 0x00000000, 0x00000000, 0x00000000)) return DXGI_FORMAT_R16_UNORM;
+				if (isBitMask(0x000000ff, 0x00000000, 0x00000000, 0x0000ff00)) return DXGI_FORMAT_R8G8_UNORM;
+			}
+		}
+		else if (pf.Flags & DdsAlphaFlag)
+		{
+			if (pf.RGBBitCount == 8) return DXGI_FORMAT_A8_UNORM;
+		}
+		else if (pf.Flags & DdsFourCCFlag)
+		{
+			switch (pf.FourCC)
+			{
+			case FourCC('D', 'X', 'T', '1'): return DXGI_FORMAT_BC1_UNORM;
+			case FourCC('D', 'X', 'T', '2'):
+			case FourCC('D', 'X', 'T', '3'): return DXGI_FORMAT_BC2_UNORM;
+			case FourCC('D', 'X', 'T', '4'):
+			case FourCC('D', 'X', 'T', '5'): return DXGI_FORMAT_BC3_UNORM;
+			case FourCC('A', 'T', 'I', '1'):
+			case FourCC('B', 'C', '4', 'U'): return DXGI_FORMAT_BC4_UNORM;
+			case FourCC('B', 'C', '4', 'S'): return DXGI_FORMAT_BC4_SNORM;
+			case FourCC('A', 'T', 'I', '2'):
+			case FourCC('B', 'C', '5', 'U'): return DXGI_FORMAT_BC5_UNORM;
+			case FourCC('B', 'C', '5', 'S'): return DXGI_FORMAT_BC5_SNORM;
+			case FourCC('R', 'G', 'B', 'G'): return DXGI_FORMAT_R8G8_B8G8_UNORM;
+			case FourCC('G', 'R', 'G', 'B'): return DXGI_FORMAT_G8R8_G8B8_UNORM;
+			case FourCC('Y', 'U', 'Y', '2'): return DXGI_FORMAT_YUY2;
+			// D3DFORMAT values
+			case 36: return DXGI_FORMAT_R16G16B16A16_UNORM;
+			case 110: return DXGI_FORMAT_R16G16B16A16_SNORM;
+			case 111: return DXGI_FORMAT_R16_FLOAT;
+			case 112: return DXGI_FORMAT_R16G16_FLOAT;
+			case 113: return DXGI_FORMAT_R16G16B16A16_FLOAT;
+			case 114: return DXGI_FORMAT_R32_FLOAT;
+			case 115: return DXGI_FORMAT_R32G32_FLOAT;
+			case 116: return DXGI_FORMAT_R32G32B32A32_FLOAT;
+			}
+		}
+		return DXGI_FORMAT_UNKNOWN;
+	}
+}
+
+size_t DdsBitsPerPixel(uint32_t format)
+{
+	switch (format)
+	{
+	case DXGI_FORMAT_R32G32B32A32_TYPELESS:
+	case DXGI_FORMAT_R32G32B32A32_FLOAT:
+	case DXGI_FORMAT_R32G32B32A32_UINT:
+	case DXGI_FORMAT_R32G32B32A32_SINT:
+		return 128;
+
+	case DXGI_FORMAT_R32G32B32_TYPELESS:
+	case DXGI_FORMAT_R32G32B32_FLOAT:
+	case DXGI_FORMAT_R32G32B32_UINT:
+	case DXGI_FORMAT_R32G32B32_SINT:
+		return 96;
+
+	case DXGI_FORMAT_R16G16B16A16_TYPELESS:
+	case DXGI_FORMAT_R16G16B16A16_FLOAT:
+	case DXGI_FORMAT_R16G16B16A16_UNORM:
+	case DXGI_FORMAT_R16G16B16A16_UINT:
+	case DXGI_FORMAT_R16G16B16A16_SNORM:
+	case DXGI_FORMAT_R16G16B16A16_SINT:
+	case DXGI_FORMAT_R32G32_TYPELESS:
+	case DXGI_FORMAT_R32G32_FLOAT:
+	case DXGI_FORMAT_R32G32_UINT:
+	case DXGI_FORMAT_R32G32_SINT:
+	case DXGI_FORMAT_R32G8X24_TYPELESS:
+	case DXGI_FORMAT_D32_FLOAT_S8X24_UINT:
+	case DXGI_FORMAT_R32_FLOAT_X8X24_TYPELESS:
+	case DXGI_FORMAT_X32_TYPELESS_G8X24_UINT:
+	case DXGI_FORMAT_Y416:
+	case DXGI_FORMAT_Y210:
+	case DXGI_FORMAT_Y216:
+		return 64;
+
+	case DXGI_FORMAT_R10G10B10A2_TYPELESS:
+	case DXGI_FORMAT_R10G10B10A2_UNORM:
+	case DXGI_FORMAT_R10G10B10A2_UINT:
+	case DXGI_FORMAT_R11G11B10_FLOAT:
+	case DXGI_FORMAT_R8G8B8A8_TYPELESS:
+	case DXGI_FORMAT_R8G8B8A8_UNORM:
+	case DXGI_FORMAT_R8G8B8A8_UNORM_SRGB:
+	case DXGI_FORMAT_R8G8B8A8_UINT:
+	case DXGI_FORMAT_R8G8B8A8_SNORM:
+	case DXGI_FORMAT_R8G8B8A8_SINT:
+	case DXGI_FORMAT_R16G16_TYPELESS:
+	case DXGI_FORMAT_R16G16_FLOAT:
+	case DXGI_FORMAT_R16G16_UNORM:
+	case DXGI_FORMAT_R16G16_UINT:
+	case DXGI_FORMAT_R16G16_SNORM:
+	case DXGI_FORMAT_R16G16_SINT:
+	case DXGI_FORMAT_R32_TYPELESS:
+	case DXGI_FORMAT_D32_FLOAT:
+	case DXGI_FORMAT_R32_FLOAT:
+	case DXGI_FORMAT_R32_UINT:
+	case DXGI_FORMAT_R32_SINT:
+	case DXGI_FORMAT_R24G8_TYPELESS:
+	case DXGI_FORMAT_D24_UNORM_S8_UINT:
+	case DXGI_FORMAT_R24_UNORM_X8_TYPELESS:
+	case DXGI_FORMAT_X24_TYPELESS_G8_UINT:
+	case DXGI_FORMAT_R9G9B9E5_SHAREDEXP:
+	case DXGI_FORMAT_R8G8_B8G8_UNORM:
+	case DXGI_FORMAT_G8R8_G8B8_UNORM:
+	case DXGI_FORMAT_B8G8R8A8_UNORM:
+	case DXGI_FORMAT_B8G8R8X8_UNORM:
+	case DXGI_FORMAT_R10G10B10_XR_BIAS_A2_UNORM:
+	case DXGI_FORMAT_B8G8R8A8_TYPELESS:
+	case DXGI_FORMAT_B8G8R8A8_UNORM_SRGB:
+	case DXGI_FORMAT_B8G8R8X8_TYPELESS:
+	case DXGI_FORMAT_B8G8R8X8_UNORM_SRGB:
+	case DXGI_FORMAT_AYUV:
+	case DXGI_FORMAT_Y410:
+	case DXGI_FORMAT_YUY2:
+		return 32;
+
+	case DXGI_FORMAT_P010:
+	case DXGI_FORMAT_P016:
+		return 24;
+
+	case DXGI_FORMAT_R8G8_TYPELESS:
+	case DXGI_FORMAT_R8G8_UNORM:
+	case DXGI_FORMAT_R8G8_UINT:
+	case DXGI_FORMAT_R8G8_SNORM:
+	case DXGI_FORMAT_R8G8_SINT:
+	case DXGI_FORMAT_R16_TYPELESS:
+	case DXGI_FORMAT_R16_FLOAT:
+	case DXGI_FORMAT_D16_UNORM:
+	case DXGI_FORMAT_R16_UNORM:
+	case DXGI_FORMAT_R16_UINT:
+	case DXGI_FORMAT_R16_SNORM:
+	case DXGI_FORMAT_R16_SINT:
+	case DXGI_FORMAT_B5G6R5_UNORM:
+	case DXGI_FORMAT_B5G5R5A1_UNORM:
+	case DXGI_FORMAT_A8P8:
+	case DXGI_FORMAT_B4G4R4A4_UNORM:
+		return 16;
+
+	case DXGI_FORMAT_NV12:
+	case DXGI_FORMAT_420_OPAQUE:
+	case DXGI_FORMAT_NV11:
+		return 12;
+
+	case DXGI_FORMAT_R8_TYPELESS:
+	case DXGI_FORMAT_R8_UNORM:
+	case DXGI_FORMAT_R8_UINT:
+	case DXGI_FORMAT_R8_SNORM:
+	case DXGI_FORMAT_R8_SINT:
+	case DXGI_FORMAT_A8_UNORM:
+	case DXGI_FORMAT_AI44:
+	case DXGI_FORMAT_IA44:
+	case DXGI_FORMAT_P8:
+		return 8;
+
+	case DXGI_FORMAT_R1_UNORM:
+		return 1;
+
+	case DXGI_FORMAT_BC1_TYPELESS:
+	case DXGI_FORMAT_BC1_UNORM:
+	case DXGI_FORMAT_BC1_UNORM_SRGB:
+	case DXGI_FORMAT_BC4_TYPELESS:
+	case DXGI_FORMAT_BC4_UNORM:
+	case DXGI_FORMAT_BC4_SNORM:
+		return 4;
+
+	case DXGI_FORMAT_BC2_TYPELESS:
+	case DXGI_FORMAT_BC2_UNORM:
+	case DXGI_FORMAT_BC2_UNORM_SRGB:
+	case DXGI_FORMAT_BC3_TYPELESS:
+	case DXGI_FORMAT_BC3_UNORM:
+	case DXGI_FORMAT_BC3_UNORM_SRGB:
+	case DXGI_FORMAT_BC5_TYPELESS:
+	case DXGI_FORMAT_BC5_UNORM:
+	case DXGI_FORMAT_BC5_SNORM:
+	case DXGI_FORMAT_BC6H_TYPELESS:
+	case DXGI_FORMAT_BC6H_UF16:
+	case DXGI_FORMAT_BC6H_SF16:
+	case DXGI_FORMAT_BC7_TYPELESS:
+	case DXGI_FORMAT_BC7_UNORM:
+	case DXGI_FORMAT_BC7_UNORM_SRGB:
+		return 8;
+
+	default:
+		return 0;
+	}
+}
+
+void DdsSurfaceInfo(size_t width, size_t height, uint32_t format, size_t* numBytes, size_t* rowBytes, size_t* numRows)
+{
+	size_t bytes = 0;
+	size_t row = 0;
+	size_t rows = 0;
+
+	bool bc = false;
+	bool packed = false;
+	bool planar = false;
+	size_t bpe = 0;
+	switch (format)
+	{
+	case DXGI_FORMAT_BC1_TYPELESS:
+	case DXGI_FORMAT_BC1_UNORM:
+	case DXGI_FORMAT_BC1_UNORM_SRGB:
+	case DXGI_FORMAT_BC4_TYPELESS:
+	case DXGI_FORMAT_BC4_UNORM:
+	case DXGI_FORMAT_BC4_SNORM:
+		bc = true;
+		bpe = 8;
+		break;
+
+	case DXGI_FORMAT_BC2_TYPELESS:
+	case DXGI_FORMAT_BC2_UNORM:
+	case DXGI_FORMAT_BC2_UNORM_SRGB:
+	case DXGI_FORMAT_BC3_TYPELESS:
+	case DXGI_FORMAT_BC3_UNORM:
+	case DXGI_FORMAT_BC3_UNORM_SRGB:
+	case DXGI_FORMAT_BC5_TYPELESS:
+	case DXGI_FORMAT_BC5_UNORM:
+	case DXGI_FORMAT_BC5_SNORM:
+	case DXGI_FORMAT_BC6H_TYPELESS:
+	case DXGI_FORMAT_BC6H_UF16:
+	case DXGI_FORMAT_BC6H_SF16:
+	case DXGI_FORMAT_BC7_TYPELESS:
+	case DXGI_FORMAT_BC7_UNORM:
+	case DXGI_FORMAT_BC7_UNORM_SRGB:
+		bc = true;
+		bpe = 16;
+		break;
+
+	case DXGI_FORMAT_R8G8_B8G8_UNORM:
+	case DXGI_FORMAT_G8R8_G8B8_UNORM:
+	case DXGI_FORMAT_YUY2:
+		packed = true;
+		bpe = 4;
+		break;
+
+	case DXGI_FORMAT_Y210:
+	case DXGI_FORMAT_Y216:
+		packed = true;
+		bpe = 8;
+		break;
+
+	case DXGI_FORMAT_NV12:
+	case DXGI_FORMAT_420_OPAQUE:
+		planar = true;
+		bpe = 2;
+		break;
+
+	case DXGI_FORMAT_P010:
+	case DXGI_FORMAT_P016:
+		planar = true;
+		bpe = 4;
+		break;
+	}
+
+	if (bc)
+	{
+		const size_t blocksWide = (width > 0) ? std::max<size_t>(1, (width + 3) / 4) : 0;
+		const size_t blocksHigh = (height > 0) ? std::max<size_t>(1, (height + 3) / 4) : 0;
+		row = blocksWide * bpe;
+		rows = blocksHigh;
+		bytes = row * blocksHigh;
+	}
+	else if (packed)
+	{
+		row = ((width + 1) >> 1) * bpe;
+		rows = height;
+		bytes = row * height;
+	}
+	else if (format == DXGI_FORMAT_NV11)
+	{
+		// Direct3D assumes twice the rows, more than the 4:1:1 data needs
+		row = ((width + 3) >> 2) * 4;
+		rows = height * 2;
+		bytes = row * rows;
+	}
+	else if (planar)
+	{
+		row = ((width + 1) >> 1) * bpe;
+		bytes = (row * height) + ((row * height + 1) >> 1);
+		rows = height + ((height + 1) >> 1);
+	}
+	else
+	{
+		row = (width * DdsBitsPerPixel(format) + 7) / 8;
+		rows = height;
+		bytes = row * height;
+	}
+
+	if (numBytes)
+	{
+		*numBytes = bytes;
+	}
+	if (rowBytes)
+	{
+		*rowBytes = row;
+	}
+	if (numRows)
+	{
+		*numRows = rows;
+	}
+}
+
+void DdsBlockSize(uint32_t format, uint32_t& blockWidth, uint32_t& blockHeight)
+{
+	switch (format)
+	{
+	case DXGI_FORMAT_BC1_TYPELESS:
+	case DXGI_FORMAT_BC1_UNORM:
+	case DXGI_FORMAT_BC1_UNORM_SRGB:
+	case DXGI_FORMAT_BC2_TYPELESS:
+	case DXGI_FORMAT_BC2_UNORM:
+	case DXGI_FORMAT_BC2_UNORM_SRGB:
+	case DXGI_FORMAT_BC3_TYPELESS:
+	case DXGI_FORMAT_BC3_UNORM:
+	case DXGI_FORMAT_BC3_UNORM_SRGB:
+	case DXGI_FORMAT_BC4_TYPELESS:
+	case DXGI_FORMAT_BC4_UNORM:
+	case DXGI_FORMAT_BC4_SNORM:
+	case DXGI_FORMAT_BC5_TYPELESS:
+	case DXGI_FORMAT_BC5_UNORM:
+	case DXGI_FORMAT_BC5_SNORM:
+	case DXGI_FORMAT_BC6H_TYPELESS:
+	case DXGI_FORMAT_BC6H_UF16:
+	case DXGI_FORMAT_BC6H_SF16:
+	case DXGI_FORMAT_BC7_TYPELESS:
+	case DXGI_FORMAT_BC7_UNORM:
+	case DXGI_FORMAT_BC7_UNORM_SRGB:
+		blockWidth = 4;
+		blockHeight = 4;
+		break;
+
+	case DXGI_FORMAT_R8G8_B8G8_UNORM:
+	case DXGI_FORMAT_G8R8_G8B8_UNORM:
+	case DXGI_FORMAT_YUY2:
+	case DXGI_FORMAT_Y210:
+	case DXGI_FORMAT_Y216:
+		blockWidth = 2;
+		blockHeight = 1;
+		break;
+
+	case DXGI_FORMAT_NV12:
+	case DXGI_FORMAT_420_OPAQUE:
+	case DXGI_FORMAT_P010:
+	case DXGI_FORMAT_P016:
+		blockWidth = 2;
+		blockHeight = 2;
+		break;
+
+	case DXGI_FORMAT_NV11:
+		blockWidth = 4;
+		blockHeight = 1;
+		break;
+
+	default:
+		blockWidth = 1;
+		blockHeight = 1;
+		break;
+	}
+}
+
+bool DdsIsPlanar(uint32_t format)
+{
+	switch (format)
+	{
+	case DXGI_FORMAT_NV12:
+	case DXGI_FORMAT_420_OPAQUE:
+	case DXGI_FORMAT_P010:
+	case DXGI_FORMAT_P016:
+	case DXGI_FORMAT_NV11:
+		return true;
+
+	default:
+		return false;
+	}
+}
+
+DdsStatus ParseDdsHeader(const uint8_t* data, size_t size, uint64_t fileSize, DdsInfo& info)
+{
+	info = DdsInfo();
+
+	uint32_t magic;
+	DdsHeader header;
+	if (size < sizeof(magic) + sizeof(header) || fileSize < size)
+	{
+		return DdsStatus_Invalid;
+	}
+	memcpy(&magic, data, sizeof(magic));
+	memcpy(&header, data + sizeof(magic), sizeof(header));
+	if (magic != DdsMagic || header.Size != sizeof(DdsHeader) || header.PixelFormat.Size != sizeof(DdsPixelFormat))
+	{
+		return DdsStatus_Invalid;
+	}
+
+	info.Width = header.Width;
+	info.Height = header.Height;
+	info.Depth = header.Depth;
+	info.MipCount = std::max(header.MipMapCount, 1u);
+	info.ArraySize = 1;
+	info.DataOffset = sizeof(magic) + sizeof(header);
+
+	if ((header.PixelFormat.Flags & DdsFourCCFlag) && header.PixelFormat.FourCC == FourCC('D', 'X', '1', '0'))
+	{
+		DdsHeaderDxt10 dxt10;
+		if (size < sizeof(magic) + sizeof(header) + sizeof(dxt10))
+		{
+			return DdsStatus_Invalid;
+		}
+		memcpy(&dxt10, data + info.DataOffset, sizeof(dxt10));
+		info.DataOffset += sizeof(dxt10);
+
+		info.ArraySize = dxt10.ArraySize;
+		if (info.ArraySize == 0)
+		{
+			return DdsStatus_Invalid;
+		}
+
+		switch (dxt10.DxgiFormat)
+		{
+		case DXGI_FORMAT_AI44:
+		case DXGI_FORMAT_IA44:
+		case DXGI_FORMAT_P8:
+		case DXGI_FORMAT_A8P8:
+			return DdsStatus_NotSupported;
+
+		default:
+			if (DdsBitsPerPixel(dxt10.DxgiFormat) == 0)
+			{
+				return DdsStatus_NotSupported;
+			}
+		}
+		info.Format = dxt10.DxgiFormat;
+
+		switch (dxt10.ResourceDimension)
+		{
+		case DdsDimension_Texture1D:
+			if ((header.Flags & DdsHeightFlag) && info.Height != 1)
+			{
+				return DdsStatus_Invalid;
+			}
+			info.Height = info.Depth = 1;
+			break;
+
+		case DdsDimension_Texture2D:
+			if (dxt10.MiscFlag & MiscTextureCube)
+			{
+				info.ArraySize *= 6;
+				info.IsCubeMap = true;
+			}
+			info.Depth = 1;
+			break;
+
+		case DdsDimension_Texture3D:
+			if (!(header.Flags & DdsVolumeFlag))
+			{
+				return DdsStatus_Invalid;
+			}
+			if (info.ArraySize > 1)
+			{
+				return DdsStatus_NotSupported;
+			}
+			break;
+
+		default:
+			return DdsStatus_NotSupported;
+		}
+		info.Dimension = static_cast<DdsDimension>(dxt10.ResourceDimension);
+	}
+	else
+	{
+		info.Format = FormatFromPixelFormat(header.PixelFormat);
+		if (info.Format == DXGI_FORMAT_UNKNOWN)
+		{
+			return DdsStatus_NotSupported;
+		}
+
+		if (header.Flags & DdsVolumeFlag)
+		{
+			info.Dimension = DdsDimension_Texture3D;
+		}
+		else
+		{
+			if (header.Caps2 & DdsCubeMap)
+			{
+				if ((header.Caps2 & DdsCubeMapAllFaces) != DdsCubeMapAllFaces)
+				{
+					return DdsStatus_NotSupported;
+				}
+				info.ArraySize = 6;
+				info.IsCubeMap = true;
+			}
+			info.Depth = 1;
+			info.Dimension = DdsDimension_Texture2D;
+		}
+	}
+
+	if (info.MipCount > MaxMipLevels)
+	{
+		return DdsStatus_NotSupported;
+	}
+
+	switch (info.Dimension)
+	{
+	case DdsDimension_Texture1D:
+		if (info.ArraySize > MaxTexture1DArraySize || info.Width > MaxTexture1DSize)
+		{
+			return DdsStatus_NotSupported;
+		}
+		break;
+
+	case DdsDimension_Texture2D:
+		if (info.ArraySize > MaxTexture2DArraySize ||
+			info.Width > (info.IsCubeMap ? MaxTextureCubeSize : MaxTexture2DSize) ||
+			info.Height > (info.IsCubeMap ? MaxTextureCubeSize : MaxTexture2DSize))
+		{
+			return DdsStatus_NotSupported;
+		}
+		break;
+
+	case DdsDimension_Texture3D:
+		if (info.Width > MaxTexture3DSize || info.Height > MaxTexture3DSize || info.Depth > MaxTexture3DSize)
+		{
+			return DdsStatus_NotSupported;
+		}
+		break;
+	}
+
+	// Walk the surfaces as FillInitData12 does, without touching them
+	uint64_t dataBytes = 0;
+	for (uint32_t slice = 0; slice < info.ArraySize; slice++)
+	{
+		size_t w = info.Width;
+		size_t h = info.Height;
+		size_t d = info.Depth;
+		for (uint32_t mip = 0; mip < info.MipCount; mip++)
+		{
+			size_t surfaceBytes;
+			DdsSurfaceInfo(w, h, info.Format, &surfaceBytes, nullptr, nullptr);
+			dataBytes += static_cast<uint64_t>(surfaceBytes) * d;
+			w = std::max<size_t>(w >> 1, 1);
+			h = std::max<size_t>(h >> 1, 1);
+			d = std::max<size_t>(d >> 1, 1);
+		}
+	}
+	info.DataBytes = dataBytes;
+	if (dataBytes > fileSize - info.DataOffset)
+	{
+		return DdsStatus_Truncated;
+	}
+	return DdsStatus_Ok;
+}
@@ -0,0 +1,68 @@
+#pragma once
+#include <cstddef>
+#include <cstdint>
+
+// DDS header parsing and DXGI format sizes without any Windows header, so textures can
+// be inspected by tools and worker threads before a device exists. Formats are
+// DXGI_FORMAT values. The rules follow CreateTextureFromDDS12: a header accepted here
+// loads there, provided the surfaces it describes are all in the file.
+
+// Enough of a file to hold its headers: magic, DDS_HEADER and DDS_HEADER_DXT10
+const size_t DdsMaxHeaderBytes = 148;
+
+// The D3D12_RESOURCE_DIMENSION values
+enum DdsDimension : uint32_t
+{
+	DdsDimension_Texture1D = 2,
+	DdsDimension_Texture2D = 3,
+	DdsDimension_Texture3D = 4,
+};
+
+enum DdsStatus : uint32_t
+{
+	DdsStatus_Ok = 0,
+	// Not a DDS file, or a header that contradicts itself
+	DdsStatus_Invalid,
+	// A DDS file the loader refuses (ERROR_NOT_SUPPORTED)
+	DdsStatus_NotSupported,
+	// Shorter than its surfaces need (ERROR_HANDLE_EOF)
+	DdsStatus_Truncated,
+	// Could not be opened or read
+	DdsStatus_Unreadable,
+};
+
+struct DdsInfo
+{
+	uint32_t Width;
+	uint32_t Height;
+	uint32_t Depth;
+	// As stored; the loader builds a chain for 2D textures that have a single level
+	uint32_t MipCount;
+	// Six per cube for cube maps
+	uint32_t ArraySize;
+	uint32_t Format;
+	DdsDimension Dimension;
+	bool IsCubeMap;
+	// Where the surfaces start in the file, and their total size
+	uint32_t DataOffset;
+	uint64_t DataBytes;
+};
+
+// Bits per texel, or 0 for formats the loader does not handle
+size_t DdsBitsPerPixel(uint32_t format);
+
+// Bytes of a width x height surface, of one row (of blocks, for block compressed and
+// planar formats) and the number of rows. Any output may be null.
+void DdsSurfaceInfo(size_t width, size_t height, uint32_t format, size_t* numBytes, size_t* rowBytes, size_t* numRows);
+
+// Texels per block: 4x4 for block compressed formats, 2x1 for packed 4:2:2 ones and 1x1
+// for the rest. Copies of these formats must cover whole blocks.
+void DdsBlockSize(uint32_t format, uint32_t& blockWidth, uint32_t& blockHeight);
+
+// Formats stored as a luma plane followed by chroma (NV12, P010, ...). The surfaces in a
+// DDS file keep the planes together; D3D12 gives each plane its own subresources.
+bool DdsIsPlanar(uint32_t format);
+
+// Validates the headers at the start of a DDS file. data holds the first size bytes
+// (DdsMaxHeaderBytes are enough) of a file fileSize bytes long.
+DdsStatus ParseDdsHeader(const uint8_t* data, size_t size, uint64_t fileSize, DdsInfo& info);
@@ -0,0 +1,240 @@
+#include "DdsManifest.h"
+#include "MappedFile.h"
+#include "Parallel.h"
+#include <algorithm>
+#include <cstring>
+#include <fstream>
+#include <system_error>
+#include <unordered_map>
+
+namespace
+{
+	struct ManifestHeader
+	{
+		uint32_t Magic;
+		uint32_t Version;
+		uint32_t EntryCount;
+		uint32_t InfoSize;
+		uint64_t PathBytes;
+	};
+
+	// Followed by the paths, packed one after another
+	struct ManifestRecord
+	{
+		uint64_t Size;
+		int64_t Time;
+		uint64_t PathOffset;
+		uint32_t PathLength;
+		uint32_t Status;
+		DdsInfo Info;
+	};
+
+	bool IsDdsFile(const std::filesystem::path& path)
+	{
+		std::string extension = path.extension().string();
+		std::transform(extension.begin(), extension.end(), extension.begin(), [](char c)
+		{
+			return static_cast<char>((c >= 'A' && c <= 'Z') ? c - 'A' + 'a' : c);
+		});
+		return extension == ".dds";
+	}
+}
+
+DdsStatus ProbeDdsFile(const std::filesystem::path& path, DdsInfo& info)
+{
+	info = DdsInfo();
+
+	std::error_code ec;
+	const uint64_t fileSize = std::filesystem::file_size(path, ec);
+	std::ifstream file(path, std::ios::binary);
+	if (ec || !file)
+	{
+		return DdsStatus_Unreadable;
+	}
+
+	uint8_t header[DdsMaxHeaderBytes];
+	const size_t wanted = static_cast<size_t>(std::min<uint64_t>(fileSize, sizeof(header)));
+	file.read(reinterpret_cast<char*>(header), static_cast<std::streamsize>(wanted));
+	if (static_cast<size_t>(file.gcount()) != wanted)
+	{
+		return DdsStatus_Unreadable;
+	}
+	return ParseDdsHeader(header, wanted, fileSize, info);
+}
+
+std::vector<uint8_t> SerializeDdsManifest(const std::vector<DdsManifestEntry>& entries)
+{
+	ManifestHeader header = {};
+	header.Magic = DdsManifestMagic;
+	header.Version = DdsManifestVersion;
+	header.EntryCount = static_cast<uint32_t>(entries.size());
+	header.InfoSize = sizeof(DdsInfo);
+	for (const DdsManifestEntry& entry : entries)
+	{
+		header.PathBytes += entry.Path.size();
+	}
+
+	std::vector<uint8_t> image(sizeof(header) + entries.size() * sizeof(ManifestRecord) + header.PathBytes);
+	memcpy(image.data(), &header, sizeof(header));
+
+	uint8_t* records = image.data() + sizeof(header);
+	uint8_t* paths = records + entries.size() * sizeof(ManifestRecord);
+	uint64_t pathOffset = 0;
+	for (size_t i = 0; i < entries.size(); i++)
+	{
+		const DdsManifestEntry& entry = entries[i];
+		ManifestRecord record = {};
+		record.Size = entry.Size;
+		record.Time = entry.Time;
+		record.PathOffset = pathOffset;
+		record.PathLength = static_cast<uint32_t>(entry.Path.size());
+		record.Status = entry.Status;
+		record.Info = entry.Info;
+		memcpy(records + i * sizeof(ManifestRecord), &record, sizeof(record));
+		memcpy(paths + pathOffset, entry.Path.data(), entry.Path.size());
+		pathOffset += entry.Path.size();
+	}
+	return image;
+}
+
+bool ParseDdsManifest(const uint8_t* data, size_t size, std::vector<DdsManifestEntry>& entries)
+{
+	entries.clear();
+
+	ManifestHeader header;
+	if (size < sizeof(header))
+	{
+		return false;
+	}
+	memcpy(&header, data, sizeof(header));
+	if (header.Magic != DdsManifestMagic || header.Version != DdsManifestVersion || header.InfoSize != sizeof(DdsInfo) ||
+		header.EntryCount > (size - sizeof(header)) / sizeof(ManifestRecord) ||
+		header.PathBytes != size - sizeof(header) - header.EntryCount * sizeof(ManifestRecord))
+	{
+		return false;
+	}
+
+	const uint8_t* records = data + sizeof(header);
+	const char* paths = reinterpret_cast<const char*>(records + header.EntryCount * sizeof(ManifestRecord));
+	entries.resize(header.EntryCount);
+	for (uint32_t i = 0; i < header.EntryCount; i++)
+	{
+		ManifestRecord record;
+		memcpy(&record, records + i * sizeof(ManifestRecord), sizeof(record));
+		if (record.PathOffset > header.PathBytes || record.PathLength > header.PathBytes - record.PathOffset ||
+			record.Status > DdsStatus_Unreadable)
+		{
+			entries.clear();
+			return false;
+		}
+
+		DdsManifestEntry& entry = entries[i];
+		entry.Path.assign(paths + record.PathOffset, record.PathLength);
+		entry.Size = record.Size;
+		entry.Time = record.Time;
+		entry.Status = static_cast<DdsStatus>(record.Status);
+		entry.Info = record.Info;
+	}
+	return true;
+}
+
+bool ScanDdsDirectory(const std::filesystem::path& directory, const std::filesystem::path& manifestPath,
+	std::vector<DdsManifestEntry>& entries, DdsScanStats* stats, unsigned threadCount)
+{
+	entries.clear();
+	if (stats)
+	{
+		*stats = DdsScanStats();
+	}
+
+	std::error_code ec;
+	std::vector<std::filesystem::path> files;
+	for (auto it = std::filesystem::recursive_directory_iterator(directory, ec);
+		!ec && it != std::filesystem::recursive_directory_iterator(); it.increment(ec))
+	{
+		if (it->is_regular_file() && IsDdsFile(it->path()))
+		{
+			files.push_back(it->path());
+		}
+	}
+	if (ec)
+	{
+		return false;
+	}
+
+	entries.resize(files.size());
+	for (size_t i = 0; i < files.size(); i++)
+	{
+		DdsManifestEntry& entry = entries[i];
+		entry.Path = files[i].lexically_relative(directory).generic_u8string();
+		entry.Size = std::filesystem::file_size(files[i], ec);
+		entry.Time = ec ? 0 : static_cast<int64_t>(std::filesystem::last_write_time(files[i], ec).time_since_epoch().count());
+		entry.Status = DdsStatus_Unreadable;
+		entry.Info = DdsInfo();
+	}
+
+	// A missing or stale manifest just means probing everything
+	std::vector<DdsManifestEntry> previous;
+	MappedFile manifest;
+	if (manifest.Open(manifestPath))
+	{
+		ParseDdsManifest(manifest.Data(), static_cast<size_t>(manifest.Size()), previous);
+		manifest.Close();
+	}
+	std::unordered_map<std::string, const DdsManifestEntry*> byPath;
+	for (const DdsManifestEntry& entry : previous)
+	{
+		byPath[entry.Path] = &entry;
+	}
+
+	std::vector<size_t> changed;
+	for (size_t i = 0; i < entries.size(); i++)
+	{
+		auto it = byPath.find(entries[i].Path);
+		if (it != byPath.end() && it->second->Size == entries[i].Size && it->second->Time == entries[i].Time)
+		{
+			entries[i].Status = it->second->Status;
+			entries[i].Info = it->second->Info;
+		}
+		else
+		{
+			changed.push_back(i);
+		}
+	}
+
+	ParallelFor(changed.size(), threadCount, [&](size_t i)
+	{
+		DdsManifestEntry& entry = entries[changed[i]];
+		entry.Status = ProbeDdsFile(files[changed[i]], entry.Info);
+	});
+
+	std::vector<size_t> order(entries.size());
+	for (size_t i = 0; i < order.size(); i++)
+	{
+		order[i] = i;
+	}
+	std::sort(order.begin(), order.end(), [&](size_t a, size_t b) { return entries[a].Path < entries[b].Path; });
+	std::vector<DdsManifestEntry> sorted(entries.size());
+	for (size_t i = 0; i < order.size(); i++)
+	{
+		sorted[i] = std::move(entries[order[i]]);
+	}
+	entries.swap(sorted);
+
+	// Files removed since also make the manifest stale
+	const bool stale = !changed.empty() || previous.size() != entries.size();
+	bool written = false;
+	if (stale)
+	{
+		written = WriteFileAtomic(manifestPath, SerializeDdsManifest(entries));
+	}
+
+	if (stats)
+	{
+		stats->Files = static_cast<uint32_t>(entries.size());
+		stats->Probed = static_cast<uint32_t>(changed.size());
+		stats->Reused = static_cast<uint32_t>(entries.size() - changed.size());
+		stats->ManifestWritten = written;
+	}
+	return true;
+}
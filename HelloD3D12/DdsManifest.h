@@ -0,0 +1,42 @@
+#pragma once
+#include "DdsFormat.h"
+#include <filesystem>
+#include <string>
+#include <vector>
+
+// A record of the DDS files under a directory, kept in a small binary file so later
+// runs only read the headers of files that changed. Bump DdsManifestVersion when
+// DdsInfo or the validation rules change; stale manifests are then ignored.
+const uint32_t DdsManifestMagic = 0x4D534444; // "DDSM"
+const uint32_t DdsManifestVersion = 1;
+
+struct DdsManifestEntry
+{
+	// Relative to the scanned directory, with forward slashes
+	std::string Path;
+	uint64_t Size;
+	int64_t Time;
+	DdsStatus Status;
+	DdsInfo Info;
+};
+
+struct DdsScanStats
+{
+	uint32_t Files;
+	uint32_t Probed;
+	uint32_t Reused;
+	bool ManifestWritten;
+};
+
+// Validates a file from its headers alone, reading at most DdsMaxHeaderBytes of it
+DdsStatus ProbeDdsFile(const std::filesystem::path& path, DdsInfo& info);
+
+std::vector<uint8_t> SerializeDdsManifest(const std::vector<DdsManifestEntry>& entries);
+bool ParseDdsManifest(const uint8_t* data, size_t size, std::vector<DdsManifestEntry>& entries);
+
+// Describes every .dds file under directory, sorted by path. Entries of the manifest at
+// manifestPath whose file kept its size and time are reused and the rest are probed in
+// parallel; the manifest is rewritten when anything changed. Fails only when the
+// directory cannot be listed.
+bool ScanDdsDirectory(const std::filesystem::path& directory, const std::filesystem::path& manifestPath,
+	std::vector<DdsManifestEntry>& entries, DdsScanStats* stats = nullptr, unsigned threadCount = 0);
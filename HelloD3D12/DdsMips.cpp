@@ -0,0 +1,61 @@
+#include "DdsMips.h"
+#include <cstring>
+
+bool DdsMipFormat(uint32_t format, MipFormat& mipFormat)
+{
+	switch (format)
+	{
+	case 28: // DXGI_FORMAT_R8G8B8A8_UNORM
+	case 87: // DXGI_FORMAT_B8G8R8A8_UNORM
+	case 88: // DXGI_FORMAT_B8G8R8X8_UNORM
+		mipFormat = MipFormat_RGBA8;
+		return true;
+	case 29: // DXGI_FORMAT_R8G8B8A8_UNORM_SRGB
+	case 91: // DXGI_FORMAT_B8G8R8A8_UNORM_SRGB
+	case 93: // DXGI_FORMAT_B8G8R8X8_UNORM_SRGB
+		mipFormat = MipFormat_RGBA8Srgb;
+		return true;
+	case 10: // DXGI_FORMAT_R16G16B16A16_FLOAT
+		mipFormat = MipFormat_RGBA16Float;
+		return true;
+	case 41: // DXGI_FORMAT_R32_FLOAT
+		mipFormat = MipFormat_R32Float;
+		return true;
+	default:
+		return false;
+	}
+}
+
+bool ExpandDdsMips(DdsInfo& info, const uint8_t*& data, size_t& size, std::vector<uint8_t>& mips, unsigned threadCount)
+{
+	MipFormat mipFormat;
+	if (info.MipCount != 1 || info.Dimension != DdsDimension_Texture2D || info.IsCubeMap ||
+		(info.Width <= 1 && info.Height <= 1) || !DdsMipFormat(info.Format, mipFormat))
+	{
+		return false;
+	}
+
+	const uint32_t mipCount = FullMipCount(info.Width, info.Height);
+	const size_t topBytes = MipChainBytes(mipFormat, info.Width, info.Height, 1);
+	const size_t sliceBytes = MipChainBytes(mipFormat, info.Width, info.Height, mipCount);
+	if (size < topBytes * info.ArraySize)
+	{
+		return false;
+	}
+
+	mips.resize(sliceBytes * info.ArraySize);
+	for (uint32_t slice = 0; slice < info.ArraySize; slice++)
+	{
+		memcpy(mips.data() + slice * sliceBytes, data + slice * topBytes, topBytes);
+	}
+	if (!GenerateMips(mipFormat, MipFilter_Box, info.Width, info.Height, info.ArraySize, mipCount,
+		mips.data(), mips.size(), threadCount))
+	{
+		return false;
+	}
+
+	info.MipCount = mipCount;
+	data = mips.data();
+	size = mips.size();
+	return true;
+}
@@ -0,0 +1,19 @@
+#pragma once
+#include "DdsFormat.h"
+#include "MipGenerator.h"
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+
+// The CPU work a DDS load does between parsing the header and staging the surfaces,
+// kept free of Windows headers so tools and benchmarks run the loader's own code.
+
+// The format mip chains are filtered in for a DXGI format, or false for formats whose
+// chains are not built at load time (block compressed ones among them)
+bool DdsMipFormat(uint32_t format, MipFormat& mipFormat);
+
+// 2D textures other than cube maps that ship with only their top level get a box
+// filtered chain built in mips. data and size then point at it and info.MipCount covers
+// the full chain. Otherwise nothing changes and the file's surfaces are staged as they
+// are. Returns whether a chain was built.
+bool ExpandDdsMips(DdsInfo& info, const uint8_t*& data, size_t& size, std::vector<uint8_t>& mips, unsigned threadCount = 0);
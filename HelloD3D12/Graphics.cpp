@@ -1,8 +1,10 @@
 #include "Graphics.h"
 #include <algorithm>
 #include <array>
+#include <cfloat>
 #include "DDSTextureLoader.h"
-#include <fstream>
+#include "MeshCache.h"
+#include "TextureUpload12.h"
 
 Graphics::Graphics()
 	:
@@ -66,12 +68,11 @@ void Graphics::Init(HWND hWnd)
 	CreateCommandList();
 	CloseCommandList();
 	pCommandList->Reset(pCommandAllocator.Get(), nullptr);
-	auto woodCrateTex = std::make_unique<Texture>();
-	woodCrateTex->Name = "woodCrateTex";
-	woodCrateTex->Filename = L"Textures/WoodCrate01.dds";
-	ThrowIfFailed(DirectX::CreateDDSTextureFromFile12(
-		pDevice.Get(), pCommandList.Get(), woodCrateTex->Filename.c_str(),
-		woodCrateTex->Resource, woodCrateTex->UploadHeap));
+	ThrowIfFailed(pUploadRing.Create(pDevice.Get(), UploadRingSize));
+	ThrowIfFailed(pTextureHeap.Create(pDevice.Get()));
+	pTextureStreamer.Create(pDevice.Get(), &pUploadRing, &pTextureHeap);
+	// Without an adapter to ask, the fallback budget is used
+	pVideoMemoryBudget.Create(pFactory.Get(), pDevice.Get());
 	// Create empty root signature
 	CreateRootSignature();
 
@@ -83,16 +84,14 @@ void Graphics::Init(HWND hWnd)
 
 	CD3DX12_CPU_DESCRIPTOR_HANDLE hDescriptor(pSRVDescriptorHeap->GetCPUDescriptorHandleForHeapStart());
 
-	woodTexResource = woodCrateTex->Resource;
-
-	D3D12_SHADER_RESOURCE_VIEW_DESC srvDesc = {};
-	srvDesc.Shader4ComponentMapping = D3D12_DEFAULT_SHADER_4_COMPONENT_MAPPING;
-	srvDesc.Format = woodTexResource->GetDesc().Format;
-	srvDesc.ViewDimension = D3D12_SRV_DIMENSION_TEXTURE2D;
-	srvDesc.Texture2D.MostDetailedMip = 0;
-	srvDesc.Texture2D.MipLevels = woodTexResource->GetDesc().MipLevels;
-
-	pDevice->CreateShaderResourceView(woodTexResource.Get(), &srvDesc, pSRVDescriptorHeap->GetCPUDescriptorHandleForHeapStart());
+	// Only the small mips are loaded now; the streamer writes the SRV and moves it to
+	// finer mips as they arrive. It also owns the resource, which it replaces when the
+	// texture is demoted or evicted, so no other reference is kept.
+	auto woodCrateTex = std::make_unique<Texture>();
+	woodCrateTex->Name = "woodCrateTex";
+	woodCrateTex->Filename = L"Textures/WoodCrate01.dds";
+	ThrowIfFailed(pTextureStreamer.Load(pCommandList.Get(), woodCrateTex->Filename.c_str(), StreamResidentSize,
+		hDescriptor, pWoodTexture, woodCrateTex->UploadHeap));
 
 	// Compile shaders
 	CompileShaders();
@@ -122,8 +121,18 @@ void Graphics::Init(HWND hWnd)
 	ID3D12CommandList* ppCommandLists[] = { pCommandList.Get() };
 	pCommandQueue->ExecuteCommandLists(_countof(ppCommandLists), ppCommandLists);
 
+	// The texture copies are done once the next fence value is reached
+	pUploadRing.Submit(pFenceValue);
+
 	// Wait for GPU to complete (check on fence)
 	WaitForPreviousFrame();
+	pUploadRing.Retire(pFence.Get());
+
+	const TextureUploadStatistics uploads = GetTextureUploadStatistics();
+	char uploadText[128];
+	snprintf(uploadText, sizeof(uploadText), "Texture uploads: %llu (%llu subresources), %llu heap allocations\n",
+		uploads.Uploads, uploads.Subresources, uploads.HeapAllocations);
+	OutputDebugStringA(uploadText);
 }
 
 void Graphics::Shutdown()
@@ -153,8 +162,11 @@ void Graphics::Update()
 	//DirectX::XMMATRIX proj = DirectX::XMMatrixPerspectiveFovLH(0.25f * DirectX::XM_PI, 1280/960, 0.1f, 100.0f);
 	//DirectX::XMMATRIX worldViewProj = world * view * proj;
 	
-	DirectX::XMStoreFloat4x4(&cb2.transform, DirectX::XMMatrixTranspose(DirectX::XMMatrixTranslation(0.0f, -3.0f, 0.0f)));
+	DirectX::XMMATRIX skullWorld = DirectX::XMMatrixTranslation(0.0f, -3.0f, 0.0f);
+	DirectX::XMStoreFloat4x4(&cb2.transform, DirectX::XMMatrixTranspose(skullWorld));
 	DirectX::XMStoreFloat4x4(&cb2.texTransform, DirectX::XMMatrixTranspose(DirectX::XMMatrixIdentity()));
+	cb2.positionScale = pPositionScale;
+	cb2.positionOffset = pPositionOffset;
 
 	UINT8* pConstantDataBegin;
 	CD3DX12_RANGE readRange(0, 0);
@@ -200,9 +212,38 @@ void Graphics::Update()
 	DirectX::XMMATRIX gView = DirectX::XMMatrixLookAtLH(viewPos, viewTarget, viewUp);
 
 	DirectX::XMMATRIX gViewProj = DirectX::XMMatrixMultiply(gView, gProj);
+	DirectX::XMStoreFloat4x4(&pViewProj, gViewProj);
 	DirectX::XMStoreFloat3(&lightsCB.eyePosW, viewPos);
 	DirectX::XMStoreFloat4x4(&lightsCB.view, DirectX::XMMatrixTranspose(gViewProj));
 
+	// Cull meshlets in model space
+	DirectX::XMFLOAT4X4 skullWorldViewProj;
+	DirectX::XMStoreFloat4x4(&skullWorldViewProj, skullWorld * gViewProj);
+	DirectX::XMFLOAT3 skullEye;
+	DirectX::XMStoreFloat3(&skullEye, DirectX::XMVector3TransformCoord(viewPos, DirectX::XMMatrixInverse(nullptr, skullWorld)));
+
+	MeshletFrustum frustum;
+	ExtractMeshletFrustum(&skullWorldViewProj.m[0][0], { skullEye.x, skullEye.y, skullEye.z }, frustum);
+	pVisibleMeshletCount = CullMeshlets(pVisibleMeshlets.data(), pMeshlets.data(), pMeshlets.size(), frustum).Visible;
+
+	// Pick the skull's level of detail from its projected size
+	DirectX::XMFLOAT3 skullCenter;
+	DirectX::XMStoreFloat3(&skullCenter, DirectX::XMVector3TransformCoord(DirectX::XMVectorSet(pMeshCenter.x, pMeshCenter.y, pMeshCenter.z, 1.0f), skullWorld));
+	pLodObjects.CenterX[0] = skullCenter.x;
+	pLodObjects.CenterY[0] = skullCenter.y;
+	pLodObjects.CenterZ[0] = skullCenter.z;
+	pLodSettings.Eye = { pEyePos.x, pEyePos.y, pEyePos.z };
+	pLodSettings.ProjectionScale = LodProjectionScale(0.25f * DirectX::XM_PI, 960.0f);
+	SelectLods(pLodObjects, pLodTables.data(), pLodSettings);
+
+	// Ask for the wood texture at the skull's projected diameter in pixels
+	const float skullDistance = DirectX::XMVectorGetX(DirectX::XMVector3Length(
+		DirectX::XMVectorSubtract(DirectX::XMLoadFloat3(&skullCenter), viewPos)));
+	const float skullPixels = 2.0f * pMeshRadius * pLodSettings.ProjectionScale / std::max(skullDistance, 1e-3f);
+	const UINT texturePixels = static_cast<UINT>(std::min(skullPixels, 16384.0f)) + 1;
+	pTextureStreamer.RequestResolution(pWoodTexture, texturePixels, texturePixels);
+	pTextureStreamer.SetMemoryBudget(pVideoMemoryBudget.Query(FallbackVideoMemoryBudget) / 2);
+
 	UINT lightConstantBufferByteSize = CalcConstantBufferByteSize(sizeof(PassConstants));
 
 	UINT8* pLightsConstantDataBegin;
@@ -225,6 +266,8 @@ void Graphics::Render()
 	//////////////////////////////
 	ID3D12CommandList* ppCommandLists[] = { pCommandList.Get() };
 	pCommandQueue->ExecuteCommandLists(_countof(ppCommandLists), ppCommandLists);
+	pUploadRing.Submit(pFenceValue);
+	pTextureStreamer.Submit(pFenceValue);
 
 	//////////////////////////////
 	// PRESENT COMMAND LIST //////
@@ -237,6 +280,9 @@ void Graphics::Render()
 	// Check on fence
 	WaitForPreviousFrame();
 
+	// Streamed mips copied this frame can be sampled from the next one
+	pUploadRing.Retire(pFence.Get());
+	pTextureStreamer.Retire(pFence.Get());
 }
 
 void Graphics::GetHardwareAdapter(Microsoft::WRL::ComPtr<IDXGIFactory1> pFactory, Microsoft::WRL::ComPtr<IDXGIAdapter1> ppAdapter)
@@ -413,7 +459,12 @@ void Graphics::CompileShaders()
 #else
 	UINT compileFlags = 0;
 #endif
-	ThrowIfFailed(D3DCompileFromFile(L"Shaders/VertexShader.hlsl", nullptr, nullptr, "main", "vs_5_0", compileFlags, 0, &pVertexShaderBlob, nullptr));
+	const D3D_SHADER_MACRO vertexShaderDefines[] =
+	{
+		{ "COMPRESSED_VERTICES", pCompressedVertices ? "1" : "0" },
+		{ nullptr, nullptr }
+	};
+	ThrowIfFailed(D3DCompileFromFile(L"Shaders/VertexShader.hlsl", vertexShaderDefines, nullptr, "main", "vs_5_0", compileFlags, 0, &pVertexShaderBlob, nullptr));
 	ThrowIfFailed(D3DCompileFromFile(L"Shaders/PixelShader.hlsl", nullptr, nullptr, "main", "ps_5_0", compileFlags, 0, &pPixelShaderBlob, nullptr));
 }
 
@@ -453,6 +504,14 @@ void Graphics::CreatePipelineState()
 		{"NORMAL", 0, DXGI_FORMAT_R32G32B32_FLOAT, 0, 12, D3D12_INPUT_CLASSIFICATION_PER_VERTEX_DATA, 0},
 		{"TEXCOORD", 0, DXGI_FORMAT_R32G32_FLOAT, 0, 24, D3D12_INPUT_CLASSIFICATION_PER_VERTEX_DATA, 0}
 	};
+
+	// PackedVertex: UNORM16 position, octahedral SNORM16 normal, half UVs
+	D3D12_INPUT_ELEMENT_DESC compressedInputElementDescs[] =
+	{
+		{"POSITION", 0, DXGI_FORMAT_R16G16B16A16_UNORM, 0, 0, D3D12_INPUT_CLASSIFICATION_PER_VERTEX_DATA, 0},
+		{"NORMAL", 0, DXGI_FORMAT_R16G16_SNORM, 0, 8, D3D12_INPUT_CLASSIFICATION_PER_VERTEX_DATA, 0},
+		{"TEXCOORD", 0, DXGI_FORMAT_R16G16_FLOAT, 0, 12, D3D12_INPUT_CLASSIFICATION_PER_VERTEX_DATA, 0}
+	};
 	
 	D3D12_GRAPHICS_PIPELINE_STATE_DESC psoDesc = {};
 	psoDesc.pRootSignature = pRootSignature.Get();
@@ -463,7 +522,9 @@ void Graphics::CreatePipelineState()
 	psoDesc.DepthStencilState = CD3DX12_DEPTH_STENCIL_DESC1(D3D12_DEFAULT);
 	psoDesc.DSVFormat = DXGI_FORMAT_D32_FLOAT;
 	psoDesc.PrimitiveTopologyType = D3D12_PRIMITIVE_TOPOLOGY_TYPE_TRIANGLE;
-	psoDesc.InputLayout = { inputElementDescs, _countof(inputElementDescs) };
+	psoDesc.InputLayout = pCompressedVertices ?
+		D3D12_INPUT_LAYOUT_DESC{ compressedInputElementDescs, _countof(compressedInputElementDescs) } :
+		D3D12_INPUT_LAYOUT_DESC{ inputElementDescs, _countof(inputElementDescs) };
 	psoDesc.SampleMask = UINT_MAX;
 	psoDesc.NumRenderTargets = 1;
 	psoDesc.RTVFormats[0] = DXGI_FORMAT_R8G8B8A8_UNORM;
@@ -484,36 +545,6 @@ void Graphics::CloseCommandList()
 
 void Graphics::CreateVertexBuffer()
 {
-	struct Vertex
-	{
-		Vertex() {}
-		Vertex(
-			const DirectX::XMFLOAT3& p,
-			const DirectX::XMFLOAT3& n,
-			const DirectX::XMFLOAT2& uv) :
-			Position(p),
-			Normal(n),
-			TexC(uv) {}
-		Vertex(
-			float px, float py, float pz,
-			float nx, float ny, float nz,
-			float u, float v) :
-			Position(px, py, pz),
-			Normal(nx, ny, nz),
-			TexC(u, v) {}
-		Vertex(
-			float px, float py, float pz,
-			float nx, float ny, float nz)
-			:
-			Position(px, py, pz),
-			Normal(nx, ny, nz)
-			{}
-
-		DirectX::XMFLOAT3 Position;
-		DirectX::XMFLOAT3 Normal;
-		DirectX::XMFLOAT2 TexC;
-
-	};
 	/*
 	std::array<Vertex, 24> vertices;
 	float w2 = 1.0f;
@@ -583,45 +614,53 @@ void Graphics::CreateVertexBuffer()
 	indices[33] = 20; indices[34] = 22; indices[35] = 23;
 	*/
 
-	std::ifstream fin("Models/skull.txt");
-
-	if (!fin)
+	// Vertex and index data come straight out of the mapped binary cache
+	MeshCacheFile model;
+	if (!LoadCachedModel("Models/skull.txt", model))
 	{
 		MessageBox(0, L"Models/skull.txt not found.", 0, 0);
 		return;
 	}
 
-	UINT vcount = 0;
-	UINT tcount = 0;
-	std::string ignore;
-
-	fin >> ignore >> vcount;
-	fin >> ignore >> tcount;
-	fin >> ignore >> ignore >> ignore >> ignore;
-
-	std::vector<Vertex> vertices(vcount);
-
-	for (UINT i = 0; i < vcount; i++)
+	const MeshCacheStats& stats = model.Header().Stats;
+	char statsText[256];
+	snprintf(statsText, sizeof(statsText), "Models/skull.txt: vertices %u -> %u, ACMR %.3f -> %.3f, ATVR %.3f -> %.3f, overdraw %.3f -> %.3f, %u meshlets\n",
+		stats.VerticesBefore, stats.VerticesAfter, stats.AcmrBefore, stats.AcmrAfter, stats.AtvrBefore, stats.AtvrAfter,
+		stats.OverdrawBefore, stats.OverdrawAfter, model.MeshletCount());
+	OutputDebugStringA(statsText);
+	for (uint32_t i = 0; i < model.LodCount(); i++)
 	{
-		fin >> vertices[i].Position.x >> vertices[i].Position.y >> vertices[i].Position.z;
-		fin >> vertices[i].Normal.x >> vertices[i].Normal.y >> vertices[i].Normal.z;
+		const MeshLod& lod = model.Lods()[i];
+		snprintf(statsText, sizeof(statsText), "  LOD %u: %u triangles, error %.4f\n", i, lod.IndexCount / 3, lod.Error);
+		OutputDebugStringA(statsText);
 	}
 
-	fin >> ignore;
-	fin >> ignore;
-	fin >> ignore;
+	// The index buffer holds every level; without meshlets the full detail level is drawn
+	indicesSize = model.Lods()[0].IndexCount;
 
-	std::vector<int32_t> indices(3 * tcount);
-	for (UINT i = 0; i < tcount; i++)
-	{ 
-		fin >> indices[i * 3 + 0] >> indices[i * 3 + 1] >> indices[i * 3 + 2];
+	const void* vertexData = model.Vertices();
+	UINT vertexStride = sizeof(MeshVertex);
+	if (pCompressedVertices)
+	{
+		const VertexQuantization& quantization = model.Header().Quantization;
+		pPositionScale = { quantization.Scale.x, quantization.Scale.y, quantization.Scale.z, 0.0f };
+		pPositionOffset = { quantization.Offset.x, quantization.Offset.y, quantization.Offset.z, 0.0f };
+		vertexData = model.PackedVertices();
+		vertexStride = sizeof(PackedVertex);
 	}
 
-	fin.close();
-
-	indicesSize = indices.size();
+	// Narrow indices whenever the mesh has few enough vertices
+	const void* indexData = model.Indices();
+	UINT indexStride = sizeof(uint32_t);
+	DXGI_FORMAT indexFormat = DXGI_FORMAT_R32_UINT;
+	if (model.Indices16())
+	{
+		indexData = model.Indices16();
+		indexStride = sizeof(uint16_t);
+		indexFormat = DXGI_FORMAT_R16_UINT;
+	}
 
-	const UINT vertexBufferByteSize = vertices.size() * sizeof(Vertex);
+	const UINT vertexBufferByteSize = model.VertexCount() * vertexStride;
 
 	ThrowIfFailed(pDevice->CreateCommittedResource(
 		&CD3DX12_HEAP_PROPERTIES(D3D12_HEAP_TYPE_UPLOAD),
@@ -632,14 +671,14 @@ void Graphics::CreateVertexBuffer()
 	UINT8* pVertexDataBegin;
 	CD3DX12_RANGE readRange(0, 0);
 	ThrowIfFailed(pVertexBuffer->Map(0, &readRange, reinterpret_cast<void**>(&pVertexDataBegin)));
-	memcpy(pVertexDataBegin, vertices.data(), vertexBufferByteSize);
+	memcpy(pVertexDataBegin, vertexData, vertexBufferByteSize);
 	pVertexBuffer->Unmap(0, nullptr);
 
 	pVertexBufferView.BufferLocation = pVertexBuffer->GetGPUVirtualAddress();
 	pVertexBufferView.SizeInBytes = vertexBufferByteSize;
-	pVertexBufferView.StrideInBytes = sizeof(Vertex);
+	pVertexBufferView.StrideInBytes = vertexStride;
 
-	const UINT indexBufferByteSize = (UINT)indices.size() * sizeof(int32_t);
+	const UINT indexBufferByteSize = model.IndexCount() * indexStride;
 
 	ThrowIfFailed(pDevice->CreateCommittedResource(
 		&CD3DX12_HEAP_PROPERTIES(D3D12_HEAP_TYPE_UPLOAD),
@@ -650,12 +689,48 @@ void Graphics::CreateVertexBuffer()
 	UINT8* pIndexDataBegin;
 	CD3DX12_RANGE readRange1(0, 0);
 	ThrowIfFailed(pIndexBuffer->Map(0, &readRange1, reinterpret_cast<void**>(&pIndexDataBegin)));
-	memcpy(pIndexDataBegin, indices.data(), indexBufferByteSize);
+	memcpy(pIndexDataBegin, indexData, indexBufferByteSize);
 	pIndexBuffer->Unmap(0, nullptr);
 
 	pIndexBufferView.BufferLocation = pIndexBuffer->GetGPUVirtualAddress();
 	pIndexBufferView.SizeInBytes = indexBufferByteSize;
-	pIndexBufferView.Format = DXGI_FORMAT_R32_UINT;
+	pIndexBufferView.Format = indexFormat;
+
+	pMeshlets.assign(model.Meshlets(), model.Meshlets() + model.MeshletCount());
+	pVisibleMeshlets.resize(pMeshlets.size());
+
+	// Bounding sphere and extent for level of detail selection
+	const MeshVertex* vertices = model.Vertices();
+	MeshFloat3 minP = vertices[0].Position;
+	MeshFloat3 maxP = minP;
+	for (uint32_t i = 1; i < model.VertexCount(); i++)
+	{
+		const MeshFloat3& p = vertices[i].Position;
+		minP = { std::min(minP.x, p.x), std::min(minP.y, p.y), std::min(minP.z, p.z) };
+		maxP = { std::max(maxP.x, p.x), std::max(maxP.y, p.y), std::max(maxP.z, p.z) };
+	}
+	pMeshCenter = { (minP.x + maxP.x) * 0.5f, (minP.y + maxP.y) * 0.5f, (minP.z + maxP.z) * 0.5f };
+	pMeshRadius = 0.5f * sqrtf((maxP.x - minP.x) * (maxP.x - minP.x) + (maxP.y - minP.y) * (maxP.y - minP.y) + (maxP.z - minP.z) * (maxP.z - minP.z));
+	const float extent = std::max({ maxP.x - minP.x, maxP.y - minP.y, maxP.z - minP.z });
+
+	pLods.assign(model.Lods(), model.Lods() + model.LodCount());
+	pLodTables.resize(1);
+	MakeLodErrorTable(pLods.data(), static_cast<uint32_t>(pLods.size()), extent, pLodTables[0]);
+	pLodObjects.Resize(1);
+	pLodObjects.Radius[0] = pMeshRadius;
+	pLodObjects.Mesh[0] = 0;
+
+	// Picking tests the full detail triangles
+	pMeshBvhs.resize(1);
+	BuildMeshBvh(pMeshBvhs[0], model.Indices(), pLods[0].IndexCount, vertices, model.VertexCount());
+
+	const DirectX::XMMATRIX skullWorld = DirectX::XMMatrixTranslation(0.0f, -3.0f, 0.0f);
+	BvhInstance skull;
+	DirectX::XMStoreFloat4x4(reinterpret_cast<DirectX::XMFLOAT4X4*>(skull.World), skullWorld);
+	DirectX::XMStoreFloat4x4(reinterpret_cast<DirectX::XMFLOAT4X4*>(skull.InverseWorld), DirectX::XMMatrixInverse(nullptr, skullWorld));
+	skull.Mesh = 0;
+	pInstances.assign(1, skull);
+	BuildSceneBvh(pSceneBvh, pInstances.data(), pInstances.size(), pMeshBvhs.data());
 }
 
 void Graphics::BuildMaterials()
@@ -857,6 +932,10 @@ void Graphics::PopulateCommandList()
 
 	// Reset command list
 	ThrowIfFailed(pCommandList->Reset(pCommandAllocator.Get(), pPipelineState.Get()));
+
+	// Fit the streamed textures to the memory budget and copy in their next mips before
+	// anything samples them
+	ThrowIfFailed(pTextureStreamer.Update(pCommandList.Get(), StreamBytesPerFrame));
 	
 	ID3D12DescriptorHeap* descriptorHeaps[] = { pSRVDescriptorHeap.Get() };
 	pCommandList->SetDescriptorHeaps(_countof(descriptorHeaps), descriptorHeaps);
@@ -912,7 +991,29 @@ void Graphics::PopulateCommandList()
 	pCommandList->IASetPrimitiveTopology(D3D_PRIMITIVE_TOPOLOGY_TRIANGLELIST);
 	pCommandList->IASetVertexBuffers(0, 1, &pVertexBufferView);
 	pCommandList->IASetIndexBuffer(&pIndexBufferView);
-	pCommandList->DrawIndexedInstanced(indicesSize, 1, 0, 0, 0);
+	const uint8_t lod = pLodObjects.Size() ? pLodObjects.Lod[0] : 0;
+	if (lod > 0)
+	{
+		pCommandList->DrawIndexedInstanced(pLods[lod].IndexCount, 1, pLods[lod].IndexOffset, 0, 0);
+	}
+	else if (pMeshlets.empty())
+	{
+		pCommandList->DrawIndexedInstanced(indicesSize, 1, 0, 0, 0);
+	}
+	else
+	{
+		// Visible meshlets come out in index buffer order; merge neighbours into one draw
+		for (uint32_t i = 0; i < pVisibleMeshletCount;)
+		{
+			const Meshlet& first = pMeshlets[pVisibleMeshlets[i]];
+			UINT indexCount = first.TriangleCount * 3;
+			for (i++; i < pVisibleMeshletCount && pMeshlets[pVisibleMeshlets[i]].IndexOffset == first.IndexOffset + indexCount; i++)
+			{
+				indexCount += pMeshlets[pVisibleMeshlets[i]].TriangleCount * 3;
+			}
+			pCommandList->DrawIndexedInstanced(indexCount, 1, first.IndexOffset, 0, 0);
+		}
+	}
 
 	// Indicate back buffer will be used to present after command list has executed
 	pCommandList->ResourceBarrier(1, &CD3DX12_RESOURCE_BARRIER::Transition(pRenderTargets[pFrameIndex].Get(), D3D12_RESOURCE_STATE_RENDER_TARGET, D3D12_RESOURCE_STATE_PRESENT));
@@ -980,6 +1081,43 @@ void Graphics::OnMouseDown(WPARAM buttonState, int x, int y)
 	pLastMousePos.x = x;
 	pLastMousePos.y = y;
 	last = std::chrono::steady_clock::now();
+
+	if ((buttonState & MK_LBUTTON) != 0)
+	{
+		Pick(x, y);
+	}
+}
+
+void Graphics::Pick(int x, int y)
+{
+	// Unproject the pixel centre onto the near and far planes
+	const float ndcX = 2.0f * (static_cast<float>(x) + 0.5f) / 1280.0f - 1.0f;
+	const float ndcY = 1.0f - 2.0f * (static_cast<float>(y) + 0.5f) / 960.0f;
+	const DirectX::XMMATRIX inverseViewProj = DirectX::XMMatrixInverse(nullptr, DirectX::XMLoadFloat4x4(&pViewProj));
+	const DirectX::XMVECTOR nearPoint = DirectX::XMVector3TransformCoord(DirectX::XMVectorSet(ndcX, ndcY, 0.0f, 1.0f), inverseViewProj);
+	const DirectX::XMVECTOR farPoint = DirectX::XMVector3TransformCoord(DirectX::XMVectorSet(ndcX, ndcY, 1.0f, 1.0f), inverseViewProj);
+	const DirectX::XMVECTOR direction = DirectX::XMVector3Normalize(DirectX::XMVectorSubtract(farPoint, nearPoint));
+
+	BvhRay ray;
+	DirectX::XMStoreFloat3(reinterpret_cast<DirectX::XMFLOAT3*>(&ray.Origin), nearPoint);
+	DirectX::XMStoreFloat3(reinterpret_cast<DirectX::XMFLOAT3*>(&ray.Direction), direction);
+
+	const auto start = std::chrono::steady_clock::now();
+	SceneHit hit;
+	const bool found = IntersectSceneBvh(pSceneBvh, pInstances.data(), pMeshBvhs.data(), ray, FLT_MAX, hit);
+	const std::chrono::duration<float, std::micro> elapsed = std::chrono::steady_clock::now() - start;
+
+	char text[256];
+	if (found)
+	{
+		snprintf(text, sizeof(text), "Pick (%d, %d): object %u, triangle %u, barycentrics (%.3f, %.3f, %.3f), distance %.3f, %.1f us\n",
+			x, y, hit.Instance, hit.Hit.Triangle, 1.0f - hit.Hit.U - hit.Hit.V, hit.Hit.U, hit.Hit.V, hit.Hit.Distance, elapsed.count());
+	}
+	else
+	{
+		snprintf(text, sizeof(text), "Pick (%d, %d): nothing, %.1f us\n", x, y, elapsed.count());
+	}
+	OutputDebugStringA(text);
 }
 
 void Graphics::OnMouseUp()
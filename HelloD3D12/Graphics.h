@@ -1,5 +1,12 @@
 #pragma once
 #include "stdafx.h"
+#include "Bvh.h"
+#include "LodSelect.h"
+#include "Meshlet.h"
+#include "TextureHeap12.h"
+#include "TextureStreamer12.h"
+#include "UploadRing12.h"
+#include "VideoMemoryBudget12.h"
 #include <chrono>
 #include <unordered_map>
 
@@ -9,6 +16,9 @@ struct ConstantBuffer
 {
 	DirectX::XMFLOAT4X4 transform;
 	DirectX::XMFLOAT4X4 texTransform;
+	// Dequantizes compressed vertex positions (identity for full precision vertices)
+	DirectX::XMFLOAT4 positionScale;
+	DirectX::XMFLOAT4 positionOffset;
 };
 
 #define MaxLights 16
@@ -146,6 +156,9 @@ public:
 
 	void OnMouseUp();
 
+	// Reports the object, triangle and barycentrics under a client area point
+	void Pick(int x, int y);
+
 	void BuildMaterials();
 
 	std::array<const CD3DX12_STATIC_SAMPLER_DESC, 6> GetStaticSamplers();
@@ -167,6 +180,14 @@ public:
 	
 private:
 	static const int SwapChainBufferCount = 2;
+	static const UINT64 UploadRingSize = 64 * 1024 * 1024;
+	// Streamed textures load mips up to this size at startup, and stream at most this
+	// many bytes of finer mips per frame
+	static const UINT StreamResidentSize = 64;
+	static const UINT64 StreamBytesPerFrame = 4 * 1024 * 1024;
+	// Streamed textures may take half the video memory the OS grants, assumed to be this
+	// much when the adapter cannot say
+	static const UINT64 FallbackVideoMemoryBudget = 512 * 1024 * 1024;
 	UINT pRTVDescriptorSize;
 	UINT indicesSize;
 
@@ -196,15 +217,46 @@ private:
 	Microsoft::WRL::ComPtr<ID3D12Resource> pConstantBuffer;
 	Microsoft::WRL::ComPtr<ID3D12Resource> pMaterialConstantBuffer;
 	Microsoft::WRL::ComPtr<ID3D12Resource> pLightsConstantBuffer;
-	Microsoft::WRL::ComPtr<ID3D12Resource> woodTexResource;
 	Microsoft::WRL::ComPtr<ID3D12Fence> pFence;
 
+	// Staging memory shared by texture uploads, recycled as the queue passes each batch
+	UploadRing12 pUploadRing;
+	// Default heap blocks the textures are placed in
+	TextureHeap12 pTextureHeap;
+	TextureStreamer12 pTextureStreamer;
+	VideoMemoryBudget12 pVideoMemoryBudget;
+	uint32_t pWoodTexture = 0;
+
 	D3D12_VIEWPORT pVP;
 
 	D3D12_RECT pScissorRect;
 
 	D3D12_VERTEX_BUFFER_VIEW pVertexBufferView;
 	D3D12_INDEX_BUFFER_VIEW pIndexBufferView;
+
+	// Draw from the 16-byte PackedVertex buffer instead of the 32-byte MeshVertex one
+	bool pCompressedVertices = true;
+	DirectX::XMFLOAT4 pPositionScale = { 1.0f, 1.0f, 1.0f, 0.0f };
+	DirectX::XMFLOAT4 pPositionOffset = { 0.0f, 0.0f, 0.0f, 0.0f };
+
+	// Meshlets are index buffer ranges; only the ones surviving CPU culling are drawn
+	std::vector<Meshlet> pMeshlets;
+	std::vector<uint32_t> pVisibleMeshlets;
+	uint32_t pVisibleMeshletCount = 0;
+
+	// Levels of detail share the index buffer; meshlets only cover level 0
+	std::vector<MeshLod> pLods;
+	std::vector<LodErrorTable> pLodTables;
+	LodObjects pLodObjects;
+	LodSelectSettings pLodSettings;
+	MeshFloat3 pMeshCenter = { 0.0f, 0.0f, 0.0f };
+	float pMeshRadius = 0.0f;
+
+	// Mouse picking: a BVH per mesh and one over the placed instances
+	std::vector<MeshBvh> pMeshBvhs;
+	std::vector<BvhInstance> pInstances;
+	SceneBvh pSceneBvh;
+	DirectX::XMFLOAT4X4 pViewProj;
 	UINT64 pFenceValue;
 	HANDLE pFenceEvent;
 	UINT pFrameIndex;
@@ -0,0 +1,6 @@
+#pragma once
+#include <cstddef>
+#include <cstdint>
+
+// 64-bit xxHash (XXH64) of a byte range. Used to fingerprint source assets.
+uint64_t HashBytes64(const void* data, size_t size, uint64_t seed = 0);
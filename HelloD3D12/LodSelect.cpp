@@ -0,0 +1,136 @@
+#include "LodSelect.h"
+#include <algorithm>
+#include <cmath>
+#include <limits>
+
+#if (defined(_M_X64) || defined(__x86_64__)) && !defined(HELLOD3D12_NO_SIMD)
+#include <emmintrin.h>
+#define LOD_SELECT_SSE2 1
+#endif
+
+namespace
+{
+	// Objects per pass: the allowed errors of a block are computed first, then the levels
+	const size_t BlockSize = 256;
+
+	inline uint32_t CountFitting(const LodErrorTable& table, float allowed)
+	{
+#if LOD_SELECT_SSE2
+		static const uint8_t BitCount[16] = { 0, 1, 1, 2, 1, 2, 2, 3, 1, 2, 2, 3, 2, 3, 3, 4 };
+		const __m128 a = _mm_set1_ps(allowed);
+		const int lo = _mm_movemask_ps(_mm_cmple_ps(_mm_load_ps(table.Error), a));
+		const int hi = _mm_movemask_ps(_mm_cmple_ps(_mm_load_ps(table.Error + 4), a));
+		return BitCount[lo] + BitCount[hi];
+#else
+		// Entries past Count hold +infinity and never fit
+		uint32_t count = 0;
+		for (uint32_t i = 0; i < table.Count; i++)
+		{
+			count += (table.Error[i] <= allowed) ? 1 : 0;
+		}
+		return count;
+#endif
+	}
+
+	// Largest model space error each object may show: the pixel budget turned into world
+	// units at the nearest point of the sphere, then into the object's model space
+	void ComputeAllowedErrors(float* allowed, const LodObjects& objects, size_t first, size_t count, const LodSelectSettings& settings)
+	{
+		const float budget = settings.MaxPixelError * exp2f(settings.Bias) / settings.ProjectionScale;
+		const float* cx = objects.CenterX.data() + first;
+		const float* cy = objects.CenterY.data() + first;
+		const float* cz = objects.CenterZ.data() + first;
+		const float* radius = objects.Radius.data() + first;
+		const float* scale = objects.Scale.data() + first;
+
+		size_t i = 0;
+#if LOD_SELECT_SSE2
+		const __m128 ex = _mm_set1_ps(settings.Eye.x);
+		const __m128 ey = _mm_set1_ps(settings.Eye.y);
+		const __m128 ez = _mm_set1_ps(settings.Eye.z);
+		const __m128 b = _mm_set1_ps(budget);
+		const __m128 zero = _mm_setzero_ps();
+		for (; i + 4 <= count; i += 4)
+		{
+			const __m128 dx = _mm_sub_ps(_mm_loadu_ps(cx + i), ex);
+			const __m128 dy = _mm_sub_ps(_mm_loadu_ps(cy + i), ey);
+			const __m128 dz = _mm_sub_ps(_mm_loadu_ps(cz + i), ez);
+			const __m128 distance = _mm_sqrt_ps(_mm_add_ps(_mm_add_ps(_mm_mul_ps(dx, dx), _mm_mul_ps(dy, dy)), _mm_mul_ps(dz, dz)));
+			const __m128 nearest = _mm_max_ps(_mm_sub_ps(distance, _mm_loadu_ps(radius + i)), zero);
+			_mm_storeu_ps(allowed + i, _mm_div_ps(_mm_mul_ps(nearest, b), _mm_loadu_ps(scale + i)));
+		}
+#endif
+		for (; i < count; i++)
+		{
+			const float dx = cx[i] - settings.Eye.x;
+			const float dy = cy[i] - settings.Eye.y;
+			const float dz = cz[i] - settings.Eye.z;
+			const float nearest = std::max(sqrtf(dx * dx + dy * dy + dz * dz) - radius[i], 0.0f);
+			allowed[i] = nearest * budget / scale[i];
+		}
+	}
+}
+
+void MakeLodErrorTable(const MeshLod* lods, uint32_t lodCount, float meshExtent, LodErrorTable& table)
+{
+	table.Count = std::min(lodCount, MaxLodLevels);
+	float error = 0.0f;
+	for (uint32_t i = 0; i < MaxLodLevels; i++)
+	{
+		if (i < table.Count)
+		{
+			error = std::max(error, lods[i].Error * meshExtent);
+			table.Error[i] = (i == 0) ? 0.0f : error;
+		}
+		else
+		{
+			table.Error[i] = std::numeric_limits<float>::infinity();
+		}
+	}
+}
+
+void LodObjects::Resize(size_t count)
+{
+	CenterX.resize(count);
+	CenterY.resize(count);
+	CenterZ.resize(count);
+	Radius.resize(count);
+	Scale.resize(count, 1.0f);
+	Mesh.resize(count);
+	Lod.resize(count);
+}
+
+float LodProjectionScale(float fovY, float viewportHeight)
+{
+	return viewportHeight / (2.0f * tanf(fovY * 0.5f));
+}
+
+void SelectLods(LodObjects& objects, const LodErrorTable* tables, const LodSelectSettings& settings)
+{
+	const float coarserFactor = 1.0f - std::min(std::max(settings.Hysteresis, 0.0f), 1.0f);
+	float allowed[BlockSize];
+
+	for (size_t first = 0; first < objects.Size(); first += BlockSize)
+	{
+		const size_t count = std::min(BlockSize, objects.Size() - first);
+		ComputeAllowedErrors(allowed, objects, first, count, settings);
+
+		const uint32_t* mesh = objects.Mesh.data() + first;
+		uint8_t* lod = objects.Lod.data() + first;
+		for (size_t i = 0; i < count; i++)
+		{
+			const LodErrorTable& table = tables[mesh[i]];
+			if (table.Count == 0)
+			{
+				lod[i] = 0;
+				continue;
+			}
+
+			// Levels with a fitting error form a prefix since errors never decrease
+			const uint32_t fitting = std::max(CountFitting(table, allowed[i]), 1u) - 1;
+			const uint32_t fittingWithMargin = std::max(CountFitting(table, allowed[i] * coarserFactor), 1u) - 1;
+			const uint32_t current = std::min<uint32_t>(lod[i], table.Count - 1);
+			lod[i] = static_cast<uint8_t>((current > fitting) ? fitting : std::max(current, fittingWithMargin));
+		}
+	}
+}
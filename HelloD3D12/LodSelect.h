@@ -0,0 +1,60 @@
+#pragma once
+#include "Mesh.h"
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+
+const uint32_t MaxLodLevels = 8;
+
+// Model space errors of one mesh's levels, full detail first. Unused entries hold
+// +infinity so a level count can be taken with one vector compare.
+struct alignas(16) LodErrorTable
+{
+	float Error[MaxLodLevels];
+	uint32_t Count;
+};
+
+// Converts MeshLod::Error (relative to the mesh extent) to model space errors. Errors
+// are made non-decreasing so a coarser level never claims to be more accurate.
+void MakeLodErrorTable(const MeshLod* lods, uint32_t lodCount, float meshExtent, LodErrorTable& table);
+
+// Objects to pick levels for, stored as one array per field so they can be processed
+// four at a time
+struct LodObjects
+{
+	// World space bounding sphere
+	std::vector<float> CenterX;
+	std::vector<float> CenterY;
+	std::vector<float> CenterZ;
+	std::vector<float> Radius;
+	// World units per model unit
+	std::vector<float> Scale;
+	// Index of the object's LodErrorTable
+	std::vector<uint32_t> Mesh;
+	// Selected level; kept between frames for hysteresis
+	std::vector<uint8_t> Lod;
+
+	void Resize(size_t count);
+	inline size_t Size() const { return Lod.size(); }
+};
+
+struct LodSelectSettings
+{
+	MeshFloat3 Eye = { 0.0f, 0.0f, 0.0f };
+	// Pixels covered by one world unit at distance one (see LodProjectionScale)
+	float ProjectionScale = 1.0f;
+	// Largest simplification error allowed on screen
+	float MaxPixelError = 1.0f;
+	// Each step doubles the allowed error, which is about one level coarser
+	float Bias = 0.0f;
+	// A coarser level is only picked once its error fits this fraction below the
+	// threshold; a finer one as soon as the current level no longer fits
+	float Hysteresis = 0.25f;
+};
+
+float LodProjectionScale(float fovY, float viewportHeight);
+
+// Picks, for every object, the coarsest level whose error projected at the nearest
+// point of its bounding sphere stays below the pixel threshold. Objects with the eye
+// inside their sphere get full detail.
+void SelectLods(LodObjects& objects, const LodErrorTable* tables, const LodSelectSettings& settings);
@@ -0,0 +1,178 @@
+#include "MappedFile.h"
+#include <cstdint>
+#include <fstream>
+#include <system_error>
+#include <utility>
+
+#ifdef _WIN32
+#ifndef WIN32_LEAN_AND_MEAN
+#define WIN32_LEAN_AND_MEAN
+#endif
+#include <Windows.h>
+#else
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#endif
+
+MappedFile::~MappedFile()
+{
+	Close();
+}
+
+MappedFile::MappedFile(MappedFile&& other) noexcept
+{
+	*this = std::move(other);
+}
+
+MappedFile& MappedFile::operator=(MappedFile&& other) noexcept
+{
+	if (this != &other)
+	{
+		Close();
+		std::swap(m_Data, other.m_Data);
+		std::swap(m_Size, other.m_Size);
+#ifdef _WIN32
+		std::swap(m_File, other.m_File);
+		std::swap(m_Mapping, other.m_Mapping);
+#endif
+	}
+	return *this;
+}
+
+#ifdef _WIN32
+
+bool MappedFile::Open(const std::filesystem::path& path)
+{
+	Close();
+
+	HANDLE file = CreateFileW(path.c_str(), GENERIC_READ, FILE_SHARE_READ, nullptr,
+		OPEN_EXISTING, FILE_ATTRIBUTE_NORMAL | FILE_FLAG_SEQUENTIAL_SCAN, nullptr);
+	if (file == INVALID_HANDLE_VALUE)
+	{
+		return false;
+	}
+
+	LARGE_INTEGER fileSize = {};
+	if (!GetFileSizeEx(file, &fileSize) || fileSize.QuadPart == 0 ||
+		static_cast<uint64_t>(fileSize.QuadPart) > SIZE_MAX)
+	{
+		CloseHandle(file);
+		return false;
+	}
+
+	HANDLE mapping = CreateFileMappingW(file, nullptr, PAGE_READONLY, 0, 0, nullptr);
+	if (mapping == nullptr)
+	{
+		CloseHandle(file);
+		return false;
+	}
+
+	void* view = MapViewOfFile(mapping, FILE_MAP_READ, 0, 0, 0);
+	if (view == nullptr)
+	{
+		CloseHandle(mapping);
+		CloseHandle(file);
+		return false;
+	}
+
+	m_File = file;
+	m_Mapping = mapping;
+	m_Data = static_cast<const uint8_t*>(view);
+	m_Size = static_cast<uint64_t>(fileSize.QuadPart);
+	return true;
+}
+
+void MappedFile::Close()
+{
+	if (m_Data)
+	{
+		UnmapViewOfFile(m_Data);
+	}
+	if (m_Mapping)
+	{
+		CloseHandle(m_Mapping);
+	}
+	if (m_File)
+	{
+		CloseHandle(m_File);
+	}
+	m_Data = nullptr;
+	m_Size = 0;
+	m_Mapping = nullptr;
+	m_File = nullptr;
+}
+
+#else
+
+bool MappedFile::Open(const std::filesystem::path& path)
+{
+	Close();
+
+	int fd = open(path.c_str(), O_RDONLY);
+	if (fd < 0)
+	{
+		return false;
+	}
+
+	struct stat st;
+	if (fstat(fd, &st) != 0 || st.st_size == 0 ||
+		static_cast<uint64_t>(st.st_size) > SIZE_MAX)
+	{
+		close(fd);
+		return false;
+	}
+
+	void* view = mmap(nullptr, static_cast<size_t>(st.st_size), PROT_READ, MAP_PRIVATE, fd, 0);
+	// The mapping keeps its own reference to the file
+	close(fd);
+	if (view == MAP_FAILED)
+	{
+		return false;
+	}
+
+	m_Data = static_cast<const uint8_t*>(view);
+	m_Size = static_cast<uint64_t>(st.st_size);
+	return true;
+}
+
+void MappedFile::Close()
+{
+	if (m_Data)
+	{
+		munmap(const_cast<uint8_t*>(m_Data), static_cast<size_t>(m_Size));
+	}
+	m_Data = nullptr;
+	m_Size = 0;
+}
+
+#endif
+
+bool WriteFileAtomic(const std::filesystem::path& path, const std::vector<uint8_t>& image)
+{
+	std::filesystem::path tempPath = path;
+	tempPath += ".tmp";
+
+	{
+		std::ofstream fout(tempPath, std::ios::binary | std::ios::trunc);
+		if (!fout)
+		{
+			return false;
+		}
+		fout.write(reinterpret_cast<const char*>(image.data()), image.size());
+		if (!fout)
+		{
+			return false;
+		}
+	}
+
+	std::error_code ec;
+	std::filesystem::rename(tempPath, path, ec);
+	if (ec)
+	{
+		std::filesystem::remove(tempPath, ec);
+		return false;
+	}
+	return true;
+}
@@ -0,0 +1,40 @@
+#pragma once
+#include <cstdint>
+#include <filesystem>
+#include <vector>
+
+// Read-only view of a whole file mapped into the address space.
+// Uses CreateFileMapping/MapViewOfFile on Windows and mmap everywhere else; files
+// larger than the address space fail to open.
+class MappedFile
+{
+public:
+	MappedFile() = default;
+	~MappedFile();
+
+	MappedFile(const MappedFile&) = delete;
+	MappedFile& operator=(const MappedFile&) = delete;
+
+	MappedFile(MappedFile&& other) noexcept;
+	MappedFile& operator=(MappedFile&& other) noexcept;
+
+	bool Open(const std::filesystem::path& path);
+	void Close();
+
+	inline bool IsOpen() const { return m_Data != nullptr; }
+	inline const uint8_t* Data() const { return m_Data; }
+	inline uint64_t Size() const { return m_Size; }
+
+private:
+	const uint8_t* m_Data = nullptr;
+	uint64_t m_Size = 0;
+
+#ifdef _WIN32
+	void* m_File = nullptr;
+	void* m_Mapping = nullptr;
+#endif
+};
+
+// Writes image to a temporary file next to path and renames it over path, so readers
+// never see a partly written file
+bool WriteFileAtomic(const std::filesystem::path& path, const std::vector<uint8_t>& image);
@@ -0,0 +1,46 @@
+#pragma once
+#include <cstdint>
+#include <vector>
+
+struct MeshFloat2
+{
+	float x;
+	float y;
+};
+
+struct MeshFloat3
+{
+	float x;
+	float y;
+	float z;
+};
+
+// Vertex layout shared by the model parser, the mesh cache and the GPU vertex
+// buffer (POSITION, NORMAL, TEXCOORD - see Graphics::CreatePipelineState).
+struct MeshVertex
+{
+	MeshFloat3 Position;
+	MeshFloat3 Normal;
+	MeshFloat2 TexC;
+};
+
+static_assert(sizeof(MeshVertex) == 32, "MeshVertex must match the input layout");
+
+// A level of detail: a range of MeshData::Indices drawn with the shared vertex buffer
+struct MeshLod
+{
+	uint32_t IndexOffset;
+	uint32_t IndexCount;
+	// Simplification error relative to the mesh extent (0 for full detail)
+	float Error;
+	uint32_t Reserved;
+};
+
+struct MeshData
+{
+	std::vector<MeshVertex> Vertices;
+	// All levels of detail back to back, full detail first
+	std::vector<uint32_t> Indices;
+	// Empty until BuildLodChain runs; a single level then covers all of Indices
+	std::vector<MeshLod> Lods;
+};
@@ -0,0 +1,476 @@
+#include "MeshCache.h"
+#include "Hash.h"
+#include "ModelParser.h"
+#include "Overdraw.h"
+#include "Parallel.h"
+#include "Simplify.h"
+#include "VertexCache.h"
+#include "VertexRemap.h"
+#include <algorithm>
+#include <cstring>
+#include <system_error>
+
+namespace
+{
+	uint32_t SectionStride(uint32_t type)
+	{
+		switch (type)
+		{
+		case MeshCacheSection_Vertices: return sizeof(MeshVertex);
+		case MeshCacheSection_Indices: return sizeof(uint32_t);
+		case MeshCacheSection_PackedVertices: return sizeof(PackedVertex);
+		case MeshCacheSection_Indices16: return sizeof(uint16_t);
+		case MeshCacheSection_Meshlets: return sizeof(Meshlet);
+		case MeshCacheSection_MeshletVertices: return sizeof(uint32_t);
+		case MeshCacheSection_MeshletTriangles: return sizeof(uint8_t);
+		case MeshCacheSection_Lods: return sizeof(MeshLod);
+		default: return 0;
+		}
+	}
+
+	uint64_t AlignUp(uint64_t value, uint64_t alignment)
+	{
+		return (value + alignment - 1) & ~(alignment - 1);
+	}
+
+	bool GetSourceStamp(const std::filesystem::path& path, MeshSourceInfo& info)
+	{
+		std::error_code ec;
+		info.Size = std::filesystem::file_size(path, ec);
+		if (ec)
+		{
+			return false;
+		}
+		info.Time = static_cast<int64_t>(std::filesystem::last_write_time(path, ec).time_since_epoch().count());
+		return !ec;
+	}
+
+	// Rewrites the source stamp of an up to date cache so the next load takes the fast path
+	bool RestampCache(const std::filesystem::path& cachePath, const MeshSourceInfo& source, MeshCacheFile& model)
+	{
+		std::vector<uint8_t> image(model.Data(), model.Data() + model.Size());
+		MeshCacheHeader& header = *reinterpret_cast<MeshCacheHeader*>(image.data());
+		header.SourceSize = source.Size;
+		header.SourceTime = source.Time;
+
+		// The mapping has to go before the file can be replaced
+		model.Close();
+		if (WriteFileAtomic(cachePath, image) && model.Open(cachePath))
+		{
+			return true;
+		}
+		return model.Adopt(std::move(image));
+	}
+}
+
+void ProcessMesh(MeshData& mesh, MeshCacheStats& stats, unsigned threadCount)
+{
+	stats.VerticesBefore = static_cast<uint32_t>(mesh.Vertices.size());
+
+	// Merge duplicate vertices first so the cache passes see the real connectivity
+	std::vector<uint32_t> remap(mesh.Vertices.size());
+	size_t vertexCount = GenerateWeldRemap(remap.data(), mesh.Vertices.data(), mesh.Vertices.size());
+	if (vertexCount < mesh.Vertices.size())
+	{
+		RemapMesh(mesh, remap.data(), vertexCount);
+	}
+
+	VertexCacheStatistics before = AnalyzeVertexCache(mesh.Indices.data(), mesh.Indices.size(), vertexCount);
+
+	std::vector<uint32_t> optimized(mesh.Indices.size());
+	OptimizeVertexCache(optimized.data(), mesh.Indices.data(), mesh.Indices.size(), vertexCount);
+	VertexCacheStatistics after = AnalyzeVertexCache(optimized.data(), optimized.size(), vertexCount);
+
+	// Some exported models already come out of a cache optimiser; never make them worse
+	if (after.ACMR < before.ACMR)
+	{
+		mesh.Indices.swap(optimized);
+	}
+	else
+	{
+		after = before;
+	}
+
+	// Draw outward facing clusters first, giving back a little of the cache gain
+	const OverdrawStatistics overdrawBefore = AnalyzeOverdraw(mesh.Indices.data(), mesh.Indices.size(), mesh.Vertices.data(), vertexCount,
+		DefaultOverdrawResolution, threadCount);
+	OverdrawStatistics overdrawAfter = overdrawBefore;
+
+	OptimizeOverdraw(optimized.data(), mesh.Indices.data(), mesh.Indices.size(), mesh.Vertices.data(), vertexCount,
+		DefaultOverdrawThreshold, threadCount);
+	const VertexCacheStatistics sorted = AnalyzeVertexCache(optimized.data(), optimized.size(), vertexCount);
+	if (sorted.ACMR <= after.ACMR * DefaultOverdrawThreshold)
+	{
+		const OverdrawStatistics overdrawSorted = AnalyzeOverdraw(optimized.data(), optimized.size(), mesh.Vertices.data(), vertexCount,
+			DefaultOverdrawResolution, threadCount);
+		if (overdrawSorted.Overdraw < overdrawBefore.Overdraw)
+		{
+			mesh.Indices.swap(optimized);
+			after = sorted;
+			overdrawAfter = overdrawSorted;
+		}
+	}
+
+	// Lay vertices out in the order the final index buffer fetches them
+	vertexCount = GenerateFetchRemap(remap.data(), mesh.Indices.data(), mesh.Indices.size(), vertexCount);
+	RemapMesh(mesh, remap.data(), vertexCount);
+	stats.VerticesAfter = static_cast<uint32_t>(vertexCount);
+
+	stats.AcmrBefore = before.ACMR;
+	stats.AtvrBefore = before.ATVR;
+	stats.AcmrAfter = after.ACMR;
+	stats.AtvrAfter = after.ATVR;
+	stats.OverdrawBefore = overdrawBefore.Overdraw;
+	stats.OverdrawAfter = overdrawAfter.Overdraw;
+
+	// Coarser levels reuse the vertex buffer laid out for full detail
+	BuildLodChain(mesh, 0.5f, DefaultLodLevels, threadCount);
+}
+
+std::vector<uint8_t> SerializeMeshCache(const MeshData& mesh, const MeshSourceInfo& source, const MeshCacheStats& stats)
+{
+	MeshCacheHeader header = {};
+	header.Magic = MeshCacheMagic;
+	header.Version = MeshCacheVersion;
+	header.SourceSize = source.Size;
+	header.SourceTime = source.Time;
+	header.SourceHash = source.Hash;
+	header.Stats = stats;
+	header.SectionCount = MeshCacheSection_Count;
+
+	CompressedMesh compressed;
+	CompressMesh(mesh, compressed);
+	header.Quantization = compressed.Quantization;
+
+	// A mesh that skipped BuildLodChain is a single level
+	std::vector<MeshLod> lods = mesh.Lods;
+	if (lods.empty())
+	{
+		lods.push_back({ 0, static_cast<uint32_t>(mesh.Indices.size()), 0.0f, 0 });
+	}
+
+	MeshletData meshlets;
+	BuildMeshlets(meshlets, mesh.Indices.data(), lods[0].IndexCount, mesh.Vertices.data(), mesh.Vertices.size());
+
+	const void* blobs[MeshCacheSection_Count] = {};
+	blobs[MeshCacheSection_Vertices] = mesh.Vertices.data();
+	blobs[MeshCacheSection_Indices] = mesh.Indices.data();
+	blobs[MeshCacheSection_PackedVertices] = compressed.Vertices.data();
+	blobs[MeshCacheSection_Indices16] = compressed.Indices.data();
+	blobs[MeshCacheSection_Meshlets] = meshlets.Meshlets.data();
+	blobs[MeshCacheSection_MeshletVertices] = meshlets.Vertices.data();
+	blobs[MeshCacheSection_MeshletTriangles] = meshlets.Triangles.data();
+	blobs[MeshCacheSection_Lods] = lods.data();
+
+	header.Sections[MeshCacheSection_Vertices].Count = mesh.Vertices.size();
+	header.Sections[MeshCacheSection_Indices].Count = mesh.Indices.size();
+	header.Sections[MeshCacheSection_PackedVertices].Count = compressed.Vertices.size();
+	header.Sections[MeshCacheSection_Indices16].Count = compressed.Indices.size();
+	header.Sections[MeshCacheSection_Meshlets].Count = meshlets.Meshlets.size();
+	header.Sections[MeshCacheSection_MeshletVertices].Count = meshlets.Vertices.size();
+	header.Sections[MeshCacheSection_MeshletTriangles].Count = meshlets.Triangles.size();
+	header.Sections[MeshCacheSection_Lods].Count = lods.size();
+
+	uint64_t offset = AlignUp(sizeof(MeshCacheHeader), MeshCacheAlignment);
+	for (uint32_t i = 0; i < MeshCacheSection_Count; i++)
+	{
+		MeshCacheSection& section = header.Sections[i];
+		section.Type = i;
+		section.Stride = SectionStride(i);
+		section.Offset = offset;
+		offset = AlignUp(offset + section.Count * section.Stride, MeshCacheAlignment);
+	}
+
+	std::vector<uint8_t> image(static_cast<size_t>(offset), 0);
+	memcpy(image.data(), &header, sizeof(header));
+	for (uint32_t i = 0; i < MeshCacheSection_Count; i++)
+	{
+		const MeshCacheSection& section = header.Sections[i];
+		if (section.Count)
+		{
+			memcpy(image.data() + section.Offset, blobs[i], static_cast<size_t>(section.Count * section.Stride));
+		}
+	}
+
+	return image;
+}
+
+bool MeshCacheFile::Open(const std::filesystem::path& path)
+{
+	Close();
+
+	if (!m_File.Open(path))
+	{
+		return false;
+	}
+
+	m_Data = m_File.Data();
+	m_Size = m_File.Size();
+	if (!Validate())
+	{
+		Close();
+		return false;
+	}
+	return true;
+}
+
+bool MeshCacheFile::Adopt(std::vector<uint8_t>&& image)
+{
+	Close();
+
+	m_Image = std::move(image);
+	m_Data = m_Image.data();
+	m_Size = m_Image.size();
+	if (!Validate())
+	{
+		Close();
+		return false;
+	}
+	return true;
+}
+
+void MeshCacheFile::Close()
+{
+	m_File.Close();
+	m_Image.clear();
+	m_Image.shrink_to_fit();
+	m_Data = nullptr;
+	m_Size = 0;
+}
+
+const MeshVertex* MeshCacheFile::Vertices() const
+{
+	size_t count;
+	return Section<MeshVertex>(MeshCacheSection_Vertices, count);
+}
+
+uint32_t MeshCacheFile::VertexCount() const
+{
+	return static_cast<uint32_t>(Header().Sections[MeshCacheSection_Vertices].Count);
+}
+
+const uint32_t* MeshCacheFile::Indices() const
+{
+	size_t count;
+	return Section<uint32_t>(MeshCacheSection_Indices, count);
+}
+
+uint32_t MeshCacheFile::IndexCount() const
+{
+	return static_cast<uint32_t>(Header().Sections[MeshCacheSection_Indices].Count);
+}
+
+const PackedVertex* MeshCacheFile::PackedVertices() const
+{
+	size_t count;
+	return Section<PackedVertex>(MeshCacheSection_PackedVertices, count);
+}
+
+const uint16_t* MeshCacheFile::Indices16() const
+{
+	size_t count;
+	const uint16_t* indices = Section<uint16_t>(MeshCacheSection_Indices16, count);
+	return count ? indices : nullptr;
+}
+
+const Meshlet* MeshCacheFile::Meshlets() const
+{
+	size_t count;
+	return Section<Meshlet>(MeshCacheSection_Meshlets, count);
+}
+
+uint32_t MeshCacheFile::MeshletCount() const
+{
+	return static_cast<uint32_t>(Header().Sections[MeshCacheSection_Meshlets].Count);
+}
+
+const MeshLod* MeshCacheFile::Lods() const
+{
+	size_t count;
+	return Section<MeshLod>(MeshCacheSection_Lods, count);
+}
+
+uint32_t MeshCacheFile::LodCount() const
+{
+	return static_cast<uint32_t>(Header().Sections[MeshCacheSection_Lods].Count);
+}
+
+bool MeshCacheFile::Validate() const
+{
+	if (!m_Data || m_Size < sizeof(MeshCacheHeader))
+	{
+		return false;
+	}
+
+	const MeshCacheHeader& header = Header();
+	if (header.Magic != MeshCacheMagic ||
+		header.Version != MeshCacheVersion ||
+		header.SectionCount != MeshCacheSection_Count)
+	{
+		return false;
+	}
+
+	for (uint32_t i = 0; i < MeshCacheSection_Count; i++)
+	{
+		const MeshCacheSection& section = header.Sections[i];
+		if (section.Type != i ||
+			section.Stride != SectionStride(i) ||
+			section.Offset % MeshCacheAlignment != 0 ||
+			section.Offset > m_Size ||
+			section.Count > (m_Size - section.Offset) / section.Stride)
+		{
+			return false;
+		}
+	}
+
+	// The compressed sections mirror the full precision ones
+	const uint32_t indexCount = IndexCount();
+	const uint32_t vertexCount = VertexCount();
+	const uint64_t indices16Count = header.Sections[MeshCacheSection_Indices16].Count;
+	if (header.Sections[MeshCacheSection_PackedVertices].Count != vertexCount ||
+		(indices16Count != 0 && indices16Count != indexCount))
+	{
+		return false;
+	}
+
+	// Index data must stay inside the vertex range so it can go to the GPU unchecked
+	const uint32_t* indices = Indices();
+	for (uint32_t i = 0; i < indexCount; i++)
+	{
+		if (indices[i] >= vertexCount)
+		{
+			return false;
+		}
+	}
+
+	// Level 0 is the full detail mesh at the start of the index buffer
+	const MeshLod* lods = Lods();
+	if (LodCount() == 0 || lods[0].IndexOffset != 0)
+	{
+		return false;
+	}
+	for (uint32_t i = 0; i < LodCount(); i++)
+	{
+		if (lods[i].IndexOffset > indexCount ||
+			lods[i].IndexCount > indexCount - lods[i].IndexOffset ||
+			lods[i].IndexCount % 3 != 0)
+		{
+			return false;
+		}
+	}
+
+	// Meshlets may be drawn as index ranges or through their local lists
+	const Meshlet* meshlets = Meshlets();
+	const uint64_t meshletVertexCount = header.Sections[MeshCacheSection_MeshletVertices].Count;
+	const uint64_t meshletTriangleCount = header.Sections[MeshCacheSection_MeshletTriangles].Count;
+	for (uint32_t i = 0; i < MeshletCount(); i++)
+	{
+		const Meshlet& meshlet = meshlets[i];
+		if (meshlet.IndexOffset > lods[0].IndexCount ||
+			meshlet.TriangleCount > (lods[0].IndexCount - meshlet.IndexOffset) / 3 ||
+			meshlet.VertexCount > MaxMeshletVertices ||
+			meshlet.VertexOffset > meshletVertexCount ||
+			meshlet.VertexCount > meshletVertexCount - meshlet.VertexOffset ||
+			meshlet.TriangleOffset > meshletTriangleCount ||
+			meshlet.TriangleCount > (meshletTriangleCount - meshlet.TriangleOffset) / 3)
+		{
+			return false;
+		}
+	}
+
+	size_t count;
+	const uint32_t* meshletVertices = Section<uint32_t>(MeshCacheSection_MeshletVertices, count);
+	for (size_t i = 0; i < count; i++)
+	{
+		if (meshletVertices[i] >= vertexCount)
+		{
+			return false;
+		}
+	}
+
+	if (const uint16_t* indices16 = Indices16())
+	{
+		for (uint32_t i = 0; i < indexCount; i++)
+		{
+			if (indices16[i] != indices[i])
+			{
+				return false;
+			}
+		}
+	}
+
+	return true;
+}
+
+bool LoadCachedModel(const std::filesystem::path& modelPath, MeshCacheFile& model, unsigned threadCount)
+{
+	std::filesystem::path cachePath = modelPath;
+	cachePath.replace_extension(".mesh");
+
+	MeshSourceInfo source;
+	if (!GetSourceStamp(modelPath, source))
+	{
+		// No source to compare against; a valid cache on its own is good enough
+		return model.Open(cachePath);
+	}
+
+	// Fast path: same size and timestamp as the source the cache was built from
+	if (model.Open(cachePath) &&
+		model.Header().SourceSize == source.Size &&
+		model.Header().SourceTime == source.Time)
+	{
+		return true;
+	}
+
+	MappedFile text;
+	if (!text.Open(modelPath))
+	{
+		model.Close();
+		return false;
+	}
+
+	// The timestamp changed but the content did not (e.g. a fresh checkout)
+	source.Hash = HashBytes64(text.Data(), static_cast<size_t>(text.Size()));
+	if (model.IsOpen() && model.Header().SourceHash == source.Hash)
+	{
+		text.Close();
+		return RestampCache(cachePath, source, model);
+	}
+	model.Close();
+
+	MeshData mesh;
+	if (!ParseModelText(reinterpret_cast<const char*>(text.Data()), static_cast<size_t>(text.Size()), mesh, threadCount))
+	{
+		return false;
+	}
+	text.Close();
+
+	MeshCacheStats stats = {};
+	ProcessMesh(mesh, stats, threadCount);
+
+	std::vector<uint8_t> image = SerializeMeshCache(mesh, source, stats);
+	if (WriteFileAtomic(cachePath, image) && model.Open(cachePath))
+	{
+		return true;
+	}
+
+	// Read-only install location: keep the freshly built image in memory
+	return model.Adopt(std::move(image));
+}
+
+bool LoadCachedModels(const std::vector<std::filesystem::path>& modelPaths, std::vector<MeshCacheFile>& models, unsigned threadCount)
+{
+	models.clear();
+	models.resize(modelPaths.size());
+
+	// Parallel across meshes; each rebuild stays on its own thread so the pools do not nest.
+	// A single model gets the whole pool instead.
+	const unsigned meshThreads = (modelPaths.size() > 1) ? 1 : threadCount;
+	std::vector<char> loaded(modelPaths.size(), 0);
+	ParallelFor(modelPaths.size(), threadCount, [&](size_t i)
+	{
+		loaded[i] = LoadCachedModel(modelPaths[i], models[i], meshThreads) ? 1 : 0;
+	});
+
+	return std::find(loaded.begin(), loaded.end(), 0) == loaded.end();
+}
@@ -0,0 +1,142 @@
+#pragma once
+#include "Mesh.h"
+#include "MappedFile.h"
+#include "Meshlet.h"
+#include "VertexCompression.h"
+#include <filesystem>
+
+// Binary mesh cache (*.mesh) written next to a text model the first time it is
+// loaded. The file is a MeshCacheHeader followed by blobs aligned to
+// MeshCacheAlignment, so once mapped the vertex and index data can be copied
+// straight into an upload buffer.
+//
+// Bump MeshCacheVersion whenever the layout or the mesh processing applied
+// before serialization changes; stale caches are rebuilt automatically.
+const uint32_t MeshCacheMagic = 0x4853454D; // "MESH"
+const uint32_t MeshCacheVersion = 8;
+const uint32_t MeshCacheAlignment = 64;
+
+enum MeshCacheSectionType : uint32_t
+{
+	MeshCacheSection_Vertices = 0,
+	MeshCacheSection_Indices,
+	// Compressed copies of the two sections above (see VertexCompression.h);
+	// Indices16 is empty when the vertex count does not fit 16 bits
+	MeshCacheSection_PackedVertices,
+	MeshCacheSection_Indices16,
+	// Meshlets cut from the full detail index range (see Meshlet.h)
+	MeshCacheSection_Meshlets,
+	MeshCacheSection_MeshletVertices,
+	MeshCacheSection_MeshletTriangles,
+	// Index ranges of the levels of detail, full detail first (see Simplify.h)
+	MeshCacheSection_Lods,
+	MeshCacheSection_Count
+};
+
+struct MeshCacheSection
+{
+	uint32_t Type;
+	uint32_t Stride;
+	uint64_t Offset;
+	uint64_t Count;
+};
+
+// Results of the mesh processing done when the cache was built
+struct MeshCacheStats
+{
+	float AcmrBefore;
+	float AtvrBefore;
+	float AcmrAfter;
+	float AtvrAfter;
+	float OverdrawBefore;
+	float OverdrawAfter;
+	uint32_t VerticesBefore;
+	uint32_t VerticesAfter;
+};
+
+struct MeshCacheHeader
+{
+	uint32_t Magic;
+	uint32_t Version;
+
+	// Identity of the text model the cache was built from
+	uint64_t SourceSize;
+	int64_t SourceTime;
+	uint64_t SourceHash;
+
+	MeshCacheStats Stats;
+	VertexQuantization Quantization;
+
+	uint32_t SectionCount;
+	uint32_t Reserved;
+	MeshCacheSection Sections[MeshCacheSection_Count];
+};
+
+struct MeshSourceInfo
+{
+	uint64_t Size = 0;
+	int64_t Time = 0;
+	uint64_t Hash = 0;
+};
+
+// Optimises a freshly parsed mesh before it is written to the cache:
+// duplicate vertices are welded, triangles are reordered for the
+// post-transform vertex cache, clusters of them are sorted to reduce
+// overdraw, and vertices are laid out in index first-use order. Finally a
+// chain of simplified levels of detail is appended to the index buffer.
+void ProcessMesh(MeshData& mesh, MeshCacheStats& stats, unsigned threadCount = 0);
+
+std::vector<uint8_t> SerializeMeshCache(const MeshData& mesh, const MeshSourceInfo& source, const MeshCacheStats& stats);
+
+class MeshCacheFile
+{
+public:
+	// Maps a cache file from disk
+	bool Open(const std::filesystem::path& path);
+	// Takes ownership of an in-memory cache image (used when the cache cannot be written)
+	bool Adopt(std::vector<uint8_t>&& image);
+	void Close();
+
+	inline bool IsOpen() const { return m_Data != nullptr; }
+	inline const MeshCacheHeader& Header() const { return *reinterpret_cast<const MeshCacheHeader*>(m_Data); }
+	inline const uint8_t* Data() const { return m_Data; }
+	inline uint64_t Size() const { return m_Size; }
+
+	const MeshVertex* Vertices() const;
+	uint32_t VertexCount() const;
+	const uint32_t* Indices() const;
+	uint32_t IndexCount() const;
+	const PackedVertex* PackedVertices() const;
+	// nullptr when the indices need 32 bits
+	const uint16_t* Indices16() const;
+	const Meshlet* Meshlets() const;
+	uint32_t MeshletCount() const;
+	const MeshLod* Lods() const;
+	uint32_t LodCount() const;
+
+	template<typename T>
+	const T* Section(MeshCacheSectionType type, size_t& count) const
+	{
+		const MeshCacheSection& section = Header().Sections[type];
+		count = static_cast<size_t>(section.Count);
+		return reinterpret_cast<const T*>(m_Data + section.Offset);
+	}
+
+private:
+	bool Validate() const;
+
+	MappedFile m_File;
+	std::vector<uint8_t> m_Image;
+	const uint8_t* m_Data = nullptr;
+	uint64_t m_Size = 0;
+};
+
+// Loads a text model through its binary cache (the model path with a .mesh
+// extension). The cache is rebuilt when missing, from an older version, or
+// when the source content hash no longer matches. A rebuild runs on up to
+// threadCount threads (0 picks one per core).
+bool LoadCachedModel(const std::filesystem::path& modelPath, MeshCacheFile& model, unsigned threadCount = 0);
+
+// Loads several models at once, one per thread; models is resized to match
+// modelPaths. Returns false if any of them failed to load.
+bool LoadCachedModels(const std::vector<std::filesystem::path>& modelPaths, std::vector<MeshCacheFile>& models, unsigned threadCount = 0);
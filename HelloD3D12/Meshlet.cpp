@@ -0,0 +1,259 @@
+#include "Meshlet.h"
+#include <algorithm>
+#include <cmath>
+
+namespace
+{
+	const uint32_t NoLocalVertex = ~0u;
+
+	// Cone cutoff that no view direction can reach; used when the normals spread over
+	// more than a hemisphere
+	const float DisabledConeCutoff = 2.0f;
+
+	// Below this minimum normal agreement the cone is too wide to ever cull anything
+	const float MinConeSpread = 0.1f;
+
+	inline MeshFloat3 Subtract(const MeshFloat3& a, const MeshFloat3& b) { return { a.x - b.x, a.y - b.y, a.z - b.z }; }
+	inline MeshFloat3 Cross(const MeshFloat3& a, const MeshFloat3& b) { return { a.y * b.z - a.z * b.y, a.z * b.x - a.x * b.z, a.x * b.y - a.y * b.x }; }
+	inline float Dot(const MeshFloat3& a, const MeshFloat3& b) { return a.x * b.x + a.y * b.y + a.z * b.z; }
+
+	void ComputeMeshletBounds(Meshlet& meshlet, const MeshletData& data, const uint32_t* indices, const MeshVertex* vertices)
+	{
+		// Sphere around the centre of the vertex AABB
+		const uint32_t* local = &data.Vertices[meshlet.VertexOffset];
+		MeshFloat3 minP = vertices[local[0]].Position;
+		MeshFloat3 maxP = minP;
+		for (uint32_t i = 1; i < meshlet.VertexCount; i++)
+		{
+			const MeshFloat3& p = vertices[local[i]].Position;
+			minP = { std::min(minP.x, p.x), std::min(minP.y, p.y), std::min(minP.z, p.z) };
+			maxP = { std::max(maxP.x, p.x), std::max(maxP.y, p.y), std::max(maxP.z, p.z) };
+		}
+		meshlet.Center = { (minP.x + maxP.x) * 0.5f, (minP.y + maxP.y) * 0.5f, (minP.z + maxP.z) * 0.5f };
+
+		float radiusSq = 0.0f;
+		for (uint32_t i = 0; i < meshlet.VertexCount; i++)
+		{
+			const MeshFloat3 d = Subtract(vertices[local[i]].Position, meshlet.Center);
+			radiusSq = std::max(radiusSq, Dot(d, d));
+		}
+		meshlet.Radius = sqrtf(radiusSq);
+
+		// Normal cone around the average front face normal
+		const uint32_t* tris = &indices[meshlet.IndexOffset];
+		std::vector<MeshFloat3> normals;
+		normals.reserve(meshlet.TriangleCount);
+		MeshFloat3 axis = { 0.0f, 0.0f, 0.0f };
+		for (uint32_t t = 0; t < meshlet.TriangleCount; t++)
+		{
+			const MeshFloat3& p0 = vertices[tris[t * 3 + 0]].Position;
+			const MeshFloat3& p1 = vertices[tris[t * 3 + 1]].Position;
+			const MeshFloat3& p2 = vertices[tris[t * 3 + 2]].Position;
+			const MeshFloat3 n = Cross(Subtract(p1, p0), Subtract(p2, p0));
+			const float length = sqrtf(Dot(n, n));
+			if (length == 0.0f)
+			{
+				// Degenerate triangles never rasterise, so they do not constrain the cone
+				normals.push_back({ 0.0f, 0.0f, 0.0f });
+				continue;
+			}
+			normals.push_back({ n.x / length, n.y / length, n.z / length });
+			axis = { axis.x + normals.back().x, axis.y + normals.back().y, axis.z + normals.back().z };
+		}
+
+		meshlet.ConeApex = meshlet.Center;
+		meshlet.ConeAxis = { 0.0f, 0.0f, 0.0f };
+		meshlet.ConeCutoff = DisabledConeCutoff;
+
+		const float axisLength = sqrtf(Dot(axis, axis));
+		if (axisLength == 0.0f)
+		{
+			return;
+		}
+		axis = { axis.x / axisLength, axis.y / axisLength, axis.z / axisLength };
+
+		float minDot = 1.0f;
+		for (const MeshFloat3& n : normals)
+		{
+			if (n.x != 0.0f || n.y != 0.0f || n.z != 0.0f)
+			{
+				minDot = std::min(minDot, Dot(n, axis));
+			}
+		}
+		meshlet.ConeAxis = axis;
+		if (minDot <= MinConeSpread)
+		{
+			return;
+		}
+
+		// Move the apex back along the axis until it is behind every triangle plane, so
+		// seeing the apex from behind means seeing every triangle from behind
+		float maxT = 0.0f;
+		for (uint32_t t = 0; t < meshlet.TriangleCount; t++)
+		{
+			const MeshFloat3& n = normals[t];
+			if (n.x == 0.0f && n.y == 0.0f && n.z == 0.0f)
+			{
+				continue;
+			}
+			const MeshFloat3& p0 = vertices[tris[t * 3 + 0]].Position;
+			maxT = std::max(maxT, Dot(n, Subtract(meshlet.Center, p0)) / Dot(n, axis));
+		}
+		meshlet.ConeApex = { meshlet.Center.x - axis.x * maxT, meshlet.Center.y - axis.y * maxT, meshlet.Center.z - axis.z * maxT };
+		meshlet.ConeCutoff = sqrtf(1.0f - minDot * minDot);
+	}
+}
+
+void BuildMeshlets(MeshletData& meshlets, const uint32_t* indices, size_t indexCount,
+	const MeshVertex* vertices, size_t vertexCount, uint32_t maxVertices, uint32_t maxTriangles)
+{
+	meshlets.Meshlets.clear();
+	meshlets.Vertices.clear();
+	meshlets.Triangles.clear();
+
+	// Local indices are 8-bit
+	maxVertices = std::min(std::max(maxVertices, 3u), 256u);
+	maxTriangles = std::max(maxTriangles, 1u);
+
+	std::vector<uint32_t> localIndex(vertexCount, NoLocalVertex);
+	Meshlet current = {};
+
+	auto flush = [&]()
+	{
+		if (current.TriangleCount == 0)
+		{
+			return;
+		}
+		for (uint32_t i = 0; i < current.VertexCount; i++)
+		{
+			localIndex[meshlets.Vertices[current.VertexOffset + i]] = NoLocalVertex;
+		}
+		ComputeMeshletBounds(current, meshlets, indices, vertices);
+		meshlets.Meshlets.push_back(current);
+
+		const uint32_t nextIndex = current.IndexOffset + current.TriangleCount * 3;
+		current = {};
+		current.IndexOffset = nextIndex;
+		current.VertexOffset = static_cast<uint32_t>(meshlets.Vertices.size());
+		current.TriangleOffset = static_cast<uint32_t>(meshlets.Triangles.size());
+	};
+
+	// Greedy scan in index buffer order. Growing meshlets by adjacency gives tighter cones,
+	// but reordering the triangles costs more vertex cache hits than the cones cull.
+	const size_t triangleCount = indexCount / 3;
+	for (size_t t = 0; t < triangleCount; t++)
+	{
+		const uint32_t* tri = &indices[t * 3];
+
+		uint32_t newVertices = 0;
+		for (uint32_t k = 0; k < 3; k++)
+		{
+			// Count each new vertex once, even if the triangle repeats it
+			if (localIndex[tri[k]] == NoLocalVertex && (k == 0 || tri[k] != tri[0]) && (k < 2 || tri[k] != tri[1]))
+			{
+				newVertices++;
+			}
+		}
+
+		if (current.VertexCount + newVertices > maxVertices || current.TriangleCount == maxTriangles)
+		{
+			flush();
+		}
+
+		for (uint32_t k = 0; k < 3; k++)
+		{
+			uint32_t& local = localIndex[tri[k]];
+			if (local == NoLocalVertex)
+			{
+				local = current.VertexCount++;
+				meshlets.Vertices.push_back(tri[k]);
+			}
+			meshlets.Triangles.push_back(static_cast<uint8_t>(local));
+		}
+		current.TriangleCount++;
+	}
+	flush();
+}
+
+void ExtractMeshletFrustum(const float worldViewProj[16], const MeshFloat3& eye, MeshletFrustum& frustum)
+{
+	// Clip coordinates are dot products with the matrix columns
+	auto column = [&](int c, float out[4])
+	{
+		for (int r = 0; r < 4; r++)
+		{
+			out[r] = worldViewProj[r * 4 + c];
+		}
+	};
+
+	float cx[4], cy[4], cz[4], cw[4];
+	column(0, cx);
+	column(1, cy);
+	column(2, cz);
+	column(3, cw);
+
+	for (int i = 0; i < 4; i++)
+	{
+		frustum.Planes[0][i] = cw[i] + cx[i]; // left
+		frustum.Planes[1][i] = cw[i] - cx[i]; // right
+		frustum.Planes[2][i] = cw[i] + cy[i]; // bottom
+		frustum.Planes[3][i] = cw[i] - cy[i]; // top
+		frustum.Planes[4][i] = cz[i]; // near
+		frustum.Planes[5][i] = cw[i] - cz[i]; // far
+	}
+
+	for (float* plane : frustum.Planes)
+	{
+		const float length = sqrtf(plane[0] * plane[0] + plane[1] * plane[1] + plane[2] * plane[2]);
+		if (length > 0.0f)
+		{
+			for (int i = 0; i < 4; i++)
+			{
+				plane[i] /= length;
+			}
+		}
+	}
+
+	frustum.Eye = eye;
+}
+
+MeshletCullStatistics CullMeshlets(uint32_t* visible, const Meshlet* meshlets, size_t meshletCount,
+	const MeshletFrustum& frustum)
+{
+	MeshletCullStatistics stats;
+	stats.Meshlets = static_cast<uint32_t>(meshletCount);
+
+	for (size_t m = 0; m < meshletCount; m++)
+	{
+		const Meshlet& meshlet = meshlets[m];
+		stats.Triangles += meshlet.TriangleCount;
+
+		bool outside = false;
+		for (const float* plane : frustum.Planes)
+		{
+			const float distance = plane[0] * meshlet.Center.x + plane[1] * meshlet.Center.y + plane[2] * meshlet.Center.z + plane[3];
+			if (distance < -meshlet.Radius)
+			{
+				outside = true;
+				break;
+			}
+		}
+		if (outside)
+		{
+			stats.FrustumCulled++;
+			continue;
+		}
+
+		const MeshFloat3 view = Subtract(meshlet.ConeApex, frustum.Eye);
+		const float viewLength = sqrtf(Dot(view, view));
+		if (Dot(view, meshlet.ConeAxis) >= meshlet.ConeCutoff * viewLength)
+		{
+			stats.BackfaceCulled++;
+			continue;
+		}
+
+		visible[stats.Visible++] = static_cast<uint32_t>(m);
+		stats.TrianglesVisible += meshlet.TriangleCount;
+	}
+	return stats;
+}
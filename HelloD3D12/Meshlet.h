@@ -0,0 +1,73 @@
+#pragma once
+#include "Mesh.h"
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+
+const uint32_t MaxMeshletVertices = 64;
+const uint32_t MaxMeshletTriangles = 124;
+
+// A cluster of consecutive triangles of the mesh index buffer. Meshlets are cut in
+// index buffer order, so the vertex cache and overdraw ordering are kept and each
+// meshlet can also be drawn as a plain DrawIndexedInstanced range.
+struct Meshlet
+{
+	// Range of the mesh index buffer covered by this meshlet
+	uint32_t IndexOffset;
+	uint32_t TriangleCount;
+
+	// Local vertex list in MeshletData::Vertices and 8-bit local triangles (three per
+	// triangle) in MeshletData::Triangles, as consumed by a mesh shader
+	uint32_t VertexOffset;
+	uint32_t VertexCount;
+	uint32_t TriangleOffset;
+
+	// Bounding sphere in model space
+	MeshFloat3 Center;
+	float Radius;
+
+	// Backface cone: every triangle faces away from an eye for which
+	// dot(normalize(ConeApex - eye), ConeAxis) >= ConeCutoff
+	MeshFloat3 ConeApex;
+	MeshFloat3 ConeAxis;
+	float ConeCutoff;
+};
+
+static_assert(sizeof(Meshlet) == 64, "Meshlet is stored in the mesh cache");
+
+struct MeshletData
+{
+	std::vector<Meshlet> Meshlets;
+	std::vector<uint32_t> Vertices;
+	std::vector<uint8_t> Triangles;
+};
+
+void BuildMeshlets(MeshletData& meshlets, const uint32_t* indices, size_t indexCount,
+	const MeshVertex* vertices, size_t vertexCount,
+	uint32_t maxVertices = MaxMeshletVertices, uint32_t maxTriangles = MaxMeshletTriangles);
+
+// Normalised clip planes and eye position, both in the meshlets' model space
+struct MeshletFrustum
+{
+	float Planes[6][4];
+	MeshFloat3 Eye;
+};
+
+// worldViewProj is row-major for row vectors (DirectXMath convention) with D3D clip
+// space depth in [0, w]
+void ExtractMeshletFrustum(const float worldViewProj[16], const MeshFloat3& eye, MeshletFrustum& frustum);
+
+struct MeshletCullStatistics
+{
+	uint32_t Meshlets = 0;
+	uint32_t FrustumCulled = 0;
+	uint32_t BackfaceCulled = 0;
+	uint32_t Visible = 0;
+	uint32_t Triangles = 0;
+	uint32_t TrianglesVisible = 0;
+};
+
+// Writes the indices of the meshlets that survive frustum and backface cone culling
+// to visible (room for meshletCount entries)
+MeshletCullStatistics CullMeshlets(uint32_t* visible, const Meshlet* meshlets, size_t meshletCount,
+	const MeshletFrustum& frustum);
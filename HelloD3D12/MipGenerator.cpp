@@ -0,0 +1,496 @@
+#include "MipGenerator.h"
+#include "Parallel.h"
+#include <algorithm>
+#include <cmath>
+#include <cstring>
+#include <vector>
+
+#if defined(_M_X64) || defined(__x86_64__)
+#include <emmintrin.h>
+#define MIP_GENERATOR_SSE2 1
+#endif
+
+namespace
+{
+	const double Pi = 3.14159265358979323846;
+	const double KaiserWidth = 3.0;
+	const double KaiserAlpha = 4.0;
+
+	uint32_t ChannelCount(MipFormat format)
+	{
+		return (format == MipFormat_R32Float) ? 1 : 4;
+	}
+
+	float HalfToFloat(uint16_t half)
+	{
+		const uint32_t sign = static_cast<uint32_t>(half & 0x8000) << 16;
+		const uint32_t exponent = (half >> 10) & 31;
+		const uint32_t mantissa = half & 0x3FF;
+
+		uint32_t bits;
+		if (exponent == 0)
+		{
+			// Zero or subnormal
+			const float value = mantissa * (1.0f / 16777216.0f);
+			memcpy(&bits, &value, sizeof(bits));
+			bits |= sign;
+		}
+		else if (exponent == 31)
+		{
+			bits = sign | 0x7F800000 | (mantissa << 13);
+		}
+		else
+		{
+			bits = sign | ((exponent + 112) << 23) | (mantissa << 13);
+		}
+
+		float value;
+		memcpy(&value, &bits, sizeof(value));
+		return value;
+	}
+
+	// Rounds to nearest even, as the GPU does
+	uint16_t FloatToHalf(float value)
+	{
+		uint32_t bits;
+		memcpy(&bits, &value, sizeof(bits));
+		const uint16_t sign = static_cast<uint16_t>((bits >> 16) & 0x8000);
+		bits &= 0x7FFFFFFF;
+
+		if (bits >= 0x7F800000)
+		{
+			// Infinity stays infinity, NaN stays NaN
+			return sign | 0x7C00 | (bits > 0x7F800000 ? 0x200 : 0);
+		}
+		if (bits >= 0x477FF000)
+		{
+			// Rounds past the largest half
+			return sign | 0x7C00;
+		}
+		if (bits < 0x38800000)
+		{
+			// Subnormal half; scaling by 2^24 is exact and leaves the mantissa to round
+			float magnitude;
+			memcpy(&magnitude, &bits, sizeof(magnitude));
+			return sign | static_cast<uint16_t>(std::nearbyint(magnitude * 16777216.0f));
+		}
+
+		bits += 0xFFF + ((bits >> 13) & 1);
+		bits -= 112u << 23;
+		return sign | static_cast<uint16_t>(bits >> 13);
+	}
+
+	// sRGB to linear for every byte, and linear back to sRGB at 16 bits of precision,
+	// fine enough that dark values round the same as the exact curve
+	struct SrgbTables
+	{
+		float ToLinear[256];
+		uint8_t FromLinear[65536];
+
+		SrgbTables()
+		{
+			for (int i = 0; i < 256; i++)
+			{
+				const double s = i / 255.0;
+				ToLinear[i] = static_cast<float>(s <= 0.04045 ? s / 12.92 : std::pow((s + 0.055) / 1.055, 2.4));
+			}
+			for (int i = 0; i < 65536; i++)
+			{
+				const double l = i / 65535.0;
+				const double s = (l <= 0.0031308) ? l * 12.92 : 1.055 * std::pow(l, 1.0 / 2.4) - 0.055;
+				FromLinear[i] = static_cast<uint8_t>(std::min(255.0, std::floor(s * 255.0 + 0.5)));
+			}
+		}
+	};
+
+	const SrgbTables& GetSrgbTables()
+	{
+		static const SrgbTables tables;
+		return tables;
+	}
+
+	inline uint32_t LinearIndex(float value)
+	{
+		return static_cast<uint32_t>(std::min(std::max(value, 0.0f), 1.0f) * 65535.0f + 0.5f);
+	}
+
+	inline uint8_t UnormToByte(float value)
+	{
+		return static_cast<uint8_t>(std::min(std::max(value, 0.0f), 255.0f) + 0.5f);
+	}
+
+	// Expands one row of texels to floats. Linear 8 bit channels keep their 0-255 range so
+	// that a 2x2 average is exact; sRGB channels become linear 0-1.
+	void DecodeRow(MipFormat format, const uint8_t* src, float* dest, uint32_t width)
+	{
+		switch (format)
+		{
+		case MipFormat_RGBA8:
+		{
+			uint32_t i = 0;
+#ifdef MIP_GENERATOR_SSE2
+			const __m128i zero = _mm_setzero_si128();
+			for (; i + 4 <= width * 4; i += 4)
+			{
+				int32_t packed;
+				memcpy(&packed, src + i, sizeof(packed));
+				const __m128i words = _mm_unpacklo_epi8(_mm_cvtsi32_si128(packed), zero);
+				_mm_storeu_ps(dest + i, _mm_cvtepi32_ps(_mm_unpacklo_epi16(words, zero)));
+			}
+#endif
+			for (; i < width * 4; i++)
+			{
+				dest[i] = src[i];
+			}
+		} break;
+
+		case MipFormat_RGBA8Srgb:
+		{
+			const SrgbTables& tables = GetSrgbTables();
+			for (uint32_t x = 0; x < width; x++)
+			{
+				dest[x * 4 + 0] = tables.ToLinear[src[x * 4 + 0]];
+				dest[x * 4 + 1] = tables.ToLinear[src[x * 4 + 1]];
+				dest[x * 4 + 2] = tables.ToLinear[src[x * 4 + 2]];
+				dest[x * 4 + 3] = src[x * 4 + 3];
+			}
+		} break;
+
+		case MipFormat_RGBA16Float:
+			for (uint32_t i = 0; i < width * 4; i++)
+			{
+				uint16_t half;
+				memcpy(&half, src + i * 2, sizeof(half));
+				dest[i] = HalfToFloat(half);
+			}
+			break;
+
+		case MipFormat_R32Float:
+			memcpy(dest, src, width * sizeof(float));
+			break;
+		}
+	}
+
+	void EncodeRow(MipFormat format, const float* src, uint8_t* dest, uint32_t width)
+	{
+		switch (format)
+		{
+		case MipFormat_RGBA8:
+		{
+			uint32_t i = 0;
+#ifdef MIP_GENERATOR_SSE2
+			// Four texels at a time
+			const __m128 zero = _mm_setzero_ps();
+			const __m128 top = _mm_set1_ps(255.0f);
+			const __m128 half = _mm_set1_ps(0.5f);
+			for (; i + 16 <= width * 4; i += 16)
+			{
+				__m128i v[4];
+				for (int j = 0; j < 4; j++)
+				{
+					const __m128 clamped = _mm_min_ps(_mm_max_ps(_mm_loadu_ps(src + i + j * 4), zero), top);
+					v[j] = _mm_cvttps_epi32(_mm_add_ps(clamped, half));
+				}
+				const __m128i words = _mm_packs_epi32(v[0], v[1]);
+				const __m128i words2 = _mm_packs_epi32(v[2], v[3]);
+				_mm_storeu_si128(reinterpret_cast<__m128i*>(dest + i), _mm_packus_epi16(words, words2));
+			}
+#endif
+			for (; i < width * 4; i++)
+			{
+				dest[i] = UnormToByte(src[i]);
+			}
+		} break;
+
+		case MipFormat_RGBA8Srgb:
+		{
+			const SrgbTables& tables = GetSrgbTables();
+			for (uint32_t x = 0; x < width; x++)
+			{
+				dest[x * 4 + 0] = tables.FromLinear[LinearIndex(src[x * 4 + 0])];
+				dest[x * 4 + 1] = tables.FromLinear[LinearIndex(src[x * 4 + 1])];
+				dest[x * 4 + 2] = tables.FromLinear[LinearIndex(src[x * 4 + 2])];
+				dest[x * 4 + 3] = UnormToByte(src[x * 4 + 3]);
+			}
+		} break;
+
+		case MipFormat_RGBA16Float:
+			for (uint32_t i = 0; i < width * 4; i++)
+			{
+				const uint16_t half = FloatToHalf(src[i]);
+				memcpy(dest + i * 2, &half, sizeof(half));
+			}
+			break;
+
+		case MipFormat_R32Float:
+			memcpy(dest, src, width * sizeof(float));
+			break;
+		}
+	}
+
+	double BesselI0(double x)
+	{
+		double sum = 1.0, term = 1.0;
+		for (int k = 1; k < 32; k++)
+		{
+			term *= (x / (2.0 * k)) * (x / (2.0 * k));
+			sum += term;
+		}
+		return sum;
+	}
+
+	double FilterWeight(MipFilter filter, double sourceCenter, double destCenter, double scale)
+	{
+		if (filter == MipFilter_Box)
+		{
+			// Overlap of the source texel with the footprint of the destination texel
+			const double low = std::max(sourceCenter - 0.5, destCenter - scale / 2.0);
+			const double high = std::min(sourceCenter + 0.5, destCenter + scale / 2.0);
+			return std::max(0.0, high - low);
+		}
+
+		const double t = (sourceCenter - destCenter) / scale;
+		if (std::fabs(t) >= KaiserWidth)
+		{
+			return 0.0;
+		}
+		const double sinc = (t == 0.0) ? 1.0 : std::sin(Pi * t) / (Pi * t);
+		const double r = t / KaiserWidth;
+		return sinc * BesselI0(KaiserAlpha * std::sqrt(1.0 - r * r)) / BesselI0(KaiserAlpha);
+	}
+
+	// The source texels and weights behind each destination texel along one axis, padded
+	// to the same count with zero weights. Indices past the edges are clamped.
+	struct FilterTaps
+	{
+		uint32_t Count = 0;
+		std::vector<uint32_t> Index;
+		std::vector<float> Weight;
+	};
+
+	FilterTaps BuildTaps(MipFilter filter, uint32_t sourceSize, uint32_t destSize)
+	{
+		const double scale = static_cast<double>(sourceSize) / destSize;
+		const double radius = (filter == MipFilter_Box) ? scale / 2.0 : KaiserWidth * scale;
+
+		std::vector<std::vector<std::pair<int64_t, double>>> lists(destSize);
+		FilterTaps taps;
+		for (uint32_t x = 0; x < destSize; x++)
+		{
+			const double center = (x + 0.5) * scale;
+			const int64_t first = static_cast<int64_t>(std::floor(center - radius));
+			const int64_t last = static_cast<int64_t>(std::ceil(center + radius));
+			double total = 0.0;
+			for (int64_t i = first; i <= last; i++)
+			{
+				const double weight = FilterWeight(filter, i + 0.5, center, scale);
+				// The sinc zeros land exactly on texel centres for even sizes
+				if (std::fabs(weight) > 1e-7)
+				{
+					lists[x].emplace_back(i, weight);
+					total += weight;
+				}
+			}
+			for (auto& tap : lists[x])
+			{
+				tap.second /= total;
+			}
+			taps.Count = std::max(taps.Count, static_cast<uint32_t>(lists[x].size()));
+		}
+
+		taps.Index.resize(static_cast<size_t>(destSize) * taps.Count);
+		taps.Weight.resize(static_cast<size_t>(destSize) * taps.Count, 0.0f);
+		for (uint32_t x = 0; x < destSize; x++)
+		{
+			for (uint32_t k = 0; k < taps.Count; k++)
+			{
+				const size_t slot = static_cast<size_t>(x) * taps.Count + k;
+				const int64_t index = (k < lists[x].size()) ? lists[x][k].first : lists[x].back().first;
+				taps.Index[slot] = static_cast<uint32_t>(std::min<int64_t>(std::max<int64_t>(index, 0), sourceSize - 1));
+				taps.Weight[slot] = (k < lists[x].size()) ? static_cast<float>(lists[x][k].second) : 0.0f;
+			}
+		}
+		return taps;
+	}
+
+	void FilterRowHorizontal(const float* src, float* dest, uint32_t destWidth, uint32_t channels, const FilterTaps& taps)
+	{
+		const uint32_t* index = taps.Index.data();
+		const float* weight = taps.Weight.data();
+		if (channels == 4)
+		{
+			for (uint32_t x = 0; x < destWidth; x++, index += taps.Count, weight += taps.Count)
+			{
+#ifdef MIP_GENERATOR_SSE2
+				__m128 sum = _mm_setzero_ps();
+				for (uint32_t k = 0; k < taps.Count; k++)
+				{
+					sum = _mm_add_ps(sum, _mm_mul_ps(_mm_set1_ps(weight[k]), _mm_loadu_ps(src + index[k] * 4)));
+				}
+				_mm_storeu_ps(dest + x * 4, sum);
+#else
+				float sum[4] = {};
+				for (uint32_t k = 0; k < taps.Count; k++)
+				{
+					for (int c = 0; c < 4; c++)
+					{
+						sum[c] += weight[k] * src[index[k] * 4 + c];
+					}
+				}
+				memcpy(dest + x * 4, sum, sizeof(sum));
+#endif
+			}
+		}
+		else
+		{
+			for (uint32_t x = 0; x < destWidth; x++, index += taps.Count, weight += taps.Count)
+			{
+				float sum = 0.0f;
+				for (uint32_t k = 0; k < taps.Count; k++)
+				{
+					sum += weight[k] * src[index[k]];
+				}
+				dest[x] = sum;
+			}
+		}
+	}
+
+	// dest = sum of weight[k] * rows[k], count floats wide
+	void FilterRowVertical(const float* const* rows, const float* weight, uint32_t tapCount, float* dest, size_t count)
+	{
+		size_t i = 0;
+#ifdef MIP_GENERATOR_SSE2
+		for (; i + 4 <= count; i += 4)
+		{
+			__m128 sum = _mm_setzero_ps();
+			for (uint32_t k = 0; k < tapCount; k++)
+			{
+				sum = _mm_add_ps(sum, _mm_mul_ps(_mm_set1_ps(weight[k]), _mm_loadu_ps(rows[k] + i)));
+			}
+			_mm_storeu_ps(dest + i, sum);
+		}
+#endif
+		for (; i < count; i++)
+		{
+			float sum = 0.0f;
+			for (uint32_t k = 0; k < tapCount; k++)
+			{
+				sum += weight[k] * rows[k][i];
+			}
+			dest[i] = sum;
+		}
+	}
+}
+
+size_t MipTexelBytes(MipFormat format)
+{
+	switch (format)
+	{
+	case MipFormat_RGBA8:
+	case MipFormat_RGBA8Srgb:
+	case MipFormat_R32Float:
+		return 4;
+	case MipFormat_RGBA16Float:
+		return 8;
+	default:
+		return 0;
+	}
+}
+
+uint32_t FullMipCount(uint32_t width, uint32_t height)
+{
+	uint32_t count = 1;
+	while (width > 1 || height > 1)
+	{
+		width = std::max(1u, width / 2);
+		height = std::max(1u, height / 2);
+		count++;
+	}
+	return count;
+}
+
+size_t MipChainBytes(MipFormat format, uint32_t width, uint32_t height, uint32_t mipCount)
+{
+	size_t bytes = 0;
+	for (uint32_t level = 0; level < mipCount; level++)
+	{
+		bytes += static_cast<size_t>(width) * height * MipTexelBytes(format);
+		width = std::max(1u, width / 2);
+		height = std::max(1u, height / 2);
+	}
+	return bytes;
+}
+
+bool GenerateMips(MipFormat format, MipFilter filter, uint32_t width, uint32_t height, uint32_t arraySize,
+	uint32_t mipCount, uint8_t* data, size_t dataSize, unsigned threadCount)
+{
+	const size_t sliceBytes = MipChainBytes(format, width, height, mipCount);
+	if (width == 0 || height == 0 || mipCount > FullMipCount(width, height) ||
+		dataSize / std::max<size_t>(1, sliceBytes) < arraySize)
+	{
+		return false;
+	}
+	if (mipCount <= 1 || arraySize == 0)
+	{
+		return true;
+	}
+
+	const uint32_t channels = ChannelCount(format);
+	const size_t texelBytes = MipTexelBytes(format);
+
+	// Float copies of the level being filtered from, and the one being filtered to,
+	// for every slice; the horizontal pass writes to an intermediate between them
+	std::vector<float> source(static_cast<size_t>(width) * height * channels * arraySize);
+	std::vector<float> horizontal;
+	std::vector<float> dest;
+
+	ParallelFor(static_cast<size_t>(arraySize) * height, threadCount, [&](size_t row)
+	{
+		const size_t slice = row / height;
+		const size_t y = row % height;
+		DecodeRow(format, data + slice * sliceBytes + y * width * texelBytes,
+			source.data() + row * width * channels, width);
+	});
+
+	uint32_t sourceWidth = width, sourceHeight = height;
+	size_t levelOffset = 0;
+	for (uint32_t level = 1; level < mipCount; level++)
+	{
+		levelOffset += static_cast<size_t>(sourceWidth) * sourceHeight * texelBytes;
+		const uint32_t destWidth = std::max(1u, sourceWidth / 2);
+		const uint32_t destHeight = std::max(1u, sourceHeight / 2);
+		const FilterTaps columns = BuildTaps(filter, sourceWidth, destWidth);
+		const FilterTaps rows = BuildTaps(filter, sourceHeight, destHeight);
+
+		const size_t sourceRowFloats = static_cast<size_t>(sourceWidth) * channels;
+		const size_t destRowFloats = static_cast<size_t>(destWidth) * channels;
+		horizontal.resize(destRowFloats * sourceHeight * arraySize);
+		dest.resize(destRowFloats * destHeight * arraySize);
+
+		ParallelFor(static_cast<size_t>(arraySize) * sourceHeight, threadCount, [&](size_t row)
+		{
+			FilterRowHorizontal(source.data() + row * sourceRowFloats, horizontal.data() + row * destRowFloats,
+				destWidth, channels, columns);
+		});
+
+		ParallelFor(static_cast<size_t>(arraySize) * destHeight, threadCount, [&](size_t row)
+		{
+			const size_t slice = row / destHeight;
+			const size_t y = row % destHeight;
+			// A level is at most three times smaller, so the Kaiser filter spans under 20 rows
+			const float* tapRows[32];
+			for (uint32_t k = 0; k < rows.Count; k++)
+			{
+				tapRows[k] = horizontal.data() + (slice * sourceHeight + rows.Index[y * rows.Count + k]) * destRowFloats;
+			}
+			float* destRow = dest.data() + row * destRowFloats;
+			FilterRowVertical(tapRows, rows.Weight.data() + y * rows.Count, rows.Count, destRow, destRowFloats);
+			EncodeRow(format, destRow, data + slice * sliceBytes + levelOffset + y * destWidth * texelBytes, destWidth);
+		});
+
+		source.swap(dest);
+		sourceWidth = destWidth;
+		sourceHeight = destHeight;
+	}
+	return true;
+}
@@ -0,0 +1,40 @@
+#pragma once
+#include <cstddef>
+#include <cstdint>
+
+// CPU mip chain generation for textures that ship with only their top level. Works at
+// load time on a copy of the texture data, or in the cooker before block compression.
+
+enum MipFormat : uint32_t
+{
+	MipFormat_RGBA8,
+	// The first three channels hold sRGB encoded values and are filtered in linear
+	// space; the fourth is linear
+	MipFormat_RGBA8Srgb,
+	MipFormat_RGBA16Float,
+	MipFormat_R32Float,
+};
+
+enum MipFilter : uint32_t
+{
+	// Average of the texels each mip texel covers (2x2 for even sizes)
+	MipFilter_Box,
+	// Kaiser windowed sinc, three lobes wide; sharper at a distance, may ring a little
+	MipFilter_Kaiser,
+};
+
+size_t MipTexelBytes(MipFormat format);
+
+// Levels down to 1x1
+uint32_t FullMipCount(uint32_t width, uint32_t height);
+
+// Bytes of one array slice holding mipCount tightly packed levels
+size_t MipChainBytes(MipFormat format, uint32_t width, uint32_t height, uint32_t mipCount);
+
+// Fills levels 1..mipCount-1 of every array slice in data from level 0. Slices follow
+// one another, each laid out as MipChainBytes describes (the DDS order), so only the
+// top level of each needs to be filled in. Every level is filtered from the one above
+// it at full float precision; its rows and slices are spread over up to threadCount
+// threads (0 picks one per core). Returns false when dataSize is too small.
+bool GenerateMips(MipFormat format, MipFilter filter, uint32_t width, uint32_t height, uint32_t arraySize,
+	uint32_t mipCount, uint8_t* data, size_t dataSize, unsigned threadCount = 0);
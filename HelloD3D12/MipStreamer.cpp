@@ -0,0 +1,174 @@
+#include "MipStreamer.h"
+#include <algorithm>
+
+uint32_t MipStreamer::AddTexture(uint32_t mipCount, uint32_t residentMip, const uint64_t* mipBytes)
+{
+	mipCount = std::max(mipCount, 1u);
+	residentMip = std::min(residentMip, mipCount - 1);
+
+	TextureState texture;
+	texture.MipCount = mipCount;
+	texture.ResidentMip = residentMip;
+	texture.StartedMip = residentMip;
+	texture.RequestedMip = residentMip;
+	texture.MinMip = 0;
+	texture.FirstMipBytes = static_cast<uint32_t>(m_MipBytes.size());
+	m_MipBytes.insert(m_MipBytes.end(), mipBytes, mipBytes + mipCount);
+
+	m_Textures.push_back(texture);
+	return static_cast<uint32_t>(m_Textures.size() - 1);
+}
+
+void MipStreamer::Request(uint32_t texture, uint32_t mip)
+{
+	TextureState& state = m_Textures[texture];
+	state.RequestedMip = std::min(mip, state.MipCount - 1);
+}
+
+void MipStreamer::SetMinMip(uint32_t texture, uint32_t mip)
+{
+	TextureState& state = m_Textures[texture];
+	state.MinMip = std::min(mip, state.MipCount);
+	state.ResidentMip = std::max(state.ResidentMip, state.MinMip);
+	state.StartedMip = std::max(state.StartedMip, state.MinMip);
+
+	// Copies of dropped mips still complete, but must not make them resident again
+	const size_t firstUnsubmitted = m_InFlight.size() - m_Unsubmitted;
+	size_t kept = 0;
+	for (size_t i = 0; i < m_InFlight.size(); ++i)
+	{
+		const InFlight& upload = m_InFlight[i];
+		if (upload.Texture == texture && upload.Mip < state.MinMip)
+		{
+			if (i >= firstUnsubmitted)
+			{
+				m_Unsubmitted--;
+			}
+			continue;
+		}
+		m_InFlight[kept++] = upload;
+	}
+	m_InFlight.resize(kept);
+}
+
+void MipStreamer::Schedule(uint64_t byteBudget, std::vector<MipUpload>& uploads) const
+{
+	uploads.clear();
+
+	struct Candidate
+	{
+		uint32_t Texture;
+		uint32_t NextMip;
+	};
+	std::vector<Candidate> candidates;
+	for (uint32_t i = 0; i < m_Textures.size(); ++i)
+	{
+		if (Target(m_Textures[i]) < m_Textures[i].StartedMip)
+		{
+			candidates.push_back({ i, m_Textures[i].StartedMip });
+		}
+	}
+
+	uint64_t remaining = byteBudget;
+	while (!candidates.empty())
+	{
+		// Largest shortfall first, smaller next mip on ties
+		std::stable_sort(candidates.begin(), candidates.end(), [&](const Candidate& a, const Candidate& b)
+		{
+			const uint32_t gapA = a.NextMip - Target(m_Textures[a.Texture]);
+			const uint32_t gapB = b.NextMip - Target(m_Textures[b.Texture]);
+			if (gapA != gapB)
+			{
+				return gapA > gapB;
+			}
+			const TextureState& ta = m_Textures[a.Texture];
+			const TextureState& tb = m_Textures[b.Texture];
+			return m_MipBytes[ta.FirstMipBytes + a.NextMip - 1] < m_MipBytes[tb.FirstMipBytes + b.NextMip - 1];
+		});
+
+		size_t kept = 0;
+		for (Candidate& candidate : candidates)
+		{
+			const TextureState& texture = m_Textures[candidate.Texture];
+			const uint32_t mip = candidate.NextMip - 1;
+			const uint64_t bytes = m_MipBytes[texture.FirstMipBytes + mip];
+			if (bytes > remaining && !uploads.empty())
+			{
+				// Later, smaller mips of other textures may still fit
+				continue;
+			}
+
+			uploads.push_back({ candidate.Texture, mip, bytes });
+			remaining -= std::min(bytes, remaining);
+			candidate.NextMip = mip;
+			if (mip > Target(texture))
+			{
+				candidates[kept++] = candidate;
+			}
+		}
+		candidates.resize(kept);
+	}
+}
+
+bool MipStreamer::Start(const MipUpload& upload)
+{
+	if (upload.Texture >= m_Textures.size())
+	{
+		return false;
+	}
+	TextureState& texture = m_Textures[upload.Texture];
+	if (upload.Mip + 1 != texture.StartedMip)
+	{
+		return false;
+	}
+	texture.StartedMip = upload.Mip;
+	m_InFlight.push_back({ upload.Texture, upload.Mip, 0 });
+	m_Unsubmitted++;
+	return true;
+}
+
+void MipStreamer::Submit(uint64_t fenceValue)
+{
+	for (size_t i = m_InFlight.size() - m_Unsubmitted; i < m_InFlight.size(); ++i)
+	{
+		m_InFlight[i].FenceValue = fenceValue;
+	}
+	m_Unsubmitted = 0;
+}
+
+void MipStreamer::Retire(uint64_t completedFenceValue, std::vector<MipResidencyChange>& changes)
+{
+	changes.clear();
+
+	// Uploads complete in submission order, and each texture's mips were started finest last
+	while (m_InFlight.size() > m_Unsubmitted && m_InFlight.front().FenceValue <= completedFenceValue)
+	{
+		const InFlight upload = m_InFlight.front();
+		m_InFlight.pop_front();
+		m_Textures[upload.Texture].ResidentMip = upload.Mip;
+
+		auto change = std::find_if(changes.begin(), changes.end(),
+			[&](const MipResidencyChange& c) { return c.Texture == upload.Texture; });
+		if (change != changes.end())
+		{
+			change->ResidentMip = upload.Mip;
+		}
+		else
+		{
+			changes.push_back({ upload.Texture, upload.Mip });
+		}
+	}
+}
+
+uint32_t MipStreamer::MipForResolution(uint32_t width, uint32_t height, uint32_t mipCount,
+	uint32_t requiredWidth, uint32_t requiredHeight)
+{
+	uint32_t mip = 0;
+	while (mip + 1 < mipCount &&
+		std::max(width >> (mip + 1), 1u) >= requiredWidth &&
+		std::max(height >> (mip + 1), 1u) >= requiredHeight)
+	{
+		mip++;
+	}
+	return mip;
+}
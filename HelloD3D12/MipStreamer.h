@@ -0,0 +1,100 @@
+#pragma once
+#include <algorithm>
+#include <cstddef>
+#include <cstdint>
+#include <deque>
+#include <vector>
+
+// One mip level to copy to the GPU
+struct MipUpload
+{
+	uint32_t Texture;
+	uint32_t Mip;
+	uint64_t Bytes;
+};
+
+// A texture whose most detailed resident mip changed; its view should be rebuilt
+struct MipResidencyChange
+{
+	uint32_t Texture;
+	uint32_t ResidentMip;
+};
+
+// Decides which mip levels of streamed textures to upload and tracks them until the
+// GPU has copied them. Mips become resident from the smallest up, so a texture's
+// resident mips are always ResidentMip..MipCount-1 and a view can start at ResidentMip.
+// Nothing here touches the GPU: uploads are reported as records and completion is
+// driven by fence values.
+class MipStreamer
+{
+public:
+	// mipBytes holds the upload size of every mip; mips residentMip and below are
+	// already on the GPU. Returns the texture's index.
+	uint32_t AddTexture(uint32_t mipCount, uint32_t residentMip, const uint64_t* mipBytes);
+
+	// Most detailed mip the texture should get; asking for less detail never evicts
+	void Request(uint32_t texture, uint32_t mip);
+
+	// Most detailed mip the texture may have. Raising it drops the finer mips, resident or
+	// in flight (MipCount drops them all); lowering it lets requests stream them back.
+	void SetMinMip(uint32_t texture, uint32_t mip);
+
+	// Proposes uploads toward the requested mips, totalling at most byteBudget (though
+	// at least one upload is proposed when any is wanted). Textures missing the most
+	// levels go first and advance one mip per round.
+	void Schedule(uint64_t byteBudget, std::vector<MipUpload>& uploads) const;
+
+	// Marks a proposed upload as recorded. Fails when it is not the texture's next mip,
+	// so a caller that could not record an upload must skip the rest for that texture.
+	bool Start(const MipUpload& upload);
+
+	// Tags the uploads started since the last call with the fence value that follows them
+	void Submit(uint64_t fenceValue);
+
+	// Makes the mips whose fence has completed resident and reports the textures changed
+	void Retire(uint64_t completedFenceValue, std::vector<MipResidencyChange>& changes);
+
+	inline uint32_t TextureCount() const { return static_cast<uint32_t>(m_Textures.size()); }
+	inline uint32_t MipCount(uint32_t texture) const { return m_Textures[texture].MipCount; }
+	// MipCount when no mip is resident
+	inline uint32_t ResidentMip(uint32_t texture) const { return m_Textures[texture].ResidentMip; }
+	// Most detailed mip resident or on its way
+	inline uint32_t StartedMip(uint32_t texture) const { return m_Textures[texture].StartedMip; }
+	inline uint32_t MinMip(uint32_t texture) const { return m_Textures[texture].MinMip; }
+	inline uint32_t RequestedMip(uint32_t texture) const { return m_Textures[texture].RequestedMip; }
+	inline size_t PendingUploads() const { return m_InFlight.size(); }
+
+	// Most detailed mip of a width x height texture that still has at least
+	// requiredWidth x requiredHeight texels
+	static uint32_t MipForResolution(uint32_t width, uint32_t height, uint32_t mipCount,
+		uint32_t requiredWidth, uint32_t requiredHeight);
+
+private:
+	struct TextureState
+	{
+		uint32_t MipCount;
+		uint32_t ResidentMip;
+		// Most detailed mip resident or on its way
+		uint32_t StartedMip;
+		uint32_t RequestedMip;
+		uint32_t MinMip;
+		// Offset of the texture's sizes in m_MipBytes
+		uint32_t FirstMipBytes;
+	};
+
+	struct InFlight
+	{
+		uint32_t Texture;
+		uint32_t Mip;
+		uint64_t FenceValue;
+	};
+
+	// Most detailed mip to stream towards
+	static inline uint32_t Target(const TextureState& texture) { return std::max(texture.RequestedMip, texture.MinMip); }
+
+	std::vector<TextureState> m_Textures;
+	std::vector<uint64_t> m_MipBytes;
+	std::deque<InFlight> m_InFlight;
+	// Uploads at the back of m_InFlight not yet tagged with a fence value
+	size_t m_Unsubmitted = 0;
+};
@@ -0,0 +1,362 @@
+#include "ModelParser.h"
+#include "Parallel.h"
+#include <charconv>
+#include <cstring>
+
+namespace
+{
+	// Chunks smaller than this are not worth a thread
+	const size_t MinChunkBytes = 64 * 1024;
+
+	const double Pow10[] =
+	{
+		1e0, 1e1, 1e2, 1e3, 1e4, 1e5, 1e6, 1e7, 1e8, 1e9, 1e10, 1e11,
+		1e12, 1e13, 1e14, 1e15, 1e16, 1e17, 1e18, 1e19, 1e20, 1e21, 1e22
+	};
+
+	struct TextRange
+	{
+		const char* Begin;
+		const char* End;
+	};
+
+	inline bool IsSpace(char c)
+	{
+		return c == ' ' || c == '\t' || c == '\n' || c == '\r' || c == '\v' || c == '\f';
+	}
+
+	inline bool IsDigit(char c)
+	{
+		return static_cast<unsigned>(c - '0') < 10u;
+	}
+
+	inline void SkipSpace(const char*& p, const char* end)
+	{
+		while (p != end && IsSpace(*p))
+		{
+			p++;
+		}
+	}
+
+	bool ParseUInt(const char*& p, const char* end, uint32_t& value)
+	{
+		if (p == end || !IsDigit(*p))
+		{
+			return false;
+		}
+
+		uint64_t v = 0;
+		while (p != end && IsDigit(*p))
+		{
+			v = v * 10 + static_cast<uint32_t>(*p - '0');
+			if (v > UINT32_MAX)
+			{
+				return false;
+			}
+			p++;
+		}
+		value = static_cast<uint32_t>(v);
+		return true;
+	}
+
+	const char* Find(const char* begin, const char* end, const char* what)
+	{
+		const size_t length = strlen(what);
+		for (const char* p = begin; p + length <= end; p++)
+		{
+			if (*p == *what && memcmp(p, what, length) == 0)
+			{
+				return p;
+			}
+		}
+		return nullptr;
+	}
+
+	bool ParseCount(const char* text, const char* end, const char* label, uint32_t& value)
+	{
+		const char* p = Find(text, end, label);
+		if (!p)
+		{
+			return false;
+		}
+		p += strlen(label);
+		SkipSpace(p, end);
+		if (p != end && *p == ':')
+		{
+			p++;
+		}
+		SkipSpace(p, end);
+		return ParseUInt(p, end, value);
+	}
+
+	// Returns the text between the braces following a section label
+	bool FindSection(const char* text, const char* end, const char* label, TextRange& body, TextRange& title)
+	{
+		const char* p = Find(text, end, label);
+		if (!p)
+		{
+			return false;
+		}
+		const char* open = static_cast<const char*>(memchr(p, '{', end - p));
+		if (!open)
+		{
+			return false;
+		}
+		const char* close = static_cast<const char*>(memchr(open, '}', end - open));
+		if (!close)
+		{
+			return false;
+		}
+		title = { p, open };
+		body = { open + 1, close };
+		return true;
+	}
+
+	// Splits a range into roughly equal chunks that start and end on line boundaries
+	std::vector<TextRange> SplitLines(TextRange range, unsigned threadCount)
+	{
+		const size_t size = range.End - range.Begin;
+		size_t chunkCount = std::min<size_t>(threadCount, std::max<size_t>(1, size / MinChunkBytes));
+
+		std::vector<TextRange> chunks;
+		chunks.reserve(chunkCount);
+
+		const char* begin = range.Begin;
+		for (size_t i = 1; i <= chunkCount && begin < range.End; i++)
+		{
+			const char* split = (i == chunkCount) ? range.End : range.Begin + size * i / chunkCount;
+			if (split < begin)
+			{
+				split = begin;
+			}
+			const char* newline = static_cast<const char*>(memchr(split, '\n', range.End - split));
+			const char* chunkEnd = newline ? newline + 1 : range.End;
+			chunks.push_back({ begin, chunkEnd });
+			begin = chunkEnd;
+		}
+		return chunks;
+	}
+
+	// Parses every value of a section body in parallel and concatenates the chunks in order
+	template<typename T, typename ParseFn>
+	bool ParseSection(TextRange body, unsigned threadCount, size_t expected, std::vector<T>& out, ParseFn parse)
+	{
+		std::vector<TextRange> chunks = SplitLines(body, threadCount);
+		std::vector<std::vector<T>> values(chunks.size());
+		std::vector<char> failed(chunks.size(), 0);
+
+		ParallelFor(chunks.size(), threadCount, [&](size_t c)
+		{
+			std::vector<T>& local = values[c];
+			// Every value takes at least two characters including its separator
+			local.reserve((chunks[c].End - chunks[c].Begin) / 2);
+
+			const char* p = chunks[c].Begin;
+			const char* end = chunks[c].End;
+			for (;;)
+			{
+				SkipSpace(p, end);
+				if (p == end)
+				{
+					break;
+				}
+				T value;
+				if (!parse(p, end, value))
+				{
+					failed[c] = 1;
+					return;
+				}
+				local.push_back(value);
+			}
+		});
+
+		size_t total = 0;
+		for (size_t c = 0; c < chunks.size(); c++)
+		{
+			if (failed[c])
+			{
+				return false;
+			}
+			total += values[c].size();
+		}
+		if (total != expected)
+		{
+			return false;
+		}
+
+		out.resize(total);
+		size_t offset = 0;
+		for (const std::vector<T>& local : values)
+		{
+			if (!local.empty())
+			{
+				memcpy(out.data() + offset, local.data(), local.size() * sizeof(T));
+			}
+			offset += local.size();
+		}
+		return true;
+	}
+}
+
+bool ParseFloat(const char*& p, const char* end, float& value)
+{
+	const char* start = p;
+	bool negative = false;
+	if (p != end && (*p == '-' || *p == '+'))
+	{
+		negative = (*p == '-');
+		p++;
+	}
+	const char* number = p;
+
+	uint64_t mantissa = 0;
+	int significant = 0;
+	int exponent = 0;
+	bool truncated = false;
+	bool anyDigits = false;
+
+	while (p != end && IsDigit(*p))
+	{
+		if (significant < 19)
+		{
+			mantissa = mantissa * 10 + static_cast<uint64_t>(*p - '0');
+			significant += (mantissa != 0);
+		}
+		else
+		{
+			exponent++;
+			truncated = true;
+		}
+		anyDigits = true;
+		p++;
+	}
+
+	if (p != end && *p == '.')
+	{
+		p++;
+		while (p != end && IsDigit(*p))
+		{
+			if (significant < 19)
+			{
+				mantissa = mantissa * 10 + static_cast<uint64_t>(*p - '0');
+				significant += (mantissa != 0);
+				exponent--;
+			}
+			else
+			{
+				truncated = true;
+			}
+			anyDigits = true;
+			p++;
+		}
+	}
+
+	if (!anyDigits)
+	{
+		p = start;
+		return false;
+	}
+
+	if (p != end && (*p == 'e' || *p == 'E'))
+	{
+		const char* e = p + 1;
+		bool negativeExponent = false;
+		if (e != end && (*e == '-' || *e == '+'))
+		{
+			negativeExponent = (*e == '-');
+			e++;
+		}
+		if (e != end && IsDigit(*e))
+		{
+			int exp = 0;
+			while (e != end && IsDigit(*e))
+			{
+				exp = std::min(exp * 10 + (*e - '0'), 100000);
+				e++;
+			}
+			exponent += negativeExponent ? -exp : exp;
+			p = e;
+		}
+	}
+
+	// Clinger's fast path: both the mantissa and the power of ten are exact doubles
+	if (!truncated && mantissa <= (1ull << 53) && exponent >= -22 && exponent <= 22)
+	{
+		double d = static_cast<double>(mantissa);
+		d = (exponent < 0) ? d / Pow10[-exponent] : d * Pow10[exponent];
+		value = static_cast<float>(negative ? -d : d);
+		return true;
+	}
+
+	// Rare long or extreme literals take the correctly rounded path
+	float parsed = 0.0f;
+	std::from_chars_result result = std::from_chars(number, p, parsed);
+	if (result.ec == std::errc::result_out_of_range && result.ptr == p && exponent < 0)
+	{
+		// Too small for a float: flush to zero like strtof does
+		parsed = 0.0f;
+	}
+	else if (result.ec != std::errc() || result.ptr != p)
+	{
+		p = start;
+		return false;
+	}
+	value = negative ? -parsed : parsed;
+	return true;
+}
+
+bool ParseModelText(const char* text, size_t size, MeshData& mesh, unsigned threadCount)
+{
+	const char* end = text + size;
+
+	if (threadCount == 0)
+	{
+		threadCount = DefaultThreadCount();
+	}
+
+	uint32_t vcount = 0;
+	uint32_t tcount = 0;
+	if (!ParseCount(text, end, "VertexCount", vcount) ||
+		!ParseCount(text, end, "TriangleCount", tcount))
+	{
+		return false;
+	}
+
+	TextRange vertexBody;
+	TextRange vertexTitle;
+	if (!FindSection(text, end, "VertexList", vertexBody, vertexTitle))
+	{
+		return false;
+	}
+
+	TextRange triangleBody;
+	TextRange triangleTitle;
+	if (!FindSection(vertexBody.End, end, "TriangleList", triangleBody, triangleTitle))
+	{
+		return false;
+	}
+
+	// "VertexList (pos, normal)" or "VertexList (pos, normal, texc)"
+	const char* layout = Find(vertexTitle.Begin, vertexTitle.End, "(");
+	const bool hasTexC = layout &&
+		(Find(layout, vertexTitle.End, "tex") != nullptr || Find(layout, vertexTitle.End, "uv") != nullptr);
+	const size_t floatsPerVertex = hasTexC ? 8 : 6;
+
+	std::vector<float> floats;
+	if (!ParseSection(vertexBody, threadCount, vcount * floatsPerVertex, floats, ParseFloat))
+	{
+		return false;
+	}
+
+	mesh.Vertices.assign(vcount, MeshVertex{});
+	for (size_t i = 0; i < vcount; i++)
+	{
+		memcpy(&mesh.Vertices[i], &floats[i * floatsPerVertex], floatsPerVertex * sizeof(float));
+	}
+
+	return ParseSection(triangleBody, threadCount, 3 * static_cast<size_t>(tcount), mesh.Indices,
+		[vcount](const char*& p, const char* e, uint32_t& index)
+		{
+			return ParseUInt(p, e, index) && index < vcount;
+		});
+}
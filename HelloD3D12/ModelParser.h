@@ -0,0 +1,21 @@
+#pragma once
+#include "Mesh.h"
+#include <cstddef>
+
+// Parses the text model format used by Models/*.txt:
+//
+//   VertexCount: N
+//   TriangleCount: M
+//   VertexList (pos, normal)
+//   { px py pz nx ny nz ... }
+//   TriangleList
+//   { i0 i1 i2 ... }
+//
+// The VertexList and TriangleList bodies are split into chunks on line
+// boundaries and parsed on threadCount threads (0 picks one per core).
+// Parsing is locale independent. Returns false if the text is malformed or
+// an index is out of range.
+bool ParseModelText(const char* text, size_t size, MeshData& mesh, unsigned threadCount = 0);
+
+// Parses a decimal floating point number at p, advancing p past it.
+bool ParseFloat(const char*& p, const char* end, float& value);
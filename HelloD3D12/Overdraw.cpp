@@ -0,0 +1,352 @@
+#include "Overdraw.h"
+#include "Parallel.h"
+#include "VertexCache.h"
+#include <algorithm>
+#include <cmath>
+#include <limits>
+#include <numeric>
+#include <vector>
+
+namespace
+{
+	struct Float3
+	{
+		float x, y, z;
+	};
+
+	inline Float3 Subtract(const MeshFloat3& a, const MeshFloat3& b) { return { a.x - b.x, a.y - b.y, a.z - b.z }; }
+	inline Float3 Cross(const Float3& a, const Float3& b) { return { a.y * b.z - a.z * b.y, a.z * b.x - a.x * b.z, a.x * b.y - a.y * b.x }; }
+	inline float Dot(const Float3& a, const Float3& b) { return a.x * b.x + a.y * b.y + a.z * b.z; }
+
+	// Face normal scaled by twice the triangle area. Triangles are clockwise in a
+	// left-handed space, so this points out of the front face.
+	inline Float3 FaceNormal(const MeshFloat3& p0, const MeshFloat3& p1, const MeshFloat3& p2)
+	{
+		return Cross(Subtract(p1, p0), Subtract(p2, p0));
+	}
+
+	// Loads a triangle into a FIFO cache simulated with timestamps (see AnalyzeVertexCache)
+	// and returns the number of misses
+	inline uint32_t UpdateCache(const uint32_t* tri, std::vector<uint32_t>& timestamps, uint32_t& time)
+	{
+		uint32_t misses = 0;
+		for (uint32_t k = 0; k < 3; k++)
+		{
+			if (time - timestamps[tri[k]] > DefaultVertexCacheSize)
+			{
+				timestamps[tri[k]] = time++;
+				misses++;
+			}
+		}
+		return misses;
+	}
+
+	inline void ResetCache(uint32_t& time)
+	{
+		time += DefaultVertexCacheSize + 1;
+	}
+
+	// Three misses in a row usually means the optimiser started a new, disjoint patch
+	std::vector<uint32_t> HardBoundaries(const uint32_t* indices, size_t triangleCount, size_t vertexCount)
+	{
+		std::vector<uint32_t> timestamps(vertexCount, 0);
+		uint32_t time = DefaultVertexCacheSize + 1;
+
+		std::vector<uint32_t> boundaries;
+		for (size_t t = 0; t < triangleCount; t++)
+		{
+			if (UpdateCache(&indices[t * 3], timestamps, time) == 3 || t == 0)
+			{
+				boundaries.push_back(static_cast<uint32_t>(t));
+			}
+		}
+		return boundaries;
+	}
+
+	// Splits each hard cluster further, ending a cluster as soon as its own ACMR (with a
+	// cold cache) is within threshold of the ACMR of the whole hard cluster
+	std::vector<uint32_t> SoftBoundaries(const uint32_t* indices, size_t triangleCount, size_t vertexCount,
+		const std::vector<uint32_t>& hard, float threshold)
+	{
+		std::vector<uint32_t> timestamps(vertexCount, 0);
+		uint32_t time = 0;
+
+		std::vector<uint32_t> boundaries;
+		for (size_t c = 0; c < hard.size(); c++)
+		{
+			const size_t start = hard[c];
+			const size_t end = (c + 1 < hard.size()) ? hard[c + 1] : triangleCount;
+
+			ResetCache(time);
+			uint32_t clusterMisses = 0;
+			for (size_t t = start; t < end; t++)
+			{
+				clusterMisses += UpdateCache(&indices[t * 3], timestamps, time);
+			}
+			const float clusterThreshold = threshold * static_cast<float>(clusterMisses) / static_cast<float>(end - start);
+
+			boundaries.push_back(static_cast<uint32_t>(start));
+
+			ResetCache(time);
+			uint32_t runningMisses = 0;
+			uint32_t runningTriangles = 0;
+			for (size_t t = start; t < end; t++)
+			{
+				runningMisses += UpdateCache(&indices[t * 3], timestamps, time);
+				runningTriangles++;
+
+				if (static_cast<float>(runningMisses) <= clusterThreshold * static_cast<float>(runningTriangles))
+				{
+					boundaries.push_back(static_cast<uint32_t>(t + 1));
+					ResetCache(time);
+					runningMisses = 0;
+					runningTriangles = 0;
+				}
+			}
+
+			// The last split is either empty (it ended exactly at the hard boundary) or a short
+			// tail with a poor ACMR; fold it back into the previous cluster either way
+			if (boundaries.back() != start)
+			{
+				boundaries.pop_back();
+			}
+		}
+		return boundaries;
+	}
+
+	struct RasterVertex
+	{
+		float x, y, z;
+	};
+
+	// Pixels on a shared edge belong to exactly one triangle; the rule only has to be
+	// antisymmetric in the edge direction
+	inline bool InsideEdge(float w, float dx, float dy)
+	{
+		return w > 0.0f || (w == 0.0f && (dy > 0.0f || (dy == 0.0f && dx < 0.0f)));
+	}
+
+	void RasterizeTriangle(RasterVertex a, RasterVertex b, RasterVertex c, uint32_t resolution,
+		std::vector<float>& depth, uint64_t& shaded)
+	{
+		float area = (b.x - a.x) * (c.y - a.y) - (b.y - a.y) * (c.x - a.x);
+		if (area == 0.0f)
+		{
+			return;
+		}
+		if (area < 0.0f)
+		{
+			std::swap(b, c);
+			area = -area;
+		}
+
+		const float maxCoord = static_cast<float>(resolution - 1);
+		const int minX = static_cast<int>(std::max(0.0f, floorf(std::min({ a.x, b.x, c.x }))));
+		const int maxX = static_cast<int>(std::min(maxCoord, ceilf(std::max({ a.x, b.x, c.x }))));
+		const int minY = static_cast<int>(std::max(0.0f, floorf(std::min({ a.y, b.y, c.y }))));
+		const int maxY = static_cast<int>(std::min(maxCoord, ceilf(std::max({ a.y, b.y, c.y }))));
+
+		const float invArea = 1.0f / area;
+		for (int y = minY; y <= maxY; y++)
+		{
+			const float py = y + 0.5f;
+			for (int x = minX; x <= maxX; x++)
+			{
+				const float px = x + 0.5f;
+				const float w0 = (c.x - b.x) * (py - b.y) - (c.y - b.y) * (px - b.x);
+				const float w1 = (a.x - c.x) * (py - c.y) - (a.y - c.y) * (px - c.x);
+				const float w2 = (b.x - a.x) * (py - a.y) - (b.y - a.y) * (px - a.x);
+				if (!InsideEdge(w0, c.x - b.x, c.y - b.y) ||
+					!InsideEdge(w1, a.x - c.x, a.y - c.y) ||
+					!InsideEdge(w2, b.x - a.x, b.y - a.y))
+				{
+					continue;
+				}
+
+				const float z = (w0 * a.z + w1 * b.z + w2 * c.z) * invArea;
+				float& stored = depth[static_cast<size_t>(y) * resolution + x];
+				if (z < stored)
+				{
+					stored = z;
+					shaded++;
+				}
+			}
+		}
+	}
+}
+
+OverdrawStatistics AnalyzeOverdraw(const uint32_t* indices, size_t indexCount,
+	const MeshVertex* vertices, size_t vertexCount, uint32_t resolution, unsigned threadCount)
+{
+	OverdrawStatistics stats;
+	if (indexCount < 3 || vertexCount == 0 || resolution == 0)
+	{
+		return stats;
+	}
+
+	// Project around the bounding sphere so every view uses the same scale
+	MeshFloat3 minP = vertices[0].Position;
+	MeshFloat3 maxP = vertices[0].Position;
+	for (size_t v = 1; v < vertexCount; v++)
+	{
+		const MeshFloat3& p = vertices[v].Position;
+		minP = { std::min(minP.x, p.x), std::min(minP.y, p.y), std::min(minP.z, p.z) };
+		maxP = { std::max(maxP.x, p.x), std::max(maxP.y, p.y), std::max(maxP.z, p.z) };
+	}
+	const MeshFloat3 center = { (minP.x + maxP.x) * 0.5f, (minP.y + maxP.y) * 0.5f, (minP.z + maxP.z) * 0.5f };
+	const Float3 extent = Subtract(maxP, center);
+	const float radius = sqrtf(Dot(extent, extent));
+	if (radius == 0.0f)
+	{
+		return stats;
+	}
+
+	// The six axes and the eight cube diagonals
+	std::vector<Float3> views;
+	for (int axis = 0; axis < 3; axis++)
+	{
+		for (float sign : { -1.0f, 1.0f })
+		{
+			Float3 d = { 0.0f, 0.0f, 0.0f };
+			(&d.x)[axis] = sign;
+			views.push_back(d);
+		}
+	}
+	const float diagonal = 1.0f / sqrtf(3.0f);
+	for (int i = 0; i < 8; i++)
+	{
+		views.push_back({ (i & 1) ? diagonal : -diagonal, (i & 2) ? diagonal : -diagonal, (i & 4) ? diagonal : -diagonal });
+	}
+
+	std::vector<OverdrawStatistics> results(views.size());
+	ParallelFor(views.size(), threadCount, [&](size_t viewIndex)
+	{
+		const Float3 forward = views[viewIndex];
+		const Float3 helper = (fabsf(forward.y) < 0.9f) ? Float3{ 0.0f, 1.0f, 0.0f } : Float3{ 1.0f, 0.0f, 0.0f };
+		Float3 right = Cross(helper, forward);
+		const float rightLength = sqrtf(Dot(right, right));
+		right = { right.x / rightLength, right.y / rightLength, right.z / rightLength };
+		const Float3 up = Cross(forward, right);
+
+		const float scale = 0.5f * resolution / radius;
+		const float offset = 0.5f * resolution;
+
+		std::vector<float> depth(static_cast<size_t>(resolution) * resolution, std::numeric_limits<float>::infinity());
+		uint64_t shaded = 0;
+
+		for (size_t i = 0; i + 2 < indexCount; i += 3)
+		{
+			const MeshFloat3& p0 = vertices[indices[i + 0]].Position;
+			const MeshFloat3& p1 = vertices[indices[i + 1]].Position;
+			const MeshFloat3& p2 = vertices[indices[i + 2]].Position;
+
+			// Back-face culling, as with the default rasterizer state
+			if (Dot(FaceNormal(p0, p1, p2), forward) >= 0.0f)
+			{
+				continue;
+			}
+
+			RasterVertex raster[3];
+			const MeshFloat3* corners[3] = { &p0, &p1, &p2 };
+			for (int k = 0; k < 3; k++)
+			{
+				const Float3 local = Subtract(*corners[k], center);
+				raster[k] = { Dot(local, right) * scale + offset, Dot(local, up) * scale + offset, Dot(local, forward) };
+			}
+			RasterizeTriangle(raster[0], raster[1], raster[2], resolution, depth, shaded);
+		}
+
+		OverdrawStatistics& result = results[viewIndex];
+		result.PixelsShaded = shaded;
+		result.PixelsCovered = std::count_if(depth.begin(), depth.end(), [](float z) { return z != std::numeric_limits<float>::infinity(); });
+	});
+
+	for (const OverdrawStatistics& result : results)
+	{
+		stats.PixelsCovered += result.PixelsCovered;
+		stats.PixelsShaded += result.PixelsShaded;
+	}
+	stats.Overdraw = stats.PixelsCovered ? static_cast<float>(stats.PixelsShaded) / static_cast<float>(stats.PixelsCovered) : 0.0f;
+	return stats;
+}
+
+void OptimizeOverdraw(uint32_t* destination, const uint32_t* indices, size_t indexCount,
+	const MeshVertex* vertices, size_t vertexCount, float threshold, unsigned threadCount)
+{
+	const size_t triangleCount = indexCount / 3;
+	if (triangleCount == 0)
+	{
+		return;
+	}
+
+	const std::vector<uint32_t> hard = HardBoundaries(indices, triangleCount, vertexCount);
+	const std::vector<uint32_t> clusters = SoftBoundaries(indices, triangleCount, vertexCount, hard, threshold);
+	const size_t clusterCount = clusters.size();
+
+	// Area weighted centroid and normal of each cluster and of the whole mesh
+	std::vector<Float3> centroids(clusterCount, Float3{ 0.0f, 0.0f, 0.0f });
+	std::vector<Float3> normals(clusterCount, Float3{ 0.0f, 0.0f, 0.0f });
+	std::vector<float> areas(clusterCount, 0.0f);
+	ParallelFor(clusterCount, threadCount, [&](size_t c)
+	{
+		const size_t start = clusters[c];
+		const size_t end = (c + 1 < clusterCount) ? clusters[c + 1] : triangleCount;
+
+		for (size_t t = start; t < end; t++)
+		{
+			const MeshFloat3& p0 = vertices[indices[t * 3 + 0]].Position;
+			const MeshFloat3& p1 = vertices[indices[t * 3 + 1]].Position;
+			const MeshFloat3& p2 = vertices[indices[t * 3 + 2]].Position;
+
+			const Float3 normal = FaceNormal(p0, p1, p2);
+			const float area = sqrtf(Dot(normal, normal));
+
+			centroids[c].x += (p0.x + p1.x + p2.x) * area;
+			centroids[c].y += (p0.y + p1.y + p2.y) * area;
+			centroids[c].z += (p0.z + p1.z + p2.z) * area;
+			normals[c].x += normal.x;
+			normals[c].y += normal.y;
+			normals[c].z += normal.z;
+			areas[c] += area;
+		}
+	});
+
+	// Summed in cluster order so the result does not depend on the thread count
+	Float3 meshCentroid = { 0.0f, 0.0f, 0.0f };
+	float meshArea = 0.0f;
+	for (size_t c = 0; c < clusterCount; c++)
+	{
+		meshCentroid.x += centroids[c].x;
+		meshCentroid.y += centroids[c].y;
+		meshCentroid.z += centroids[c].z;
+		meshArea += areas[c];
+
+		const float invArea = (areas[c] == 0.0f) ? 0.0f : 1.0f / (3.0f * areas[c]);
+		centroids[c] = { centroids[c].x * invArea, centroids[c].y * invArea, centroids[c].z * invArea };
+	}
+
+	const float invMeshArea = (meshArea == 0.0f) ? 0.0f : 1.0f / (3.0f * meshArea);
+	meshCentroid = { meshCentroid.x * invMeshArea, meshCentroid.y * invMeshArea, meshCentroid.z * invMeshArea };
+
+	// Clusters that face away from the centre of the mesh are likely to occlude the rest
+	std::vector<float> keys(clusterCount);
+	for (size_t c = 0; c < clusterCount; c++)
+	{
+		const Float3 outward = { centroids[c].x - meshCentroid.x, centroids[c].y - meshCentroid.y, centroids[c].z - meshCentroid.z };
+		const float normalLength = sqrtf(Dot(normals[c], normals[c]));
+		keys[c] = (normalLength == 0.0f) ? 0.0f : Dot(outward, normals[c]) / normalLength;
+	}
+
+	std::vector<uint32_t> order(clusterCount);
+	std::iota(order.begin(), order.end(), 0);
+	std::stable_sort(order.begin(), order.end(), [&](uint32_t a, uint32_t b) { return keys[a] > keys[b]; });
+
+	size_t out = 0;
+	for (uint32_t c : order)
+	{
+		const size_t start = clusters[c];
+		const size_t end = (c + 1 < clusterCount) ? clusters[c + 1] : triangleCount;
+		std::copy(indices + start * 3, indices + end * 3, destination + out);
+		out += (end - start) * 3;
+	}
+}
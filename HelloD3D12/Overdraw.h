@@ -0,0 +1,32 @@
+#pragma once
+#include "Mesh.h"
+#include <cstddef>
+#include <cstdint>
+
+// Allowed ACMR regression of the overdraw pass (1.05 = at most 5% worse)
+const float DefaultOverdrawThreshold = 1.05f;
+
+// Side of the square views AnalyzeOverdraw rasterises
+const uint32_t DefaultOverdrawResolution = 256;
+
+struct OverdrawStatistics
+{
+	uint64_t PixelsCovered = 0;
+	uint64_t PixelsShaded = 0;
+	// Shaded fragments per covered pixel (1.0 is ideal)
+	float Overdraw = 0.0f;
+};
+
+// Estimates overdraw by rasterising the triangle list in submission order with back-face
+// culling and a less-than depth test from a set of fixed view directions around the mesh.
+// The views are rasterised on up to threadCount threads (0 picks one per core).
+OverdrawStatistics AnalyzeOverdraw(const uint32_t* indices, size_t indexCount,
+	const MeshVertex* vertices, size_t vertexCount, uint32_t resolution = DefaultOverdrawResolution, unsigned threadCount = 0);
+
+// Splits a vertex cache optimised triangle list into clusters and sorts the clusters so
+// outward facing geometry is drawn first (Sander et al., "Fast Triangle Reordering for
+// Vertex Locality and Reduced Overdraw"). threshold bounds the ACMR regression of the
+// soft cluster splits. The clusters are measured on up to threadCount threads (0 picks one
+// per core). destination must not alias indices.
+void OptimizeOverdraw(uint32_t* destination, const uint32_t* indices, size_t indexCount,
+	const MeshVertex* vertices, size_t vertexCount, float threshold = DefaultOverdrawThreshold, unsigned threadCount = 0);
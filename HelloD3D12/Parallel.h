@@ -0,0 +1,53 @@
+#pragma once
+#include <algorithm>
+#include <atomic>
+#include <cstddef>
+#include <thread>
+#include <vector>
+
+inline unsigned DefaultThreadCount()
+{
+	return std::max(1u, std::thread::hardware_concurrency());
+}
+
+// Runs fn(i) for every i in [0, count) on up to threadCount threads
+// (0 picks one per core). The calling thread takes part in the work.
+template<typename Fn>
+void ParallelFor(size_t count, unsigned threadCount, Fn&& fn)
+{
+	if (threadCount == 0)
+	{
+		threadCount = DefaultThreadCount();
+	}
+	threadCount = static_cast<unsigned>(std::min<size_t>(threadCount, count));
+
+	if (threadCount <= 1)
+	{
+		for (size_t i = 0; i < count; i++)
+		{
+			fn(i);
+		}
+		return;
+	}
+
+	std::atomic<size_t> next(0);
+	auto worker = [&]()
+	{
+		for (size_t i = next.fetch_add(1); i < count; i = next.fetch_add(1))
+		{
+			fn(i);
+		}
+	};
+
+	std::vector<std::thread> threads;
+	threads.reserve(threadCount - 1);
+	for (unsigned t = 1; t < threadCount; t++)
+	{
+		threads.emplace_back(worker);
+	}
+	worker();
+	for (std::thread& thread : threads)
+	{
+		thread.join();
+	}
+}
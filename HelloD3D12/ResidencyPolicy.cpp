@@ -0,0 +1,194 @@
+#include "ResidencyPolicy.h"
+#include <algorithm>
+
+uint32_t ResidencyPolicy::AddTexture(uint32_t mipCount, const uint64_t* mipBytes, uint32_t tailMip, uint32_t priority)
+{
+	mipCount = std::max(mipCount, 1u);
+
+	TextureState texture;
+	texture.MipCount = mipCount;
+	texture.TailMip = std::min(tailMip, mipCount - 1);
+	texture.BaseMip = 0;
+	texture.WantedMip = 0;
+	texture.Priority = priority;
+	texture.LastUsedFrame = 0;
+	texture.FirstBytes = static_cast<uint32_t>(m_BytesFrom.size());
+
+	m_BytesFrom.resize(m_BytesFrom.size() + mipCount + 1);
+	uint64_t* bytesFrom = m_BytesFrom.data() + texture.FirstBytes;
+	bytesFrom[mipCount] = 0;
+	for (uint32_t mip = mipCount; mip-- > 0;)
+	{
+		bytesFrom[mip] = bytesFrom[mip + 1] + mipBytes[mip];
+	}
+	m_ResidentBytes += bytesFrom[0];
+
+	m_Textures.push_back(texture);
+	return static_cast<uint32_t>(m_Textures.size() - 1);
+}
+
+void ResidencyPolicy::Touch(uint32_t texture, uint64_t frame, uint32_t wantedMip)
+{
+	TextureState& state = m_Textures[texture];
+	wantedMip = std::min(wantedMip, state.MipCount - 1);
+	state.WantedMip = (state.LastUsedFrame == frame) ? std::min(state.WantedMip, wantedMip) : wantedMip;
+	state.LastUsedFrame = frame;
+}
+
+void ResidencyPolicy::SetBase(uint32_t texture, uint32_t base)
+{
+	TextureState& state = m_Textures[texture];
+	m_ResidentBytes -= BytesFrom(state, state.BaseMip);
+	m_ResidentBytes += BytesFrom(state, base);
+	if (base > state.BaseMip)
+	{
+		m_DemotedMips += base - state.BaseMip;
+	}
+	else
+	{
+		m_PromotedMips += state.BaseMip - base;
+	}
+	state.BaseMip = base;
+}
+
+void ResidencyPolicy::Update(uint64_t frame, std::vector<ResidencyChange>& changes)
+{
+	changes.clear();
+	m_PreviousBase.resize(m_Textures.size());
+	for (size_t i = 0; i < m_Textures.size(); i++)
+	{
+		m_PreviousBase[i] = m_Textures[i].BaseMip;
+	}
+
+	// Room for what the textures in use are missing is made first
+	uint64_t wanted = 0;
+	for (const TextureState& texture : m_Textures)
+	{
+		if (texture.LastUsedFrame == frame && TargetMip(texture) < texture.BaseMip)
+		{
+			wanted += BytesFrom(texture, TargetMip(texture)) - BytesFrom(texture, texture.BaseMip);
+		}
+	}
+	const uint64_t target = (m_Budget > wanted) ? m_Budget - wanted : 0;
+
+	if (m_ResidentBytes > target)
+	{
+		m_Candidates.clear();
+		for (uint32_t i = 0; i < m_Textures.size(); i++)
+		{
+			if (m_Textures[i].LastUsedFrame != frame && m_Textures[i].BaseMip < m_Textures[i].MipCount)
+			{
+				m_Candidates.push_back(i);
+			}
+		}
+		std::stable_sort(m_Candidates.begin(), m_Candidates.end(), [&](uint32_t a, uint32_t b)
+		{
+			const TextureState& ta = m_Textures[a];
+			const TextureState& tb = m_Textures[b];
+			return (ta.Priority != tb.Priority) ? ta.Priority < tb.Priority : ta.LastUsedFrame < tb.LastUsedFrame;
+		});
+
+		// Stale textures go entirely; the others give up detail before anything is evicted
+		for (uint32_t i : m_Candidates)
+		{
+			TextureState& texture = m_Textures[i];
+			if (m_ResidentBytes <= target)
+			{
+				break;
+			}
+			if (frame - texture.LastUsedFrame >= m_EvictAfterFrames)
+			{
+				SetBase(i, texture.MipCount);
+				continue;
+			}
+			while (texture.BaseMip < texture.TailMip && m_ResidentBytes > target)
+			{
+				SetBase(i, texture.BaseMip + 1);
+			}
+		}
+		for (uint32_t i : m_Candidates)
+		{
+			if (m_ResidentBytes <= target)
+			{
+				break;
+			}
+			SetBase(i, m_Textures[i].MipCount);
+		}
+	}
+
+	// Raise the textures in use a mip per round, most important first, while they fit
+	m_Candidates.clear();
+	for (uint32_t i = 0; i < m_Textures.size(); i++)
+	{
+		if (m_Textures[i].LastUsedFrame == frame && TargetMip(m_Textures[i]) < m_Textures[i].BaseMip)
+		{
+			m_Candidates.push_back(i);
+		}
+	}
+	std::stable_sort(m_Candidates.begin(), m_Candidates.end(), [&](uint32_t a, uint32_t b)
+	{
+		return m_Textures[a].Priority > m_Textures[b].Priority;
+	});
+	while (!m_Candidates.empty())
+	{
+		size_t kept = 0;
+		for (uint32_t i : m_Candidates)
+		{
+			const TextureState& texture = m_Textures[i];
+			// An evicted texture comes back with its tail first
+			const uint32_t base = (texture.BaseMip == texture.MipCount) ? texture.TailMip : texture.BaseMip - 1;
+			if (m_ResidentBytes + BytesFrom(texture, base) - BytesFrom(texture, texture.BaseMip) > m_Budget)
+			{
+				continue;
+			}
+			SetBase(i, base);
+			if (base > TargetMip(texture))
+			{
+				m_Candidates[kept++] = i;
+			}
+		}
+		m_Candidates.resize(kept);
+	}
+
+	// Still over only when the textures in use do not fit by themselves
+	if (m_ResidentBytes > m_Budget)
+	{
+		m_Candidates.clear();
+		for (uint32_t i = 0; i < m_Textures.size(); i++)
+		{
+			if (m_Textures[i].BaseMip < m_Textures[i].TailMip)
+			{
+				m_Candidates.push_back(i);
+			}
+		}
+		std::stable_sort(m_Candidates.begin(), m_Candidates.end(), [&](uint32_t a, uint32_t b)
+		{
+			return m_Textures[a].Priority < m_Textures[b].Priority;
+		});
+		while (!m_Candidates.empty() && m_ResidentBytes > m_Budget)
+		{
+			size_t kept = 0;
+			for (uint32_t i : m_Candidates)
+			{
+				if (m_ResidentBytes <= m_Budget)
+				{
+					break;
+				}
+				SetBase(i, m_Textures[i].BaseMip + 1);
+				if (m_Textures[i].BaseMip < m_Textures[i].TailMip)
+				{
+					m_Candidates[kept++] = i;
+				}
+			}
+			m_Candidates.resize(kept);
+		}
+	}
+
+	for (uint32_t i = 0; i < m_Textures.size(); i++)
+	{
+		if (m_Textures[i].BaseMip != m_PreviousBase[i])
+		{
+			changes.push_back({ i, m_Textures[i].BaseMip });
+		}
+	}
+}
@@ -0,0 +1,85 @@
+#pragma once
+#include <cstdint>
+#include <vector>
+
+// A texture whose base mip moved: mips more detailed than BaseMip should be dropped,
+// and BaseMip == MipCount means nothing of it is kept at all
+struct ResidencyChange
+{
+	uint32_t Texture;
+	uint32_t BaseMip;
+};
+
+// Keeps the memory of a set of textures within a budget. Each texture has a base mip,
+// the most detailed level it keeps memory for. While over budget, textures not used
+// this frame are demoted a mip at a time, or evicted once unused for long enough,
+// lowest priority and least recently used first; textures used this frame are raised
+// back toward the mip they asked for as far as the budget allows. Nothing here touches
+// the GPU: the caller applies the changes and feeds in the budget.
+class ResidencyPolicy
+{
+public:
+	static const uint64_t DefaultEvictAfterFrames = 300;
+
+	// mipBytes holds the memory of every mip. Mips tailMip and below are kept or dropped
+	// together, as a block-compressed texture cannot shrink below a 4x4 top level.
+	// Textures start with every mip; higher priorities are reclaimed last.
+	uint32_t AddTexture(uint32_t mipCount, const uint64_t* mipBytes, uint32_t tailMip, uint32_t priority = 0);
+
+	inline void SetBudget(uint64_t bytes) { m_Budget = bytes; }
+	// Textures unused for this many frames are evicted rather than demoted
+	inline void SetEvictAfterFrames(uint64_t frames) { m_EvictAfterFrames = frames; }
+	inline void SetPriority(uint32_t texture, uint32_t priority) { m_Textures[texture].Priority = priority; }
+
+	// Records that the texture is used in frame and needs mips down to wantedMip there
+	void Touch(uint32_t texture, uint64_t frame, uint32_t wantedMip = 0);
+
+	// Moves base mips for frame and reports the textures changed. Textures used this frame
+	// are only demoted when they alone exceed the budget, and are never evicted.
+	void Update(uint64_t frame, std::vector<ResidencyChange>& changes);
+
+	inline uint32_t TextureCount() const { return static_cast<uint32_t>(m_Textures.size()); }
+	inline uint32_t MipCount(uint32_t texture) const { return m_Textures[texture].MipCount; }
+	inline uint32_t BaseMip(uint32_t texture) const { return m_Textures[texture].BaseMip; }
+	inline bool IsEvicted(uint32_t texture) const { return m_Textures[texture].BaseMip == m_Textures[texture].MipCount; }
+	inline uint64_t LastUsedFrame(uint32_t texture) const { return m_Textures[texture].LastUsedFrame; }
+	inline uint64_t Budget() const { return m_Budget; }
+	inline uint64_t ResidentBytes() const { return m_ResidentBytes; }
+	// Mips dropped and brought back so far; both growing together means the budget thrashes
+	inline uint64_t DemotedMips() const { return m_DemotedMips; }
+	inline uint64_t PromotedMips() const { return m_PromotedMips; }
+
+private:
+	struct TextureState
+	{
+		uint32_t MipCount;
+		uint32_t TailMip;
+		uint32_t BaseMip;
+		uint32_t WantedMip;
+		uint32_t Priority;
+		uint64_t LastUsedFrame;
+		// Offset of the texture's MipCount + 1 suffix sums in m_BytesFrom
+		uint32_t FirstBytes;
+	};
+
+	// Memory of the mips from base on
+	inline uint64_t BytesFrom(const TextureState& texture, uint32_t base) const { return m_BytesFrom[texture.FirstBytes + base]; }
+	// Base mip the texture would like: as wanted, but not inside its tail
+	static inline uint32_t TargetMip(const TextureState& texture)
+	{
+		return texture.WantedMip < texture.TailMip ? texture.WantedMip : texture.TailMip;
+	}
+	void SetBase(uint32_t texture, uint32_t base);
+
+	std::vector<TextureState> m_Textures;
+	std::vector<uint64_t> m_BytesFrom;
+	uint64_t m_Budget = UINT64_MAX;
+	uint64_t m_EvictAfterFrames = DefaultEvictAfterFrames;
+	uint64_t m_ResidentBytes = 0;
+	uint64_t m_DemotedMips = 0;
+	uint64_t m_PromotedMips = 0;
+
+	// Scratch kept between updates to avoid reallocating
+	std::vector<uint32_t> m_PreviousBase;
+	std::vector<uint32_t> m_Candidates;
+};
@@ -0,0 +1,33 @@
+#include "ScratchArena.h"
+#include <algorithm>
+
+ScratchArena::ScratchArena(void* memory, size_t size)
+	: m_Memory(static_cast<uint8_t*>(memory)), m_Capacity(size)
+{
+}
+
+ScratchArena::ScratchArena(size_t size)
+	: m_Owned(new uint8_t[size]), m_Memory(m_Owned.get()), m_Capacity(size)
+{
+}
+
+void* ScratchArena::Allocate(size_t size, size_t alignment)
+{
+	// Align the address rather than the offset, as caller memory may start anywhere
+	const uintptr_t base = reinterpret_cast<uintptr_t>(m_Memory);
+	const uintptr_t start = (base + m_Used + alignment - 1) & ~static_cast<uintptr_t>(alignment - 1);
+	const size_t offset = static_cast<size_t>(start - base);
+	if (offset > m_Capacity || size > m_Capacity - offset)
+	{
+		return nullptr;
+	}
+	m_Used = offset + size;
+	m_HighWater = std::max(m_HighWater, m_Used);
+	return m_Memory + offset;
+}
+
+ScratchArena& ThreadScratchArena()
+{
+	thread_local ScratchArena arena(ThreadScratchBytes);
+	return arena;
+}
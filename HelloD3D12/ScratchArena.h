@@ -0,0 +1,63 @@
+#pragma once
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+
+// Bump allocator over a fixed block, for arrays that only live while one texture is
+// uploaded or one frame is recorded. It never touches the heap after construction: an
+// allocation that does not fit returns null and the caller finds another way. Memory is
+// handed out unconstructed, so it suits trivial types only.
+class ScratchArena
+{
+public:
+	// Frees everything allocated after it was made once it goes out of scope
+	class Scope
+	{
+	public:
+		explicit Scope(ScratchArena& arena) : m_Arena(arena), m_Used(arena.m_Used) {}
+		~Scope() { m_Arena.m_Used = m_Used; }
+
+		Scope(const Scope&) = delete;
+		Scope& operator=(const Scope&) = delete;
+
+	private:
+		ScratchArena& m_Arena;
+		size_t m_Used;
+	};
+
+	// Over caller memory, such as a buffer on the stack
+	ScratchArena(void* memory, size_t size);
+	// Over a block of its own, allocated once here
+	explicit ScratchArena(size_t size);
+
+	ScratchArena(const ScratchArena&) = delete;
+	ScratchArena& operator=(const ScratchArena&) = delete;
+
+	// alignment must be a power of two
+	void* Allocate(size_t size, size_t alignment);
+
+	template <typename T>
+	inline T* Allocate(size_t count)
+	{
+		return (count <= SIZE_MAX / sizeof(T)) ? static_cast<T*>(Allocate(count * sizeof(T), alignof(T))) : nullptr;
+	}
+
+	inline void Reset() { m_Used = 0; }
+	inline size_t Used() const { return m_Used; }
+	inline size_t Capacity() const { return m_Capacity; }
+	// Most ever in use at once, to size the block
+	inline size_t HighWater() const { return m_HighWater; }
+
+private:
+	std::unique_ptr<uint8_t[]> m_Owned;
+	uint8_t* m_Memory;
+	size_t m_Capacity;
+	size_t m_Used = 0;
+	size_t m_HighWater = 0;
+};
+
+// Enough for the footprints of a few thousand subresources
+const size_t ThreadScratchBytes = 256 * 1024;
+
+// The calling thread's arena of ThreadScratchBytes, made the first time it asks
+ScratchArena& ThreadScratchArena();
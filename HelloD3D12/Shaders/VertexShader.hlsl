@@ -1,5 +1,10 @@
 #define MaxLights 16
 
+// Set by Graphics::CompileShaders to match the input layout
+#ifndef COMPRESSED_VERTICES
+#define COMPRESSED_VERTICES 0
+#endif
+
 struct Light
 {
 	float3 Strength; // Light colour
@@ -14,6 +19,9 @@ cbuffer ConstantBuffer : register(b0)
 {
 	matrix gWorld;
 	matrix gTexTransform;
+	// Position dequantization: posL = gPositionOffset + unorm * gPositionScale
+	float4 gPositionScale;
+	float4 gPositionOffset;
 };
 
 cbuffer cbMaterial : register(b1)
@@ -44,12 +52,22 @@ cbuffer cbPass : register (b2)
 	Light gLights[MaxLights];
 }
 
+#if COMPRESSED_VERTICES
+// PackedVertex (VertexCompression.h)
+struct VSInput
+{
+	float4 PosQ : POSITION; // R16G16B16A16_UNORM
+	float2 NormalOct : NORMAL; // R16G16_SNORM
+	float2 TexC : TEXCOORD; // R16G16_FLOAT
+};
+#else
 struct VSInput
 {
 	float3 PosL : POSITION;
 	float3 NormalL : NORMAL;
 	float2 TexC : TEXCOORD;
 };
+#endif
 
 struct VSOutput
 {
@@ -59,17 +77,34 @@ struct VSOutput
 	float2 TexC : TEXCOORD;
 };
 
+// Same arithmetic as DecodeOctahedral in VertexCompression.cpp
+float3 DecodeOctahedral(float2 e)
+{
+	float3 n = float3(e, 1.0f - abs(e.x) - abs(e.y));
+	float t = saturate(-n.z);
+	n.xy += (n.xy >= 0.0f) ? -t : t;
+	return normalize(n);
+}
+
 VSOutput main(VSInput vsInput)
 {
 	VSOutput vsOut = (VSOutput)0.0f;
 
+#if COMPRESSED_VERTICES
+	float3 posL = gPositionOffset.xyz + vsInput.PosQ.xyz * gPositionScale.xyz;
+	float3 normalL = DecodeOctahedral(vsInput.NormalOct);
+#else
+	float3 posL = vsInput.PosL;
+	float3 normalL = vsInput.NormalL;
+#endif
+
 	// Transform to world space.
-	float4 posW = mul(float4(vsInput.PosL, 1.0f), gWorld);
+	float4 posW = mul(float4(posL, 1.0f), gWorld);
 	vsOut.PosW = posW.xyz;
 
 	// Assumes nonuniform scaling; otherwise, need to 
 	// use inverse-transpose of world matrix.
-	vsOut.NormalW = mul(vsInput.NormalL, (float3x3)gWorld);
+	vsOut.NormalW = mul(normalL, (float3x3)gWorld);
 
 	// Output vertex attributes for interpolation across triangle
 //	float4 texC = mul(float4(vsInput.TexC, 0.0f, 1.0f), gTexTransform);
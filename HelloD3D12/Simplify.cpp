@@ -0,0 +1,668 @@
+#include "Simplify.h"
+#include "Parallel.h"
+#include "VertexCache.h"
+#include <algorithm>
+#include <cmath>
+#include <cstring>
+#include <limits>
+#include <unordered_map>
+#include <vector>
+
+namespace
+{
+	// Collapses that turn a triangle's normal by more than ~84 degrees are rejected
+	const float MinFlipCosine = 0.1f;
+
+	struct Double3
+	{
+		double x, y, z;
+	};
+
+	inline Double3 Subtract(const Double3& a, const Double3& b) { return { a.x - b.x, a.y - b.y, a.z - b.z }; }
+	inline Double3 Cross(const Double3& a, const Double3& b) { return { a.y * b.z - a.z * b.y, a.z * b.x - a.x * b.z, a.x * b.y - a.y * b.x }; }
+	inline double Dot(const Double3& a, const Double3& b) { return a.x * b.x + a.y * b.y + a.z * b.z; }
+
+	// Sum of squared distances to a set of area weighted planes:
+	// E(p) = p'Ap + 2b'p + c, with the total weight kept to turn it into a mean
+	struct Quadric
+	{
+		double a00 = 0, a01 = 0, a02 = 0, a11 = 0, a12 = 0, a22 = 0;
+		double b0 = 0, b1 = 0, b2 = 0;
+		double c = 0;
+		double w = 0;
+
+		void AddPlane(const Double3& n, double d, double weight)
+		{
+			a00 += weight * n.x * n.x; a01 += weight * n.x * n.y; a02 += weight * n.x * n.z;
+			a11 += weight * n.y * n.y; a12 += weight * n.y * n.z; a22 += weight * n.z * n.z;
+			b0 += weight * n.x * d; b1 += weight * n.y * d; b2 += weight * n.z * d;
+			c += weight * d * d;
+			w += weight;
+		}
+
+		void Add(const Quadric& q)
+		{
+			a00 += q.a00; a01 += q.a01; a02 += q.a02; a11 += q.a11; a12 += q.a12; a22 += q.a22;
+			b0 += q.b0; b1 += q.b1; b2 += q.b2;
+			c += q.c;
+			w += q.w;
+		}
+
+		double Evaluate(const Double3& p) const
+		{
+			const double rx = a00 * p.x + a01 * p.y + a02 * p.z;
+			const double ry = a01 * p.x + a11 * p.y + a12 * p.z;
+			const double rz = a02 * p.x + a12 * p.y + a22 * p.z;
+			const double e = rx * p.x + ry * p.y + rz * p.z + 2.0 * (b0 * p.x + b1 * p.y + b2 * p.z) + c;
+			return std::max(e, 0.0);
+		}
+	};
+
+	struct Collapse
+	{
+		double Cost;
+		uint32_t From;
+		uint32_t To;
+	};
+
+	inline uint64_t EdgeKey(uint32_t a, uint32_t b)
+	{
+		return (static_cast<uint64_t>(std::min(a, b)) << 32) | std::max(a, b);
+	}
+
+	struct PositionHash
+	{
+		size_t operator()(const MeshFloat3& p) const
+		{
+			uint32_t bits[3];
+			static_assert(sizeof(bits) == sizeof(MeshFloat3), "MeshFloat3 must be three floats");
+			memcpy(bits, &p, sizeof(bits));
+			return (bits[0] * 73856093u) ^ (bits[1] * 19349663u) ^ (bits[2] * 83492791u);
+		}
+	};
+
+	struct PositionEqual
+	{
+		bool operator()(const MeshFloat3& a, const MeshFloat3& b) const
+		{
+			return a.x == b.x && a.y == b.y && a.z == b.z;
+		}
+	};
+
+	// Closest point on triangle abc to p (Ericson, Real-Time Collision Detection 5.1.5)
+	Double3 ClosestPointOnTriangle(const Double3& p, const Double3& a, const Double3& b, const Double3& c)
+	{
+		const Double3 ab = Subtract(b, a), ac = Subtract(c, a), ap = Subtract(p, a);
+		const double d1 = Dot(ab, ap), d2 = Dot(ac, ap);
+		if (d1 <= 0.0 && d2 <= 0.0)
+		{
+			return a;
+		}
+		const Double3 bp = Subtract(p, b);
+		const double d3 = Dot(ab, bp), d4 = Dot(ac, bp);
+		if (d3 >= 0.0 && d4 <= d3)
+		{
+			return b;
+		}
+		const double vc = d1 * d4 - d3 * d2;
+		if (vc <= 0.0 && d1 >= 0.0 && d3 <= 0.0)
+		{
+			const double t = d1 / (d1 - d3);
+			return { a.x + ab.x * t, a.y + ab.y * t, a.z + ab.z * t };
+		}
+		const Double3 cp = Subtract(p, c);
+		const double d5 = Dot(ab, cp), d6 = Dot(ac, cp);
+		if (d6 >= 0.0 && d5 <= d6)
+		{
+			return c;
+		}
+		const double vb = d5 * d2 - d1 * d6;
+		if (vb <= 0.0 && d2 >= 0.0 && d6 <= 0.0)
+		{
+			const double t = d2 / (d2 - d6);
+			return { a.x + ac.x * t, a.y + ac.y * t, a.z + ac.z * t };
+		}
+		const double va = d3 * d6 - d5 * d4;
+		if (va <= 0.0 && (d4 - d3) >= 0.0 && (d5 - d6) >= 0.0)
+		{
+			const double t = (d4 - d3) / ((d4 - d3) + (d5 - d6));
+			return { b.x + (c.x - b.x) * t, b.y + (c.y - b.y) * t, b.z + (c.z - b.z) * t };
+		}
+		const double denom = 1.0 / (va + vb + vc);
+		const double v = vb * denom, w = vc * denom;
+		return { a.x + ab.x * v + ac.x * w, a.y + ab.y * v + ac.y * w, a.z + ab.z * v + ac.z * w };
+	}
+
+	// The source triangles bucketed by bounding box in a uniform grid over the unit cube
+	// the simplifier works in
+	class SurfaceGrid
+	{
+	public:
+		SurfaceGrid(const uint32_t* indices, size_t indexCount, const std::vector<Double3>& positions)
+			: m_Indices(indices), m_Positions(positions)
+		{
+			const size_t triangleCount = indexCount / 3;
+			m_Resolution = std::min(std::max(static_cast<int>(2.0 * cbrt(static_cast<double>(triangleCount))), 1), 128);
+			m_Offsets.assign(static_cast<size_t>(m_Resolution) * m_Resolution * m_Resolution + 1, 0);
+
+			for (int pass = 0; pass < 2; pass++)
+			{
+				std::vector<uint32_t> cursor;
+				if (pass == 1)
+				{
+					for (size_t c = 1; c < m_Offsets.size(); c++)
+					{
+						m_Offsets[c] += m_Offsets[c - 1];
+					}
+					m_Triangles.resize(m_Offsets.back());
+					cursor.assign(m_Offsets.begin(), m_Offsets.end() - 1);
+				}
+				for (size_t t = 0; t < triangleCount; t++)
+				{
+					const Double3& a = positions[indices[t * 3 + 0]];
+					const Double3& b = positions[indices[t * 3 + 1]];
+					const Double3& c = positions[indices[t * 3 + 2]];
+					int lo[3], hi[3];
+					Cell({ std::min({ a.x, b.x, c.x }), std::min({ a.y, b.y, c.y }), std::min({ a.z, b.z, c.z }) }, lo);
+					Cell({ std::max({ a.x, b.x, c.x }), std::max({ a.y, b.y, c.y }), std::max({ a.z, b.z, c.z }) }, hi);
+					for (int z = lo[2]; z <= hi[2]; z++)
+					{
+						for (int y = lo[1]; y <= hi[1]; y++)
+						{
+							for (int x = lo[0]; x <= hi[0]; x++)
+							{
+								const size_t cell = CellIndex(x, y, z);
+								if (pass == 0)
+								{
+									m_Offsets[cell + 1]++;
+								}
+								else
+								{
+									m_Triangles[cursor[cell]++] = static_cast<uint32_t>(t);
+								}
+							}
+						}
+					}
+				}
+			}
+		}
+
+		// True if some triangle is within maxDistance of p. The cell holding p usually has one.
+		bool Within(const Double3& p, double maxDistance) const
+		{
+			const double maxDistanceSq = maxDistance * maxDistance;
+			return NearestSq(p, 0.0, maxDistanceSq) <= maxDistanceSq || NearestSq(p, maxDistance, maxDistanceSq) <= maxDistanceSq;
+		}
+
+		// Distance from p to the nearest triangle if that is within maxDistance, otherwise
+		// something larger than maxDistance
+		double Distance(const Double3& p, double maxDistance) const
+		{
+			return sqrt(NearestSq(p, maxDistance, 0.0));
+		}
+
+	private:
+		// Smallest squared distance from p to the triangles in the cells within radius of it,
+		// stopping at the first one within sqrt(stopSq)
+		double NearestSq(const Double3& p, double radius, double stopSq) const
+		{
+			int lo[3], hi[3];
+			Cell({ p.x - radius, p.y - radius, p.z - radius }, lo);
+			Cell({ p.x + radius, p.y + radius, p.z + radius }, hi);
+			double nearestSq = std::numeric_limits<double>::infinity();
+			for (int z = lo[2]; z <= hi[2]; z++)
+			{
+				for (int y = lo[1]; y <= hi[1]; y++)
+				{
+					for (int x = lo[0]; x <= hi[0]; x++)
+					{
+						const size_t cell = CellIndex(x, y, z);
+						for (uint32_t i = m_Offsets[cell]; i < m_Offsets[cell + 1]; i++)
+						{
+							const uint32_t* tri = &m_Indices[m_Triangles[i] * 3];
+							const Double3 d = Subtract(p, ClosestPointOnTriangle(p, m_Positions[tri[0]], m_Positions[tri[1]], m_Positions[tri[2]]));
+							nearestSq = std::min(nearestSq, Dot(d, d));
+							if (nearestSq <= stopSq)
+							{
+								return nearestSq;
+							}
+						}
+					}
+				}
+			}
+			return nearestSq;
+		}
+
+		void Cell(const Double3& p, int cell[3]) const
+		{
+			const double c[3] = { p.x, p.y, p.z };
+			for (int k = 0; k < 3; k++)
+			{
+				cell[k] = std::min(std::max(static_cast<int>(floor(c[k] * m_Resolution)), 0), m_Resolution - 1);
+			}
+		}
+
+		size_t CellIndex(int x, int y, int z) const
+		{
+			return (static_cast<size_t>(z) * m_Resolution + y) * m_Resolution + x;
+		}
+
+		const uint32_t* m_Indices;
+		const std::vector<Double3>& m_Positions;
+		int m_Resolution;
+		std::vector<uint32_t> m_Offsets;
+		std::vector<uint32_t> m_Triangles;
+	};
+
+	// Largest distance from the edge midpoints and centroids of the simplified triangles to
+	// the source surface, starting from a known bound. The corners are source vertices.
+	double MeasureSurfaceDistance(const SurfaceGrid& source, const uint32_t* indices, size_t indexCount,
+		const std::vector<Double3>& positions, double bound)
+	{
+		for (size_t i = 0; i < indexCount; i += 3)
+		{
+			const Double3& a = positions[indices[i + 0]];
+			const Double3& b = positions[indices[i + 1]];
+			const Double3& c = positions[indices[i + 2]];
+			const Double3 samples[4] =
+			{
+				{ (a.x + b.x) * 0.5, (a.y + b.y) * 0.5, (a.z + b.z) * 0.5 },
+				{ (b.x + c.x) * 0.5, (b.y + c.y) * 0.5, (b.z + c.z) * 0.5 },
+				{ (c.x + a.x) * 0.5, (c.y + a.y) * 0.5, (c.z + a.z) * 0.5 },
+				{ (a.x + b.x + c.x) / 3.0, (a.y + b.y + c.y) / 3.0, (a.z + b.z + c.z) / 3.0 },
+			};
+			for (const Double3& p : samples)
+			{
+				if (source.Within(p, bound))
+				{
+					continue;
+				}
+				// Widen the search until it finds the nearest triangle
+				double radius = std::max(bound, 1.0 / 1024.0);
+				double distance = source.Distance(p, radius);
+				while (distance > radius)
+				{
+					radius *= 2.0;
+					distance = source.Distance(p, radius);
+				}
+				bound = std::max(bound, distance);
+			}
+		}
+		return bound;
+	}
+
+	// Vertices on open or non-manifold edges, and vertices that share their position with
+	// another vertex (UV or normal seams), must not move
+	std::vector<char> FindLockedVertices(const uint32_t* indices, size_t indexCount, const MeshVertex* vertices, size_t vertexCount)
+	{
+		std::vector<char> locked(vertexCount, 0);
+
+		std::unordered_map<uint64_t, uint32_t> edgeUse;
+		edgeUse.reserve(indexCount);
+		for (size_t i = 0; i < indexCount; i += 3)
+		{
+			for (uint32_t k = 0; k < 3; k++)
+			{
+				edgeUse[EdgeKey(indices[i + k], indices[i + (k + 1) % 3])]++;
+			}
+		}
+		for (const auto& edge : edgeUse)
+		{
+			if (edge.second != 2)
+			{
+				locked[edge.first >> 32] = 1;
+				locked[edge.first & 0xFFFFFFFF] = 1;
+			}
+		}
+
+		std::unordered_map<MeshFloat3, uint32_t, PositionHash, PositionEqual> firstAtPosition;
+		firstAtPosition.reserve(vertexCount);
+		for (uint32_t v = 0; v < vertexCount; v++)
+		{
+			auto inserted = firstAtPosition.emplace(vertices[v].Position, v);
+			if (!inserted.second)
+			{
+				locked[v] = 1;
+				locked[inserted.first->second] = 1;
+			}
+		}
+		return locked;
+	}
+}
+
+size_t SimplifyMesh(uint32_t* destination, const uint32_t* indices, size_t indexCount,
+	const MeshVertex* vertices, size_t vertexCount, const SimplifyOptions& options, float* error)
+{
+	indexCount -= indexCount % 3;
+	if (destination != indices)
+	{
+		std::copy(indices, indices + indexCount, destination);
+	}
+	if (error)
+	{
+		*error = 0.0f;
+	}
+	if (indexCount == 0 || vertexCount == 0)
+	{
+		return indexCount;
+	}
+
+	// Work in a unit-sized space so errors are relative to the mesh extent
+	MeshFloat3 minP = vertices[0].Position;
+	MeshFloat3 maxP = vertices[0].Position;
+	for (size_t v = 1; v < vertexCount; v++)
+	{
+		const MeshFloat3& p = vertices[v].Position;
+		minP = { std::min(minP.x, p.x), std::min(minP.y, p.y), std::min(minP.z, p.z) };
+		maxP = { std::max(maxP.x, p.x), std::max(maxP.y, p.y), std::max(maxP.z, p.z) };
+	}
+	const double extent = std::max({ maxP.x - minP.x, maxP.y - minP.y, maxP.z - minP.z });
+	const double invExtent = (extent > 0.0) ? 1.0 / extent : 1.0;
+
+	std::vector<Double3> positions(vertexCount);
+	for (size_t v = 0; v < vertexCount; v++)
+	{
+		const MeshFloat3& p = vertices[v].Position;
+		positions[v] = { (p.x - minP.x) * invExtent, (p.y - minP.y) * invExtent, (p.z - minP.z) * invExtent };
+	}
+
+	// The error is measured against the source triangles
+	std::vector<uint32_t> sourceIndices;
+	if (error)
+	{
+		sourceIndices.assign(destination, destination + indexCount);
+	}
+
+	std::vector<char> locked(vertexCount, 0);
+	if (options.LockBorder)
+	{
+		locked = FindLockedVertices(destination, indexCount, vertices, vertexCount);
+	}
+
+	std::vector<Quadric> quadrics(vertexCount);
+	for (size_t i = 0; i < indexCount; i += 3)
+	{
+		const uint32_t a = destination[i + 0];
+		const uint32_t b = destination[i + 1];
+		const uint32_t c = destination[i + 2];
+		Double3 n = Cross(Subtract(positions[b], positions[a]), Subtract(positions[c], positions[a]));
+		const double length = sqrt(Dot(n, n));
+		if (length == 0.0)
+		{
+			continue;
+		}
+		n = { n.x / length, n.y / length, n.z / length };
+		const double d = -Dot(n, positions[a]);
+		const double area = 0.5 * length;
+		quadrics[a].AddPlane(n, d, area);
+		quadrics[b].AddPlane(n, d, area);
+		quadrics[c].AddPlane(n, d, area);
+	}
+
+	// Without locking, open edges get a plane perpendicular to the face so borders keep their shape
+	if (!options.LockBorder)
+	{
+		std::unordered_map<uint64_t, uint32_t> edgeUse;
+		edgeUse.reserve(indexCount);
+		for (size_t i = 0; i < indexCount; i += 3)
+		{
+			for (uint32_t k = 0; k < 3; k++)
+			{
+				edgeUse[EdgeKey(destination[i + k], destination[i + (k + 1) % 3])]++;
+			}
+		}
+		for (size_t i = 0; i < indexCount; i += 3)
+		{
+			const Double3 faceNormal = Cross(Subtract(positions[destination[i + 1]], positions[destination[i]]), Subtract(positions[destination[i + 2]], positions[destination[i]]));
+			for (uint32_t k = 0; k < 3; k++)
+			{
+				const uint32_t a = destination[i + k];
+				const uint32_t b = destination[i + (k + 1) % 3];
+				if (edgeUse[EdgeKey(a, b)] != 1)
+				{
+					continue;
+				}
+				const Double3 edge = Subtract(positions[b], positions[a]);
+				Double3 n = Cross(edge, faceNormal);
+				const double length = sqrt(Dot(n, n));
+				if (length == 0.0)
+				{
+					continue;
+				}
+				n = { n.x / length, n.y / length, n.z / length };
+				const double weight = Dot(edge, edge) * 10.0;
+				quadrics[a].AddPlane(n, -Dot(n, positions[a]), weight);
+				quadrics[b].AddPlane(n, -Dot(n, positions[b]), weight);
+			}
+		}
+	}
+
+	auto attributeError = [&](uint32_t from, uint32_t to)
+	{
+		const MeshVertex& a = vertices[from];
+		const MeshVertex& b = vertices[to];
+		const double nx = a.Normal.x - b.Normal.x, ny = a.Normal.y - b.Normal.y, nz = a.Normal.z - b.Normal.z;
+		const double u = a.TexC.x - b.TexC.x, v = a.TexC.y - b.TexC.y;
+		// Scaled by the squared edge length so it reads as a distance, like the quadric term
+		const Double3 edge = Subtract(positions[to], positions[from]);
+		return Dot(edge, edge) * (options.NormalWeight * options.NormalWeight * (nx * nx + ny * ny + nz * nz) +
+			options.TexCoordWeight * options.TexCoordWeight * (u * u + v * v));
+	};
+
+	auto collapseCost = [&](uint32_t from, uint32_t to)
+	{
+		const Quadric& q = quadrics[from];
+		const double distance = (q.w > 0.0) ? q.Evaluate(positions[to]) / q.w : 0.0;
+		return distance + attributeError(from, to);
+	};
+
+	const size_t targetIndexCount = static_cast<size_t>(indexCount * std::min(std::max(options.TargetRatio, 0.0f), 1.0f)) / 3 * 3;
+	const double maxCost = static_cast<double>(options.TargetError) * options.TargetError;
+	double worstCost = 0.0;
+
+	std::vector<uint32_t> remap(vertexCount);
+	std::vector<char> touched(vertexCount);
+	std::vector<uint32_t> adjacencyOffsets(vertexCount + 1);
+	std::vector<uint32_t> adjacency;
+	std::vector<Collapse> candidates;
+	std::vector<Collapse> best(vertexCount);
+
+	while (indexCount > targetIndexCount)
+	{
+		// Vertex -> triangle adjacency of the current triangles
+		std::fill(adjacencyOffsets.begin(), adjacencyOffsets.end(), 0);
+		for (size_t i = 0; i < indexCount; i++)
+		{
+			adjacencyOffsets[destination[i] + 1]++;
+		}
+		for (size_t v = 0; v < vertexCount; v++)
+		{
+			adjacencyOffsets[v + 1] += adjacencyOffsets[v];
+		}
+		adjacency.resize(indexCount);
+		{
+			std::vector<uint32_t> cursor(adjacencyOffsets.begin(), adjacencyOffsets.end() - 1);
+			for (size_t i = 0; i < indexCount; i++)
+			{
+				adjacency[cursor[destination[i]]++] = static_cast<uint32_t>(i / 3);
+			}
+		}
+
+		// Cheapest collapse out of every movable vertex
+		for (uint32_t v = 0; v < vertexCount; v++)
+		{
+			best[v] = { -1.0, v, v };
+		}
+		for (size_t i = 0; i < indexCount; i += 3)
+		{
+			for (uint32_t k = 0; k < 3; k++)
+			{
+				const uint32_t a = destination[i + k];
+				const uint32_t b = destination[i + (k + 1) % 3];
+				for (int direction = 0; direction < 2; direction++)
+				{
+					const uint32_t from = direction ? b : a;
+					const uint32_t to = direction ? a : b;
+					if (locked[from])
+					{
+						continue;
+					}
+					const double cost = collapseCost(from, to);
+					if (best[from].Cost < 0.0 || cost < best[from].Cost)
+					{
+						best[from] = { cost, from, to };
+					}
+				}
+			}
+		}
+
+		candidates.clear();
+		for (uint32_t v = 0; v < vertexCount; v++)
+		{
+			if (best[v].Cost >= 0.0 && best[v].Cost <= maxCost)
+			{
+				candidates.push_back(best[v]);
+			}
+		}
+		if (candidates.empty())
+		{
+			break;
+		}
+		std::sort(candidates.begin(), candidates.end(), [](const Collapse& a, const Collapse& b) { return a.Cost < b.Cost; });
+
+		for (uint32_t v = 0; v < vertexCount; v++)
+		{
+			remap[v] = v;
+		}
+		std::fill(touched.begin(), touched.end(), 0);
+
+		// An interior collapse removes two triangles; stop once the pass has done enough
+		const size_t trianglesToRemove = (indexCount - targetIndexCount) / 3;
+		size_t removed = 0;
+		size_t collapses = 0;
+
+		for (const Collapse& collapse : candidates)
+		{
+			if (removed >= trianglesToRemove)
+			{
+				break;
+			}
+			const uint32_t from = collapse.From;
+			const uint32_t to = collapse.To;
+			if (touched[from] || touched[to])
+			{
+				continue;
+			}
+
+			// Reject collapses that fold a surviving triangle over
+			bool flips = false;
+			uint32_t collapsedTriangles = 0;
+			for (uint32_t j = adjacencyOffsets[from]; j < adjacencyOffsets[from + 1] && !flips; j++)
+			{
+				const uint32_t* tri = &destination[adjacency[j] * 3];
+				if (tri[0] == to || tri[1] == to || tri[2] == to)
+				{
+					collapsedTriangles++;
+					continue;
+				}
+				Double3 corners[3] = { positions[tri[0]], positions[tri[1]], positions[tri[2]] };
+				const Double3 before = Cross(Subtract(corners[1], corners[0]), Subtract(corners[2], corners[0]));
+				for (uint32_t k = 0; k < 3; k++)
+				{
+					if (tri[k] == from)
+					{
+						corners[k] = positions[to];
+					}
+				}
+				const Double3 after = Cross(Subtract(corners[1], corners[0]), Subtract(corners[2], corners[0]));
+				const double lengths = sqrt(Dot(before, before) * Dot(after, after));
+				flips = Dot(before, after) <= MinFlipCosine * lengths;
+			}
+			if (flips)
+			{
+				continue;
+			}
+
+			// Triangles around from change shape, so their vertices sit out the rest of the pass
+			for (uint32_t j = adjacencyOffsets[from]; j < adjacencyOffsets[from + 1]; j++)
+			{
+				const uint32_t* tri = &destination[adjacency[j] * 3];
+				touched[tri[0]] = touched[tri[1]] = touched[tri[2]] = 1;
+			}
+
+			remap[from] = to;
+			quadrics[to].Add(quadrics[from]);
+			worstCost = std::max(worstCost, collapse.Cost);
+			removed += collapsedTriangles;
+			collapses++;
+		}
+
+		if (collapses == 0)
+		{
+			break;
+		}
+
+		// Apply the collapses and drop triangles that became degenerate
+		size_t written = 0;
+		for (size_t i = 0; i < indexCount; i += 3)
+		{
+			const uint32_t a = remap[destination[i + 0]];
+			const uint32_t b = remap[destination[i + 1]];
+			const uint32_t c = remap[destination[i + 2]];
+			if (a != b && b != c && a != c)
+			{
+				destination[written++] = a;
+				destination[written++] = b;
+				destination[written++] = c;
+			}
+		}
+		indexCount = written;
+	}
+
+	if (error)
+	{
+		const SurfaceGrid source(sourceIndices.data(), sourceIndices.size(), positions);
+		*error = static_cast<float>(MeasureSurfaceDistance(source, destination, indexCount, positions, sqrt(worstCost)));
+	}
+	return indexCount;
+}
+
+void BuildLodChain(MeshData& mesh, float ratio, uint32_t levelCount, unsigned threadCount)
+{
+	const uint32_t fullCount = static_cast<uint32_t>(mesh.Lods.empty() ? mesh.Indices.size() : mesh.Lods[0].IndexCount);
+	mesh.Indices.resize(fullCount);
+	mesh.Lods.assign(1, MeshLod{ 0, fullCount, 0.0f, 0 });
+	if (levelCount <= 1 || fullCount == 0)
+	{
+		return;
+	}
+
+	std::vector<std::vector<uint32_t>> levels(levelCount - 1);
+	std::vector<float> errors(levelCount - 1, 0.0f);
+	ParallelFor(levels.size(), threadCount, [&](size_t i)
+	{
+		SimplifyOptions options;
+		options.TargetRatio = powf(ratio, static_cast<float>(i + 1));
+		// Coarser levels are seen from further away and may drift further
+		options.TargetError = 0.01f * static_cast<float>(1u << i);
+
+		std::vector<uint32_t>& level = levels[i];
+		level.resize(fullCount);
+		const size_t count = SimplifyMesh(level.data(), mesh.Indices.data(), fullCount,
+			mesh.Vertices.data(), mesh.Vertices.size(), options, &errors[i]);
+		level.resize(count);
+		OptimizeVertexCache(level.data(), level.data(), level.size(), mesh.Vertices.size());
+	});
+
+	for (size_t i = 0; i < levels.size(); i++)
+	{
+		// Keep a level only if it is meaningfully smaller than the one before it
+		const MeshLod& previous = mesh.Lods.back();
+		if (levels[i].empty() || levels[i].size() * 10 > previous.IndexCount * 9)
+		{
+			break;
+		}
+		mesh.Lods.push_back({ static_cast<uint32_t>(mesh.Indices.size()), static_cast<uint32_t>(levels[i].size()), errors[i], 0 });
+		mesh.Indices.insert(mesh.Indices.end(), levels[i].begin(), levels[i].end());
+	}
+}
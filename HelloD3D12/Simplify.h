@@ -0,0 +1,33 @@
+#pragma once
+#include "Mesh.h"
+#include <cstddef>
+#include <cstdint>
+
+struct SimplifyOptions
+{
+	// Fraction of the triangles to keep
+	float TargetRatio = 0.5f;
+	// Largest allowed error, relative to the mesh extent
+	float TargetError = 0.02f;
+	// Weights of the normal and texture coordinate differences against position error
+	float NormalWeight = 0.5f;
+	float TexCoordWeight = 1.0f;
+	// Keep open borders and attribute seams (vertices sharing a position) in place
+	bool LockBorder = true;
+};
+
+// Quadric error metric edge collapse. Vertices only ever collapse onto other existing
+// vertices, so the result indexes the same vertex buffer. Returns the new index count;
+// destination needs room for indexCount indices and may alias indices. error receives
+// the larger of the largest collapse error and the distance from the edge midpoints and
+// centroids of the result to the source triangles, relative to the mesh extent.
+size_t SimplifyMesh(uint32_t* destination, const uint32_t* indices, size_t indexCount,
+	const MeshVertex* vertices, size_t vertexCount, const SimplifyOptions& options, float* error = nullptr);
+
+const uint32_t DefaultLodLevels = 4;
+
+// Appends up to levelCount - 1 simplified levels, each keeping ratio of the triangles of
+// the level before it, after the full detail triangles in mesh.Indices and records them in
+// mesh.Lods. Levels are simplified from the full mesh independently, on up to threadCount
+// threads (0 picks one per core), and optimised for the vertex cache.
+void BuildLodChain(MeshData& mesh, float ratio = 0.5f, uint32_t levelCount = DefaultLodLevels, unsigned threadCount = 0);
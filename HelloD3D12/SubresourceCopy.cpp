@@ -0,0 +1,125 @@
+#include "SubresourceCopy.h"
+#include "Parallel.h"
+#include <algorithm>
+#include <cstring>
+
+#if (defined(_M_X64) || defined(__x86_64__)) && !defined(HELLOD3D12_NO_SIMD)
+#include <emmintrin.h>
+#define SUBRESOURCE_COPY_SSE2 1
+#endif
+
+namespace
+{
+#if SUBRESOURCE_COPY_SSE2
+	// Whole cache lines go through streaming stores; the partial lines at either end are
+	// written normally, as a partly streamed line costs a write combining flush of its own.
+	// The caller fences once it is done.
+	void StreamBytes(uint8_t* dest, const uint8_t* source, size_t size)
+	{
+		const size_t head = std::min<size_t>((64 - (reinterpret_cast<uintptr_t>(dest) & 63)) & 63, size);
+		memcpy(dest, source, head);
+		dest += head;
+		source += head;
+		size -= head;
+
+		for (; size >= 64; size -= 64, dest += 64, source += 64)
+		{
+			const __m128i a = _mm_loadu_si128(reinterpret_cast<const __m128i*>(source));
+			const __m128i b = _mm_loadu_si128(reinterpret_cast<const __m128i*>(source + 16));
+			const __m128i c = _mm_loadu_si128(reinterpret_cast<const __m128i*>(source + 32));
+			const __m128i d = _mm_loadu_si128(reinterpret_cast<const __m128i*>(source + 48));
+			_mm_stream_si128(reinterpret_cast<__m128i*>(dest), a);
+			_mm_stream_si128(reinterpret_cast<__m128i*>(dest + 16), b);
+			_mm_stream_si128(reinterpret_cast<__m128i*>(dest + 32), c);
+			_mm_stream_si128(reinterpret_cast<__m128i*>(dest + 48), d);
+		}
+		memcpy(dest, source, size);
+	}
+#endif
+}
+
+void CopyRows(uint8_t* dest, size_t destPitch, const uint8_t* source, size_t sourcePitch, size_t rowBytes, size_t rowCount)
+{
+	if (rowCount == 0 || rowBytes == 0)
+	{
+		return;
+	}
+
+	// Matching pitches with no padding between rows make one contiguous block
+	const bool contiguous = (destPitch == rowBytes && sourcePitch == rowBytes) || rowCount == 1;
+	const size_t totalBytes = rowBytes * rowCount;
+
+#if SUBRESOURCE_COPY_SSE2
+	if (totalBytes >= StreamingCopyMinBytes && rowBytes >= 64)
+	{
+		if (contiguous)
+		{
+			StreamBytes(dest, source, totalBytes);
+		}
+		else
+		{
+			for (size_t y = 0; y < rowCount; y++)
+			{
+				StreamBytes(dest + destPitch * y, source + sourcePitch * y, rowBytes);
+			}
+		}
+		_mm_sfence();
+		return;
+	}
+#endif
+
+	if (contiguous)
+	{
+		memcpy(dest, source, totalBytes);
+		return;
+	}
+
+	// The small mips of block compressed textures are a row of one or two blocks
+	switch (rowBytes)
+	{
+	case 8:
+		for (size_t y = 0; y < rowCount; y++)
+		{
+			memcpy(dest + destPitch * y, source + sourcePitch * y, 8);
+		}
+		break;
+
+	case 16:
+		for (size_t y = 0; y < rowCount; y++)
+		{
+			memcpy(dest + destPitch * y, source + sourcePitch * y, 16);
+		}
+		break;
+
+	default:
+		for (size_t y = 0; y < rowCount; y++)
+		{
+			memcpy(dest + destPitch * y, source + sourcePitch * y, rowBytes);
+		}
+		break;
+	}
+}
+
+void CopyRowsParallel(uint8_t* dest, size_t destPitch, const uint8_t* source, size_t sourcePitch, size_t rowBytes,
+	size_t rowCount, unsigned threadCount)
+{
+	if (threadCount == 0)
+	{
+		threadCount = DefaultThreadCount();
+	}
+	if (threadCount <= 1 || rowBytes * rowCount < ParallelCopyMinBytes)
+	{
+		CopyRows(dest, destPitch, source, sourcePitch, rowBytes, rowCount);
+		return;
+	}
+
+	// A few bands per thread evens out threads that start late
+	const size_t bandCount = std::min<size_t>(rowCount, static_cast<size_t>(threadCount) * 4);
+	const size_t bandRows = (rowCount + bandCount - 1) / bandCount;
+	ParallelFor((rowCount + bandRows - 1) / bandRows, threadCount, [&](size_t band)
+	{
+		const size_t first = band * bandRows;
+		const size_t count = std::min(bandRows, rowCount - first);
+		CopyRows(dest + destPitch * first, destPitch, source + sourcePitch * first, sourcePitch, rowBytes, count);
+	});
+}
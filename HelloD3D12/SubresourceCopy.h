@@ -0,0 +1,21 @@
+#pragma once
+#include <cstddef>
+#include <cstdint>
+
+// Copies larger than this use non-temporal stores, which write upload heap memory (write
+// combined on most GPUs) without pulling its lines through the cache
+const size_t StreamingCopyMinBytes = 64 * 1024;
+// CopyRowsParallel only splits copies at least this large; below it starting threads
+// costs more than it saves
+const size_t ParallelCopyMinBytes = 4 * 1024 * 1024;
+
+// Copies rowCount rows of rowBytes from source, whose rows are sourcePitch apart, to dest,
+// whose rows are destPitch apart. Rows that follow one another on both sides are copied in
+// one go; rows of a single 4x4 block (8 or 16 bytes) are copied without a memcpy call.
+void CopyRows(uint8_t* dest, size_t destPitch, const uint8_t* source, size_t sourcePitch, size_t rowBytes, size_t rowCount);
+
+// CopyRows split into bands of rows over up to threadCount threads (0 picks one per core)
+// when the copy is at least ParallelCopyMinBytes. The threads are started and joined in
+// each call, so this is for one-off loads of large surfaces; per-frame copies pass 1.
+void CopyRowsParallel(uint8_t* dest, size_t destPitch, const uint8_t* source, size_t sourcePitch, size_t rowBytes,
+	size_t rowCount, unsigned threadCount);
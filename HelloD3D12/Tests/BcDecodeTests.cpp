@@ -0,0 +1,315 @@
+#include "BcDecode.h"
+#include "DdsFormat.h"
+#include "MappedFile.h"
+#include "TestHarness.h"
+#include <algorithm>
+#include <cmath>
+#include <random>
+#include <vector>
+
+namespace
+{
+	// Straight from the format descriptions, rounding interpolated values to nearest
+	// with floating point; shares nothing with BcDecode.cpp
+	uint32_t Bits(const uint8_t* data, uint32_t first, uint32_t count)
+	{
+		uint32_t value = 0;
+		for (uint32_t i = 0; i < count; i++)
+		{
+			const uint32_t bit = first + i;
+			value |= ((data[bit / 8] >> (bit % 8)) & 1u) << i;
+		}
+		return value;
+	}
+
+	int32_t Lerp(int32_t a, int32_t b, int32_t weightB, int32_t divisor)
+	{
+		return static_cast<int32_t>(std::lround((static_cast<double>(a) * (divisor - weightB) + static_cast<double>(b) * weightB) / divisor));
+	}
+
+	void ReferenceColorBlock(const uint8_t* block, bool alwaysFourColors, uint8_t texels[16][4])
+	{
+		const uint32_t c[2] = { Bits(block, 0, 16), Bits(block, 16, 16) };
+		int32_t palette[4][4];
+		for (int e = 0; e < 2; e++)
+		{
+			// Endpoints widen to 8 bits by repeating their top bits, as GPUs do
+			const uint32_t r = (c[e] >> 11) & 31;
+			const uint32_t g = (c[e] >> 5) & 63;
+			const uint32_t b = c[e] & 31;
+			palette[e][0] = static_cast<int32_t>(r * 8 + r / 4);
+			palette[e][1] = static_cast<int32_t>(g * 4 + g / 16);
+			palette[e][2] = static_cast<int32_t>(b * 8 + b / 4);
+			palette[e][3] = 255;
+		}
+		for (int k = 0; k < 3; k++)
+		{
+			if (alwaysFourColors || c[0] > c[1])
+			{
+				palette[2][k] = Lerp(palette[0][k], palette[1][k], 1, 3);
+				palette[3][k] = Lerp(palette[0][k], palette[1][k], 2, 3);
+			}
+			else
+			{
+				palette[2][k] = Lerp(palette[0][k], palette[1][k], 1, 2);
+				palette[3][k] = 0;
+			}
+		}
+		palette[2][3] = 255;
+		palette[3][3] = (alwaysFourColors || c[0] > c[1]) ? 255 : 0;
+
+		for (uint32_t t = 0; t < 16; t++)
+		{
+			const uint32_t index = Bits(block, 32 + 2 * t, 2);
+			for (int k = 0; k < 4; k++)
+			{
+				texels[t][k] = static_cast<uint8_t>(palette[index][k]);
+			}
+		}
+	}
+
+	void ReferenceAlphaBlock(const uint8_t* block, bool isSigned, uint8_t values[16])
+	{
+		int32_t a0 = block[0];
+		int32_t a1 = block[1];
+		if (isSigned)
+		{
+			a0 = std::max(static_cast<int32_t>(static_cast<int8_t>(block[0])), -127);
+			a1 = std::max(static_cast<int32_t>(static_cast<int8_t>(block[1])), -127);
+		}
+		int32_t palette[8] = { a0, a1 };
+		if (a0 > a1)
+		{
+			for (int i = 1; i < 7; i++)
+			{
+				palette[1 + i] = Lerp(a0, a1, i, 7);
+			}
+		}
+		else
+		{
+			for (int i = 1; i < 5; i++)
+			{
+				palette[1 + i] = Lerp(a0, a1, i, 5);
+			}
+			palette[6] = isSigned ? -127 : 0;
+			palette[7] = isSigned ? 127 : 255;
+		}
+		for (uint32_t t = 0; t < 16; t++)
+		{
+			values[t] = static_cast<uint8_t>(palette[Bits(block, 16 + 3 * t, 3)]);
+		}
+	}
+
+	// One block to 4x4 texels of BcTexelBytes(format)
+	void ReferenceBlock(BcFormat format, const uint8_t* block, uint8_t* dest, size_t destPitch)
+	{
+		uint8_t color[16][4];
+		uint8_t alpha[16];
+		uint8_t second[16];
+		switch (format)
+		{
+		case BcFormat_BC1:
+			ReferenceColorBlock(block, false, color);
+			break;
+		case BcFormat_BC2:
+			ReferenceColorBlock(block + 8, true, color);
+			for (uint32_t t = 0; t < 16; t++)
+			{
+				color[t][3] = static_cast<uint8_t>(Bits(block, 4 * t, 4) * 17);
+			}
+			break;
+		case BcFormat_BC3:
+			ReferenceColorBlock(block + 8, true, color);
+			ReferenceAlphaBlock(block, false, alpha);
+			for (uint32_t t = 0; t < 16; t++)
+			{
+				color[t][3] = alpha[t];
+			}
+			break;
+		case BcFormat_BC4Unorm:
+		case BcFormat_BC4Snorm:
+			ReferenceAlphaBlock(block, format == BcFormat_BC4Snorm, alpha);
+			break;
+		case BcFormat_BC5Unorm:
+		case BcFormat_BC5Snorm:
+			ReferenceAlphaBlock(block, format == BcFormat_BC5Snorm, alpha);
+			ReferenceAlphaBlock(block + 8, format == BcFormat_BC5Snorm, second);
+			break;
+		}
+
+		const size_t texelBytes = BcTexelBytes(format);
+		for (uint32_t t = 0; t < 16; t++)
+		{
+			uint8_t* texel = dest + (t / 4) * destPitch + (t % 4) * texelBytes;
+			if (texelBytes == 4)
+			{
+				std::copy_n(color[t], 4, texel);
+			}
+			else
+			{
+				texel[0] = alpha[t];
+				if (texelBytes == 2)
+				{
+					texel[1] = second[t];
+				}
+			}
+		}
+	}
+
+	bool ReferenceSurface(BcFormat format, const uint8_t* src, uint32_t width, uint32_t height, uint8_t* dest, size_t destPitch)
+	{
+		const size_t texelBytes = BcTexelBytes(format);
+		const uint32_t blocksWide = (width + 3) / 4;
+		uint8_t texels[4 * 4 * 4];
+		for (uint32_t by = 0; by < (height + 3) / 4; by++)
+		{
+			for (uint32_t bx = 0; bx < blocksWide; bx++)
+			{
+				ReferenceBlock(format, src + (by * blocksWide + bx) * BcBlockBytes(format), texels, 4 * texelBytes);
+				for (uint32_t y = 0; y < 4 && by * 4 + y < height; y++)
+				{
+					for (uint32_t x = 0; x < 4 && bx * 4 + x < width; x++)
+					{
+						std::copy_n(texels + y * 4 * texelBytes + x * texelBytes, texelBytes,
+							dest + (by * 4 + y) * destPitch + (bx * 4 + x) * texelBytes);
+					}
+				}
+			}
+		}
+		return true;
+	}
+
+	// Decodes a surface all three ways into buffers with padded rows; the padding
+	// must be left alone
+	bool SurfacesMatch(BcFormat format, const uint8_t* src, size_t srcSize, uint32_t width, uint32_t height)
+	{
+		const size_t pitch = width * BcTexelBytes(format) + 3;
+		std::vector<uint8_t> simd(pitch * height, 0xCD);
+		std::vector<uint8_t> scalar(pitch * height, 0xCD);
+		std::vector<uint8_t> reference(pitch * height, 0xCD);
+		const bool decoded = DecodeBcSurface(format, src, srcSize, width, height, simd.data(), pitch) &&
+			DecodeBcSurfaceScalar(format, src, srcSize, width, height, scalar.data(), pitch);
+		ReferenceSurface(format, src, width, height, reference.data(), pitch);
+		return decoded && simd == reference && scalar == reference;
+	}
+
+	bool ToBcFormat(uint32_t dxgiFormat, BcFormat& format)
+	{
+		switch (dxgiFormat)
+		{
+		case 71: case 72: format = BcFormat_BC1; return true;
+		case 74: case 75: format = BcFormat_BC2; return true;
+		case 77: case 78: format = BcFormat_BC3; return true;
+		case 80: format = BcFormat_BC4Unorm; return true;
+		case 81: format = BcFormat_BC4Snorm; return true;
+		case 83: format = BcFormat_BC5Unorm; return true;
+		case 84: format = BcFormat_BC5Snorm; return true;
+		default: return false;
+		}
+	}
+
+	// Every mip of every slice of the block compressed textures we ship
+	void TestShippedTextures()
+	{
+		size_t files = 0;
+		size_t surfaces = 0;
+		for (const auto& entry : std::filesystem::directory_iterator(SourcePath("Textures")))
+		{
+			if (entry.path().extension() != ".dds")
+			{
+				continue;
+			}
+			MappedFile file;
+			DdsInfo info;
+			CHECK(file.Open(entry.path()));
+			CHECK(ParseDdsHeader(file.Data(), static_cast<size_t>(file.Size()), file.Size(), info) == DdsStatus_Ok);
+			BcFormat format;
+			if (!ToBcFormat(info.Format, format))
+			{
+				continue;
+			}
+			files++;
+
+			const uint8_t* data = file.Data() + info.DataOffset;
+			size_t offset = 0;
+			for (uint32_t slice = 0; slice < info.ArraySize; slice++)
+			{
+				for (uint32_t mip = 0; mip < std::max(info.MipCount, 1u); mip++)
+				{
+					const uint32_t width = std::max(info.Width >> mip, 1u);
+					const uint32_t height = std::max(info.Height >> mip, 1u);
+					const size_t bytes = BcSurfaceBytes(format, width, height);
+					if (!SurfacesMatch(format, data + offset, static_cast<size_t>(info.DataBytes - offset), width, height))
+					{
+						std::fprintf(stderr, "%s slice %u mip %u decodes differently\n", entry.path().filename().string().c_str(), slice, mip);
+						CHECK(false);
+					}
+					offset += bytes;
+					surfaces++;
+				}
+			}
+			CHECK(offset == info.DataBytes);
+		}
+		std::printf("shipped textures: %zu block compressed files, %zu surfaces\n", files, surfaces);
+		CHECK(files > 0);
+	}
+
+	// Random blocks of every format at odd sizes, with the edge cases forced often:
+	// equal endpoints (the 3-color / 6-value modes) and -128 for the signed formats
+	void TestRandomBlocks()
+	{
+		std::mt19937 rng(5);
+		for (uint32_t f = BcFormat_BC1; f <= BcFormat_BC5Snorm; f++)
+		{
+			const BcFormat format = static_cast<BcFormat>(f);
+			for (int i = 0; i < 60; i++)
+			{
+				const uint32_t width = 1 + rng() % 70;
+				const uint32_t height = 1 + rng() % 70;
+				std::vector<uint8_t> src(BcSurfaceBytes(format, width, height));
+				for (uint8_t& byte : src)
+				{
+					byte = static_cast<uint8_t>(rng());
+				}
+				for (size_t b = 0; b + 1 < src.size(); b += 8)
+				{
+					if (i % 3 == 0)
+					{
+						src[b] = src[b + 1];
+					}
+					if (i % 5 == 0)
+					{
+						src[b] = 0x80;
+					}
+				}
+				if (!SurfacesMatch(format, src.data(), src.size(), width, height))
+				{
+					std::fprintf(stderr, "format %u %ux%u decodes differently\n", f, width, height);
+					CHECK(false);
+					break;
+				}
+			}
+		}
+
+		// A source that is too small is refused
+		uint8_t texels[4 * 4 * 4];
+		std::vector<uint8_t> small(BcSurfaceBytes(BcFormat_BC3, 8, 8) - 1);
+		CHECK(!DecodeBcSurface(BcFormat_BC3, small.data(), small.size(), 8, 8, texels, 8 * 4));
+	}
+
+	void TestSizes()
+	{
+		CHECK(BcBlockBytes(BcFormat_BC1) == 8 && BcBlockBytes(BcFormat_BC3) == 16 && BcBlockBytes(BcFormat_BC4Snorm) == 8);
+		CHECK(BcTexelBytes(BcFormat_BC2) == 4 && BcTexelBytes(BcFormat_BC4Unorm) == 1 && BcTexelBytes(BcFormat_BC5Snorm) == 2);
+		CHECK(BcSurfaceBytes(BcFormat_BC1, 1, 1) == 8);
+		CHECK(BcSurfaceBytes(BcFormat_BC3, 5, 9) == 2 * 3 * 16);
+	}
+}
+
+int main()
+{
+	TestSizes();
+	TestShippedTextures();
+	TestRandomBlocks();
+	return TestResult("BcDecodeTests");
+}
@@ -0,0 +1,130 @@
+#include "Bvh.h"
+#include "MappedFile.h"
+#include "ModelParser.h"
+#include "ReferenceBvh.h"
+#include "TestHarness.h"
+#include <cmath>
+#include <random>
+
+namespace
+{
+	void SetTranslation(BvhInstance& instance, float x, float y, float z)
+	{
+		for (int i = 0; i < 16; i++)
+		{
+			instance.World[i] = instance.InverseWorld[i] = (i % 5 == 0) ? 1.0f : 0.0f;
+		}
+		instance.World[12] = x;
+		instance.World[13] = y;
+		instance.World[14] = z;
+		instance.InverseWorld[12] = -x;
+		instance.InverseWorld[13] = -y;
+		instance.InverseWorld[14] = -z;
+	}
+}
+
+// Mouse picking on skull.txt: BVH build time, a pick against testing every
+// triangle, and ray throughput through a mesh and through a scene of instances
+int main()
+{
+#ifdef HELLOD3D12_NO_SIMD
+	std::printf("scalar build\n");
+#endif
+	MappedFile file;
+	MeshData skull;
+	if (!file.Open(SourcePath("Models/skull.txt")) ||
+		!ParseModelText(reinterpret_cast<const char*>(file.Data()), static_cast<size_t>(file.Size()), skull))
+	{
+		std::printf("skull.txt not found\n");
+		return 1;
+	}
+
+	MeshBvh bvh;
+	double buildMs = MeasureMilliseconds(5, [&]()
+	{
+		BuildMeshBvh(bvh, skull.Indices.data(), skull.Indices.size(), skull.Vertices.data(), skull.Vertices.size());
+	});
+	std::printf("skull: %zu triangles, build %.2f ms, %zu nodes, %zu packets\n",
+		skull.Indices.size() / 3, buildMs, bvh.Nodes.size(), bvh.Packets.size());
+
+	// Rays from a sphere around the mesh towards its centre, slightly jittered
+	const BvhNode& root = bvh.Nodes[0];
+	const float center[3] = { (root.Min[0] + root.Max[0]) * 0.5f, (root.Min[1] + root.Max[1]) * 0.5f, (root.Min[2] + root.Max[2]) * 0.5f };
+	std::mt19937 rng(3);
+	std::uniform_real_distribution<float> random(-1.0f, 1.0f);
+	std::vector<BvhRay> rays(200000);
+	for (BvhRay& ray : rays)
+	{
+		float d[3] = { random(rng), random(rng), random(rng) };
+		const float length = std::sqrt(d[0] * d[0] + d[1] * d[1] + d[2] * d[2]);
+		d[0] /= length;
+		d[1] /= length;
+		d[2] /= length;
+		ray.Origin = { center[0] - d[0] * 30.0f, center[1] - d[1] * 30.0f, center[2] - d[2] * 30.0f };
+		ray.Direction = { d[0] + random(rng) * 0.2f, d[1] + random(rng) * 0.2f, d[2] + random(rng) * 0.2f };
+	}
+
+	// Picks agree with brute force; a pick is one ray, so time them one at a time
+	const size_t Picks = 500;
+	size_t mismatches = 0;
+	double bruteMs = 0.0;
+	double pickMs = 0.0;
+	for (size_t i = 0; i < Picks; i++)
+	{
+		BvhHit expected = {};
+		BvhHit hit = {};
+		bool foundExpected = false;
+		bool found = false;
+		bruteMs += MeasureMilliseconds(1, [&]() { foundExpected = IntersectBruteForce(skull, rays[i], expected); });
+		pickMs += MeasureMilliseconds(1, [&]() { found = IntersectMeshBvh(bvh, rays[i], INFINITY, hit); });
+		if (found != foundExpected || (found && std::fabs(hit.Distance - expected.Distance) > 1e-3f * expected.Distance))
+		{
+			mismatches++;
+		}
+	}
+	std::printf("  pick: brute force %.1f us, BVH %.2f us (%zu picks, %zu disagree)\n",
+		bruteMs * 1e3 / Picks, pickMs * 1e3 / Picks, Picks, mismatches);
+
+	size_t hits = 0;
+	double raysMs = MeasureMilliseconds(3, [&]()
+	{
+		hits = 0;
+		for (const BvhRay& ray : rays)
+		{
+			BvhHit hit;
+			hits += IntersectMeshBvh(bvh, ray, INFINITY, hit) ? 1 : 0;
+		}
+	});
+	std::printf("  mesh: %.2f Mrays/s (%zu of %zu hit)\n", rays.size() / (raysMs * 1e3), hits, rays.size());
+
+	// 1000 skulls on a grid, each ray aimed at one of them
+	std::vector<BvhInstance> instances(1000);
+	for (size_t i = 0; i < instances.size(); i++)
+	{
+		SetTranslation(instances[i], (i % 10) * 30.0f, ((i / 10) % 10) * 30.0f, (i / 100) * 30.0f);
+		instances[i].Mesh = 0;
+	}
+	SceneBvh scene;
+	double sceneBuildMs = MeasureMilliseconds(5, [&]() { BuildSceneBvh(scene, instances.data(), instances.size(), &bvh); });
+
+	std::vector<BvhRay> sceneRays = rays;
+	for (size_t i = 0; i < sceneRays.size(); i++)
+	{
+		const BvhInstance& target = instances[(i * 7) % instances.size()];
+		sceneRays[i].Origin.x += target.World[12];
+		sceneRays[i].Origin.y += target.World[13];
+		sceneRays[i].Origin.z += target.World[14];
+	}
+	double sceneMs = MeasureMilliseconds(3, [&]()
+	{
+		hits = 0;
+		for (const BvhRay& ray : sceneRays)
+		{
+			SceneHit hit;
+			hits += IntersectSceneBvh(scene, instances.data(), &bvh, ray, INFINITY, hit) ? 1 : 0;
+		}
+	});
+	std::printf("  scene of %zu instances: build %.3f ms, %.2f Mrays/s (%zu hit)\n",
+		instances.size(), sceneBuildMs, sceneRays.size() / (sceneMs * 1e3), hits);
+	return mismatches == 0 ? 0 : 1;
+}
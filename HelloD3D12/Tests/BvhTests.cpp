@@ -0,0 +1,117 @@
+#include "Bvh.h"
+#include "MappedFile.h"
+#include "ModelParser.h"
+#include "ReferenceBvh.h"
+#include "TestHarness.h"
+#include <algorithm>
+#include <cmath>
+#include <limits>
+#include <random>
+
+namespace
+{
+	const float MaxDistance = std::numeric_limits<float>::max();
+
+	// Length of the longest root to leaf path
+	uint32_t TreeDepth(const std::vector<BvhNode>& nodes)
+	{
+		uint32_t deepest = 0;
+		std::vector<std::pair<uint32_t, uint32_t>> stack = { { 0, 0 } };
+		while (!stack.empty())
+		{
+			const std::pair<uint32_t, uint32_t> item = stack.back();
+			stack.pop_back();
+			deepest = std::max(deepest, item.second);
+			const BvhNode& node = nodes[item.first];
+			if (node.Count == 0 && nodes.size() > 1)
+			{
+				stack.push_back({ node.LeftFirst, item.second + 1 });
+				stack.push_back({ node.LeftFirst + 1, item.second + 1 });
+			}
+		}
+		return deepest;
+	}
+
+	bool SameHit(const BvhHit& a, const BvhHit& b)
+	{
+		return a.Triangle == b.Triangle && std::fabs(a.Distance - b.Distance) <= 1e-4f * std::max(1.0f, b.Distance);
+	}
+
+	// Collinear slivers along x, each 10% further out than the one before. Their boxes
+	// have no area, so every SAH split looks free and the build peels one off per level,
+	// far past the 64 levels the traversal stack holds.
+	void TestSkewedInput()
+	{
+		const uint32_t count = 300;
+		MeshData mesh;
+		float x = 1.0f;
+		for (uint32_t i = 0; i < count; i++, x *= 1.1f)
+		{
+			const uint32_t v = static_cast<uint32_t>(mesh.Vertices.size());
+			for (const float offset : { 0.0f, 0.0001f, 0.0002f })
+			{
+				MeshVertex vertex = {};
+				vertex.Position = { x * (1.0f + offset), 0.0f, 0.0f };
+				mesh.Vertices.push_back(vertex);
+			}
+			mesh.Indices.insert(mesh.Indices.end(), { v, v + 1, v + 2 });
+		}
+
+		MeshBvh bvh;
+		BuildMeshBvh(bvh, mesh.Indices.data(), mesh.Indices.size(), mesh.Vertices.data(), mesh.Vertices.size());
+		const uint32_t depth = TreeDepth(bvh.Nodes);
+		std::printf("skewed: %u triangles, %zu nodes, depth %u\n", count, bvh.Nodes.size(), depth);
+		CHECK(depth <= 64);
+
+		// Every triangle is still in exactly one leaf
+		std::vector<uint32_t> seen(count, 0);
+		for (const BvhNode& node : bvh.Nodes)
+		{
+			for (uint32_t p = node.LeftFirst; p < node.LeftFirst + node.Count; p++)
+			{
+				for (const uint32_t triangle : bvh.Packets[p].Triangle)
+				{
+					if (triangle != ~0u)
+					{
+						seen[triangle]++;
+					}
+				}
+			}
+		}
+		CHECK(std::count(seen.begin(), seen.end(), 1u) == count);
+	}
+
+	// Random rays at the skull agree with testing every triangle
+	void TestSkull()
+	{
+		MappedFile file;
+		CHECK(file.Open(SourcePath("Models/skull.txt")));
+		MeshData skull;
+		CHECK(ParseModelText(reinterpret_cast<const char*>(file.Data()), static_cast<size_t>(file.Size()), skull));
+
+		MeshBvh bvh;
+		BuildMeshBvh(bvh, skull.Indices.data(), skull.Indices.size(), skull.Vertices.data(), skull.Vertices.size());
+		CHECK(TreeDepth(bvh.Nodes) <= 64);
+
+		std::mt19937 rng(3);
+		std::uniform_real_distribution<float> unit(-1.0f, 1.0f);
+		uint32_t hits = 0;
+		for (int i = 0; i < 200; i++)
+		{
+			const BvhRay ray = { { unit(rng) * 20.0f, unit(rng) * 20.0f, -20.0f }, { unit(rng) * 0.3f, unit(rng) * 0.3f, 1.0f } };
+			BvhHit hit = {}, expected = {};
+			const bool found = IntersectMeshBvh(bvh, ray, MaxDistance, hit);
+			CHECK(found == IntersectBruteForce(skull, ray, expected));
+			CHECK(!found || SameHit(hit, expected));
+			hits += found ? 1 : 0;
+		}
+		CHECK(hits > 0);
+	}
+}
+
+int main()
+{
+	TestSkewedInput();
+	TestSkull();
+	return TestResult("BvhTests");
+}
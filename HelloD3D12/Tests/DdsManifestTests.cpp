@@ -0,0 +1,177 @@
+#include "DdsManifest.h"
+#include "MappedFile.h"
+#include "TestHarness.h"
+#include <fstream>
+
+namespace
+{
+	bool SameInfo(const DdsInfo& a, const DdsInfo& b)
+	{
+		return a.Width == b.Width && a.Height == b.Height && a.Depth == b.Depth && a.MipCount == b.MipCount &&
+			a.ArraySize == b.ArraySize && a.Format == b.Format && a.Dimension == b.Dimension &&
+			a.IsCubeMap == b.IsCubeMap && a.DataOffset == b.DataOffset && a.DataBytes == b.DataBytes;
+	}
+
+	bool SameEntries(const std::vector<DdsManifestEntry>& a, const std::vector<DdsManifestEntry>& b)
+	{
+		if (a.size() != b.size())
+		{
+			return false;
+		}
+		for (size_t i = 0; i < a.size(); i++)
+		{
+			if (a[i].Path != b[i].Path || a[i].Size != b[i].Size || a[i].Time != b[i].Time ||
+				a[i].Status != b[i].Status || (a[i].Status == DdsStatus_Ok && !SameInfo(a[i].Info, b[i].Info)))
+			{
+				return false;
+			}
+		}
+		return true;
+	}
+
+	std::vector<std::filesystem::path> ShippedTextures()
+	{
+		std::vector<std::filesystem::path> files;
+		for (const auto& entry : std::filesystem::directory_iterator(SourcePath("Textures")))
+		{
+			if (entry.path().extension() == ".dds")
+			{
+				files.push_back(entry.path());
+			}
+		}
+		return files;
+	}
+
+	// Every shipped texture loads, and its surfaces end exactly at the end of the file
+	void TestShippedTextures()
+	{
+		const std::vector<std::filesystem::path> files = ShippedTextures();
+		CHECK(files.size() == 22);
+		for (const std::filesystem::path& path : files)
+		{
+			DdsInfo info;
+			CHECK(ProbeDdsFile(path, info) == DdsStatus_Ok);
+			CHECK(info.DataOffset + info.DataBytes == std::filesystem::file_size(path));
+		}
+
+		DdsInfo info;
+		CHECK(ProbeDdsFile(SourcePath("Textures/WoodCrate01.dds"), info) == DdsStatus_Ok);
+		CHECK(info.Width == 512 && info.Height == 512 && info.MipCount == 10 && info.ArraySize == 1);
+		CHECK(info.Format == 77 && info.Dimension == DdsDimension_Texture2D && !info.IsCubeMap);
+		CHECK(info.DataOffset == 128 && info.DataBytes == 349552);
+
+		// DX10 header with an array
+		CHECK(ProbeDdsFile(SourcePath("Textures/treearray.dds"), info) == DdsStatus_Ok);
+		CHECK(info.ArraySize == 3 && info.MipCount == 10 && info.DataOffset == 148);
+
+		CHECK(ProbeDdsFile(SourcePath("Textures/missing.dds"), info) == DdsStatus_Unreadable);
+		CHECK(ProbeDdsFile(SourcePath("Textures/tree0.bmp"), info) == DdsStatus_Invalid);
+	}
+
+	void TestMalformedHeaders()
+	{
+		MappedFile file;
+		CHECK(file.Open(SourcePath("Textures/WoodCrate01.dds")));
+		const std::vector<uint8_t> original(file.Data(), file.Data() + file.Size());
+		const uint64_t size = original.size();
+		DdsInfo info;
+
+		CHECK(ParseDdsHeader(original.data(), DdsMaxHeaderBytes, size, info) == DdsStatus_Ok);
+		CHECK(ParseDdsHeader(original.data(), DdsMaxHeaderBytes, size - 1, info) == DdsStatus_Truncated);
+		CHECK(ParseDdsHeader(original.data(), 100, 100, info) == DdsStatus_Invalid);
+
+		std::vector<uint8_t> bytes = original;
+		bytes[0] = 'X';
+		CHECK(ParseDdsHeader(bytes.data(), DdsMaxHeaderBytes, size, info) == DdsStatus_Invalid);
+
+		// DDS_HEADER::size
+		bytes = original;
+		bytes[4] = 0;
+		CHECK(ParseDdsHeader(bytes.data(), DdsMaxHeaderBytes, size, info) == DdsStatus_Invalid);
+
+		// A DX10 header promised but not present
+		MappedFile arrayFile;
+		CHECK(arrayFile.Open(SourcePath("Textures/treearray.dds")));
+		CHECK(ParseDdsHeader(arrayFile.Data(), 128, 128, info) == DdsStatus_Invalid);
+	}
+
+	void TestManifestRoundTrip()
+	{
+		const std::filesystem::path directory = TestDirectory("DdsManifestRoundTrip");
+		const std::filesystem::path manifest = directory / "textures.manifest";
+		std::vector<DdsManifestEntry> entries;
+		CHECK(ScanDdsDirectory(SourcePath("Textures"), manifest, entries, nullptr, 1));
+		CHECK(entries.size() == 22);
+
+		const std::vector<uint8_t> image = SerializeDdsManifest(entries);
+		std::vector<DdsManifestEntry> parsed;
+		CHECK(ParseDdsManifest(image.data(), image.size(), parsed));
+		CHECK(SameEntries(entries, parsed));
+
+		// Cut short, or from another version
+		CHECK(!ParseDdsManifest(image.data(), image.size() - 1, parsed));
+		CHECK(!ParseDdsManifest(image.data(), 3, parsed));
+		std::vector<uint8_t> stale = image;
+		stale[4] ^= 0xFF;
+		CHECK(!ParseDdsManifest(stale.data(), stale.size(), parsed));
+	}
+
+	// A copy of the textures in a subdirectory plus a broken file: the second scan reuses
+	// everything, changed files are probed again and a bad manifest is rebuilt
+	void TestRescan()
+	{
+		namespace fs = std::filesystem;
+		const fs::path directory = TestDirectory("DdsManifestRescan");
+		const fs::path textures = directory / "Textures";
+		const fs::path manifest = directory / "textures.manifest";
+		fs::create_directories(textures / "sub");
+		for (const fs::path& path : ShippedTextures())
+		{
+			fs::copy(path, textures / "sub" / path.filename());
+		}
+		{
+			std::ofstream broken(textures / "broken.DDS", std::ios::binary);
+			broken << "DDS garbage";
+		}
+
+		std::vector<DdsManifestEntry> first, second;
+		DdsScanStats stats;
+		CHECK(ScanDdsDirectory(textures, manifest, first, &stats));
+		CHECK(stats.Files == 23 && stats.Probed == 23 && stats.Reused == 0 && stats.ManifestWritten);
+		CHECK(first.size() == 23 && first[0].Path == "broken.DDS" && first[0].Status == DdsStatus_Invalid);
+		CHECK(first[1].Path == "sub/WireFence.dds" && first[1].Status == DdsStatus_Ok);
+
+		CHECK(ScanDdsDirectory(textures, manifest, second, &stats));
+		CHECK(stats.Files == 23 && stats.Probed == 0 && stats.Reused == 23 && !stats.ManifestWritten);
+		CHECK(SameEntries(first, second));
+
+		// Touched, truncated and removed files
+		fs::last_write_time(textures / "sub/bricks.dds", fs::last_write_time(textures / "sub/bricks.dds") + std::chrono::seconds(2));
+		fs::resize_file(textures / "sub/grass.dds", 1000);
+		fs::remove(textures / "broken.DDS");
+		CHECK(ScanDdsDirectory(textures, manifest, second, &stats));
+		CHECK(stats.Files == 22 && stats.Probed == 2 && stats.Reused == 20 && stats.ManifestWritten);
+		for (const DdsManifestEntry& entry : second)
+		{
+			CHECK(entry.Status == (entry.Path == "sub/grass.dds" ? DdsStatus_Truncated : DdsStatus_Ok));
+		}
+
+		{
+			std::ofstream junk(manifest, std::ios::binary);
+			junk << "junk";
+		}
+		CHECK(ScanDdsDirectory(textures, manifest, second, &stats));
+		CHECK(stats.Probed == 22 && stats.Reused == 0 && stats.ManifestWritten);
+
+		CHECK(!ScanDdsDirectory(directory / "missing", manifest, second, &stats));
+	}
+}
+
+int main()
+{
+	TestShippedTextures();
+	TestMalformedHeaders();
+	TestManifestRoundTrip();
+	TestRescan();
+	return TestResult("DdsManifestTests");
+}
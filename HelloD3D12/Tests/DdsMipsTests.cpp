@@ -0,0 +1,89 @@
+#include "DdsMips.h"
+#include "TestHarness.h"
+#include <cstring>
+#include <vector>
+
+namespace
+{
+	DdsInfo SingleLevel(uint32_t format, uint32_t width, uint32_t height, uint32_t arraySize)
+	{
+		DdsInfo info = {};
+		info.Width = width;
+		info.Height = height;
+		info.Depth = 1;
+		info.MipCount = 1;
+		info.ArraySize = arraySize;
+		info.Format = format;
+		info.Dimension = DdsDimension_Texture2D;
+		return info;
+	}
+
+	void TestFormats()
+	{
+		MipFormat mipFormat;
+		CHECK(DdsMipFormat(87, mipFormat) && mipFormat == MipFormat_RGBA8);
+		CHECK(DdsMipFormat(93, mipFormat) && mipFormat == MipFormat_RGBA8Srgb);
+		CHECK(DdsMipFormat(10, mipFormat) && mipFormat == MipFormat_RGBA16Float);
+		CHECK(DdsMipFormat(41, mipFormat) && mipFormat == MipFormat_R32Float);
+		CHECK(!DdsMipFormat(71, mipFormat)); // BC1
+		CHECK(!DdsMipFormat(0, mipFormat));
+	}
+
+	// Two RGBA8 slices of 8x4 become two chains of four levels, each slice's top level
+	// copied from its own place in the file
+	void TestExpand()
+	{
+		const uint32_t slices = 2;
+		std::vector<uint8_t> file(8 * 4 * 4 * slices);
+		for (size_t i = 0; i < file.size(); i++)
+		{
+			file[i] = static_cast<uint8_t>((i < file.size() / 2) ? 40 : 200);
+		}
+
+		DdsInfo info = SingleLevel(28, 8, 4, slices);
+		const uint8_t* data = file.data();
+		size_t size = file.size();
+		std::vector<uint8_t> mips;
+		CHECK(ExpandDdsMips(info, data, size, mips, 1));
+		CHECK(info.MipCount == 4);
+		const size_t sliceBytes = MipChainBytes(MipFormat_RGBA8, 8, 4, 4);
+		CHECK(data == mips.data() && size == sliceBytes * slices);
+		CHECK(std::memcmp(mips.data(), file.data(), 8 * 4 * 4) == 0);
+		CHECK(std::memcmp(mips.data() + sliceBytes, file.data() + 8 * 4 * 4, 8 * 4 * 4) == 0);
+		// The 1x1 level of each slice
+		CHECK(mips[sliceBytes - 4] == 40 && mips[2 * sliceBytes - 4] == 200);
+	}
+
+	// The file's surfaces are staged as they are
+	void TestUnchanged()
+	{
+		std::vector<uint8_t> file(16 * 16 * 4);
+		std::vector<uint8_t> mips;
+		const DdsInfo cases[] =
+		{
+			SingleLevel(71, 16, 16, 1),
+			SingleLevel(28, 1, 1, 1),
+			[]() { DdsInfo info = SingleLevel(28, 16, 16, 1); info.MipCount = 5; return info; }(),
+			[]() { DdsInfo info = SingleLevel(28, 8, 8, 6); info.IsCubeMap = true; return info; }(),
+			[]() { DdsInfo info = SingleLevel(28, 16, 16, 1); info.Dimension = DdsDimension_Texture3D; return info; }(),
+			// Two slices need more than the file has
+			SingleLevel(28, 16, 16, 2),
+		};
+		for (const DdsInfo& original : cases)
+		{
+			DdsInfo info = original;
+			const uint8_t* data = file.data();
+			size_t size = file.size();
+			CHECK(!ExpandDdsMips(info, data, size, mips, 1));
+			CHECK(data == file.data() && size == file.size() && info.MipCount == original.MipCount);
+		}
+	}
+}
+
+int main()
+{
+	TestFormats();
+	TestExpand();
+	TestUnchanged();
+	return TestResult("DdsMipsTests");
+}
@@ -0,0 +1,118 @@
+#include "LodSelect.h"
+#include "TestHarness.h"
+#include <algorithm>
+#include <cmath>
+#include <random>
+
+namespace
+{
+	// One object at a time, array of structures: what a per-draw selection in
+	// Graphics::Update would look like without the batch routine
+	struct NaiveObject
+	{
+		MeshFloat3 Center;
+		float Radius;
+		float Scale;
+		uint32_t Mesh;
+		uint8_t Lod;
+	};
+
+	void SelectLodsNaive(std::vector<NaiveObject>& objects, const LodErrorTable* tables, const LodSelectSettings& settings)
+	{
+		const float budget = settings.MaxPixelError * exp2f(settings.Bias) / settings.ProjectionScale;
+		const float coarserFactor = 1.0f - std::min(std::max(settings.Hysteresis, 0.0f), 1.0f);
+		for (NaiveObject& object : objects)
+		{
+			const LodErrorTable& table = tables[object.Mesh];
+			if (table.Count == 0)
+			{
+				object.Lod = 0;
+				continue;
+			}
+			const float dx = object.Center.x - settings.Eye.x;
+			const float dy = object.Center.y - settings.Eye.y;
+			const float dz = object.Center.z - settings.Eye.z;
+			const float nearest = std::max(sqrtf(dx * dx + dy * dy + dz * dz) - object.Radius, 0.0f);
+			const float allowed = nearest * budget / object.Scale;
+
+			uint32_t fitting = 0;
+			uint32_t fittingWithMargin = 0;
+			for (uint32_t level = 1; level < table.Count; level++)
+			{
+				fitting = (table.Error[level] <= allowed) ? level : fitting;
+				fittingWithMargin = (table.Error[level] <= allowed * coarserFactor) ? level : fittingWithMargin;
+			}
+			const uint32_t current = std::min<uint32_t>(object.Lod, table.Count - 1);
+			object.Lod = static_cast<uint8_t>((current > fitting) ? fitting : std::max(current, fittingWithMargin));
+		}
+	}
+}
+
+// Per-frame cost of picking levels for 100k objects while the camera orbits
+int main()
+{
+#ifdef HELLOD3D12_NO_SIMD
+	std::printf("scalar build\n");
+#endif
+	const size_t ObjectCount = 100000;
+	const int Frames = 200;
+
+	// The skull's chain (see Simplify.h) and a shorter one
+	const MeshLod lods[] = { { 0, 0, 0.0f, 0 }, { 0, 0, 0.0082f, 0 }, { 0, 0, 0.0146f, 0 }, { 0, 0, 0.0275f, 0 }, { 0, 0, 0.05f, 0 } };
+	LodErrorTable tables[2];
+	MakeLodErrorTable(lods, 5, 10.0f, tables[0]);
+	MakeLodErrorTable(lods, 3, 10.0f, tables[1]);
+
+	LodObjects objects;
+	objects.Resize(ObjectCount);
+	std::vector<NaiveObject> naive(ObjectCount);
+	std::mt19937 rng(1);
+	std::uniform_real_distribution<float> position(-500.0f, 500.0f);
+	std::uniform_real_distribution<float> scale(0.5f, 2.0f);
+	for (size_t i = 0; i < ObjectCount; i++)
+	{
+		objects.CenterX[i] = position(rng);
+		objects.CenterY[i] = position(rng);
+		objects.CenterZ[i] = position(rng);
+		objects.Scale[i] = scale(rng);
+		objects.Radius[i] = 5.0f * objects.Scale[i];
+		objects.Mesh[i] = static_cast<uint32_t>(i & 1);
+		naive[i] = { { objects.CenterX[i], objects.CenterY[i], objects.CenterZ[i] }, objects.Radius[i], objects.Scale[i], objects.Mesh[i], 0 };
+	}
+
+	LodSelectSettings settings;
+	settings.ProjectionScale = LodProjectionScale(0.25f * 3.14159265f, 960.0f);
+
+	auto orbit = [&](int frame)
+	{
+		const float angle = 0.01f * static_cast<float>(frame);
+		settings.Eye = { 300.0f * cosf(angle), 50.0f, 300.0f * sinf(angle) };
+	};
+
+	double batchMs = 0.0;
+	double naiveMs = 0.0;
+	size_t mismatches = 0;
+	for (int frame = 0; frame < Frames; frame++)
+	{
+		orbit(frame);
+		batchMs += MeasureMilliseconds(1, [&]() { SelectLods(objects, tables, settings); });
+		naiveMs += MeasureMilliseconds(1, [&]() { SelectLodsNaive(naive, tables, settings); });
+		for (size_t i = 0; i < ObjectCount; i++)
+		{
+			mismatches += (naive[i].Lod != objects.Lod[i]) ? 1 : 0;
+		}
+	}
+
+	uint32_t histogram[MaxLodLevels] = {};
+	for (uint8_t lod : objects.Lod)
+	{
+		histogram[lod]++;
+	}
+
+	std::printf("%zu objects, %d frames\n", ObjectCount, Frames);
+	std::printf("  naive per object  %7.3f ms/frame %6.2f ns/object\n", naiveMs / Frames, naiveMs * 1e6 / Frames / ObjectCount);
+	std::printf("  SelectLods        %7.3f ms/frame %6.2f ns/object\n", batchMs / Frames, batchMs * 1e6 / Frames / ObjectCount);
+	std::printf("  levels in the last frame: %u %u %u %u %u, %zu selections differ\n",
+		histogram[0], histogram[1], histogram[2], histogram[3], histogram[4], mismatches);
+	return mismatches == 0 ? 0 : 1;
+}
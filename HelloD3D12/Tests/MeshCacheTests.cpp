@@ -0,0 +1,124 @@
+#include "MeshCache.h"
+#include "TestHarness.h"
+#include <chrono>
+#include <cstring>
+#include <fstream>
+
+namespace
+{
+	int64_t SourceTime(const std::filesystem::path& path)
+	{
+		return static_cast<int64_t>(std::filesystem::last_write_time(path).time_since_epoch().count());
+	}
+
+	void TestBuildAndReload(const std::filesystem::path& modelPath)
+	{
+		std::filesystem::path cachePath = modelPath;
+		cachePath.replace_extension(".mesh");
+
+		MeshCacheFile model;
+		CHECK(LoadCachedModel(modelPath, model));
+		CHECK(std::filesystem::exists(cachePath));
+		CHECK(model.IsOpen());
+		CHECK(model.Header().Magic == MeshCacheMagic);
+		CHECK(model.Header().Version == MeshCacheVersion);
+		CHECK(model.Header().SourceSize == std::filesystem::file_size(modelPath));
+		CHECK(model.Header().SourceTime == SourceTime(modelPath));
+		CHECK(model.VertexCount() > 0);
+		CHECK(model.IndexCount() % 3 == 0);
+		CHECK(model.LodCount() >= 1);
+
+		for (uint32_t i = 0; i < model.IndexCount(); i++)
+		{
+			if (model.Indices()[i] >= model.VertexCount())
+			{
+				CHECK(model.Indices()[i] < model.VertexCount());
+				break;
+			}
+		}
+
+		// A second load maps the same file
+		MeshCacheFile reloaded;
+		CHECK(LoadCachedModel(modelPath, reloaded));
+		CHECK(reloaded.Size() == model.Size());
+		CHECK(std::memcmp(reloaded.Data(), model.Data(), static_cast<size_t>(model.Size())) == 0);
+	}
+
+	// Touching the source without changing it (a fresh checkout) must not
+	// rebuild the cache, and must refresh its stamp so the fast path is taken again
+	void TestStaleTimestamp(const std::filesystem::path& modelPath)
+	{
+		std::filesystem::path cachePath = modelPath;
+		cachePath.replace_extension(".mesh");
+
+		MeshCacheFile before;
+		CHECK(LoadCachedModel(modelPath, before));
+		std::vector<uint8_t> image(before.Data(), before.Data() + before.Size());
+		before.Close();
+
+		std::filesystem::last_write_time(modelPath, std::filesystem::last_write_time(modelPath) + std::chrono::hours(1));
+		const int64_t touched = SourceTime(modelPath);
+
+		MeshCacheFile model;
+		CHECK(LoadCachedModel(modelPath, model));
+		CHECK(model.Header().SourceTime == touched);
+		CHECK(model.Header().SourceHash == reinterpret_cast<const MeshCacheHeader*>(image.data())->SourceHash);
+		CHECK(model.Size() == image.size());
+		// Everything past the header is untouched
+		CHECK(std::memcmp(model.Data() + sizeof(MeshCacheHeader), image.data() + sizeof(MeshCacheHeader),
+			image.size() - sizeof(MeshCacheHeader)) == 0);
+		model.Close();
+
+		// The refreshed stamp is on disk, not only in memory
+		MeshCacheFile onDisk;
+		CHECK(onDisk.Open(cachePath));
+		CHECK(onDisk.Header().SourceTime == touched);
+		CHECK(onDisk.Header().SourceSize == std::filesystem::file_size(modelPath));
+	}
+
+	void TestChangedSource(const std::filesystem::path& modelPath)
+	{
+		MeshCacheFile before;
+		CHECK(LoadCachedModel(modelPath, before));
+		const uint64_t oldHash = before.Header().SourceHash;
+		before.Close();
+
+		{
+			std::ofstream file(modelPath, std::ios::app);
+			file << "\n";
+		}
+
+		MeshCacheFile model;
+		CHECK(LoadCachedModel(modelPath, model));
+		CHECK(model.Header().SourceHash != oldHash);
+		CHECK(model.Header().SourceSize == std::filesystem::file_size(modelPath));
+		CHECK(model.Header().SourceTime == SourceTime(modelPath));
+	}
+
+	void TestCorruptCache(const std::filesystem::path& modelPath)
+	{
+		std::filesystem::path cachePath = modelPath;
+		cachePath.replace_extension(".mesh");
+		std::filesystem::resize_file(cachePath, sizeof(MeshCacheHeader) / 2);
+
+		MeshCacheFile model;
+		CHECK(LoadCachedModel(modelPath, model));
+		CHECK(model.VertexCount() > 0);
+		CHECK(std::filesystem::file_size(cachePath) > sizeof(MeshCacheHeader));
+	}
+}
+
+int main()
+{
+	std::filesystem::path dir = TestDirectory("MeshCache");
+	std::filesystem::path modelPath = dir / "skull.txt";
+	std::filesystem::copy_file(SourcePath("Models/skull.txt"), modelPath);
+
+	TestBuildAndReload(modelPath);
+	TestStaleTimestamp(modelPath);
+	TestChangedSource(modelPath);
+	TestCorruptCache(modelPath);
+
+	std::filesystem::remove_all(dir);
+	return TestResult("MeshCacheTests");
+}
@@ -0,0 +1,91 @@
+#include "MappedFile.h"
+#include "MeshCache.h"
+#include "Meshlet.h"
+#include "ModelParser.h"
+#include "TestCamera.h"
+#include "TestHarness.h"
+#include <algorithm>
+#include <cmath>
+
+// Meshlets of the cached skull and how many of them CullMeshlets removes from a few
+// camera poses, with the cost of building and culling them
+int main()
+{
+	MappedFile file;
+	MeshData skull;
+	if (!file.Open(SourcePath("Models/skull.txt")) ||
+		!ParseModelText(reinterpret_cast<const char*>(file.Data()), static_cast<size_t>(file.Size()), skull))
+	{
+		std::printf("skull.txt not found\n");
+		return 1;
+	}
+	MeshCacheStats stats = {};
+	ProcessMesh(skull, stats);
+	const uint32_t indexCount = skull.Lods[0].IndexCount;
+
+	MeshletData data;
+	const double buildMs = MeasureMilliseconds(10, [&]()
+	{
+		BuildMeshlets(data, skull.Indices.data(), indexCount, skull.Vertices.data(), skull.Vertices.size());
+	});
+	uint32_t fullMeshlets = 0;
+	for (const Meshlet& meshlet : data.Meshlets)
+	{
+		fullMeshlets += (meshlet.VertexCount == MaxMeshletVertices || meshlet.TriangleCount == MaxMeshletTriangles) ? 1 : 0;
+	}
+	std::printf("skull: %u triangles, %zu meshlets (%.1f triangles, %.1f vertices each), built in %.2f ms\n",
+		indexCount / 3, data.Meshlets.size(), indexCount / 3.0 / data.Meshlets.size(),
+		static_cast<double>(data.Vertices.size()) / data.Meshlets.size(), buildMs);
+	std::printf("  %u of them are full (%u vertices or %u triangles)\n\n", fullMeshlets, MaxMeshletVertices, MaxMeshletTriangles);
+
+	MeshFloat3 minP = skull.Vertices[0].Position;
+	MeshFloat3 maxP = minP;
+	for (const MeshVertex& v : skull.Vertices)
+	{
+		minP = { std::min(minP.x, v.Position.x), std::min(minP.y, v.Position.y), std::min(minP.z, v.Position.z) };
+		maxP = { std::max(maxP.x, v.Position.x), std::max(maxP.y, v.Position.y), std::max(maxP.z, v.Position.z) };
+	}
+	const MeshFloat3 c = { (minP.x + maxP.x) * 0.5f, (minP.y + maxP.y) * 0.5f, (minP.z + maxP.z) * 0.5f };
+	const float r = 0.5f * sqrtf((maxP.x - minP.x) * (maxP.x - minP.x) + (maxP.y - minP.y) * (maxP.y - minP.y) + (maxP.z - minP.z) * (maxP.z - minP.z));
+
+	// Distances in bounding radii from the centre
+	struct Pose
+	{
+		const char* Name;
+		MeshFloat3 Eye;
+		MeshFloat3 Target;
+		MeshFloat3 Up;
+	};
+	const Pose poses[] =
+	{
+		{ "front", { c.x, c.y, c.z - 3.0f * r }, c, { 0.0f, 1.0f, 0.0f } },
+		{ "back", { c.x, c.y, c.z + 3.0f * r }, c, { 0.0f, 1.0f, 0.0f } },
+		{ "left", { c.x - 3.0f * r, c.y, c.z }, c, { 0.0f, 1.0f, 0.0f } },
+		{ "above", { c.x, c.y + 3.0f * r, c.z }, c, { 0.0f, 0.0f, 1.0f } },
+		{ "diagonal", { c.x + 2.0f * r, c.y + 2.0f * r, c.z - 2.0f * r }, c, { 0.0f, 1.0f, 0.0f } },
+		{ "close front", { c.x, c.y, c.z - 1.2f * r }, c, { 0.0f, 1.0f, 0.0f } },
+		{ "close, off centre", { c.x + 0.8f * r, c.y, c.z - 1.2f * r }, { c.x + 0.8f * r, c.y, c.z }, { 0.0f, 1.0f, 0.0f } },
+		{ "inside", c, { c.x, c.y, c.z - r }, { 0.0f, 1.0f, 0.0f } },
+		{ "far", { c.x, c.y, c.z - 20.0f * r }, c, { 0.0f, 1.0f, 0.0f } },
+		{ "looking away", { c.x, c.y, c.z - 3.0f * r }, { c.x, c.y, c.z - 4.0f * r }, { 0.0f, 1.0f, 0.0f } },
+	};
+
+	std::vector<uint32_t> visible(data.Meshlets.size());
+	std::printf("  %-18s  %7s  %7s  %8s  %9s  %7s\n", "pose", "visible", "frustum", "backface", "tris cull", "cull us");
+	for (const Pose& pose : poses)
+	{
+		float viewProj[16];
+		LookAtPerspective(pose.Eye, pose.Target, pose.Up, 0.25f * 3.14159265f, 4.0f / 3.0f, 0.05f * r, 50.0f * r, viewProj);
+		MeshletFrustum frustum;
+		ExtractMeshletFrustum(viewProj, pose.Eye, frustum);
+
+		MeshletCullStatistics cull;
+		const double ms = MeasureMilliseconds(200, [&]()
+		{
+			cull = CullMeshlets(visible.data(), data.Meshlets.data(), data.Meshlets.size(), frustum);
+		});
+		std::printf("  %-18s  %7u  %7u  %8u  %8.1f%%  %7.2f\n", pose.Name, cull.Visible, cull.FrustumCulled, cull.BackfaceCulled,
+			100.0 * (cull.Triangles - cull.TrianglesVisible) / cull.Triangles, ms * 1e3);
+	}
+	return 0;
+}
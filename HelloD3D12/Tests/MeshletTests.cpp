@@ -0,0 +1,186 @@
+#include "MappedFile.h"
+#include "MeshCache.h"
+#include "Meshlet.h"
+#include "ModelParser.h"
+#include "TestCamera.h"
+#include "TestHarness.h"
+#include <algorithm>
+#include <cmath>
+#include <random>
+
+namespace
+{
+	inline MeshFloat3 Subtract(const MeshFloat3& a, const MeshFloat3& b) { return { a.x - b.x, a.y - b.y, a.z - b.z }; }
+	inline MeshFloat3 Cross(const MeshFloat3& a, const MeshFloat3& b) { return { a.y * b.z - a.z * b.y, a.z * b.x - a.x * b.z, a.x * b.y - a.y * b.x }; }
+	inline float Dot(const MeshFloat3& a, const MeshFloat3& b) { return a.x * b.x + a.y * b.y + a.z * b.z; }
+
+	// skull.txt as the mesh cache stores it
+	bool LoadSkull(MeshData& skull)
+	{
+		MappedFile file;
+		if (!file.Open(SourcePath("Models/skull.txt")) ||
+			!ParseModelText(reinterpret_cast<const char*>(file.Data()), static_cast<size_t>(file.Size()), skull))
+		{
+			return false;
+		}
+		MeshCacheStats stats = {};
+		ProcessMesh(skull, stats, 1);
+		return true;
+	}
+
+	// Meshlets are consecutive ranges that cover the index buffer exactly once, and their
+	// local vertices and triangles rebuild the same indices
+	void CheckMeshlets(const MeshletData& data, const uint32_t* indices, size_t indexCount, const MeshVertex* vertices,
+		uint32_t maxVertices, uint32_t maxTriangles)
+	{
+		uint32_t nextIndex = 0;
+		for (const Meshlet& meshlet : data.Meshlets)
+		{
+			CHECK(meshlet.VertexCount > 0 && meshlet.VertexCount <= maxVertices);
+			CHECK(meshlet.TriangleCount > 0 && meshlet.TriangleCount <= maxTriangles);
+			CHECK(meshlet.IndexOffset == nextIndex);
+			nextIndex += meshlet.TriangleCount * 3;
+
+			const uint32_t* local = &data.Vertices[meshlet.VertexOffset];
+			std::vector<uint32_t> unique(local, local + meshlet.VertexCount);
+			std::sort(unique.begin(), unique.end());
+			CHECK(std::unique(unique.begin(), unique.end()) == unique.end());
+
+			for (uint32_t i = 0; i < meshlet.TriangleCount * 3; i++)
+			{
+				const uint8_t corner = data.Triangles[meshlet.TriangleOffset + i];
+				CHECK(corner < meshlet.VertexCount);
+				CHECK(local[corner] == indices[meshlet.IndexOffset + i]);
+			}
+
+			for (uint32_t i = 0; i < meshlet.VertexCount; i++)
+			{
+				const MeshFloat3 d = Subtract(vertices[local[i]].Position, meshlet.Center);
+				CHECK(sqrtf(Dot(d, d)) <= meshlet.Radius * 1.0001f);
+			}
+		}
+		CHECK(nextIndex == indexCount);
+	}
+
+	void TestLimits()
+	{
+		MeshData skull;
+		CHECK(LoadSkull(skull));
+		const uint32_t indexCount = skull.Lods[0].IndexCount;
+
+		MeshletData data;
+		BuildMeshlets(data, skull.Indices.data(), indexCount, skull.Vertices.data(), skull.Vertices.size());
+		CHECK(!data.Meshlets.empty());
+		CheckMeshlets(data, skull.Indices.data(), indexCount, skull.Vertices.data(), MaxMeshletVertices, MaxMeshletTriangles);
+
+		// Either limit can end a meshlet
+		BuildMeshlets(data, skull.Indices.data(), indexCount, skull.Vertices.data(), skull.Vertices.size(), 256, 8);
+		CheckMeshlets(data, skull.Indices.data(), indexCount, skull.Vertices.data(), 256, 8);
+		BuildMeshlets(data, skull.Indices.data(), indexCount, skull.Vertices.data(), skull.Vertices.size(), 16, 124);
+		CheckMeshlets(data, skull.Indices.data(), indexCount, skull.Vertices.data(), 16, 124);
+
+		BuildMeshlets(data, skull.Indices.data(), 0, skull.Vertices.data(), skull.Vertices.size());
+		CHECK(data.Meshlets.empty());
+	}
+
+	bool InsideFrustum(const MeshletFrustum& frustum, const MeshFloat3& p)
+	{
+		for (const float* plane : frustum.Planes)
+		{
+			if (plane[0] * p.x + plane[1] * p.y + plane[2] * p.z + plane[3] < 0.0f)
+			{
+				return false;
+			}
+		}
+		return true;
+	}
+
+	// Random cameras around, near and inside the skull. No meshlet that is culled may have
+	// a triangle that faces the eye with a corner in the frustum.
+	void TestConservativeCulling()
+	{
+		MeshData skull;
+		CHECK(LoadSkull(skull));
+		MeshletData data;
+		BuildMeshlets(data, skull.Indices.data(), skull.Lods[0].IndexCount, skull.Vertices.data(), skull.Vertices.size());
+
+		MeshFloat3 minP = skull.Vertices[0].Position;
+		MeshFloat3 maxP = minP;
+		for (const MeshVertex& v : skull.Vertices)
+		{
+			minP = { std::min(minP.x, v.Position.x), std::min(minP.y, v.Position.y), std::min(minP.z, v.Position.z) };
+			maxP = { std::max(maxP.x, v.Position.x), std::max(maxP.y, v.Position.y), std::max(maxP.z, v.Position.z) };
+		}
+		const MeshFloat3 center = { (minP.x + maxP.x) * 0.5f, (minP.y + maxP.y) * 0.5f, (minP.z + maxP.z) * 0.5f };
+		const MeshFloat3 extent = Subtract(maxP, center);
+		const float radius = sqrtf(Dot(extent, extent));
+
+		std::mt19937 rng(7);
+		std::uniform_real_distribution<float> unit(-1.0f, 1.0f);
+		std::uniform_real_distribution<float> distance(0.5f, 6.0f);
+		std::vector<uint32_t> visible(data.Meshlets.size());
+		uint32_t frustumCulled = 0;
+		uint32_t backfaceCulled = 0;
+		for (int pose = 0; pose < 200; pose++)
+		{
+			MeshFloat3 direction;
+			do
+			{
+				direction = { unit(rng), unit(rng), unit(rng) };
+			} while (Dot(direction, direction) > 1.0f || Dot(direction, direction) < 0.01f);
+			const float scale = distance(rng) * radius / sqrtf(Dot(direction, direction));
+			const MeshFloat3 eye = { center.x + direction.x * scale, center.y + direction.y * scale, center.z + direction.z * scale };
+			const MeshFloat3 target = { center.x + unit(rng) * radius, center.y + unit(rng) * radius, center.z + unit(rng) * radius };
+
+			float viewProj[16];
+			LookAtPerspective(eye, target, { 0.0f, 1.0f, 0.0f }, 0.25f * 3.14159265f, 4.0f / 3.0f, 0.1f * radius, 4.0f * radius, viewProj);
+			MeshletFrustum frustum;
+			ExtractMeshletFrustum(viewProj, eye, frustum);
+
+			const MeshletCullStatistics stats = CullMeshlets(visible.data(), data.Meshlets.data(), data.Meshlets.size(), frustum);
+			CHECK(stats.Meshlets == data.Meshlets.size());
+			CHECK(stats.FrustumCulled + stats.BackfaceCulled + stats.Visible == stats.Meshlets);
+			frustumCulled += stats.FrustumCulled;
+			backfaceCulled += stats.BackfaceCulled;
+
+			std::vector<bool> drawn(data.Meshlets.size(), false);
+			for (uint32_t i = 0; i < stats.Visible; i++)
+			{
+				drawn[visible[i]] = true;
+			}
+			for (size_t m = 0; m < data.Meshlets.size(); m++)
+			{
+				if (drawn[m])
+				{
+					continue;
+				}
+				const Meshlet& meshlet = data.Meshlets[m];
+				for (uint32_t t = 0; t < meshlet.TriangleCount; t++)
+				{
+					const uint32_t* tri = &skull.Indices[meshlet.IndexOffset + t * 3];
+					const MeshFloat3& p0 = skull.Vertices[tri[0]].Position;
+					const MeshFloat3& p1 = skull.Vertices[tri[1]].Position;
+					const MeshFloat3& p2 = skull.Vertices[tri[2]].Position;
+					const MeshFloat3 normal = Cross(Subtract(p1, p0), Subtract(p2, p0));
+					const MeshFloat3 toEye = Subtract(eye, p0);
+					const float length = sqrtf(Dot(normal, normal) * Dot(toEye, toEye));
+					const bool frontFacing = Dot(normal, toEye) > 1e-4f * length;
+					const bool inFrustum = InsideFrustum(frustum, p0) || InsideFrustum(frustum, p1) || InsideFrustum(frustum, p2);
+					CHECK(!(frontFacing && inFrustum));
+				}
+			}
+		}
+
+		// Both tests took part
+		std::printf("skull: %zu meshlets, %u frustum and %u backface culls over 200 poses\n",
+			data.Meshlets.size(), frustumCulled, backfaceCulled);
+		CHECK(frustumCulled > 0 && backfaceCulled > 0);
+	}
+}
+
+int main()
+{
+	TestLimits();
+	TestConservativeCulling();
+	return TestResult("MeshletTests");
+}
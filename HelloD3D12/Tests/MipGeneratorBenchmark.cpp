@@ -0,0 +1,45 @@
+#include "MipGenerator.h"
+#include "Parallel.h"
+#include "TestHarness.h"
+#include <random>
+#include <vector>
+
+// Time to build a full chain under a 2048x2048 level in every format and filter
+int main()
+{
+	const uint32_t size = 2048;
+	const uint32_t mipCount = FullMipCount(size, size);
+	const char* formatNames[] = { "RGBA8", "RGBA8 sRGB", "RGBA16F", "R32F" };
+	const char* filterNames[] = { "box", "Kaiser" };
+	std::mt19937 rng(3);
+
+	std::printf("%ux%u, %u levels\n", size, size, mipCount);
+	std::printf("  format      filter  ms (1 thread)  MPix/s  ms (%u threads)  MPix/s\n", DefaultThreadCount());
+	for (uint32_t format = MipFormat_RGBA8; format <= MipFormat_R32Float; format++)
+	{
+		const MipFormat mipFormat = static_cast<MipFormat>(format);
+		std::vector<uint8_t> data(MipChainBytes(mipFormat, size, size, mipCount));
+		const size_t texelBytes = MipTexelBytes(mipFormat);
+		for (size_t i = 0; i < size * size * texelBytes; i++)
+		{
+			// Keep float formats finite: random mantissas, exponents around 1
+			const bool floatFormat = (mipFormat == MipFormat_RGBA16Float || mipFormat == MipFormat_R32Float);
+			data[i] = (floatFormat && i % 2 == 1) ? 0x3C : static_cast<uint8_t>(rng());
+		}
+
+		for (uint32_t filter = MipFilter_Box; filter <= MipFilter_Kaiser; filter++)
+		{
+			double ms[2];
+			for (int threads = 0; threads < 2; threads++)
+			{
+				ms[threads] = MeasureMilliseconds(3, [&]()
+				{
+					GenerateMips(mipFormat, static_cast<MipFilter>(filter), size, size, 1, mipCount, data.data(), data.size(), threads == 0 ? 1 : 0);
+				});
+			}
+			std::printf("  %-10s  %-6s  %13.1f  %6.0f  %14.1f  %6.0f\n", formatNames[format], filterNames[filter],
+				ms[0], size * size / (ms[0] * 1e3), ms[1], size * size / (ms[1] * 1e3));
+		}
+	}
+	return 0;
+}
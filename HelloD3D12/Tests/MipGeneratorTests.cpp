@@ -0,0 +1,236 @@
+#include "MipGenerator.h"
+#include "TestHarness.h"
+#include <algorithm>
+#include <cmath>
+#include <cstring>
+#include <random>
+#include <vector>
+
+namespace
+{
+	double SrgbToLinear(double s)
+	{
+		return (s <= 0.04045) ? s / 12.92 : std::pow((s + 0.055) / 1.055, 2.4);
+	}
+
+	double LinearToSrgb(double l)
+	{
+		l = std::min(1.0, std::max(0.0, l));
+		return (l <= 0.0031308) ? l * 12.92 : 1.055 * std::pow(l, 1.0 / 2.4) - 0.055;
+	}
+
+	void TestSizes()
+	{
+		CHECK(FullMipCount(1, 1) == 1);
+		CHECK(FullMipCount(256, 256) == 9);
+		CHECK(FullMipCount(512, 3) == 10);
+		CHECK(FullMipCount(37, 19) == 6);
+		CHECK(MipTexelBytes(MipFormat_RGBA8) == 4 && MipTexelBytes(MipFormat_RGBA16Float) == 8 && MipTexelBytes(MipFormat_R32Float) == 4);
+		CHECK(MipChainBytes(MipFormat_RGBA8, 4, 4, 3) == (16 + 4 + 1) * 4);
+		CHECK(MipChainBytes(MipFormat_RGBA16Float, 5, 3, 3) == (15 + 2 + 1) * 8);
+	}
+
+	// Box filter on even sizes against a double precision chain, three array slices
+	void TestBoxAgainstReference(MipFormat format)
+	{
+		const bool srgb = (format == MipFormat_RGBA8Srgb);
+		const uint32_t width = 64;
+		const uint32_t height = 32;
+		const uint32_t slices = 3;
+		const uint32_t mipCount = FullMipCount(width, height);
+		const size_t sliceBytes = MipChainBytes(format, width, height, mipCount);
+
+		std::mt19937 rng(3);
+		std::vector<uint8_t> data(sliceBytes * slices);
+		for (uint32_t s = 0; s < slices; s++)
+		{
+			for (size_t i = 0; i < width * height * 4; i++)
+			{
+				data[s * sliceBytes + i] = static_cast<uint8_t>(rng());
+			}
+		}
+		CHECK(GenerateMips(format, MipFilter_Box, width, height, slices, mipCount, data.data(), data.size(), 4));
+
+		int worst = 0;
+		size_t offByOne = 0;
+		for (uint32_t s = 0; s < slices; s++)
+		{
+			const uint8_t* slice = data.data() + s * sliceBytes;
+			std::vector<double> level(width * height * 4);
+			for (size_t i = 0; i < level.size(); i++)
+			{
+				// UNORM stays in 0-255 units so halfway averages stay exact ties
+				level[i] = (srgb && i % 4 != 3) ? SrgbToLinear(slice[i] / 255.0) * 255.0 : slice[i];
+			}
+
+			uint32_t w = width;
+			uint32_t h = height;
+			size_t offset = 0;
+			for (uint32_t mip = 1; mip < mipCount; mip++)
+			{
+				offset += w * h * 4;
+				const uint32_t nw = std::max(w / 2, 1u);
+				const uint32_t nh = std::max(h / 2, 1u);
+				std::vector<double> next(nw * nh * 4);
+				for (uint32_t y = 0; y < nh; y++)
+				{
+					for (uint32_t x = 0; x < nw; x++)
+					{
+						for (uint32_t c = 0; c < 4; c++)
+						{
+							auto at = [&](uint32_t tx, uint32_t ty) { return level[(std::min(ty, h - 1) * w + std::min(tx, w - 1)) * 4 + c]; };
+							double v;
+							if (w > 1 && h > 1)
+							{
+								v = (at(2 * x, 2 * y) + at(2 * x + 1, 2 * y) + at(2 * x, 2 * y + 1) + at(2 * x + 1, 2 * y + 1)) / 4.0;
+							}
+							else if (w > 1)
+							{
+								v = (at(2 * x, y) + at(2 * x + 1, y)) / 2.0;
+							}
+							else
+							{
+								v = (at(x, 2 * y) + at(x, 2 * y + 1)) / 2.0;
+							}
+							next[(y * nw + x) * 4 + c] = v;
+
+							const double encoded = (srgb && c != 3) ? LinearToSrgb(v / 255.0) * 255.0 : v;
+							const int expected = static_cast<int>(std::floor(encoded + 0.5));
+							const int actual = slice[offset + (y * nw + x) * 4 + c];
+							worst = std::max(worst, std::abs(expected - actual));
+							offByOne += (expected != actual) ? 1 : 0;
+						}
+					}
+				}
+				level.swap(next);
+				w = nw;
+				h = nh;
+			}
+		}
+		std::printf("box %s: worst difference %d, %zu values off by one\n", srgb ? "sRGB" : "UNORM", worst, offByOne);
+		// The sRGB curve in float can land a value on the other side of a rounding boundary
+		CHECK(worst <= (srgb ? 1 : 0));
+	}
+
+	// Both filters keep a constant image constant, at odd sizes and in every format
+	void TestConstant(MipFilter filter)
+	{
+		const uint32_t width = 37;
+		const uint32_t height = 19;
+		const uint32_t mipCount = FullMipCount(width, height);
+
+		std::vector<uint8_t> r32(MipChainBytes(MipFormat_R32Float, width, height, mipCount));
+		std::vector<float> values(r32.size() / 4, 0.3f);
+		std::memcpy(r32.data(), values.data(), r32.size());
+		CHECK(GenerateMips(MipFormat_R32Float, filter, width, height, 1, mipCount, r32.data(), r32.size()));
+		std::memcpy(values.data(), r32.data(), r32.size());
+		for (float v : values)
+		{
+			CHECK_NEAR(v, 0.3f, 1e-6f);
+		}
+
+		std::vector<uint16_t> half(MipChainBytes(MipFormat_RGBA16Float, width, height, mipCount) / 2, 0x3C00);
+		CHECK(GenerateMips(MipFormat_RGBA16Float, filter, width, height, 1, mipCount, reinterpret_cast<uint8_t*>(half.data()), half.size() * 2));
+		CHECK(std::all_of(half.begin(), half.end(), [](uint16_t h) { return h == 0x3C00; }));
+
+		for (MipFormat format : { MipFormat_RGBA8, MipFormat_RGBA8Srgb })
+		{
+			std::vector<uint8_t> rgba(MipChainBytes(format, width, height, mipCount) * 2);
+			for (size_t i = 0; i < rgba.size(); i += 4)
+			{
+				rgba[i] = 10;
+				rgba[i + 1] = 128;
+				rgba[i + 2] = 250;
+				rgba[i + 3] = 77;
+			}
+			CHECK(GenerateMips(format, filter, width, height, 2, mipCount, rgba.data(), rgba.size()));
+			bool constant = true;
+			for (size_t i = 0; i < rgba.size(); i += 4)
+			{
+				constant &= rgba[i] == 10 && rgba[i + 1] == 128 && rgba[i + 2] == 250 && rgba[i + 3] == 77;
+			}
+			CHECK(constant);
+		}
+	}
+
+	// A linear ramp stays linear through the Kaiser filter away from the edges
+	void TestKaiserRamp()
+	{
+		const uint32_t size = 64;
+		std::vector<float> data(size * size + (size / 2) * (size / 2));
+		for (uint32_t y = 0; y < size; y++)
+		{
+			for (uint32_t x = 0; x < size; x++)
+			{
+				data[y * size + x] = static_cast<float>(x);
+			}
+		}
+		CHECK(GenerateMips(MipFormat_R32Float, MipFilter_Kaiser, size, size, 1, 2, reinterpret_cast<uint8_t*>(data.data()), data.size() * 4));
+		const float* mip = data.data() + size * size;
+		for (uint32_t x = 4; x < size / 2 - 4; x++)
+		{
+			CHECK_NEAR(mip[10 * (size / 2) + x], 2.0f * x + 0.5f, 1e-4f);
+		}
+	}
+
+	// Averaging two equal halves gives the same half back for every finite value
+	void TestHalfRoundTrip()
+	{
+		size_t mismatches = 0;
+		for (uint32_t bits = 0; bits < 0x10000; bits++)
+		{
+			if (((bits >> 10) & 31) == 31)
+			{
+				continue;
+			}
+			uint16_t texels[12];
+			std::fill_n(texels, 8, static_cast<uint16_t>(bits));
+			GenerateMips(MipFormat_RGBA16Float, MipFilter_Box, 2, 1, 1, 2, reinterpret_cast<uint8_t*>(texels), sizeof(texels), 1);
+			// -0 averages to +0
+			const uint16_t expected = (bits == 0x8000) ? 0 : static_cast<uint16_t>(bits);
+			for (int i = 8; i < 12; i++)
+			{
+				mismatches += (texels[i] != expected) ? 1 : 0;
+			}
+		}
+		CHECK(mismatches == 0);
+	}
+
+	// The result does not depend on how the work is split
+	void TestThreadCounts()
+	{
+		const uint32_t width = 300;
+		const uint32_t height = 201;
+		const uint32_t slices = 3;
+		const uint32_t mipCount = FullMipCount(width, height);
+		std::mt19937 rng(9);
+		for (MipFilter filter : { MipFilter_Box, MipFilter_Kaiser })
+		{
+			std::vector<uint8_t> single(MipChainBytes(MipFormat_RGBA8Srgb, width, height, mipCount) * slices);
+			for (uint8_t& byte : single)
+			{
+				byte = static_cast<uint8_t>(rng());
+			}
+			std::vector<uint8_t> multi = single;
+			CHECK(GenerateMips(MipFormat_RGBA8Srgb, filter, width, height, slices, mipCount, single.data(), single.size(), 1));
+			CHECK(GenerateMips(MipFormat_RGBA8Srgb, filter, width, height, slices, mipCount, multi.data(), multi.size(), 7));
+			CHECK(single == multi);
+		}
+
+		std::vector<uint8_t> small(MipChainBytes(MipFormat_RGBA8, 16, 16, 5) - 1);
+		CHECK(!GenerateMips(MipFormat_RGBA8, MipFilter_Box, 16, 16, 1, 5, small.data(), small.size()));
+	}
+}
+
+int main()
+{
+	TestSizes();
+	TestBoxAgainstReference(MipFormat_RGBA8);
+	TestBoxAgainstReference(MipFormat_RGBA8Srgb);
+	TestConstant(MipFilter_Box);
+	TestConstant(MipFilter_Kaiser);
+	TestKaiserRamp();
+	TestHalfRoundTrip();
+	TestThreadCounts();
+	return TestResult("MipGeneratorTests");
+}
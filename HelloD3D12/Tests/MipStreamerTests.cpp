@@ -0,0 +1,209 @@
+#include "MipStreamer.h"
+#include "TestHarness.h"
+#include <random>
+
+namespace
+{
+	// A square mip chain of 4-byte texels
+	std::vector<uint64_t> ChainBytes(uint32_t size, uint32_t mipCount)
+	{
+		std::vector<uint64_t> bytes(mipCount);
+		for (uint32_t mip = 0; mip < mipCount; mip++)
+		{
+			const uint64_t edge = std::max(size >> mip, 1u);
+			bytes[mip] = edge * edge * 4;
+		}
+		return bytes;
+	}
+
+	void TestMipForResolution()
+	{
+		CHECK(MipStreamer::MipForResolution(256, 256, 9, 100, 100) == 1);
+		CHECK(MipStreamer::MipForResolution(256, 256, 9, 128, 128) == 1);
+		CHECK(MipStreamer::MipForResolution(256, 256, 9, 129, 128) == 0);
+		CHECK(MipStreamer::MipForResolution(256, 256, 9, 1000, 1000) == 0);
+		CHECK(MipStreamer::MipForResolution(256, 128, 9, 1, 1) == 8);
+		CHECK(MipStreamer::MipForResolution(256, 128, 4, 1, 1) == 3);
+	}
+
+	void TestStreamToRequest()
+	{
+		MipStreamer streamer;
+		const std::vector<uint64_t> bytes = ChainBytes(256, 9);
+		const uint32_t a = streamer.AddTexture(9, 6, bytes.data());
+		const uint32_t b = streamer.AddTexture(9, 6, bytes.data());
+		CHECK(streamer.ResidentMip(a) == 6 && streamer.StartedMip(a) == 6);
+
+		streamer.Request(a, 0);
+		streamer.Request(b, 3);
+
+		// Largest shortfall first: a is missing six levels, b three
+		std::vector<MipUpload> uploads;
+		streamer.Schedule(1, uploads);
+		CHECK(uploads.size() == 1 && uploads[0].Texture == a && uploads[0].Mip == 5);
+
+		// Out of order starts are refused
+		CHECK(!streamer.Start({ a, 4, bytes[4] }));
+		CHECK(!streamer.Start({ 7, 5, bytes[5] }));
+
+		std::vector<MipResidencyChange> changes;
+		uint64_t fence = 0;
+		int frames = 0;
+		for (; frames < 100; frames++)
+		{
+			streamer.Schedule(64 * 1024, uploads);
+			if (uploads.empty() && streamer.PendingUploads() == 0)
+			{
+				break;
+			}
+			for (const MipUpload& upload : uploads)
+			{
+				CHECK(streamer.Start(upload));
+			}
+			streamer.Submit(++fence);
+			// The GPU is a frame behind
+			streamer.Retire(fence - 1, changes);
+			for (const MipResidencyChange& change : changes)
+			{
+				CHECK(change.ResidentMip == streamer.ResidentMip(change.Texture));
+			}
+		}
+		CHECK(frames < 100);
+		CHECK(streamer.ResidentMip(a) == 0 && streamer.ResidentMip(b) == 3);
+
+		// Asking for less detail keeps what is resident
+		streamer.Request(a, 8);
+		streamer.Schedule(~0ull, uploads);
+		CHECK(uploads.empty());
+		CHECK(streamer.ResidentMip(a) == 0);
+	}
+
+	void TestMinMip()
+	{
+		MipStreamer streamer;
+		const std::vector<uint64_t> bytes = ChainBytes(64, 7);
+		const uint32_t t = streamer.AddTexture(7, 6, bytes.data());
+		streamer.Request(t, 0);
+
+		std::vector<MipUpload> uploads;
+		std::vector<MipResidencyChange> changes;
+		streamer.Schedule(~0ull, uploads);
+		CHECK(uploads.size() == 6);
+		for (const MipUpload& upload : uploads)
+		{
+			CHECK(streamer.Start(upload));
+		}
+		streamer.Submit(1);
+		CHECK(streamer.StartedMip(t) == 0);
+
+		// Clamping while the copies are in flight: the finer ones never become resident
+		streamer.SetMinMip(t, 3);
+		CHECK(streamer.StartedMip(t) == 3);
+		CHECK(streamer.PendingUploads() == 3);
+		streamer.Retire(1, changes);
+		CHECK(streamer.ResidentMip(t) == 3);
+		CHECK(changes.size() == 1 && changes[0].ResidentMip == 3);
+
+		// Dropping everything, then letting the request stream it back
+		streamer.SetMinMip(t, 7);
+		CHECK(streamer.ResidentMip(t) == 7);
+		streamer.Schedule(~0ull, uploads);
+		CHECK(uploads.empty());
+
+		streamer.SetMinMip(t, 2);
+		streamer.Schedule(~0ull, uploads);
+		CHECK(uploads.size() == 5 && uploads.front().Mip == 6 && uploads.back().Mip == 2);
+	}
+
+	// Random requests, clamps and budgets against a GPU that lags a random number of
+	// submissions: the residency invariants hold every frame and everything settles
+	void TestRandom()
+	{
+		std::mt19937 rng(14);
+		MipStreamer streamer;
+		std::vector<std::vector<uint64_t>> chains;
+		for (uint32_t i = 0; i < 24; i++)
+		{
+			const uint32_t mipCount = 1 + rng() % 12;
+			chains.push_back(ChainBytes(1u << (mipCount - 1), mipCount));
+			streamer.AddTexture(mipCount, mipCount - 1 - rng() % mipCount, chains.back().data());
+		}
+
+		std::vector<MipUpload> uploads;
+		std::vector<MipResidencyChange> changes;
+		uint64_t fence = 0;
+		uint64_t completed = 0;
+		for (int frame = 0; frame < 5000; frame++)
+		{
+			const bool settling = frame >= 4000;
+			if (!settling)
+			{
+				const uint32_t t = rng() % streamer.TextureCount();
+				if (rng() % 4 == 0)
+				{
+					streamer.SetMinMip(t, rng() % (streamer.MipCount(t) + 1));
+				}
+				else
+				{
+					streamer.Request(t, rng() % streamer.MipCount(t));
+				}
+			}
+
+			std::vector<uint32_t> residentBefore(streamer.TextureCount());
+			for (uint32_t t = 0; t < streamer.TextureCount(); t++)
+			{
+				residentBefore[t] = streamer.ResidentMip(t);
+			}
+
+			const uint64_t budget = 1 + rng() % (256 * 1024);
+			streamer.Schedule(budget, uploads);
+			uint64_t total = 0;
+			for (const MipUpload& upload : uploads)
+			{
+				total += upload.Bytes;
+				CHECK(upload.Bytes == chains[upload.Texture][upload.Mip]);
+				CHECK(upload.Mip >= std::max(streamer.RequestedMip(upload.Texture), streamer.MinMip(upload.Texture)));
+				// Recording every proposal in order always succeeds
+				CHECK(streamer.Start(upload));
+			}
+			CHECK(total <= budget || total == uploads.front().Bytes);
+
+			streamer.Submit(++fence);
+			if (settling || rng() % 3 != 0)
+			{
+				completed = settling ? fence : completed + rng() % (fence - completed + 1);
+			}
+			streamer.Retire(completed, changes);
+
+			for (const MipResidencyChange& change : changes)
+			{
+				CHECK(change.ResidentMip == streamer.ResidentMip(change.Texture));
+				CHECK(change.ResidentMip < residentBefore[change.Texture]);
+			}
+			for (uint32_t t = 0; t < streamer.TextureCount(); t++)
+			{
+				CHECK(streamer.StartedMip(t) <= streamer.ResidentMip(t));
+				CHECK(streamer.ResidentMip(t) <= streamer.MipCount(t));
+				CHECK(streamer.StartedMip(t) >= streamer.MinMip(t));
+				CHECK(streamer.ResidentMip(t) >= streamer.MinMip(t));
+			}
+		}
+
+		CHECK(streamer.PendingUploads() == 0);
+		for (uint32_t t = 0; t < streamer.TextureCount(); t++)
+		{
+			const uint32_t target = std::max(streamer.RequestedMip(t), streamer.MinMip(t));
+			CHECK(streamer.ResidentMip(t) == streamer.StartedMip(t));
+			CHECK(streamer.ResidentMip(t) <= target || streamer.MinMip(t) == streamer.MipCount(t));
+		}
+	}
+}
+
+int main()
+{
+	TestMipForResolution();
+	TestStreamToRequest();
+	TestMinMip();
+	TestRandom();
+	return TestResult("MipStreamerTests");
+}
@@ -0,0 +1,40 @@
+#include "MappedFile.h"
+#include "ModelParser.h"
+#include "Parallel.h"
+#include "ReferenceModelParser.h"
+#include "TestHarness.h"
+
+// Parse throughput on skull.txt: the iostream reference against ParseModelText
+// on one thread and on every core
+int main()
+{
+	const std::filesystem::path path = SourcePath("Models/skull.txt");
+	MappedFile file;
+	if (!file.Open(path))
+	{
+		std::printf("%s not found\n", path.string().c_str());
+		return 1;
+	}
+	const char* text = reinterpret_cast<const char*>(file.Data());
+	const size_t size = static_cast<size_t>(file.Size());
+	const double megabytes = size / 1e6;
+
+	double reference = MeasureMilliseconds(3, [&]()
+	{
+		MeshData mesh;
+		ParseModelFileIostream(path, mesh);
+	});
+	std::printf("skull.txt (%.2f MB)\n", megabytes);
+	std::printf("  ifstream >>             %7.2f ms %7.1f MB/s\n", reference, megabytes / (reference / 1e3));
+
+	for (unsigned threadCount : { 1u, DefaultThreadCount() })
+	{
+		double ms = MeasureMilliseconds(10, [&]()
+		{
+			MeshData mesh;
+			ParseModelText(text, size, mesh, threadCount);
+		});
+		std::printf("  ParseModelText %2u thread %7.2f ms %7.1f MB/s\n", threadCount, ms, megabytes / (ms / 1e3));
+	}
+	return 0;
+}
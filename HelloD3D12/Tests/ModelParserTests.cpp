@@ -0,0 +1,160 @@
+#include "MappedFile.h"
+#include "ModelParser.h"
+#include "ReferenceModelParser.h"
+#include "TestHarness.h"
+#include <cstdlib>
+#include <cstring>
+#include <fstream>
+#include <string>
+
+namespace
+{
+	bool SameMesh(const MeshData& a, const MeshData& b)
+	{
+		return a.Vertices.size() == b.Vertices.size() &&
+			std::memcmp(a.Vertices.data(), b.Vertices.data(), a.Vertices.size() * sizeof(MeshVertex)) == 0 &&
+			a.Indices == b.Indices;
+	}
+
+	bool ParseString(const std::string& text, MeshData& mesh, unsigned threadCount = 1)
+	{
+		return ParseModelText(text.data(), text.size(), mesh, threadCount);
+	}
+
+	// Bit exact against the iostream parser for every thread count
+	void TestMatchesReference(const std::filesystem::path& path)
+	{
+		MeshData reference;
+		CHECK(ParseModelFileIostream(path, reference));
+
+		MappedFile file;
+		CHECK(file.Open(path));
+		for (unsigned threadCount : { 1u, 2u, 3u, 8u, 0u })
+		{
+			MeshData mesh;
+			CHECK(ParseModelText(reinterpret_cast<const char*>(file.Data()), static_cast<size_t>(file.Size()), mesh, threadCount));
+			CHECK(SameMesh(mesh, reference));
+		}
+	}
+
+	// skull.txt tiled copies times, large enough to split into many chunks
+	std::string TileModel(const std::filesystem::path& path, uint32_t copies)
+	{
+		MeshData mesh;
+		ParseModelFileIostream(path, mesh);
+
+		std::ifstream file(path);
+		std::string line;
+		std::vector<std::string> vertexLines;
+		std::getline(file, line);
+		std::getline(file, line);
+		std::getline(file, line);
+		std::getline(file, line);
+		while (std::getline(file, line) && line != "}")
+		{
+			vertexLines.push_back(line);
+		}
+
+		const uint32_t vertexCount = static_cast<uint32_t>(mesh.Vertices.size());
+		std::string text = "VertexCount: " + std::to_string(vertexCount * copies) + "\r\n";
+		text += "TriangleCount: " + std::to_string(mesh.Indices.size() / 3 * copies) + "\r\n";
+		text += "VertexList (pos, normal)\r\n{\r\n";
+		for (uint32_t c = 0; c < copies; c++)
+		{
+			for (const std::string& vertex : vertexLines)
+			{
+				text += vertex + "\r\n";
+			}
+		}
+		text += "}\r\nTriangleList\r\n{\r\n";
+		for (uint32_t c = 0; c < copies; c++)
+		{
+			for (size_t i = 0; i < mesh.Indices.size(); i += 3)
+			{
+				text += "\t" + std::to_string(mesh.Indices[i] + c * vertexCount) + " " +
+					std::to_string(mesh.Indices[i + 1] + c * vertexCount) + " " +
+					std::to_string(mesh.Indices[i + 2] + c * vertexCount) + "\r\n";
+			}
+		}
+		text += "}\r\n";
+		return text;
+	}
+
+	void TestLargeModel(const std::filesystem::path& path)
+	{
+		std::filesystem::path tiledPath = TestDirectory("ModelParser") / "tiled.txt";
+		std::string text = TileModel(path, 6);
+		{
+			std::ofstream file(tiledPath, std::ios::binary);
+			file << text;
+		}
+		TestMatchesReference(tiledPath);
+		std::filesystem::remove_all(tiledPath.parent_path());
+	}
+
+	void TestParseFloat()
+	{
+		const char* values[] =
+		{
+			"0", "-0", "1", "0.1", "+7.5", "-2.5e-3", "1E10", "3.4028235e38", "1.17549435e-38", "1e-45",
+			"-0.000000123456789012345678", "123456789012345678901234", "0.803181", "-0.0239625",
+			"16777217", "9.999999e-1", ".5", "5.", "1e-50", "0.000000000000000000000000000000000000000000001"
+		};
+		for (const char* s : values)
+		{
+			const char* p = s;
+			float value = -1.0f;
+			CHECK(ParseFloat(p, s + std::strlen(s), value));
+			CHECK(p == s + std::strlen(s));
+			float expected = std::strtof(s, nullptr);
+			if (std::memcmp(&value, &expected, sizeof(float)) != 0)
+			{
+				std::fprintf(stderr, "ParseFloat(\"%s\") = %.9g, strtof = %.9g\n", s, value, expected);
+				CHECK(std::memcmp(&value, &expected, sizeof(float)) == 0);
+			}
+		}
+
+		for (const char* s : { "", "-", "e5", "abc", "." })
+		{
+			const char* p = s;
+			float value;
+			CHECK(!ParseFloat(p, s + std::strlen(s), value));
+		}
+	}
+
+	void TestMalformed()
+	{
+		const std::string good =
+			"VertexCount: 3\nTriangleCount: 1\nVertexList (pos, normal)\n{\n"
+			"\t0 0 0 0 0 1\n\t1 0 0 0 0 1\n\t0 1 0 0 0 1\n}\nTriangleList\n{\n\t0 1 2\n}\n";
+		MeshData mesh;
+		CHECK(ParseString(good, mesh));
+		CHECK(mesh.Vertices.size() == 3 && mesh.Indices.size() == 3);
+		CHECK(mesh.Vertices[1].Position.x == 1.0f && mesh.Vertices[2].Normal.z == 1.0f);
+
+		std::string outOfRange = good;
+		outOfRange.replace(outOfRange.find("0 1 2"), 5, "0 1 3");
+		CHECK(!ParseString(outOfRange, mesh));
+
+		std::string missingVertex = good;
+		missingVertex.replace(missingVertex.find("\t0 1 0 0 0 1\n"), 13, "");
+		CHECK(!ParseString(missingVertex, mesh));
+
+		std::string badNumber = good;
+		badNumber.replace(badNumber.find("1 0 0 0 0 1"), 1, "x");
+		CHECK(!ParseString(badNumber, mesh));
+
+		CHECK(!ParseString(good.substr(0, good.find("TriangleList")), mesh));
+		CHECK(!ParseString("", mesh));
+	}
+}
+
+int main()
+{
+	const std::filesystem::path skull = SourcePath("Models/skull.txt");
+	TestMatchesReference(skull);
+	TestLargeModel(skull);
+	TestParseFloat();
+	TestMalformed();
+	return TestResult("ModelParserTests");
+}
@@ -0,0 +1,150 @@
+#include "MappedFile.h"
+#include "ModelParser.h"
+#include "Overdraw.h"
+#include "TestHarness.h"
+#include "VertexCache.h"
+#include <algorithm>
+#include <array>
+
+namespace
+{
+	// Rotates each triangle so its smallest index comes first (keeps the winding)
+	std::vector<std::array<uint32_t, 3>> CanonicalTriangles(const std::vector<uint32_t>& indices)
+	{
+		std::vector<std::array<uint32_t, 3>> triangles;
+		for (size_t i = 0; i + 2 < indices.size(); i += 3)
+		{
+			std::array<uint32_t, 3> t = { indices[i], indices[i + 1], indices[i + 2] };
+			while (t[0] > t[1] || t[0] > t[2])
+			{
+				t = { t[1], t[2], t[0] };
+			}
+			triangles.push_back(t);
+		}
+		std::sort(triangles.begin(), triangles.end());
+		return triangles;
+	}
+
+	// Unit quads facing -z at the given depths, layer i using vertices 4i..4i+3
+	void StackedQuads(const std::vector<float>& depths, std::vector<MeshVertex>& vertices, std::vector<uint32_t>& indices)
+	{
+		vertices.clear();
+		indices.clear();
+		for (float z : depths)
+		{
+			const uint32_t v = static_cast<uint32_t>(vertices.size());
+			for (int corner = 0; corner < 4; corner++)
+			{
+				MeshVertex vertex = {};
+				vertex.Position = { (corner & 2) ? 1.0f : 0.0f, (corner & 1) ? 1.0f : 0.0f, z };
+				vertex.Normal = { 0.0f, 0.0f, -1.0f };
+				vertices.push_back(vertex);
+			}
+			indices.insert(indices.end(), { v, v + 1, v + 2, v + 2, v + 1, v + 3 });
+		}
+	}
+
+	void TestSingleQuad()
+	{
+		std::vector<MeshVertex> vertices;
+		std::vector<uint32_t> indices;
+		StackedQuads({ 0.0f }, vertices, indices);
+
+		// Front facing from five of the views; the shared edge is not shaded twice
+		const OverdrawStatistics stats = AnalyzeOverdraw(indices.data(), indices.size(), vertices.data(), vertices.size());
+		CHECK(stats.PixelsCovered > 0);
+		CHECK(stats.PixelsShaded == stats.PixelsCovered);
+		CHECK(stats.Overdraw == 1.0f);
+
+		// Turned around it faces the other five
+		std::swap(indices[1], indices[2]);
+		std::swap(indices[4], indices[5]);
+		const OverdrawStatistics flipped = AnalyzeOverdraw(indices.data(), indices.size(), vertices.data(), vertices.size());
+		CHECK(flipped.PixelsCovered == stats.PixelsCovered && flipped.Overdraw == 1.0f);
+
+		CHECK(AnalyzeOverdraw(indices.data(), 0, vertices.data(), vertices.size()).PixelsCovered == 0);
+	}
+
+	// Layers a thousandth apart cover nearly the same pixels from every view, so drawn back
+	// to front each pixel is shaded once per layer and front to back only once
+	void TestStackedQuads()
+	{
+		std::vector<MeshVertex> vertices;
+		std::vector<uint32_t> indices;
+		for (uint32_t layers = 2; layers <= 3; layers++)
+		{
+			std::vector<float> depths;
+			for (uint32_t i = 0; i < layers; i++)
+			{
+				depths.push_back(0.001f * (layers - 1 - i));
+			}
+			StackedQuads(depths, vertices, indices);
+
+			uint64_t layerPixels = 0;
+			for (uint32_t i = 0; i < layers; i++)
+			{
+				layerPixels += AnalyzeOverdraw(&indices[i * 6], 6, vertices.data(), vertices.size()).PixelsShaded;
+			}
+
+			const OverdrawStatistics backToFront = AnalyzeOverdraw(indices.data(), indices.size(), vertices.data(), vertices.size());
+			CHECK(backToFront.PixelsShaded == layerPixels);
+			CHECK_NEAR(backToFront.Overdraw, static_cast<float>(layers), 0.02f);
+
+			std::vector<uint32_t> reversed(indices.size());
+			for (uint32_t i = 0; i < layers; i++)
+			{
+				std::copy_n(&indices[i * 6], 6, &reversed[(layers - 1 - i) * 6]);
+			}
+			const OverdrawStatistics frontToBack = AnalyzeOverdraw(reversed.data(), reversed.size(), vertices.data(), vertices.size());
+			CHECK(frontToBack.PixelsCovered == backToFront.PixelsCovered);
+			CHECK(frontToBack.Overdraw == 1.0f);
+
+			// Each layer is its own cluster, and the sort puts the nearest one first
+			std::vector<uint32_t> sorted(indices.size());
+			OptimizeOverdraw(sorted.data(), indices.data(), indices.size(), vertices.data(), vertices.size());
+			CHECK(sorted == reversed);
+		}
+	}
+
+	// skull.txt after the vertex cache pass, as ProcessMesh sees it
+	void TestSkull()
+	{
+		MappedFile file;
+		CHECK(file.Open(SourcePath("Models/skull.txt")));
+		MeshData skull;
+		CHECK(ParseModelText(reinterpret_cast<const char*>(file.Data()), static_cast<size_t>(file.Size()), skull));
+		const size_t vertexCount = skull.Vertices.size();
+
+		std::vector<uint32_t> cached(skull.Indices.size());
+		OptimizeVertexCache(cached.data(), skull.Indices.data(), skull.Indices.size(), vertexCount);
+
+		std::vector<uint32_t> sorted(cached.size());
+		OptimizeOverdraw(sorted.data(), cached.data(), cached.size(), skull.Vertices.data(), vertexCount);
+		CHECK(CanonicalTriangles(sorted) == CanonicalTriangles(cached));
+
+		const VertexCacheStatistics cacheBefore = AnalyzeVertexCache(cached.data(), cached.size(), vertexCount);
+		const VertexCacheStatistics cacheAfter = AnalyzeVertexCache(sorted.data(), sorted.size(), vertexCount);
+		const OverdrawStatistics before = AnalyzeOverdraw(cached.data(), cached.size(), skull.Vertices.data(), vertexCount);
+		const OverdrawStatistics after = AnalyzeOverdraw(sorted.data(), sorted.size(), skull.Vertices.data(), vertexCount);
+		std::printf("skull: overdraw %.3f -> %.3f, ACMR %.3f -> %.3f\n", before.Overdraw, after.Overdraw, cacheBefore.ACMR, cacheAfter.ACMR);
+		CHECK(after.Overdraw < before.Overdraw);
+		CHECK(after.PixelsCovered == before.PixelsCovered);
+		CHECK(cacheAfter.ACMR <= cacheBefore.ACMR * DefaultOverdrawThreshold);
+
+		// The thread count changes neither pass
+		std::vector<uint32_t> serial(cached.size());
+		OptimizeOverdraw(serial.data(), cached.data(), cached.size(), skull.Vertices.data(), vertexCount, DefaultOverdrawThreshold, 1);
+		CHECK(serial == sorted);
+		const OverdrawStatistics serialStats = AnalyzeOverdraw(sorted.data(), sorted.size(), skull.Vertices.data(), vertexCount,
+			DefaultOverdrawResolution, 1);
+		CHECK(serialStats.PixelsShaded == after.PixelsShaded && serialStats.PixelsCovered == after.PixelsCovered);
+	}
+}
+
+int main()
+{
+	TestSingleQuad();
+	TestStackedQuads();
+	TestSkull();
+	return TestResult("OverdrawTests");
+}
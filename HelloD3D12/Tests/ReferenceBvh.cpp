@@ -0,0 +1,35 @@
+#include "ReferenceBvh.h"
+#include <cmath>
+
+bool IntersectBruteForce(const MeshData& mesh, const BvhRay& ray, BvhHit& hit)
+{
+	bool found = false;
+	double best = INFINITY;
+	const double d[3] = { ray.Direction.x, ray.Direction.y, ray.Direction.z };
+	for (size_t t = 0; t + 2 < mesh.Indices.size(); t += 3)
+	{
+		const MeshFloat3& p0 = mesh.Vertices[mesh.Indices[t]].Position;
+		const MeshFloat3& p1 = mesh.Vertices[mesh.Indices[t + 1]].Position;
+		const MeshFloat3& p2 = mesh.Vertices[mesh.Indices[t + 2]].Position;
+		const double e1[3] = { p1.x - static_cast<double>(p0.x), p1.y - static_cast<double>(p0.y), p1.z - static_cast<double>(p0.z) };
+		const double e2[3] = { p2.x - static_cast<double>(p0.x), p2.y - static_cast<double>(p0.y), p2.z - static_cast<double>(p0.z) };
+		const double s[3] = { ray.Origin.x - static_cast<double>(p0.x), ray.Origin.y - static_cast<double>(p0.y), ray.Origin.z - static_cast<double>(p0.z) };
+		const double p[3] = { d[1] * e2[2] - d[2] * e2[1], d[2] * e2[0] - d[0] * e2[2], d[0] * e2[1] - d[1] * e2[0] };
+		const double det = e1[0] * p[0] + e1[1] * p[1] + e1[2] * p[2];
+		if (det == 0.0)
+		{
+			continue;
+		}
+		const double q[3] = { s[1] * e1[2] - s[2] * e1[1], s[2] * e1[0] - s[0] * e1[2], s[0] * e1[1] - s[1] * e1[0] };
+		const double u = (s[0] * p[0] + s[1] * p[1] + s[2] * p[2]) / det;
+		const double v = (d[0] * q[0] + d[1] * q[1] + d[2] * q[2]) / det;
+		const double distance = (e2[0] * q[0] + e2[1] * q[1] + e2[2] * q[2]) / det;
+		if (u >= 0.0 && v >= 0.0 && u + v <= 1.0 && distance >= 0.0 && distance < best)
+		{
+			best = distance;
+			hit = { static_cast<float>(distance), static_cast<uint32_t>(t / 3), static_cast<float>(u), static_cast<float>(v) };
+			found = true;
+		}
+	}
+	return found;
+}
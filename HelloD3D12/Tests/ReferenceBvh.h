@@ -0,0 +1,6 @@
+#pragma once
+#include "Bvh.h"
+
+// Closest hit over every triangle, in double precision: the reference the BVH answers
+// are checked against
+bool IntersectBruteForce(const MeshData& mesh, const BvhRay& ray, BvhHit& hit);
@@ -0,0 +1,41 @@
+#include "ReferenceModelParser.h"
+#include <fstream>
+#include <string>
+
+bool ParseModelFileIostream(const std::filesystem::path& path, MeshData& mesh)
+{
+	std::ifstream fin(path);
+	if (!fin)
+	{
+		return false;
+	}
+
+	uint32_t vcount = 0;
+	uint32_t tcount = 0;
+	std::string ignore;
+
+	fin >> ignore >> vcount;
+	fin >> ignore >> tcount;
+	fin >> ignore >> ignore >> ignore >> ignore;
+
+	mesh.Vertices.assign(vcount, MeshVertex{});
+	for (uint32_t i = 0; i < vcount; i++)
+	{
+		MeshVertex& v = mesh.Vertices[i];
+		fin >> v.Position.x >> v.Position.y >> v.Position.z;
+		fin >> v.Normal.x >> v.Normal.y >> v.Normal.z;
+	}
+
+	fin >> ignore;
+	fin >> ignore;
+	fin >> ignore;
+
+	mesh.Indices.assign(3 * static_cast<size_t>(tcount), 0);
+	for (uint32_t i = 0; i < tcount; i++)
+	{
+		fin >> mesh.Indices[i * 3 + 0] >> mesh.Indices[i * 3 + 1] >> mesh.Indices[i * 3 + 2];
+	}
+
+	mesh.Lods.clear();
+	return static_cast<bool>(fin);
+}
@@ -0,0 +1,7 @@
+#pragma once
+#include "Mesh.h"
+#include <filesystem>
+
+// The std::ifstream parser Graphics::CreateVertexBuffer used before
+// ModelParser.h, kept as the reference the tests and benchmarks compare against
+bool ParseModelFileIostream(const std::filesystem::path& path, MeshData& mesh);
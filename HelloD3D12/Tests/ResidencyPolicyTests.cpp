@@ -0,0 +1,195 @@
+#include "MipGenerator.h"
+#include "MipStreamer.h"
+#include "ResidencyPolicy.h"
+#include "TestHarness.h"
+#include <algorithm>
+#include <random>
+
+namespace
+{
+	// Bytes of each mip of a size x size BC3 texture
+	std::vector<uint64_t> ChainBytes(uint32_t size, uint32_t mipCount)
+	{
+		std::vector<uint64_t> bytes(mipCount);
+		for (uint32_t mip = 0; mip < mipCount; mip++)
+		{
+			const uint64_t blocks = (std::max(size >> mip, 1u) + 3) / 4;
+			bytes[mip] = blocks * blocks * 16;
+		}
+		return bytes;
+	}
+
+	uint64_t BytesFrom(const std::vector<uint64_t>& chain, uint32_t base)
+	{
+		uint64_t bytes = 0;
+		for (uint32_t mip = base; mip < chain.size(); mip++)
+		{
+			bytes += chain[mip];
+		}
+		return bytes;
+	}
+
+	// Four 1024x1024 textures used one per frame, texture 0 longest ago
+	void TestReclaimOrder()
+	{
+		const std::vector<uint64_t> chain = ChainBytes(1024, 11);
+		ResidencyPolicy policy;
+		for (uint32_t i = 0; i < 4; i++)
+		{
+			policy.AddTexture(11, chain.data(), 8);
+		}
+		const uint64_t full = policy.ResidentBytes();
+		CHECK(full == 4 * BytesFrom(chain, 0));
+		for (uint32_t i = 0; i < 4; i++)
+		{
+			policy.Touch(i, i + 1);
+		}
+
+		// Least recently used first, demoted rather than evicted while recently used
+		std::vector<ResidencyChange> changes;
+		policy.SetEvictAfterFrames(1000);
+		policy.SetBudget(full * 3 / 4 + 1);
+		policy.Update(5, changes);
+		CHECK(policy.ResidentBytes() <= policy.Budget());
+		CHECK(policy.BaseMip(0) > 0 && !policy.IsEvicted(0));
+		CHECK(policy.BaseMip(3) == 0);
+		CHECK(!changes.empty() && changes[0].Texture == 0 && changes[0].BaseMip == policy.BaseMip(0));
+
+		// Unused for long enough: evicted outright
+		policy.SetEvictAfterFrames(2);
+		policy.SetBudget(full / 2);
+		policy.Update(6, changes);
+		CHECK(policy.ResidentBytes() <= policy.Budget());
+		CHECK(policy.IsEvicted(0));
+
+		// Using it again with room to spare brings every mip back
+		policy.SetBudget(full);
+		policy.Touch(0, 7);
+		policy.Update(7, changes);
+		CHECK(policy.BaseMip(0) == 0);
+		CHECK(policy.PromotedMips() > 0);
+
+		// Higher priorities are reclaimed last
+		policy.SetPriority(0, 5);
+		policy.SetEvictAfterFrames(1000);
+		policy.SetBudget(full / 2);
+		policy.Update(8, changes);
+		CHECK(policy.ResidentBytes() <= policy.Budget());
+		CHECK(policy.BaseMip(0) == 0);
+
+		// Textures in use that alone exceed the budget are demoted, never evicted
+		bool evicted[4];
+		for (uint32_t i = 0; i < 4; i++)
+		{
+			evicted[i] = policy.IsEvicted(i);
+			policy.Touch(i, 9);
+		}
+		policy.SetBudget(chain[0]);
+		policy.Update(9, changes);
+		CHECK(policy.ResidentBytes() <= policy.Budget());
+		for (uint32_t i = 0; i < 4; i++)
+		{
+			CHECK(evicted[i] || !policy.IsEvicted(i));
+		}
+	}
+
+	// The tail is kept or dropped as a whole, and a wanted mip inside it is not honoured
+	void TestTail()
+	{
+		const std::vector<uint64_t> chain = ChainBytes(256, 9);
+		ResidencyPolicy policy;
+		const uint32_t t = policy.AddTexture(9, chain.data(), 6);
+		std::vector<ResidencyChange> changes;
+
+		policy.Touch(t, 1, 8);
+		policy.SetBudget(0);
+		policy.Update(1, changes);
+		CHECK(policy.BaseMip(t) == 6);
+		CHECK(policy.ResidentBytes() == BytesFrom(chain, 6));
+
+		policy.SetEvictAfterFrames(1);
+		policy.Update(3, changes);
+		CHECK(policy.IsEvicted(t) && policy.ResidentBytes() == 0);
+		CHECK(changes.size() == 1 && changes[0].BaseMip == 9);
+	}
+
+	// Working sets drifting over textures of random sizes and priorities under random
+	// budgets, with a MipStreamer following the changes as Graphics does. Every frame the
+	// resident bytes add up, textures in use are not evicted, the budget holds unless
+	// the textures in use need more, and the streamer never keeps a dropped mip.
+	void TestTraces()
+	{
+		std::mt19937 rng(20);
+		for (int trace = 0; trace < 50; trace++)
+		{
+			ResidencyPolicy policy;
+			MipStreamer streamer;
+			std::vector<std::vector<uint64_t>> chains;
+			const uint32_t count = 50 + rng() % 200;
+			for (uint32_t i = 0; i < count; i++)
+			{
+				const uint32_t size = 64u << (rng() % 6);
+				const uint32_t mipCount = FullMipCount(size, size);
+				chains.push_back(ChainBytes(size, mipCount));
+				policy.AddTexture(mipCount, chains.back().data(), mipCount - 3, rng() % 3);
+				streamer.AddTexture(mipCount, mipCount - 1, chains.back().data());
+			}
+			const uint64_t total = policy.ResidentBytes();
+			policy.SetBudget(total * (20 + rng() % 60) / 100);
+			policy.SetEvictAfterFrames(30 + rng() % 100);
+
+			std::vector<ResidencyChange> changes;
+			std::vector<MipUpload> uploads;
+			std::vector<MipResidencyChange> residency;
+			for (uint64_t frame = 1; frame <= 2000; frame++)
+			{
+				const uint32_t center = static_cast<uint32_t>(frame / 40) % count;
+				const uint32_t workingSet = 5 + rng() % 20;
+				for (uint32_t k = 0; k < workingSet; k++)
+				{
+					const uint32_t texture = (center + k * (1 + rng() % 3)) % count;
+					const uint32_t wanted = rng() % 3;
+					policy.Touch(texture, frame, wanted);
+					streamer.Request(texture, wanted);
+				}
+
+				policy.Update(frame, changes);
+				for (const ResidencyChange& change : changes)
+				{
+					streamer.SetMinMip(change.Texture, change.BaseMip);
+				}
+				streamer.Schedule(1 << 20, uploads);
+				for (const MipUpload& upload : uploads)
+				{
+					streamer.Start(upload);
+				}
+				streamer.Submit(frame);
+				streamer.Retire(frame - 1, residency);
+
+				uint64_t resident = 0;
+				uint64_t usedBytes = 0;
+				for (uint32_t i = 0; i < count; i++)
+				{
+					resident += BytesFrom(chains[i], policy.BaseMip(i));
+					CHECK(streamer.ResidentMip(i) >= policy.BaseMip(i));
+					CHECK(streamer.StartedMip(i) >= policy.BaseMip(i));
+					if (policy.LastUsedFrame(i) == frame)
+					{
+						CHECK(!policy.IsEvicted(i));
+						usedBytes += BytesFrom(chains[i], policy.BaseMip(i));
+					}
+				}
+				CHECK(resident == policy.ResidentBytes());
+				CHECK(resident <= std::max(policy.Budget(), usedBytes));
+			}
+		}
+	}
+}
+
+int main()
+{
+	TestReclaimOrder();
+	TestTail();
+	TestTraces();
+	return TestResult("ResidencyPolicyTests");
+}
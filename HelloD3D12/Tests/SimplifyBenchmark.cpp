@@ -0,0 +1,60 @@
+#include "MappedFile.h"
+#include "ModelParser.h"
+#include "Parallel.h"
+#include "Simplify.h"
+#include "TestHarness.h"
+
+// SimplifyMesh on skull.txt at the ratios BuildLodChain uses, with and without measuring
+// the error against the source surface, and the whole chain on one thread and on all
+int main()
+{
+	MappedFile file;
+	MeshData skull;
+	if (!file.Open(SourcePath("Models/skull.txt")) ||
+		!ParseModelText(reinterpret_cast<const char*>(file.Data()), static_cast<size_t>(file.Size()), skull))
+	{
+		std::printf("skull.txt not found\n");
+		return 1;
+	}
+	const size_t indexCount = skull.Indices.size();
+	std::vector<uint32_t> level(indexCount);
+
+	std::printf("skull: %zu triangles, %zu vertices\n", indexCount / 3, skull.Vertices.size());
+	std::printf("  %5s  %9s  %7s  %8s  %10s\n", "ratio", "triangles", "error", "ms", "ms + error");
+	for (uint32_t i = 0; i + 1 < DefaultLodLevels; i++)
+	{
+		// As BuildLodChain sets up level i + 1
+		SimplifyOptions options;
+		options.TargetRatio = powf(0.5f, static_cast<float>(i + 1));
+		options.TargetError = 0.01f * static_cast<float>(1u << i);
+
+		size_t count = 0;
+		float error = 0.0f;
+		const double ms = MeasureMilliseconds(3, [&]()
+		{
+			count = SimplifyMesh(level.data(), skull.Indices.data(), indexCount, skull.Vertices.data(), skull.Vertices.size(), options);
+		});
+		const double measuredMs = MeasureMilliseconds(3, [&]()
+		{
+			SimplifyMesh(level.data(), skull.Indices.data(), indexCount, skull.Vertices.data(), skull.Vertices.size(), options, &error);
+		});
+		std::printf("  %5.3f  %9zu  %7.4f  %8.1f  %10.1f\n", options.TargetRatio, count / 3, error, ms, measuredMs);
+	}
+
+	std::printf("\nBuildLodChain, %u levels\n", DefaultLodLevels);
+	std::vector<unsigned> threadCounts = { 1 };
+	if (DefaultThreadCount() > 1)
+	{
+		threadCounts.push_back(DefaultThreadCount());
+	}
+	for (unsigned threads : threadCounts)
+	{
+		const double ms = MeasureMilliseconds(3, [&]()
+		{
+			MeshData mesh = skull;
+			BuildLodChain(mesh, 0.5f, DefaultLodLevels, threads);
+		});
+		std::printf("  %u thread(s): %.1f ms\n", threads, ms);
+	}
+	return 0;
+}
@@ -0,0 +1,327 @@
+#include "MappedFile.h"
+#include "ModelParser.h"
+#include "Simplify.h"
+#include "TestHarness.h"
+#include <algorithm>
+#include <cmath>
+#include <unordered_map>
+
+namespace
+{
+	struct Float3
+	{
+		float x, y, z;
+	};
+
+	inline Float3 ToFloat3(const MeshFloat3& p) { return { p.x, p.y, p.z }; }
+	inline Float3 Subtract(const Float3& a, const Float3& b) { return { a.x - b.x, a.y - b.y, a.z - b.z }; }
+	inline Float3 Add(const Float3& a, const Float3& b) { return { a.x + b.x, a.y + b.y, a.z + b.z }; }
+	inline Float3 Scale(const Float3& a, float s) { return { a.x * s, a.y * s, a.z * s }; }
+	inline float Dot(const Float3& a, const Float3& b) { return a.x * b.x + a.y * b.y + a.z * b.z; }
+
+	// Closest point on triangle abc to p (Ericson, Real-Time Collision Detection 5.1.5)
+	Float3 ClosestPointOnTriangle(const Float3& p, const Float3& a, const Float3& b, const Float3& c)
+	{
+		const Float3 ab = Subtract(b, a), ac = Subtract(c, a), ap = Subtract(p, a);
+		const float d1 = Dot(ab, ap), d2 = Dot(ac, ap);
+		if (d1 <= 0.0f && d2 <= 0.0f) return a;
+		const Float3 bp = Subtract(p, b);
+		const float d3 = Dot(ab, bp), d4 = Dot(ac, bp);
+		if (d3 >= 0.0f && d4 <= d3) return b;
+		const float vc = d1 * d4 - d3 * d2;
+		if (vc <= 0.0f && d1 >= 0.0f && d3 <= 0.0f) return Add(a, Scale(ab, d1 / (d1 - d3)));
+		const Float3 cp = Subtract(p, c);
+		const float d5 = Dot(ab, cp), d6 = Dot(ac, cp);
+		if (d6 >= 0.0f && d5 <= d6) return c;
+		const float vb = d5 * d2 - d1 * d6;
+		if (vb <= 0.0f && d2 >= 0.0f && d6 <= 0.0f) return Add(a, Scale(ac, d2 / (d2 - d6)));
+		const float va = d3 * d6 - d5 * d4;
+		if (va <= 0.0f && (d4 - d3) >= 0.0f && (d5 - d6) >= 0.0f) return Add(b, Scale(Subtract(c, b), (d4 - d3) / ((d4 - d3) + (d5 - d6))));
+		const float denom = 1.0f / (va + vb + vc);
+		return Add(a, Add(Scale(ab, vb * denom), Scale(ac, vc * denom)));
+	}
+
+	// The source triangles bucketed in a uniform grid, for distance queries against the
+	// full detail surface
+	class SurfaceGrid
+	{
+	public:
+		SurfaceGrid(const MeshData& mesh, uint32_t indexCount, uint32_t resolution)
+			: m_Mesh(mesh), m_IndexCount(indexCount), m_Resolution(resolution)
+		{
+			m_Min = ToFloat3(mesh.Vertices[0].Position);
+			Float3 maxP = m_Min;
+			for (const MeshVertex& v : mesh.Vertices)
+			{
+				m_Min = { std::min(m_Min.x, v.Position.x), std::min(m_Min.y, v.Position.y), std::min(m_Min.z, v.Position.z) };
+				maxP = { std::max(maxP.x, v.Position.x), std::max(maxP.y, v.Position.y), std::max(maxP.z, v.Position.z) };
+			}
+			m_Extent = std::max({ maxP.x - m_Min.x, maxP.y - m_Min.y, maxP.z - m_Min.z });
+			m_CellSize = m_Extent / resolution;
+
+			for (uint32_t t = 0; t * 3 < indexCount; t++)
+			{
+				int lo[3], hi[3];
+				TriangleCells(t, lo, hi);
+				for (int z = lo[2]; z <= hi[2]; z++)
+					for (int y = lo[1]; y <= hi[1]; y++)
+						for (int x = lo[0]; x <= hi[0]; x++)
+							m_Cells[CellKey(x, y, z)].push_back(t);
+			}
+		}
+
+		// Largest of the vertex buffer's three dimensions, as SimplifyMesh measures errors
+		float Extent() const { return m_Extent; }
+
+		// True if some source triangle is within maxDistance of p
+		bool Within(const Float3& p, float maxDistance) const
+		{
+			int lo[3], hi[3];
+			Cell(Subtract(p, { maxDistance, maxDistance, maxDistance }), lo);
+			Cell(Add(p, { maxDistance, maxDistance, maxDistance }), hi);
+			for (int z = lo[2]; z <= hi[2]; z++)
+				for (int y = lo[1]; y <= hi[1]; y++)
+					for (int x = lo[0]; x <= hi[0]; x++)
+					{
+						auto cell = m_Cells.find(CellKey(x, y, z));
+						if (cell == m_Cells.end())
+						{
+							continue;
+						}
+						for (uint32_t t : cell->second)
+						{
+							const uint32_t* tri = &m_Mesh.Indices[t * 3];
+							const Float3 q = ClosestPointOnTriangle(p, ToFloat3(m_Mesh.Vertices[tri[0]].Position),
+								ToFloat3(m_Mesh.Vertices[tri[1]].Position), ToFloat3(m_Mesh.Vertices[tri[2]].Position));
+							const Float3 d = Subtract(p, q);
+							if (Dot(d, d) <= maxDistance * maxDistance)
+							{
+								return true;
+							}
+						}
+					}
+			return false;
+		}
+
+	private:
+		static uint64_t CellKey(int x, int y, int z)
+		{
+			return (static_cast<uint64_t>(x + 1) << 42) | (static_cast<uint64_t>(y + 1) << 21) | static_cast<uint64_t>(z + 1);
+		}
+
+		void Cell(const Float3& p, int cell[3]) const
+		{
+			const float c[3] = { (p.x - m_Min.x) / m_CellSize, (p.y - m_Min.y) / m_CellSize, (p.z - m_Min.z) / m_CellSize };
+			for (int k = 0; k < 3; k++)
+			{
+				cell[k] = std::min(std::max(static_cast<int>(floorf(c[k])), -1), static_cast<int>(m_Resolution));
+			}
+		}
+
+		void TriangleCells(uint32_t t, int lo[3], int hi[3]) const
+		{
+			const uint32_t* tri = &m_Mesh.Indices[t * 3];
+			Float3 minP = ToFloat3(m_Mesh.Vertices[tri[0]].Position), maxP = minP;
+			for (int k = 1; k < 3; k++)
+			{
+				const MeshFloat3& p = m_Mesh.Vertices[tri[k]].Position;
+				minP = { std::min(minP.x, p.x), std::min(minP.y, p.y), std::min(minP.z, p.z) };
+				maxP = { std::max(maxP.x, p.x), std::max(maxP.y, p.y), std::max(maxP.z, p.z) };
+			}
+			Cell(minP, lo);
+			Cell(maxP, hi);
+		}
+
+		const MeshData& m_Mesh;
+		uint32_t m_IndexCount;
+		uint32_t m_Resolution;
+		Float3 m_Min;
+		float m_Extent;
+		float m_CellSize;
+		std::unordered_map<uint64_t, std::vector<uint32_t>> m_Cells;
+	};
+
+	// Vertices SimplifyMesh locks: on an edge not used by exactly two triangles, or sharing
+	// their position with another vertex
+	std::vector<char> LockedVertices(const uint32_t* indices, size_t indexCount, const MeshData& mesh)
+	{
+		std::unordered_map<uint64_t, uint32_t> edgeUse;
+		for (size_t i = 0; i < indexCount; i += 3)
+		{
+			for (uint32_t k = 0; k < 3; k++)
+			{
+				const uint32_t a = indices[i + k], b = indices[i + (k + 1) % 3];
+				edgeUse[(static_cast<uint64_t>(std::min(a, b)) << 32) | std::max(a, b)]++;
+			}
+		}
+		std::vector<char> locked(mesh.Vertices.size(), 0);
+		for (const auto& edge : edgeUse)
+		{
+			if (edge.second != 2)
+			{
+				locked[edge.first >> 32] = locked[edge.first & 0xFFFFFFFF] = 1;
+			}
+		}
+		std::vector<uint32_t> order(mesh.Vertices.size());
+		for (uint32_t v = 0; v < order.size(); v++)
+		{
+			order[v] = v;
+		}
+		auto less = [&](uint32_t a, uint32_t b)
+		{
+			const MeshFloat3& p = mesh.Vertices[a].Position;
+			const MeshFloat3& q = mesh.Vertices[b].Position;
+			return p.x != q.x ? p.x < q.x : p.y != q.y ? p.y < q.y : p.z < q.z;
+		};
+		std::sort(order.begin(), order.end(), less);
+		for (size_t i = 1; i < order.size(); i++)
+		{
+			if (!less(order[i - 1], order[i]))
+			{
+				locked[order[i - 1]] = locked[order[i]] = 1;
+			}
+		}
+		return locked;
+	}
+
+	// Checks every level of mesh.Lods against the full detail triangles: each keeps its
+	// share of the triangles, stays within its recorded error of the source surface and
+	// still uses every locked vertex the source used
+	void CheckLodChain(const MeshData& mesh, float ratio, const char* name)
+	{
+		const uint32_t fullCount = mesh.Lods[0].IndexCount;
+		const SurfaceGrid grid(mesh, fullCount, 64);
+		const std::vector<char> locked = LockedVertices(mesh.Indices.data(), fullCount, mesh);
+		uint32_t lockedCount = 0;
+		for (uint32_t i = 0; i < fullCount; i++)
+		{
+			lockedCount += locked[mesh.Indices[i]] ? 1 : 0;
+		}
+
+		for (size_t level = 1; level < mesh.Lods.size(); level++)
+		{
+			const MeshLod& lod = mesh.Lods[level];
+			const uint32_t* indices = &mesh.Indices[lod.IndexOffset];
+			const float target = fullCount * powf(ratio, static_cast<float>(level));
+			std::printf("%s level %zu: %u -> %u triangles (target %.0f), error %.4f\n", name, level, fullCount / 3,
+				lod.IndexCount / 3, target / 3, lod.Error);
+			CHECK(lod.IndexCount <= target);
+			CHECK(lod.IndexCount % 3 == 0 && lod.IndexCount > 0);
+			CHECK(lod.Error > 0.0f && lod.Error >= mesh.Lods[level - 1].Error);
+
+			// Corners, edge midpoints and the centroid of every triangle. Error is relative to
+			// the extent; the small slack covers float rounding in the grid queries.
+			const float maxDistance = lod.Error * grid.Extent() * 1.001f + grid.Extent() * 1e-6f;
+			uint32_t far = 0;
+			for (uint32_t i = 0; i < lod.IndexCount; i += 3)
+			{
+				const Float3 a = ToFloat3(mesh.Vertices[indices[i + 0]].Position);
+				const Float3 b = ToFloat3(mesh.Vertices[indices[i + 1]].Position);
+				const Float3 c = ToFloat3(mesh.Vertices[indices[i + 2]].Position);
+				const Float3 samples[7] =
+				{
+					a, b, c, Scale(Add(a, b), 0.5f), Scale(Add(b, c), 0.5f), Scale(Add(c, a), 0.5f),
+					Scale(Add(Add(a, b), c), 1.0f / 3.0f),
+				};
+				for (const Float3& sample : samples)
+				{
+					far += grid.Within(sample, maxDistance) ? 0 : 1;
+				}
+			}
+			CHECK(far == 0);
+
+			// Locked vertices are never collapsed, so none drops out of a level
+			std::vector<char> used(mesh.Vertices.size(), 0);
+			for (uint32_t i = 0; i < lod.IndexCount; i++)
+			{
+				used[indices[i]] = 1;
+			}
+			uint32_t lost = 0;
+			for (uint32_t i = 0; i < fullCount; i++)
+			{
+				lost += (locked[mesh.Indices[i]] && !used[mesh.Indices[i]]) ? 1 : 0;
+			}
+			CHECK(lost == 0);
+		}
+		std::printf("%s: %u locked corners\n", name, lockedCount);
+	}
+
+	void TestSkull()
+	{
+		MappedFile file;
+		CHECK(file.Open(SourcePath("Models/skull.txt")));
+		MeshData skull;
+		CHECK(ParseModelText(reinterpret_cast<const char*>(file.Data()), static_cast<size_t>(file.Size()), skull));
+
+		BuildLodChain(skull, 0.5f, DefaultLodLevels, 1);
+		CHECK(skull.Lods.size() == DefaultLodLevels);
+		CheckLodChain(skull, 0.5f, "skull");
+
+		// The same chain whatever the thread count
+		MeshData threaded = skull;
+		BuildLodChain(threaded, 0.5f, DefaultLodLevels, 4);
+		CHECK(threaded.Indices == skull.Indices);
+	}
+
+	// A rippled sheet with an open border all round and a texture seam down the middle:
+	// the columns either side of x = size / 2 use their own vertices at the same positions
+	void TestBorderAndSeam()
+	{
+		const uint32_t size = 64;
+		const uint32_t half = size / 2;
+		MeshData sheet;
+		auto vertex = [&](uint32_t x, uint32_t y, float u)
+		{
+			MeshVertex v = {};
+			v.Position = { static_cast<float>(x), 2.0f * sinf(0.2f * x) * cosf(0.15f * y), static_cast<float>(y) };
+			v.Normal = { 0.0f, 1.0f, 0.0f };
+			v.TexC = { u, static_cast<float>(y) / size };
+			sheet.Vertices.push_back(v);
+		};
+		// Left half, then the right half starting again at the seam column
+		for (uint32_t y = 0; y <= size; y++)
+		{
+			for (uint32_t x = 0; x <= half; x++)
+			{
+				vertex(x, y, static_cast<float>(x) / half);
+			}
+		}
+		const uint32_t rightBase = static_cast<uint32_t>(sheet.Vertices.size());
+		for (uint32_t y = 0; y <= size; y++)
+		{
+			for (uint32_t x = half; x <= size; x++)
+			{
+				vertex(x, y, static_cast<float>(x - half) / half);
+			}
+		}
+		auto index = [&](uint32_t x, uint32_t y, bool right)
+		{
+			return right ? rightBase + y * (half + 1) + (x - half) : y * (half + 1) + x;
+		};
+		for (uint32_t y = 0; y < size; y++)
+		{
+			for (uint32_t x = 0; x < size; x++)
+			{
+				const bool right = x >= half;
+				const uint32_t v00 = index(x, y, right), v10 = index(x + 1, y, right);
+				const uint32_t v01 = index(x, y + 1, right), v11 = index(x + 1, y + 1, right);
+				sheet.Indices.insert(sheet.Indices.end(), { v00, v01, v10, v10, v01, v11 });
+			}
+		}
+
+		const std::vector<char> locked = LockedVertices(sheet.Indices.data(), sheet.Indices.size(), sheet);
+		CHECK(locked[index(0, 10, false)] && locked[index(half, 10, false)] && locked[index(half, 10, true)]);
+		CHECK(!locked[index(10, 10, false)]);
+
+		BuildLodChain(sheet, 0.5f, 3, 1);
+		CHECK(sheet.Lods.size() == 3);
+		CheckLodChain(sheet, 0.5f, "sheet");
+	}
+}
+
+int main()
+{
+	TestSkull();
+	TestBorderAndSeam();
+	return TestResult("SimplifyTests");
+}
@@ -0,0 +1,152 @@
+#include "DdsManifest.h"
+#include "MappedFile.h"
+#include "Parallel.h"
+#include "SubresourceCopy.h"
+#include "TestHarness.h"
+#include "TextureFootprint.h"
+#include <algorithm>
+#include <cstring>
+
+// Staging copies into an upload layout: CopyRows against a memcpy per row, which is what
+// d3dx12's MemcpySubresource does. Like UploadRing12, every copy goes to memory that was
+// not written for a while, so neither side gets its destination from the cache.
+namespace
+{
+	struct Subresource
+	{
+		const uint8_t* Data;
+		size_t Pitch;
+		SubresourceFootprint Footprint;
+	};
+
+	void MemcpyRows(uint8_t* base, const std::vector<Subresource>& subresources)
+	{
+		for (const Subresource& s : subresources)
+		{
+			for (uint32_t y = 0; y < s.Footprint.NumRows * s.Footprint.Depth; y++)
+			{
+				std::memcpy(base + s.Footprint.Offset + static_cast<size_t>(s.Footprint.RowPitch) * y, s.Data + s.Pitch * y,
+					static_cast<size_t>(s.Footprint.RowSizeInBytes));
+			}
+		}
+	}
+
+	void CopyAll(uint8_t* base, const std::vector<Subresource>& subresources, unsigned threadCount)
+	{
+		for (const Subresource& s : subresources)
+		{
+			CopyRowsParallel(base + s.Footprint.Offset, s.Footprint.RowPitch, s.Data, s.Pitch,
+				static_cast<size_t>(s.Footprint.RowSizeInBytes), static_cast<size_t>(s.Footprint.NumRows) * s.Footprint.Depth, threadCount);
+		}
+	}
+
+	// GB/s of copy over a ring of ring.size() bytes, advancing by step each time
+	template<typename Fn>
+	double RingGigabytesPerSecond(std::vector<uint8_t>& ring, size_t step, uint64_t bytes, int iterations, Fn&& copy)
+	{
+		size_t offset = 0;
+		const double ms = MeasureMilliseconds(5, [&]()
+		{
+			for (int i = 0; i < iterations; i++)
+			{
+				copy(ring.data() + offset);
+				offset = (offset + 2 * step > ring.size()) ? 0 : offset + step;
+			}
+		});
+		return bytes * iterations / (ms * 1e6);
+	}
+}
+
+int main()
+{
+	std::vector<DdsManifestEntry> entries;
+	if (!ScanDdsDirectory(SourcePath("Textures"), TestDirectory("SubresourceCopyBenchmark") / "textures.manifest", entries, nullptr, 1))
+	{
+		std::printf("Textures not found\n");
+		return 1;
+	}
+	std::vector<uint8_t> ring(128 << 20);
+
+	std::printf("Shipped textures, GB/s of surface data\n");
+	std::printf("  %-18s  %9s  %9s  %6s  %9s\n", "texture", "bytes", "upload", "memcpy", "CopyRows");
+	double memcpyTotal = 0.0, copyTotal = 0.0;
+	for (const DdsManifestEntry& entry : entries)
+	{
+		MappedFile file;
+		if (entry.Status != DdsStatus_Ok || !file.Open(SourcePath("Textures") / entry.Path))
+		{
+			continue;
+		}
+		const DdsInfo& info = entry.Info;
+		const TextureLayoutDesc desc = { info.Dimension, info.Format, info.Width, info.Height, info.ArraySize, info.MipCount };
+		const uint32_t count = info.MipCount * info.ArraySize;
+		std::vector<SubresourceFootprint> footprints(count);
+		const uint64_t uploadBytes = ComputeTextureFootprints(desc, 0, count, 0, footprints.data());
+
+		std::vector<Subresource> subresources;
+		const uint8_t* data = file.Data() + info.DataOffset;
+		for (uint32_t i = 0; i < count; i++)
+		{
+			size_t surfaceBytes, rowBytes;
+			const uint32_t mip = i % info.MipCount;
+			DdsSurfaceInfo(std::max(info.Width >> mip, 1u), std::max(info.Height >> mip, 1u), info.Format, &surfaceBytes, &rowBytes, nullptr);
+			subresources.push_back({ data, rowBytes, footprints[i] });
+			data += surfaceBytes;
+		}
+
+		const size_t step = (static_cast<size_t>(uploadBytes) + 511) & ~static_cast<size_t>(511);
+		const int iterations = static_cast<int>(std::max<uint64_t>(1, (64 << 20) / info.DataBytes));
+		const double memcpyRate = RingGigabytesPerSecond(ring, step, info.DataBytes, iterations,
+			[&](uint8_t* base) { MemcpyRows(base, subresources); });
+		const double copyRate = RingGigabytesPerSecond(ring, step, info.DataBytes, iterations,
+			[&](uint8_t* base) { CopyAll(base, subresources, 1); });
+		std::printf("  %-18s  %9llu  %9llu  %6.2f  %9.2f\n", entry.Path.c_str(), static_cast<unsigned long long>(info.DataBytes),
+			static_cast<unsigned long long>(uploadBytes), memcpyRate, copyRate);
+		memcpyTotal += memcpyRate;
+		copyTotal += copyRate;
+	}
+	std::printf("  mean: memcpy %.2f GB/s, CopyRows %.2f GB/s\n", memcpyTotal / entries.size(), copyTotal / entries.size());
+
+	// Single large surfaces, where CopyRowsParallel may split the copy. Its threads are
+	// started for each call; 1024^2 is the smallest surface it splits.
+	struct Case
+	{
+		const char* Name;
+		size_t RowBytes;
+		size_t Pitch;
+		size_t Rows;
+	};
+	const Case cases[] =
+	{
+		{ "4096^2 RGBA8", 16384, 16384, 4096 },
+		{ "4000^2 RGBA8", 16000, 16128, 4000 },
+		{ "8192^2 BC1", 16384, 16384, 2048 },
+		{ "1024^2 RGBA8", 4096, 4096, 1024 },
+		{ "512^2 RGBA8", 2048, 2048, 512 },
+	};
+	std::vector<uint8_t> source(64 << 20);
+	for (size_t i = 0; i < source.size(); i++)
+	{
+		source[i] = static_cast<uint8_t>(i * 131 + 7);
+	}
+
+	std::printf("\nLarge surfaces, GB/s (%u cores)\n", DefaultThreadCount());
+	std::printf("  %-14s  %6s  %8s  %10s  %10s\n", "surface", "memcpy", "CopyRows", "2 threads", "4 threads");
+	for (const Case& c : cases)
+	{
+		const std::vector<Subresource> subresources = { { source.data(), c.RowBytes,
+			{ 0, 0, 0, 1, static_cast<uint32_t>(c.Pitch), static_cast<uint32_t>(c.Rows), c.RowBytes } } };
+		const uint64_t bytes = c.RowBytes * c.Rows;
+		const size_t step = c.Pitch * c.Rows;
+		const int iterations = static_cast<int>(std::max<uint64_t>(1, (256 << 20) / bytes));
+		double rates[4];
+		rates[0] = RingGigabytesPerSecond(ring, step, bytes, iterations, [&](uint8_t* base) { MemcpyRows(base, subresources); });
+		const unsigned threadCounts[3] = { 1, 2, 4 };
+		for (int t = 0; t < 3; t++)
+		{
+			rates[t + 1] = RingGigabytesPerSecond(ring, step, bytes, iterations, [&](uint8_t* base) { CopyAll(base, subresources, threadCounts[t]); });
+		}
+		std::printf("  %-14s  %6.2f  %8.2f  %10.2f  %10.2f\n", c.Name, rates[0], rates[1], rates[2], rates[3]);
+	}
+	return 0;
+}
@@ -0,0 +1,66 @@
+#include "SubresourceCopy.h"
+#include "TestHarness.h"
+#include <cstring>
+#include <vector>
+
+namespace
+{
+	// Every row size and misalignment the streaming, block row and memcpy paths see must
+	// match a memcpy per row, and leave the padding between rows alone
+	void TestAgainstMemcpy()
+	{
+		std::vector<uint8_t> source(1 << 20);
+		for (size_t i = 0; i < source.size(); i++)
+		{
+			source[i] = static_cast<uint8_t>(i * 131 + 7);
+		}
+
+		const size_t rowSizes[] = { 1, 3, 8, 15, 16, 17, 63, 64, 65, 200, 1000, 4096, 12000 };
+		const size_t offsets[] = { 0, 1, 5, 16 };
+		for (size_t rowBytes : rowSizes)
+		{
+			for (size_t offset : offsets)
+			{
+				for (size_t pitch : { rowBytes, (rowBytes + 255) & ~static_cast<size_t>(255) })
+				{
+					const size_t rows = 70;
+					std::vector<uint8_t> expected(pitch * rows + 64, 0xAB), actual(pitch * rows + 64, 0xAB);
+					for (size_t y = 0; y < rows; y++)
+					{
+						std::memcpy(expected.data() + offset + pitch * y, source.data() + offset + rowBytes * y, rowBytes);
+					}
+					CopyRows(actual.data() + offset, pitch, source.data() + offset, rowBytes, rowBytes, rows);
+					CHECK(expected == actual);
+				}
+			}
+		}
+	}
+
+	// Split into bands, the copy is the same as in one go
+	void TestParallel()
+	{
+		const size_t rowBytes = 16000, pitch = 16128, rows = 400;
+		std::vector<uint8_t> source(rowBytes * rows);
+		for (size_t i = 0; i < source.size(); i++)
+		{
+			source[i] = static_cast<uint8_t>(i * 73 + 1);
+		}
+		static_assert(16000 * 400 >= ParallelCopyMinBytes, "the copy must be large enough to split");
+
+		std::vector<uint8_t> expected(pitch * rows, 0), actual(pitch * rows, 0);
+		CopyRows(expected.data(), pitch, source.data(), rowBytes, rowBytes, rows);
+		for (unsigned threads : { 2u, 3u, 4u, 0u })
+		{
+			std::fill(actual.begin(), actual.end(), 0);
+			CopyRowsParallel(actual.data(), pitch, source.data(), rowBytes, rowBytes, rows, threads);
+			CHECK(expected == actual);
+		}
+	}
+}
+
+int main()
+{
+	TestAgainstMemcpy();
+	TestParallel();
+	return TestResult("SubresourceCopyTests");
+}
@@ -0,0 +1,59 @@
+#include "TestCamera.h"
+#include <cmath>
+
+namespace
+{
+	MeshFloat3 Normalize(const MeshFloat3& v)
+	{
+		const float length = sqrtf(v.x * v.x + v.y * v.y + v.z * v.z);
+		return { v.x / length, v.y / length, v.z / length };
+	}
+
+	MeshFloat3 Cross(const MeshFloat3& a, const MeshFloat3& b)
+	{
+		return { a.y * b.z - a.z * b.y, a.z * b.x - a.x * b.z, a.x * b.y - a.y * b.x };
+	}
+
+	float Dot(const MeshFloat3& a, const MeshFloat3& b)
+	{
+		return a.x * b.x + a.y * b.y + a.z * b.z;
+	}
+}
+
+void LookAtPerspective(const MeshFloat3& eye, const MeshFloat3& target, const MeshFloat3& up,
+	float fovY, float aspect, float nearZ, float farZ, float viewProj[16])
+{
+	const MeshFloat3 z = Normalize({ target.x - eye.x, target.y - eye.y, target.z - eye.z });
+	const MeshFloat3 x = Normalize(Cross(up, z));
+	const MeshFloat3 y = Cross(z, x);
+	const float view[16] =
+	{
+		x.x, y.x, z.x, 0.0f,
+		x.y, y.y, z.y, 0.0f,
+		x.z, y.z, z.z, 0.0f,
+		-Dot(x, eye), -Dot(y, eye), -Dot(z, eye), 1.0f,
+	};
+
+	const float h = 1.0f / tanf(0.5f * fovY);
+	const float range = farZ / (farZ - nearZ);
+	const float proj[16] =
+	{
+		h / aspect, 0.0f, 0.0f, 0.0f,
+		0.0f, h, 0.0f, 0.0f,
+		0.0f, 0.0f, range, 1.0f,
+		0.0f, 0.0f, -range * nearZ, 0.0f,
+	};
+
+	for (int r = 0; r < 4; r++)
+	{
+		for (int c = 0; c < 4; c++)
+		{
+			float sum = 0.0f;
+			for (int k = 0; k < 4; k++)
+			{
+				sum += view[r * 4 + k] * proj[k * 4 + c];
+			}
+			viewProj[r * 4 + c] = sum;
+		}
+	}
+}
@@ -0,0 +1,7 @@
+#pragma once
+#include "Mesh.h"
+
+// XMMatrixLookAtLH(eye, target, up) * XMMatrixPerspectiveFovLH(fovY, aspect, nearZ, farZ)
+// without DirectXMath: row-major for row vectors, the layout ExtractMeshletFrustum takes
+void LookAtPerspective(const MeshFloat3& eye, const MeshFloat3& target, const MeshFloat3& up,
+	float fovY, float aspect, float nearZ, float farZ, float viewProj[16]);
@@ -0,0 +1,74 @@
+#pragma once
+#include <chrono>
+#include <cmath>
+#include <cstdio>
+#include <filesystem>
+#include <system_error>
+
+// Minimal harness for the portable module tests: CHECK records a failure and
+// keeps going, main returns TestResult() so ctest sees the outcome.
+
+inline int& TestFailures()
+{
+	static int failures = 0;
+	return failures;
+}
+
+inline void ReportFailure(const char* file, int line, const char* expression)
+{
+	std::fprintf(stderr, "%s(%d): check failed: %s\n", file, line, expression);
+	TestFailures()++;
+}
+
+#define CHECK(condition) \
+	do { if (!(condition)) ReportFailure(__FILE__, __LINE__, #condition); } while (0)
+
+#define CHECK_NEAR(a, b, tolerance) \
+	do { if (!(std::fabs(static_cast<double>(a) - static_cast<double>(b)) <= static_cast<double>(tolerance))) \
+		ReportFailure(__FILE__, __LINE__, #a " ~= " #b); } while (0)
+
+inline int TestResult(const char* name)
+{
+	if (TestFailures() != 0)
+	{
+		std::printf("%s: %d check(s) failed\n", name, TestFailures());
+		return 1;
+	}
+	std::printf("%s: passed\n", name);
+	return 0;
+}
+
+// Path of a file shipped with the application, e.g. SourcePath("Models/skull.txt")
+inline std::filesystem::path SourcePath(const char* relative)
+{
+	return std::filesystem::path(HELLOD3D12_SOURCE_DIR) / relative;
+}
+
+// Empty scratch directory under the system temp directory; tests never write
+// into the source tree
+inline std::filesystem::path TestDirectory(const char* name)
+{
+	std::error_code ec;
+	std::filesystem::path dir = std::filesystem::temp_directory_path(ec) / "HelloD3D12Tests" / name;
+	std::filesystem::remove_all(dir, ec);
+	std::filesystem::create_directories(dir, ec);
+	return dir;
+}
+
+// Best of repeats runs of fn, in milliseconds
+template<typename Fn>
+double MeasureMilliseconds(int repeats, Fn&& fn)
+{
+	double best = 0.0;
+	for (int i = 0; i < repeats; i++)
+	{
+		auto start = std::chrono::steady_clock::now();
+		fn();
+		double ms = std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - start).count();
+		if (i == 0 || ms < best)
+		{
+			best = ms;
+		}
+	}
+	return best;
+}
@@ -0,0 +1,73 @@
+#include "DdsMips.h"
+#include "MappedFile.h"
+#include "Parallel.h"
+#include "TestHarness.h"
+#include <algorithm>
+#include <atomic>
+#include <vector>
+
+// The CPU side of TextureBatchLoader12::LoadTexturesBatch over the Textures folder:
+// workers claim files one at a time, map and parse them, build mip chains with the
+// loader's ExpandDdsMips and copy the surfaces to staging memory. Run with one worker
+// this is the serial load Graphics::Init does per texture.
+namespace
+{
+	// Bytes staged for upload, or 0 if the file does not load
+	size_t LoadTexture(const std::filesystem::path& path, std::vector<uint8_t>& mips, std::vector<uint8_t>& staging)
+	{
+		MappedFile file;
+		DdsInfo info;
+		if (!file.Open(path) || ParseDdsHeader(file.Data(), file.Size(), file.Size(), info) != DdsStatus_Ok)
+		{
+			return 0;
+		}
+		const uint8_t* data = file.Data() + info.DataOffset;
+		size_t size = static_cast<size_t>(info.DataBytes);
+		ExpandDdsMips(info, data, size, mips, 1);
+		staging.assign(data, data + size);
+		return size;
+	}
+}
+
+int main()
+{
+	std::vector<std::filesystem::path> files;
+	for (const auto& entry : std::filesystem::directory_iterator(SourcePath("Textures")))
+	{
+		if (entry.path().extension() == ".dds")
+		{
+			files.push_back(entry.path());
+		}
+	}
+	std::sort(files.begin(), files.end());
+
+	std::vector<unsigned> workerCounts = { 1, 2, 4 };
+	if (std::find(workerCounts.begin(), workerCounts.end(), DefaultThreadCount()) == workerCounts.end())
+	{
+		workerCounts.push_back(DefaultThreadCount());
+	}
+
+	std::printf("%zu files, %u cores\n", files.size(), DefaultThreadCount());
+	std::printf("  workers  ms per directory  MB/s staged  speedup\n");
+	double serialMs = 0.0;
+	for (unsigned workers : workerCounts)
+	{
+		std::atomic<size_t> staged(0);
+		const double ms = MeasureMilliseconds(20, [&]()
+		{
+			staged = 0;
+			std::atomic<size_t> next(0);
+			ParallelFor(workers, workers, [&](size_t)
+			{
+				std::vector<uint8_t> mips, staging;
+				for (size_t i = next.fetch_add(1); i < files.size(); i = next.fetch_add(1))
+				{
+					staged += LoadTexture(files[i], mips, staging);
+				}
+			});
+		});
+		serialMs = (workers == 1) ? ms : serialMs;
+		std::printf("  %7u  %16.2f  %11.0f  %7.2f\n", workers, ms, staged / (ms * 1e3), serialMs / ms);
+	}
+	return 0;
+}
@@ -0,0 +1,90 @@
+#include "MappedFile.h"
+#include "TestHarness.h"
+#include "TextureCache.h"
+#include <algorithm>
+#include <string>
+#include <vector>
+
+// Cost of keying every texture in the Textures folder, and how often TextureCache12
+// would share a texture among the same-size crate and fence files. Their content
+// differs, so only repeated loads and a renamed copy hit.
+namespace
+{
+	struct LoadedFile
+	{
+		std::string Name;
+		std::vector<uint8_t> Bytes;
+	};
+}
+
+int main()
+{
+	std::vector<LoadedFile> files;
+	for (const auto& entry : std::filesystem::directory_iterator(SourcePath("Textures")))
+	{
+		MappedFile file;
+		if (entry.path().extension() == ".dds" && file.Open(entry.path()))
+		{
+			files.push_back({ entry.path().filename().string(), std::vector<uint8_t>(file.Data(), file.Data() + file.Size()) });
+		}
+	}
+	std::sort(files.begin(), files.end(), [](const LoadedFile& a, const LoadedFile& b) { return a.Name < b.Name; });
+
+	size_t totalBytes = 0;
+	for (const LoadedFile& file : files)
+	{
+		totalBytes += file.Bytes.size();
+	}
+	// Kept so the hashing is not optimized away
+	volatile uint64_t sink = 0;
+	const double ms = MeasureMilliseconds(20, [&]()
+	{
+		for (const LoadedFile& file : files)
+		{
+			sink = sink + MakeTextureCacheKey(file.Bytes.data(), file.Bytes.size(), 0, false).Hash;
+		}
+	});
+	std::printf("%zu files, %.2f MB: keyed in %.3f ms, %.2f GB/s\n\n", files.size(), totalBytes / 1e6, ms, totalBytes / (ms * 1e6));
+
+	// The crates and the fence are the same size. Each is loaded by a few materials,
+	// then the first crate again from a copy under another name.
+	const char* names[] = { "WoodCrate01.dds", "WoodCrate02.dds", "WireFence.dds" };
+	const uint32_t loads[] = { 3, 2, 2 };
+	TextureCache cache;
+	auto load = [&](const std::vector<uint8_t>& bytes)
+	{
+		const TextureCacheKey key = MakeTextureCacheKey(bytes.data(), bytes.size(), 0, false);
+		const uint32_t slot = cache.Find(key);
+		return (slot != TextureCache::InvalidSlot) ? slot : cache.Insert(key);
+	};
+
+	std::printf("  %-17s  %8s  %16s  %4s\n", "file", "bytes", "XXH64", "slot");
+	std::vector<uint8_t> renamed;
+	for (size_t n = 0; n < 3; n++)
+	{
+		auto it = std::find_if(files.begin(), files.end(), [&](const LoadedFile& file) { return file.Name == names[n]; });
+		if (it == files.end())
+		{
+			std::printf("%s not found\n", names[n]);
+			return 1;
+		}
+		uint32_t slot = TextureCache::InvalidSlot;
+		for (uint32_t i = 0; i < loads[n]; i++)
+		{
+			slot = load(it->Bytes);
+		}
+		std::printf("  %-17s  %8zu  %016llx  %4u\n", it->Name.c_str(), it->Bytes.size(),
+			static_cast<unsigned long long>(MakeTextureCacheKey(it->Bytes.data(), it->Bytes.size(), 0, false).Hash), slot);
+		if (n == 0)
+		{
+			renamed = it->Bytes;
+		}
+	}
+	std::printf("  %-17s  %8zu  %16s  %4u\n", "(copy of crate 1)", renamed.size(), "", load(renamed));
+
+	const TextureCache::Statistics stats = cache.GetStatistics();
+	std::printf("\n  %llu loads, %llu hits (%.0f%%), %u textures\n",
+		static_cast<unsigned long long>(stats.Lookups), static_cast<unsigned long long>(stats.Hits),
+		100.0 * stats.Hits / stats.Lookups, stats.LiveSlots);
+	return 0;
+}
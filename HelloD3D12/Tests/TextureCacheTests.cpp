@@ -0,0 +1,73 @@
+#include "TextureCache.h"
+#include "TestHarness.h"
+#include <vector>
+
+namespace
+{
+	// Keys agree only when content and every load parameter do
+	void TestKeys()
+	{
+		std::vector<uint8_t> a(4096), b(4096);
+		for (size_t i = 0; i < a.size(); i++)
+		{
+			a[i] = static_cast<uint8_t>(i * 7);
+			b[i] = a[i];
+		}
+		CHECK(MakeTextureCacheKey(a.data(), a.size(), 0, false) == MakeTextureCacheKey(b.data(), b.size(), 0, false));
+		CHECK(MakeTextureCacheKey(a.data(), a.size(), 1024, true) == MakeTextureCacheKey(b.data(), b.size(), 1024, true));
+
+		CHECK(!(MakeTextureCacheKey(a.data(), a.size(), 0, false) == MakeTextureCacheKey(a.data(), a.size(), 1024, false)));
+		CHECK(!(MakeTextureCacheKey(a.data(), a.size(), 512, false) == MakeTextureCacheKey(a.data(), a.size(), 1024, false)));
+		CHECK(!(MakeTextureCacheKey(a.data(), a.size(), 0, false) == MakeTextureCacheKey(a.data(), a.size(), 0, true)));
+
+		// Same size, one byte apart; and a prefix of the same bytes
+		b[2000] ^= 1;
+		CHECK(!(MakeTextureCacheKey(a.data(), a.size(), 0, false) == MakeTextureCacheKey(b.data(), b.size(), 0, false)));
+		CHECK(!(MakeTextureCacheKey(a.data(), a.size(), 0, false) == MakeTextureCacheKey(a.data(), a.size() - 1, 0, false)));
+	}
+
+	void TestReferences()
+	{
+		const uint8_t crate[] = { 1, 2, 3, 4 };
+		const uint8_t fence[] = { 5, 6, 7, 8 };
+		const TextureCacheKey crateKey = MakeTextureCacheKey(crate, sizeof(crate), 0, false);
+		const TextureCacheKey crateSrgbKey = MakeTextureCacheKey(crate, sizeof(crate), 0, true);
+		const TextureCacheKey fenceKey = MakeTextureCacheKey(fence, sizeof(fence), 0, false);
+
+		TextureCache cache;
+		CHECK(cache.Find(crateKey) == TextureCache::InvalidSlot);
+		const uint32_t crateSlot = cache.Insert(crateKey);
+		CHECK(crateSlot == 0 && cache.References(crateSlot) == 1);
+
+		// A second load of the same content shares the slot; other parameters do not
+		CHECK(cache.Find(crateKey) == crateSlot && cache.References(crateSlot) == 2);
+		CHECK(cache.Find(crateSrgbKey) == TextureCache::InvalidSlot);
+		const uint32_t crateSrgbSlot = cache.Insert(crateSrgbKey);
+		CHECK(crateSrgbSlot == 1);
+
+		// The last release frees the slot and forgets the key
+		CHECK(!cache.Release(crateSlot) && cache.References(crateSlot) == 1);
+		CHECK(cache.Release(crateSlot) && cache.References(crateSlot) == 0);
+		CHECK(!cache.Release(crateSlot));
+		CHECK(cache.Find(crateKey) == TextureCache::InvalidSlot);
+
+		// Freed slots are reused before new ones are made
+		const uint32_t fenceSlot = cache.Insert(fenceKey);
+		CHECK(fenceSlot == crateSlot && cache.References(fenceSlot) == 1);
+		CHECK(cache.Find(fenceKey) == fenceSlot);
+		CHECK(cache.Insert(crateKey) == 2);
+		CHECK(cache.SlotCount() == 3);
+
+		const TextureCache::Statistics stats = cache.GetStatistics();
+		CHECK(stats.Lookups == 5 && stats.Hits == 2);
+		CHECK(stats.HashedBytes == 5 * sizeof(crate));
+		CHECK(stats.LiveSlots == 3);
+	}
+}
+
+int main()
+{
+	TestKeys();
+	TestReferences();
+	return TestResult("TextureCacheTests");
+}
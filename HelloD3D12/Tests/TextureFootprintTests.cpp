@@ -0,0 +1,150 @@
+#include "DdsManifest.h"
+#include "Parallel.h"
+#include "TestHarness.h"
+#include "TextureFootprint.h"
+
+// Layouts the D3D12 rules give by hand: rows padded to 256 bytes, subresources placed at
+// 512, block compressed formats in 4x4 blocks and 4:2:2 formats in texel pairs. Debug
+// builds of the application compare every cached layout with GetCopyableFootprints.
+namespace
+{
+	// DXGI_FORMAT values
+	const uint32_t FormatRgba8 = 28;
+	const uint32_t FormatBc3 = 77;
+	const uint32_t FormatBgra8 = 87;
+	const uint32_t FormatNv12 = 103;
+	const uint32_t FormatYuy2 = 107;
+
+	// Field by field: the struct has padding that copies need not preserve
+	bool SameFootprints(const SubresourceFootprint* a, const SubresourceFootprint* b, uint32_t count)
+	{
+		for (uint32_t i = 0; i < count; i++)
+		{
+			if (a[i].Offset != b[i].Offset || a[i].Width != b[i].Width || a[i].Height != b[i].Height ||
+				a[i].Depth != b[i].Depth || a[i].RowPitch != b[i].RowPitch || a[i].NumRows != b[i].NumRows ||
+				a[i].RowSizeInBytes != b[i].RowSizeInBytes)
+			{
+				return false;
+			}
+		}
+		return true;
+	}
+
+	void TestKnownLayouts()
+	{
+		SubresourceFootprint footprints[30];
+
+		const TextureLayoutDesc bc3 = { DdsDimension_Texture2D, FormatBc3, 512, 512, 1, 10 };
+		const uint64_t offsets[10] = { 0, 262144, 327680, 344064, 348160, 350208, 351232, 351744, 352256, 352768 };
+		CHECK(ComputeTextureFootprints(bc3, 0, 10, 0, footprints) == 352784);
+		for (uint32_t mip = 0; mip < 10; mip++)
+		{
+			CHECK(footprints[mip].Offset == offsets[mip]);
+		}
+		CHECK(footprints[0].RowPitch == 2048 && footprints[0].NumRows == 128 && footprints[0].RowSizeInBytes == 2048);
+		CHECK(footprints[9].Width == 4 && footprints[9].Height == 4 && footprints[9].NumRows == 1);
+		CHECK(footprints[9].RowSizeInBytes == 16 && footprints[9].RowPitch == 256);
+
+		// A range starts at the base offset; the tail of the chain alone
+		CHECK(ComputeTextureFootprints(bc3, 7, 3, 1024, footprints) == 1040);
+		CHECK(footprints[0].Offset == 1024 && footprints[1].Offset == 1536 && footprints[2].Offset == 2048);
+		CHECK(ComputeTextureFootprints(bc3, 5, 6, 0, footprints) == 0);
+
+		const TextureLayoutDesc bc3Array = { DdsDimension_Texture2D, FormatBc3, 512, 512, 3, 10 };
+		CHECK(ComputeTextureFootprints(bc3Array, 0, 30, 0, footprints) > 0);
+		CHECK(footprints[10].Offset == 353280 && footprints[20].Offset == 2 * 353280);
+
+		const TextureLayoutDesc texel = { DdsDimension_Texture2D, FormatBgra8, 1, 1, 1, 1 };
+		CHECK(ComputeTextureFootprints(texel, 0, 1, 0, footprints) == 4 && footprints[0].RowPitch == 256);
+
+		const TextureLayoutDesc volume = { DdsDimension_Texture3D, FormatRgba8, 64, 32, 16, 3 };
+		CHECK(ComputeTextureFootprints(volume, 0, 3, 0, footprints) > 0);
+		CHECK(footprints[0].Depth == 16 && footprints[1].Depth == 8 && footprints[2].Depth == 4);
+		CHECK(footprints[1].Offset == 256ull * 32 * 16 && footprints[1].NumRows == 16);
+
+		const TextureLayoutDesc line = { DdsDimension_Texture1D, FormatRgba8, 300, 1, 2, 2 };
+		CHECK(ComputeTextureFootprints(line, 0, 4, 0, footprints) > 0);
+		CHECK(footprints[0].RowSizeInBytes == 1200 && footprints[0].RowPitch == 1280);
+		CHECK(footprints[1].Width == 150 && footprints[1].Offset == 1536 && footprints[2].Offset == 2560);
+
+		const TextureLayoutDesc yuy2 = { DdsDimension_Texture2D, FormatYuy2, 7, 3, 1, 1 };
+		CHECK(ComputeTextureFootprints(yuy2, 0, 1, 0, footprints) == 528);
+		CHECK(footprints[0].Width == 8 && footprints[0].RowSizeInBytes == 16);
+
+		// Planar formats need the device
+		const TextureLayoutDesc nv12 = { DdsDimension_Texture2D, FormatNv12, 64, 64, 1, 1 };
+		CHECK(ComputeTextureFootprints(nv12, 0, 1, 0, footprints) == 0);
+	}
+
+	// For every shipped texture the packed rows add up to the surfaces in the file, and
+	// every range the cache hands out matches a direct computation
+	void TestShippedTextures()
+	{
+		std::vector<DdsManifestEntry> entries;
+		CHECK(ScanDdsDirectory(SourcePath("Textures"), TestDirectory("TextureFootprint") / "textures.manifest", entries, nullptr, 1));
+		CHECK(entries.size() == 22);
+
+		TextureFootprintCache cache;
+		for (const DdsManifestEntry& entry : entries)
+		{
+			const DdsInfo& info = entry.Info;
+			const bool volume = info.Dimension == DdsDimension_Texture3D;
+			const TextureLayoutDesc desc = { info.Dimension, info.Format, info.Width, info.Height,
+				volume ? info.Depth : info.ArraySize, info.MipCount };
+			const uint32_t count = info.MipCount * (volume ? 1 : info.ArraySize);
+
+			std::vector<SubresourceFootprint> direct(count), cached(count);
+			const uint64_t total = ComputeTextureFootprints(desc, 0, count, 0, direct.data());
+			uint64_t packed = 0;
+			for (const SubresourceFootprint& footprint : direct)
+			{
+				packed += footprint.RowSizeInBytes * footprint.NumRows * footprint.Depth;
+				CHECK(footprint.Offset % TexturePlacementAlignment == 0 && footprint.RowPitch % TexturePitchAlignment == 0);
+				CHECK(footprint.RowPitch >= footprint.RowSizeInBytes);
+			}
+			CHECK(packed == info.DataBytes);
+			CHECK(total >= packed);
+
+			uint32_t layoutCount = 0;
+			const SubresourceFootprint* layout = cache.FindLayout(desc, layoutCount);
+			CHECK(layout && layoutCount == count && SameFootprints(layout, direct.data(), count));
+
+			for (uint32_t first = 0; first < count; first++)
+			{
+				for (uint32_t n = 1; first + n <= count; n++)
+				{
+					CHECK(ComputeTextureFootprints(desc, first, n, 1024, direct.data()) == cache.GetFootprints(desc, first, n, 1024, cached.data()));
+					CHECK(SameFootprints(direct.data(), cached.data(), n));
+					CHECK(FootprintRangeBytes(cached.data(), n) == ComputeTextureFootprints(desc, first, n, 0, nullptr));
+				}
+			}
+		}
+
+		// Several files share a shape
+		const TextureFootprintCache::Statistics stats = cache.GetStatistics();
+		CHECK(stats.Layouts < entries.size() && stats.Hits + stats.Layouts == stats.Lookups);
+	}
+
+	// Many threads asking for a few shapes at once get one layout per shape
+	void TestThreads()
+	{
+		TextureFootprintCache cache;
+		ParallelFor(256, 4, [&](size_t i)
+		{
+			TextureLayoutDesc desc = { DdsDimension_Texture2D, FormatBc3, 512 + (i % 8) * 4, 512, 3, 10 };
+			SubresourceFootprint footprints[30], expected[30];
+			CHECK(cache.GetFootprints(desc, 0, 30, 0, footprints) == ComputeTextureFootprints(desc, 0, 30, 0, expected));
+			CHECK(SameFootprints(footprints, expected, 30));
+		});
+		const TextureFootprintCache::Statistics stats = cache.GetStatistics();
+		CHECK(stats.Layouts == 8 && stats.Lookups == 256 && stats.Hits == 248);
+	}
+}
+
+int main()
+{
+	TestKnownLayouts();
+	TestShippedTextures();
+	TestThreads();
+	return TestResult("TextureFootprintTests");
+}
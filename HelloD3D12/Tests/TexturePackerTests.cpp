@@ -0,0 +1,229 @@
+#include "TestHarness.h"
+#include "TexturePacker.h"
+#include <cmath>
+#include <random>
+
+namespace
+{
+	// DXGI_FORMAT values
+	const uint32_t FormatBc1 = 71;
+	const uint32_t FormatBc2 = 74;
+	const uint32_t FormatBc3 = 77;
+
+	uint32_t Gutter(const TexturePackOptions& options)
+	{
+		return (options.Padding + options.Alignment - 1) / options.Alignment * options.Alignment;
+	}
+
+	// Every input lands in exactly one place, atlas entries and their gutters stay inside
+	// the atlas without overlapping, and the remaps point at where the texture went
+	void CheckPlan(const std::vector<TexturePackInput>& inputs, const TexturePackPlan& plan, const TexturePackOptions& options)
+	{
+		const uint32_t gutter = Gutter(options);
+		std::vector<uint32_t> placed(inputs.size(), 0);
+		CHECK(plan.Remaps.size() == inputs.size());
+
+		for (size_t a = 0; a < plan.Arrays.size(); a++)
+		{
+			const TexturePackArray& array = plan.Arrays[a];
+			CHECK(array.Slices.size() >= options.MinArraySlices);
+			for (size_t s = 0; s < array.Slices.size(); s++)
+			{
+				const TexturePackInput& input = inputs[array.Slices[s]];
+				const TextureRemap& remap = plan.Remaps[array.Slices[s]];
+				placed[array.Slices[s]]++;
+				CHECK(input.Width == array.Width && input.Height == array.Height);
+				CHECK(input.MipCount == array.MipCount && input.Format == array.Format);
+				CHECK(remap.Kind == TexturePackKind_Array && remap.Index == a && remap.ArraySlice == s);
+				CHECK(remap.ScaleU == 1.0f && remap.ScaleV == 1.0f && remap.BiasU == 0.0f && remap.BiasV == 0.0f);
+			}
+		}
+
+		for (size_t i = 0; i < plan.Singles.size(); i++)
+		{
+			placed[plan.Singles[i]]++;
+			const TextureRemap& remap = plan.Remaps[plan.Singles[i]];
+			CHECK(remap.Kind == TexturePackKind_Single && remap.Index == i);
+		}
+
+		for (size_t a = 0; a < plan.Atlases.size(); a++)
+		{
+			const TexturePackAtlas& atlas = plan.Atlases[a];
+			CHECK(atlas.Width <= options.MaxAtlasSize && atlas.Height <= options.MaxAtlasSize);
+			for (size_t i = 0; i < atlas.Rects.size(); i++)
+			{
+				const TexturePackRect& rect = atlas.Rects[i];
+				const TexturePackInput& input = inputs[rect.Input];
+				placed[rect.Input]++;
+				CHECK(!input.Wraps && input.Format == atlas.Format);
+				CHECK(rect.X % options.Alignment == 0 && rect.Y % options.Alignment == 0);
+				CHECK(rect.X >= gutter && rect.Y >= gutter);
+				CHECK(rect.X + input.Width + gutter <= atlas.Width && rect.Y + input.Height + gutter <= atlas.Height);
+
+				const TextureRemap& remap = plan.Remaps[rect.Input];
+				CHECK(remap.Kind == TexturePackKind_Atlas && remap.Index == a);
+				CHECK_NEAR(remap.BiasU * atlas.Width, rect.X, 1e-3);
+				CHECK_NEAR(remap.BiasV * atlas.Height, rect.Y, 1e-3);
+				CHECK_NEAR(remap.ScaleU * atlas.Width, input.Width, 1e-3);
+				CHECK_NEAR(remap.ScaleV * atlas.Height, input.Height, 1e-3);
+
+				for (size_t j = i + 1; j < atlas.Rects.size(); j++)
+				{
+					const TexturePackRect& other = atlas.Rects[j];
+					const TexturePackInput& otherInput = inputs[other.Input];
+					const bool apartX = rect.X + input.Width + gutter <= other.X - gutter || other.X + otherInput.Width + gutter <= rect.X - gutter;
+					const bool apartY = rect.Y + input.Height + gutter <= other.Y - gutter || other.Y + otherInput.Height + gutter <= rect.Y - gutter;
+					CHECK(apartX || apartY);
+				}
+			}
+		}
+
+		for (uint32_t count : placed)
+		{
+			CHECK(count == 1);
+		}
+	}
+
+	// The Textures folder: the tiling 512x512 BC3 textures with full chains share an
+	// array, the BC1 ones without mips another, and the clamped tree sprites an atlas
+	void TestShippedTextures()
+	{
+		struct Texture
+		{
+			uint32_t Width, Height, MipCount, Format;
+			bool Wraps;
+		};
+		const Texture textures[] =
+		{
+			{ 512, 512, 10, FormatBc3, true },	// WireFence
+			{ 512, 512, 10, FormatBc3, true },	// WoodCrate01
+			{ 512, 512, 10, FormatBc3, true },	// WoodCrate02
+			{ 512, 512, 1, FormatBc1, true },	// bricks
+			{ 512, 512, 10, FormatBc3, true },	// bricks2
+			{ 512, 512, 1, FormatBc1, true },	// bricks3
+			{ 512, 512, 1, FormatBc1, true },	// checkboard
+			{ 512, 512, 10, FormatBc3, true },	// grass
+			{ 512, 512, 1, FormatBc1, true },	// ice
+			{ 512, 512, 1, FormatBc1, true },	// stone
+			{ 512, 512, 1, FormatBc1, true },	// tile
+			{ 208, 256, 1, FormatBc2, false },	// tree01S
+			{ 304, 268, 1, FormatBc2, false },	// tree02S
+			{ 228, 336, 1, FormatBc2, false },	// tree35S
+			{ 256, 256, 9, FormatBc1, true },	// water1
+		};
+		std::vector<TexturePackInput> inputs;
+		for (const Texture& texture : textures)
+		{
+			TexturePackInput input;
+			input.Width = texture.Width;
+			input.Height = texture.Height;
+			input.MipCount = texture.MipCount;
+			input.Format = texture.Format;
+			input.Wraps = texture.Wraps;
+			inputs.push_back(input);
+		}
+
+		const TexturePackOptions options;
+		const TexturePackPlan plan = PackTextures(inputs, options);
+		CheckPlan(inputs, plan, options);
+		CHECK(plan.Arrays.size() == 2);
+		CHECK(plan.Atlases.size() == 1 && plan.Atlases[0].Rects.size() == 3);
+		CHECK(plan.Singles.size() == 1 && plan.Singles[0] == 14);
+	}
+
+	// Random sets of sizes, formats and paddings
+	void TestRandom()
+	{
+		std::mt19937 rng(18);
+		for (int iteration = 0; iteration < 300; iteration++)
+		{
+			std::vector<TexturePackInput> inputs(1 + rng() % 60);
+			for (TexturePackInput& input : inputs)
+			{
+				input.Width = (1 + rng() % 60) * 4 * (1 + rng() % 3);
+				input.Height = (1 + rng() % 60) * 4 * (1 + rng() % 3);
+				input.Format = rng() % 2;
+				input.Wraps = rng() % 4 == 0;
+			}
+			TexturePackOptions options;
+			options.MaxAtlasSize = 1024;
+			options.Padding = rng() % 12;
+			CheckPlan(inputs, PackTextures(inputs, options), options);
+		}
+	}
+
+	// Row vectors: (u, v, 0, 1) times the composed matrix applies the material transform,
+	// then the remap, and puts the slice in the third coordinate
+	void TestApplyRemap()
+	{
+		TextureRemap remap;
+		remap.ScaleU = 0.25f;
+		remap.ScaleV = 0.5f;
+		remap.BiasU = 0.125f;
+		remap.BiasV = 0.5f;
+		remap.ArraySlice = 3;
+		float m[4][4] = { { 2, 0, 0, 0 }, { 0, 2, 0, 0 }, { 0, 0, 1, 0 }, { 0, 0, 0, 1 } };
+		ApplyTextureRemap(remap, m);
+
+		const float u = 0.25f, v = 0.5f;
+		CHECK_NEAR(u * m[0][0] + v * m[1][0] + m[3][0], 2 * u * 0.25f + 0.125f, 1e-6);
+		CHECK_NEAR(u * m[0][1] + v * m[1][1] + m[3][1], 2 * v * 0.5f + 0.5f, 1e-6);
+		CHECK_NEAR(u * m[0][2] + v * m[1][2] + m[3][2], 3.0f, 1e-6);
+	}
+
+	// Each texture's gutter repeats its edges; with solid images every texel in and
+	// around an entry has the entry's colour
+	void TestAtlasImage()
+	{
+		RgbaImage a, b;
+		a.Width = 3;
+		a.Height = 2;
+		a.Rgba.assign(a.Width * a.Height * 4, 10);
+		b.Width = 4;
+		b.Height = 4;
+		b.Rgba.assign(b.Width * b.Height * 4, 200);
+
+		std::vector<TexturePackInput> inputs(2);
+		inputs[0].Width = a.Width;
+		inputs[0].Height = a.Height;
+		inputs[0].Wraps = false;
+		inputs[1].Width = b.Width;
+		inputs[1].Height = b.Height;
+		inputs[1].Wraps = false;
+
+		const TexturePackOptions options;
+		const TexturePackPlan plan = PackTextures(inputs, options);
+		CHECK(plan.Atlases.size() == 1);
+		if (plan.Atlases.size() != 1)
+		{
+			return;
+		}
+		const RgbaImage image = BuildAtlasImage(plan.Atlases[0], { &a, &b }, options);
+		CHECK(image.Width == plan.Atlases[0].Width && image.Height == plan.Atlases[0].Height);
+
+		const int gutter = static_cast<int>(Gutter(options));
+		uint32_t mismatches = 0;
+		for (const TexturePackRect& rect : plan.Atlases[0].Rects)
+		{
+			const RgbaImage& source = rect.Input ? b : a;
+			for (int y = -gutter; y < static_cast<int>(source.Height) + gutter; y++)
+			{
+				for (int x = -gutter; x < static_cast<int>(source.Width) + gutter; x++)
+				{
+					const size_t texel = (static_cast<size_t>(rect.Y + y) * image.Width + rect.X + x) * 4;
+					mismatches += (image.Rgba[texel] != source.Rgba[0]) ? 1 : 0;
+				}
+			}
+		}
+		CHECK(mismatches == 0);
+	}
+}
+
+int main()
+{
+	TestShippedTextures();
+	TestRandom();
+	TestApplyRemap();
+	TestAtlasImage();
+	return TestResult("TexturePackerTests");
+}
@@ -0,0 +1,140 @@
+#include "TestHarness.h"
+#include "TlsfAllocator.h"
+#include <iterator>
+#include <map>
+#include <random>
+
+namespace
+{
+	void TestBasic()
+	{
+		const uint64_t Capacity = 1 << 20;
+		TlsfAllocator allocator(Capacity, 4096);
+		TlsfAllocator::Statistics stats = allocator.GetStatistics();
+		CHECK(stats.Capacity == Capacity && stats.FreeSize == Capacity && stats.LargestFreeBlock == Capacity);
+		CHECK(stats.AllocationCount == 0 && stats.FreeBlockCount == 1);
+
+		// Sizes round up to the granularity
+		TlsfAllocator::Allocation a, b, c;
+		CHECK(allocator.Allocate(1, 4096, a) && a.Offset == 0);
+		CHECK(allocator.Allocate(5000, 4096, b) && b.Offset == 4096);
+		CHECK(allocator.GetStatistics().FreeSize == Capacity - 3 * 4096);
+
+		// Alignment padding goes back to the free lists
+		CHECK(allocator.Allocate(4096, 65536, c) && c.Offset == 65536);
+		stats = allocator.GetStatistics();
+		CHECK(stats.FreeSize == Capacity - 4 * 4096);
+		CHECK(stats.AllocationCount == 3 && stats.FreeBlockCount == 2);
+
+		TlsfAllocator::Allocation invalid;
+		CHECK(!allocator.Allocate(4096, 3000, invalid));
+		CHECK(!allocator.Allocate(Capacity, 4096, invalid));
+
+		// Freeing merges with free neighbours on both sides: b joins the padding
+		// before c, then c joins that and the tail
+		allocator.Free(b.Handle);
+		CHECK(allocator.GetStatistics().FreeBlockCount == 2);
+		allocator.Free(c.Handle);
+		CHECK(allocator.GetStatistics().FreeBlockCount == 1);
+		CHECK(allocator.GetStatistics().LargestFreeBlock == Capacity - 4096);
+		allocator.Free(a.Handle);
+		stats = allocator.GetStatistics();
+		CHECK(stats.FreeBlockCount == 1 && stats.FreeSize == Capacity && stats.LargestFreeBlock == Capacity);
+
+		// The whole range in one piece, then nothing
+		TlsfAllocator::Allocation all;
+		CHECK(allocator.Allocate(Capacity, 4096, all) && all.Offset == 0);
+		CHECK(!allocator.Allocate(1, 1, invalid));
+		allocator.Free(all.Handle);
+
+		// Reset forgets every allocation
+		CHECK(allocator.Allocate(8192, 4096, a));
+		allocator.Reset(2 * Capacity, 256);
+		stats = allocator.GetStatistics();
+		CHECK(stats.Capacity == 2 * Capacity && stats.FreeSize == 2 * Capacity && stats.AllocationCount == 0);
+	}
+
+	// Random heap traffic like texture streaming: live ranges never overlap and the
+	// statistics always match the shadow copy
+	void TestRandom()
+	{
+		const uint64_t Capacity = 256ull << 20;
+		const uint64_t Granularity = 4096;
+		TlsfAllocator allocator(Capacity, Granularity);
+		std::mt19937 rng(1);
+
+		struct Live
+		{
+			uint64_t Size;
+			uint32_t Handle;
+		};
+		std::map<uint64_t, Live> live;
+		uint64_t allocatedBytes = 0;
+		size_t failures = 0;
+
+		for (int step = 0; step < 200000; step++)
+		{
+			if (live.empty() || rng() % 100 < 55)
+			{
+				const uint64_t size = (rng() % 2) ? rng() % 65536 + 1 : rng() % (4u << 20) + 1;
+				const uint64_t alignment = (rng() % 3 == 0) ? 65536 : 4096;
+				TlsfAllocator::Allocation allocation;
+				if (!allocator.Allocate(size, alignment, allocation))
+				{
+					failures++;
+					continue;
+				}
+				CHECK(allocation.Offset % alignment == 0);
+				CHECK(allocation.Offset + size <= Capacity);
+
+				auto next = live.lower_bound(allocation.Offset);
+				bool overlaps = (next != live.end() && allocation.Offset + size > next->first);
+				if (next != live.begin())
+				{
+					auto previous = std::prev(next);
+					overlaps |= previous->first + previous->second.Size > allocation.Offset;
+				}
+				if (overlaps)
+				{
+					CHECK(!"allocations overlap");
+					return;
+				}
+				live[allocation.Offset] = { size, allocation.Handle };
+				allocatedBytes += (size + Granularity - 1) / Granularity * Granularity;
+			}
+			else
+			{
+				auto it = live.begin();
+				std::advance(it, rng() % live.size());
+				allocator.Free(it->second.Handle);
+				allocatedBytes -= (it->second.Size + Granularity - 1) / Granularity * Granularity;
+				live.erase(it);
+			}
+
+			if (step % 1000 == 0)
+			{
+				const TlsfAllocator::Statistics stats = allocator.GetStatistics();
+				CHECK(stats.AllocationCount == live.size());
+				CHECK(stats.FreeSize == Capacity - allocatedBytes);
+				CHECK(stats.LargestFreeBlock <= stats.FreeSize);
+			}
+		}
+		std::printf("random: %zu live, %zu failed allocations\n", live.size(), failures);
+		CHECK(failures > 0);
+
+		for (const auto& entry : live)
+		{
+			allocator.Free(entry.second.Handle);
+		}
+		const TlsfAllocator::Statistics stats = allocator.GetStatistics();
+		CHECK(stats.FreeSize == Capacity && stats.LargestFreeBlock == Capacity);
+		CHECK(stats.FreeBlockCount == 1 && stats.AllocationCount == 0);
+	}
+}
+
+int main()
+{
+	TestBasic();
+	TestRandom();
+	return TestResult("TlsfAllocatorTests");
+}
@@ -0,0 +1,193 @@
+#include "TestHarness.h"
+#include "UploadRing.h"
+#include <algorithm>
+#include <random>
+#include <vector>
+
+namespace
+{
+	// Stands in for an ID3D12Fence: Signal queues a value, the "GPU" completes
+	// queued values in order some steps later
+	class SimulatedFence
+	{
+	public:
+		uint64_t Signal()
+		{
+			m_Pending.push_back(++m_Next);
+			return m_Next;
+		}
+
+		// Completes up to count of the oldest signals
+		void Advance(size_t count)
+		{
+			while (count-- > 0 && !m_Pending.empty())
+			{
+				m_Completed = m_Pending.front();
+				m_Pending.erase(m_Pending.begin());
+			}
+		}
+
+		// The CPU blocking on the oldest outstanding signal
+		bool WaitOldest()
+		{
+			if (m_Pending.empty())
+			{
+				return false;
+			}
+			Advance(1);
+			return true;
+		}
+
+		inline uint64_t Completed() const { return m_Completed; }
+
+	private:
+		uint64_t m_Next = 0;
+		uint64_t m_Completed = 0;
+		std::vector<uint64_t> m_Pending;
+	};
+
+	struct Allocation
+	{
+		uint64_t Offset;
+		uint64_t Size;
+		uint64_t Fence;
+	};
+
+	const uint64_t Unsubmitted = ~0ull;
+
+	void TestBasic()
+	{
+		UploadRing ring(1024);
+		CHECK(ring.Allocate(100, 256) == 0);
+		CHECK(ring.Allocate(100, 256) == 256);
+		CHECK(ring.Allocate(600, 256) == UploadRing::InvalidOffset);
+		CHECK(ring.Allocate(400, 256) == 512);
+		ring.Submit(1);
+		// 112 bytes left at the end and the start is still in flight
+		CHECK(ring.Allocate(200, 64) == UploadRing::InvalidOffset);
+
+		ring.Retire(0);
+		CHECK(ring.Used() == 912);
+		ring.Retire(1);
+		CHECK(ring.Used() == 0);
+		CHECK(!ring.HasPendingBatches());
+
+		CHECK(ring.Allocate(1024, 512) == 0);
+		ring.Submit(2);
+		CHECK(ring.Allocate(1, 1) == UploadRing::InvalidOffset);
+		ring.Retire(2);
+		CHECK(ring.Used() == 0);
+
+		// Larger than the ring never fits
+		CHECK(ring.Allocate(1025, 1) == UploadRing::InvalidOffset);
+	}
+
+	void TestWrap()
+	{
+		UploadRing ring(1000);
+		CHECK(ring.Allocate(600, 1) == 0);
+		ring.Submit(1);
+		CHECK(ring.Allocate(300, 1) == 600);
+		ring.Submit(2);
+		ring.Retire(1);
+
+		// Wrapping skips the 100 bytes at the end; they count as used until batch 3 retires
+		CHECK(ring.Allocate(200, 1) == 0);
+		CHECK(ring.Used() == 300 + 100 + 200);
+		CHECK(ring.Allocate(450, 1) == UploadRing::InvalidOffset);
+		CHECK(ring.Allocate(400, 1) == 200);
+		ring.Submit(3);
+		ring.Retire(2);
+		CHECK(ring.Used() == 700);
+		ring.Retire(3);
+		CHECK(ring.Used() == 0);
+	}
+
+	// Frames of uploads against a GPU that lags a few frames behind: live allocations
+	// never overlap, retirement follows the fence, and waiting always makes room
+	void TestSimulatedFrames()
+	{
+		const uint64_t Capacity = 1 << 20;
+		std::mt19937 rng(7);
+		UploadRing ring(Capacity);
+		SimulatedFence fence;
+		std::vector<Allocation> live;
+		size_t allocations = 0;
+		size_t waits = 0;
+
+		for (int frame = 0; frame < 20000; frame++)
+		{
+			const int uploads = 1 + static_cast<int>(rng() % 8);
+			for (int u = 0; u < uploads; u++)
+			{
+				const uint64_t size = 1 + rng() % (96 * 1024);
+				const uint64_t alignment = 1ull << (rng() % 10);
+				uint64_t offset = ring.Allocate(size, alignment);
+				while (offset == UploadRing::InvalidOffset)
+				{
+					// Out of space: what the renderer does is submit and wait for the GPU
+					if (!fence.WaitOldest())
+					{
+						const uint64_t value = fence.Signal();
+						std::for_each(live.begin(), live.end(), [&](Allocation& a) { a.Fence = (a.Fence == Unsubmitted) ? value : a.Fence; });
+						ring.Submit(value);
+						continue;
+					}
+					waits++;
+					ring.Retire(fence.Completed());
+					live.erase(std::remove_if(live.begin(), live.end(), [&](const Allocation& a) { return a.Fence <= fence.Completed(); }), live.end());
+					offset = ring.Allocate(size, alignment);
+				}
+
+				allocations++;
+				CHECK(offset % alignment == 0);
+				CHECK(offset + size <= Capacity);
+				for (const Allocation& other : live)
+				{
+					if (!(offset + size <= other.Offset || other.Offset + other.Size <= offset))
+					{
+						CHECK(!"live allocations overlap");
+						return;
+					}
+				}
+				live.push_back({ offset, size, Unsubmitted });
+			}
+
+			const uint64_t value = fence.Signal();
+			for (Allocation& a : live)
+			{
+				a.Fence = (a.Fence == Unsubmitted) ? value : a.Fence;
+			}
+			ring.Submit(value);
+
+			fence.Advance(rng() % 3);
+			ring.Retire(fence.Completed());
+			live.erase(std::remove_if(live.begin(), live.end(), [&](const Allocation& a) { return a.Fence <= fence.Completed(); }), live.end());
+
+			uint64_t liveBytes = 0;
+			for (const Allocation& a : live)
+			{
+				liveBytes += a.Size;
+			}
+			CHECK(ring.Used() >= liveBytes);
+			CHECK(ring.Used() <= Capacity);
+			CHECK(live.empty() || ring.HasPendingBatches());
+		}
+
+		while (fence.WaitOldest())
+		{
+		}
+		ring.Retire(fence.Completed());
+		CHECK(ring.Used() == 0);
+		CHECK(!ring.HasPendingBatches());
+		std::printf("simulated frames: %zu allocations, %zu waits on the fence\n", allocations, waits);
+	}
+}
+
+int main()
+{
+	TestBasic();
+	TestWrap();
+	TestSimulatedFrames();
+	return TestResult("UploadRingTests");
+}
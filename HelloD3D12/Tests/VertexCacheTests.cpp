@@ -0,0 +1,133 @@
+#include "MappedFile.h"
+#include "MeshCache.h"
+#include "ModelParser.h"
+#include "Overdraw.h"
+#include "TestHarness.h"
+#include "VertexCache.h"
+#include <algorithm>
+#include <array>
+#include <random>
+
+namespace
+{
+	// Rotates each triangle so its smallest index comes first (keeps the winding)
+	std::vector<std::array<uint32_t, 3>> CanonicalTriangles(const std::vector<uint32_t>& indices)
+	{
+		std::vector<std::array<uint32_t, 3>> triangles;
+		for (size_t i = 0; i + 2 < indices.size(); i += 3)
+		{
+			std::array<uint32_t, 3> t = { indices[i], indices[i + 1], indices[i + 2] };
+			while (t[0] > t[1] || t[0] > t[2])
+			{
+				t = { t[1], t[2], t[0] };
+			}
+			triangles.push_back(t);
+		}
+		std::sort(triangles.begin(), triangles.end());
+		return triangles;
+	}
+
+	void TestSimulator()
+	{
+		const uint32_t one[] = { 0, 1, 2 };
+		VertexCacheStatistics stats = AnalyzeVertexCache(one, 3, 3);
+		CHECK(stats.VerticesTransformed == 3);
+		CHECK_NEAR(stats.ACMR, 3.0f, 1e-6f);
+		CHECK_NEAR(stats.ATVR, 1.0f, 1e-6f);
+
+		// A quad: the shared edge hits
+		const uint32_t quad[] = { 0, 1, 2, 2, 1, 3 };
+		stats = AnalyzeVertexCache(quad, 6, 4);
+		CHECK(stats.VerticesTransformed == 4);
+		CHECK_NEAR(stats.ACMR, 2.0f, 1e-6f);
+		CHECK_NEAR(stats.ATVR, 1.0f, 1e-6f);
+
+		// Revisiting a triangle hits in a large cache and misses in one of 3 entries
+		const uint32_t revisit[] = { 0, 1, 2, 3, 4, 5, 0, 1, 2 };
+		CHECK(AnalyzeVertexCache(revisit, 9, 6).VerticesTransformed == 6);
+		CHECK(AnalyzeVertexCache(revisit, 9, 6, 3).VerticesTransformed == 9);
+		CHECK_NEAR(AnalyzeVertexCache(revisit, 9, 6, 3).ATVR, 1.5f, 1e-6f);
+
+		// FIFO, not LRU: hits do not refresh an entry. With 4 entries, 0 is the
+		// oldest when 4 arrives, so the third triangle misses all three
+		const uint32_t fifo[] = { 0, 1, 2, 3, 0, 1, 4, 0, 5 };
+		CHECK(AnalyzeVertexCache(fifo, 9, 6, 4).VerticesTransformed == 7);
+
+		stats = AnalyzeVertexCache(nullptr, 0, 0);
+		CHECK(stats.VerticesTransformed == 0);
+	}
+
+	// A regular grid in row order: the classic case where reordering pays off
+	std::vector<uint32_t> GridIndices(uint32_t size)
+	{
+		std::vector<uint32_t> indices;
+		for (uint32_t y = 0; y < size; y++)
+		{
+			for (uint32_t x = 0; x < size; x++)
+			{
+				uint32_t v = y * (size + 1) + x;
+				indices.insert(indices.end(), { v, v + size + 1, v + 1, v + 1, v + size + 1, v + size + 2 });
+			}
+		}
+		return indices;
+	}
+
+	void TestOptimize(const std::vector<uint32_t>& indices, size_t vertexCount, float maxAcmr, const char* name)
+	{
+		VertexCacheStatistics before = AnalyzeVertexCache(indices.data(), indices.size(), vertexCount);
+
+		std::vector<uint32_t> optimized(indices.size());
+		OptimizeVertexCache(optimized.data(), indices.data(), indices.size(), vertexCount);
+		VertexCacheStatistics after = AnalyzeVertexCache(optimized.data(), optimized.size(), vertexCount);
+		std::printf("%s: ACMR %.3f -> %.3f, ATVR %.3f -> %.3f\n", name, before.ACMR, after.ACMR, before.ATVR, after.ATVR);
+
+		CHECK(after.ACMR <= before.ACMR);
+		CHECK(after.ACMR <= maxAcmr);
+		CHECK(after.ATVR >= 1.0f);
+		CHECK(CanonicalTriangles(optimized) == CanonicalTriangles(indices));
+
+		// In place gives the same order
+		std::vector<uint32_t> inPlace = indices;
+		OptimizeVertexCache(inPlace.data(), inPlace.data(), inPlace.size(), vertexCount);
+		CHECK(inPlace == optimized);
+	}
+}
+
+int main()
+{
+	TestSimulator();
+
+	const uint32_t gridSize = 100;
+	TestOptimize(GridIndices(gridSize), (gridSize + 1) * (gridSize + 1), 0.8f, "grid");
+
+	MappedFile file;
+	CHECK(file.Open(SourcePath("Models/skull.txt")));
+	MeshData skull;
+	CHECK(ParseModelText(reinterpret_cast<const char*>(file.Data()), static_cast<size_t>(file.Size()), skull));
+
+	// skull.txt ships already cache optimised, so scramble its triangles first
+	std::vector<uint32_t> shuffled = skull.Indices;
+	std::vector<uint32_t> order(shuffled.size() / 3);
+	for (uint32_t i = 0; i < order.size(); i++)
+	{
+		order[i] = i;
+	}
+	std::shuffle(order.begin(), order.end(), std::mt19937(7));
+	for (size_t i = 0; i < order.size(); i++)
+	{
+		std::copy_n(&skull.Indices[order[i] * 3], 3, &shuffled[i * 3]);
+	}
+	TestOptimize(shuffled, skull.Vertices.size(), 0.75f, "skull (shuffled)");
+
+	// ProcessMesh keeps the authored order when the optimiser cannot beat it, and the
+	// overdraw pass may only trade away up to its threshold
+	MeshCacheStats stats = {};
+	ProcessMesh(skull, stats, 1);
+	std::printf("skull ProcessMesh: ACMR %.3f -> %.3f, ATVR %.3f -> %.3f\n", stats.AcmrBefore, stats.AcmrAfter, stats.AtvrBefore, stats.AtvrAfter);
+	CHECK(stats.AcmrAfter <= stats.AcmrBefore * DefaultOverdrawThreshold);
+	CHECK(!skull.Lods.empty());
+	const VertexCacheStatistics processed = AnalyzeVertexCache(skull.Indices.data(), skull.Lods[0].IndexCount, skull.Vertices.size());
+	CHECK_NEAR(processed.ACMR, stats.AcmrAfter, 1e-6f);
+
+	return TestResult("VertexCacheTests");
+}
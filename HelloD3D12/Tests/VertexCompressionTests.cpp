@@ -0,0 +1,242 @@
+#include "MappedFile.h"
+#include "ModelParser.h"
+#include "TestHarness.h"
+#include "VertexCompression.h"
+#include <cmath>
+#include <cstring>
+#include <random>
+
+namespace
+{
+	float BitsToFloat(uint32_t bits)
+	{
+		float value;
+		std::memcpy(&value, &bits, sizeof(value));
+		return value;
+	}
+
+	// IEEE half to float straight from the definition
+	double ReferenceHalfValue(uint16_t half)
+	{
+		const int exponent = (half >> 10) & 0x1F;
+		const int mantissa = half & 0x3FF;
+		const double magnitude = (exponent == 0) ? std::ldexp(mantissa, -24) : std::ldexp(1024 + mantissa, exponent - 25);
+		return (half & 0x8000) ? -magnitude : magnitude;
+	}
+
+	// Round to nearest even by searching the finite halves, which are ordered like their bit patterns
+	uint16_t ReferenceFloatToHalf(float value)
+	{
+		const uint16_t sign = std::signbit(value) ? 0x8000 : 0;
+		const double magnitude = std::fabs(static_cast<double>(value));
+		if (magnitude >= 65520.0)
+		{
+			return sign | 0x7C00;
+		}
+		uint16_t low = 0;
+		uint16_t high = 0x7BFF;
+		while (low < high)
+		{
+			const uint16_t mid = static_cast<uint16_t>((low + high + 1) / 2);
+			if (ReferenceHalfValue(mid) <= magnitude)
+			{
+				low = mid;
+			}
+			else
+			{
+				high = static_cast<uint16_t>(mid - 1);
+			}
+		}
+		// Everything from 65520 up was handled above
+		if (low < 0x7BFF)
+		{
+			const double below = magnitude - ReferenceHalfValue(low);
+			const double above = ReferenceHalfValue(static_cast<uint16_t>(low + 1)) - magnitude;
+			if (above < below || (above == below && (low & 1)))
+			{
+				low++;
+			}
+		}
+		return sign | low;
+	}
+
+	bool IsHalfNaN(uint16_t half)
+	{
+		return (half & 0x7C00) == 0x7C00 && (half & 0x3FF) != 0;
+	}
+
+	void TestHalf()
+	{
+		// Decode is exact for every half
+		for (uint32_t h = 0; h < 0x10000; h++)
+		{
+			const uint16_t half = static_cast<uint16_t>(h);
+			const float value = HalfToFloat(half);
+			if (IsHalfNaN(half))
+			{
+				CHECK(std::isnan(value));
+			}
+			else if ((half & 0x7FFF) == 0x7C00)
+			{
+				CHECK(std::isinf(value) && std::signbit(value) == ((half & 0x8000) != 0));
+			}
+			else if (static_cast<double>(value) != ReferenceHalfValue(half) || FloatToHalf(value) != half)
+			{
+				std::fprintf(stderr, "half %04x decodes to %.9g\n", h, value);
+				CHECK(false);
+				break;
+			}
+		}
+
+		// Encode rounds to nearest even, sampled across every float exponent
+		uint32_t mismatches = 0;
+		for (uint64_t bits = 0; bits <= 0xFFFFFFFFull; bits += 4093)
+		{
+			const float value = BitsToFloat(static_cast<uint32_t>(bits));
+			const uint16_t half = FloatToHalf(value);
+			if (std::isnan(value))
+			{
+				CHECK(IsHalfNaN(half));
+				continue;
+			}
+			if (half != ReferenceFloatToHalf(value) && mismatches++ < 5)
+			{
+				std::fprintf(stderr, "FloatToHalf(%.9g) = %04x, expected %04x\n", value, half, ReferenceFloatToHalf(value));
+			}
+		}
+		CHECK(mismatches == 0);
+
+		CHECK(FloatToHalf(1.0f) == 0x3C00);
+		CHECK(FloatToHalf(-2.0f) == 0xC000);
+		CHECK(FloatToHalf(65504.0f) == 0x7BFF);
+		CHECK(FloatToHalf(65520.0f) == 0x7C00);
+		CHECK(FloatToHalf(1.0f + std::ldexp(1.0f, -11)) == 0x3C00);
+		CHECK(FloatToHalf(1.0f + 3.0f * std::ldexp(1.0f, -11)) == 0x3C02);
+		CHECK(FloatToHalf(std::ldexp(1.0f, -24)) == 0x0001);
+		CHECK(FloatToHalf(std::ldexp(1.0f, -26)) == 0x0000);
+
+		// The documented relative error bound over the normal half range
+		std::mt19937 rng(11);
+		std::uniform_real_distribution<float> exponent(-14.0f, 15.0f);
+		for (int i = 0; i < 100000; i++)
+		{
+			const float value = std::exp2(exponent(rng));
+			CHECK(std::fabs(HalfToFloat(FloatToHalf(value)) - value) <= value * HalfMaxRelativeError);
+		}
+	}
+
+	double AngleBetween(const MeshFloat3& a, const MeshFloat3& b)
+	{
+		const double cx = static_cast<double>(a.y) * b.z - static_cast<double>(a.z) * b.y;
+		const double cy = static_cast<double>(a.z) * b.x - static_cast<double>(a.x) * b.z;
+		const double cz = static_cast<double>(a.x) * b.y - static_cast<double>(a.y) * b.x;
+		const double dot = static_cast<double>(a.x) * b.x + static_cast<double>(a.y) * b.y + static_cast<double>(a.z) * b.z;
+		return std::atan2(std::sqrt(cx * cx + cy * cy + cz * cz), dot);
+	}
+
+	void TestOctahedral()
+	{
+		const MeshFloat3 axes[] = { { 1, 0, 0 }, { -1, 0, 0 }, { 0, 1, 0 }, { 0, -1, 0 }, { 0, 0, 1 }, { 0, 0, -1 } };
+		for (const MeshFloat3& axis : axes)
+		{
+			int16_t encoded[2];
+			EncodeOctahedral(axis, encoded);
+			MeshFloat3 decoded = DecodeOctahedral(encoded);
+			CHECK(decoded.x == axis.x && decoded.y == axis.y && decoded.z == axis.z);
+		}
+
+		std::mt19937 rng(5);
+		std::normal_distribution<float> gaussian;
+		double worst = 0.0;
+		for (int i = 0; i < 1000000; i++)
+		{
+			MeshFloat3 n = { gaussian(rng), gaussian(rng), gaussian(rng) };
+			const float length = std::sqrt(n.x * n.x + n.y * n.y + n.z * n.z);
+			if (length == 0.0f)
+			{
+				continue;
+			}
+			n = { n.x / length, n.y / length, n.z / length };
+
+			int16_t encoded[2];
+			EncodeOctahedral(n, encoded);
+			MeshFloat3 decoded = DecodeOctahedral(encoded);
+			worst = std::max(worst, AngleBetween(n, decoded));
+			CHECK_NEAR(decoded.x * decoded.x + decoded.y * decoded.y + decoded.z * decoded.z, 1.0, 1e-5);
+		}
+		std::printf("octahedral: worst angle %.3g rad (bound %.3g)\n", worst, OctahedralMaxAngleError);
+		CHECK(worst <= OctahedralMaxAngleError);
+	}
+
+	void TestVertices(const MeshData& mesh, const char* name)
+	{
+		CompressedMesh compressed;
+		CompressMesh(mesh, compressed);
+		CHECK(compressed.Vertices.size() == mesh.Vertices.size());
+
+		const MeshFloat3 bound = PositionErrorBound(compressed.Quantization);
+		MeshFloat3 worst = { 0, 0, 0 };
+		double worstAngle = 0.0;
+		for (size_t v = 0; v < mesh.Vertices.size(); v++)
+		{
+			const MeshVertex& original = mesh.Vertices[v];
+			const MeshVertex decoded = DecodeVertex(compressed.Vertices[v], compressed.Quantization);
+			worst.x = std::max(worst.x, std::fabs(decoded.Position.x - original.Position.x));
+			worst.y = std::max(worst.y, std::fabs(decoded.Position.y - original.Position.y));
+			worst.z = std::max(worst.z, std::fabs(decoded.Position.z - original.Position.z));
+
+			const float length = std::sqrt(original.Normal.x * original.Normal.x + original.Normal.y * original.Normal.y + original.Normal.z * original.Normal.z);
+			const MeshFloat3 unit = { original.Normal.x / length, original.Normal.y / length, original.Normal.z / length };
+			worstAngle = std::max(worstAngle, AngleBetween(unit, decoded.Normal));
+
+			CHECK(std::fabs(decoded.TexC.x - original.TexC.x) <= std::fabs(original.TexC.x) * HalfMaxRelativeError + 1e-7f);
+			CHECK(std::fabs(decoded.TexC.y - original.TexC.y) <= std::fabs(original.TexC.y) * HalfMaxRelativeError + 1e-7f);
+		}
+		std::printf("%s: position error %.3g %.3g %.3g (bound %.3g %.3g %.3g), normal %.3g rad\n",
+			name, worst.x, worst.y, worst.z, bound.x, bound.y, bound.z, worstAngle);
+		CHECK(worst.x <= bound.x && worst.y <= bound.y && worst.z <= bound.z);
+		CHECK(worstAngle <= OctahedralMaxAngleError);
+	}
+
+	void TestIndices()
+	{
+		const uint32_t indices[] = { 0, 1, 65535 };
+		uint16_t narrow[3];
+		CHECK(NarrowIndices(narrow, indices, 3, 65536));
+		CHECK(narrow[0] == 0 && narrow[1] == 1 && narrow[2] == 65535);
+		CHECK(!NarrowIndices(narrow, indices, 3, 65537));
+	}
+}
+
+int main()
+{
+	TestHalf();
+	TestOctahedral();
+	TestIndices();
+
+	MappedFile file;
+	MeshData skull;
+	CHECK(file.Open(SourcePath("Models/skull.txt")));
+	CHECK(ParseModelText(reinterpret_cast<const char*>(file.Data()), static_cast<size_t>(file.Size()), skull));
+
+	// skull.txt has no texture coordinates; give it some to exercise the half path
+	std::mt19937 rng(3);
+	std::uniform_real_distribution<float> uv(-4.0f, 4.0f);
+	for (MeshVertex& v : skull.Vertices)
+	{
+		v.TexC = { uv(rng), uv(rng) };
+	}
+	TestVertices(skull, "skull");
+
+	CompressedMesh compressed;
+	CompressMesh(skull, compressed);
+	CHECK(compressed.Indices.size() == skull.Indices.size());
+
+	// A flat mesh has a zero extent axis
+	MeshData flat;
+	flat.Vertices = { { { -1, 2, 0 }, { 0, 0, 1 }, { 0, 0 } }, { { 3, 2, 0 }, { 0, 0, 1 }, { 1, 0 } }, { { 1, 5, 0 }, { 0, 0, 1 }, { 0, 1 } } };
+	flat.Indices = { 0, 1, 2 };
+	TestVertices(flat, "flat");
+
+	return TestResult("VertexCompressionTests");
+}
@@ -0,0 +1,129 @@
+#include "MappedFile.h"
+#include "ModelParser.h"
+#include "TestHarness.h"
+#include "VertexCache.h"
+#include "VertexRemap.h"
+#include <algorithm>
+#include <random>
+
+namespace
+{
+	// Vertex fetch through a small LRU cache of 64-byte lines, in the order the
+	// index buffer references vertices; returns lines fetched per triangle
+	float FetchedLinesPerTriangle(const std::vector<uint32_t>& indices)
+	{
+		const size_t CacheLines = 32;
+		const size_t LineBytes = 64;
+		std::vector<size_t> cache;
+		size_t fetched = 0;
+		for (uint32_t index : indices)
+		{
+			const size_t line = index * sizeof(MeshVertex) / LineBytes;
+			auto it = std::find(cache.begin(), cache.end(), line);
+			if (it != cache.end())
+			{
+				cache.erase(it);
+			}
+			else
+			{
+				fetched++;
+				if (cache.size() == CacheLines)
+				{
+					cache.erase(cache.begin());
+				}
+			}
+			cache.push_back(line);
+		}
+		return static_cast<float>(fetched) / static_cast<float>(indices.size() / 3);
+	}
+
+	void BenchmarkFetchOrder(MeshData mesh)
+	{
+		std::vector<uint32_t> remap(mesh.Vertices.size());
+		size_t unique = GenerateWeldRemap(remap.data(), mesh.Vertices.data(), mesh.Vertices.size());
+		RemapMesh(mesh, remap.data(), unique);
+
+		// The fetch remap runs after the cache optimiser in ProcessMesh; shuffle the
+		// triangles first so the optimiser does not inherit the authored layout
+		std::vector<uint32_t> order(mesh.Indices.size() / 3);
+		for (uint32_t i = 0; i < order.size(); i++)
+		{
+			order[i] = i;
+		}
+		std::shuffle(order.begin(), order.end(), std::mt19937(7));
+		std::vector<uint32_t> shuffled(mesh.Indices.size());
+		for (size_t i = 0; i < order.size(); i++)
+		{
+			std::copy_n(&mesh.Indices[order[i] * 3], 3, &shuffled[i * 3]);
+		}
+		OptimizeVertexCache(mesh.Indices.data(), shuffled.data(), shuffled.size(), mesh.Vertices.size());
+
+		const float linesBefore = FetchedLinesPerTriangle(mesh.Indices);
+
+		double ms = MeasureMilliseconds(5, [&]()
+		{
+			GenerateFetchRemap(remap.data(), mesh.Indices.data(), mesh.Indices.size(), mesh.Vertices.size());
+		});
+		size_t used = GenerateFetchRemap(remap.data(), mesh.Indices.data(), mesh.Indices.size(), mesh.Vertices.size());
+		RemapMesh(mesh, remap.data(), used);
+
+		std::printf("skull fetch order (cache optimised, 32 x 64B LRU), remap %.2f ms:\n", ms);
+		std::printf("  before: %.3f lines/triangle\n", linesBefore);
+		std::printf("  after:  %.3f lines/triangle\n", FetchedLinesPerTriangle(mesh.Indices));
+	}
+
+	void BenchmarkWeld(const std::vector<MeshVertex>& vertices, float epsilon, const char* name)
+	{
+		std::vector<uint32_t> remap(vertices.size());
+		size_t unique = 0;
+		double ms = MeasureMilliseconds(3, [&]()
+		{
+			unique = GenerateWeldRemap(remap.data(), vertices.data(), vertices.size(), epsilon);
+		});
+		std::printf("  %-28s %8zu -> %8zu %8.2f ms %7.1f Mvert/s\n", name, vertices.size(), unique, ms, vertices.size() / (ms * 1e3));
+	}
+}
+
+int main()
+{
+#ifdef HELLOD3D12_NO_SIMD
+	std::printf("scalar build\n");
+#endif
+	MappedFile file;
+	MeshData skull;
+	if (!file.Open(SourcePath("Models/skull.txt")) ||
+		!ParseModelText(reinterpret_cast<const char*>(file.Data()), static_cast<size_t>(file.Size()), skull))
+	{
+		std::printf("skull.txt not found\n");
+		return 1;
+	}
+
+	std::printf("weld:\n");
+	BenchmarkWeld(skull.Vertices, 0.0f, "skull exact");
+	BenchmarkWeld(skull.Vertices, 1e-3f, "skull epsilon 1e-3");
+
+	// A large mesh with every vertex repeated four times (half of the copies with -0 normals)
+	std::mt19937 rng(1);
+	std::uniform_real_distribution<float> random(-1.0f, 1.0f);
+	std::vector<MeshVertex> unique(1 << 20);
+	for (MeshVertex& v : unique)
+	{
+		v = { { random(rng), random(rng), random(rng) }, { random(rng), random(rng), 0.0f }, { random(rng), random(rng) } };
+	}
+	std::vector<MeshVertex> large;
+	large.reserve(unique.size() * 4);
+	for (int copy = 0; copy < 4; copy++)
+	{
+		for (MeshVertex v : unique)
+		{
+			v.Normal.z = (copy & 1) ? -0.0f : 0.0f;
+			large.push_back(v);
+		}
+	}
+	std::shuffle(large.begin(), large.end(), rng);
+	BenchmarkWeld(large, 0.0f, "4M vertices exact");
+	BenchmarkWeld(large, 1e-4f, "4M vertices epsilon 1e-4");
+
+	BenchmarkFetchOrder(skull);
+	return 0;
+}
@@ -0,0 +1,147 @@
+#include "TextureBatchLoader12.h"
+#include "DDSTextureLoader.h"
+#include "Parallel.h"
+#include <atomic>
+
+HRESULT TextureBatchLoader12::Create(ID3D12Device* device, UploadRing12* uploadRing, TextureHeap12* textureHeap,
+	unsigned threadCount)
+{
+	if (device == nullptr)
+	{
+		return E_POINTER;
+	}
+	m_Device = device;
+	m_UploadRing = uploadRing;
+	m_TextureHeap = textureHeap;
+	m_ThreadCount = (threadCount == 0) ? DefaultThreadCount() : threadCount;
+	m_Textures.clear();
+	m_Recorders.clear();
+	m_CompletedValue = 0;
+	m_FirstPending = 0;
+	return S_OK;
+}
+
+HRESULT TextureBatchLoader12::AcquireRecorders(size_t count, std::vector<Recorder*>& recorders)
+{
+	recorders.clear();
+
+	// Reuse the lists of batches the GPU has finished with
+	for (const auto& recorder : m_Recorders)
+	{
+		if (recorders.size() == count)
+		{
+			break;
+		}
+		if (recorder->FenceValue <= m_CompletedValue)
+		{
+			HRESULT hr = recorder->Allocator->Reset();
+			if (SUCCEEDED(hr))
+			{
+				hr = recorder->CommandList->Reset(recorder->Allocator.Get(), nullptr);
+			}
+			if (FAILED(hr))
+			{
+				return hr;
+			}
+			recorders.push_back(recorder.get());
+		}
+	}
+
+	while (recorders.size() < count)
+	{
+		auto recorder = std::make_unique<Recorder>();
+		HRESULT hr = m_Device->CreateCommandAllocator(D3D12_COMMAND_LIST_TYPE_DIRECT, IID_PPV_ARGS(&recorder->Allocator));
+		if (SUCCEEDED(hr))
+		{
+			hr = m_Device->CreateCommandList(0, D3D12_COMMAND_LIST_TYPE_DIRECT, recorder->Allocator.Get(), nullptr,
+				IID_PPV_ARGS(&recorder->CommandList));
+		}
+		if (FAILED(hr))
+		{
+			return hr;
+		}
+		recorders.push_back(recorder.get());
+		m_Recorders.push_back(std::move(recorder));
+	}
+	return S_OK;
+}
+
+HRESULT TextureBatchLoader12::LoadTexturesBatch(ID3D12CommandQueue* queue, const std::vector<std::wstring>& fileNames,
+	uint64_t fenceValue, std::vector<uint32_t>& textures)
+{
+	textures.clear();
+	if (!m_Device)
+	{
+		return E_NOT_VALID_STATE;
+	}
+	if (fileNames.empty())
+	{
+		return S_OK;
+	}
+
+	const size_t first = m_Textures.size();
+	m_Textures.resize(first + fileNames.size());
+	for (size_t i = 0; i < fileNames.size(); i++)
+	{
+		textures.push_back(static_cast<uint32_t>(first + i));
+		m_Textures[first + i].FenceValue = fenceValue;
+	}
+
+	const unsigned workerCount = static_cast<unsigned>(std::min<size_t>(m_ThreadCount, fileNames.size()));
+	std::vector<Recorder*> recorders;
+	HRESULT hr = AcquireRecorders(workerCount, recorders);
+	if (FAILED(hr))
+	{
+		return hr;
+	}
+
+	// Each worker keeps its own command list and takes the next file until none are left,
+	// so a few large files do not hold up the rest
+	std::atomic<size_t> next(0);
+	ParallelFor(workerCount, workerCount, [&](size_t worker)
+	{
+		ID3D12GraphicsCommandList* commandList = recorders[worker]->CommandList.Get();
+		for (size_t i = next.fetch_add(1); i < fileNames.size(); i = next.fetch_add(1))
+		{
+			LoadedTexture& texture = m_Textures[first + i];
+			texture.Status = DirectX::CreateDDSTextureFromFile12(m_Device.Get(), commandList, fileNames[i].c_str(),
+				texture.Resource, texture.UploadHeap, 0, nullptr, m_UploadRing, m_TextureHeap);
+		}
+	});
+
+	std::vector<ID3D12CommandList*> commandLists;
+	for (Recorder* recorder : recorders)
+	{
+		hr = recorder->CommandList->Close();
+		if (FAILED(hr))
+		{
+			return hr;
+		}
+		recorder->FenceValue = fenceValue;
+		commandLists.push_back(recorder->CommandList.Get());
+	}
+	queue->ExecuteCommandLists(static_cast<UINT>(commandLists.size()), commandLists.data());
+	if (m_UploadRing)
+	{
+		m_UploadRing->Submit(fenceValue);
+	}
+	return S_OK;
+}
+
+bool TextureBatchLoader12::IsReady(uint32_t texture, ID3D12Fence* fence) const
+{
+	const LoadedTexture& loaded = m_Textures[texture];
+	return SUCCEEDED(loaded.Status) && fence->GetCompletedValue() >= loaded.FenceValue;
+}
+
+void TextureBatchLoader12::Retire(ID3D12Fence* fence)
+{
+	m_CompletedValue = fence->GetCompletedValue();
+
+	// Batches complete in the order they were loaded
+	while (m_FirstPending < m_Textures.size() && m_Textures[m_FirstPending].FenceValue <= m_CompletedValue)
+	{
+		m_Textures[m_FirstPending].UploadHeap = nullptr;
+		m_FirstPending++;
+	}
+}
@@ -0,0 +1,66 @@
+#pragma once
+#include <d3d12.h>
+#include <wrl.h>
+#include <memory>
+#include <string>
+#include <vector>
+#include "TextureHeap12.h"
+#include "UploadRing12.h"
+
+// Loads many DDS textures at once. Files are mapped and parsed on a pool of worker
+// threads, each recording its upload copies into a command list of its own; the lists
+// are executed together and the textures may be sampled once the fence reaches the
+// value the batch was loaded with.
+class TextureBatchLoader12
+{
+public:
+	// Up to threadCount workers per batch (0 picks one per core)
+	HRESULT Create(ID3D12Device* device, UploadRing12* uploadRing = nullptr, TextureHeap12* textureHeap = nullptr,
+		unsigned threadCount = 0);
+
+	// Records the uploads of every file and executes them on queue; textures receives one
+	// handle per file. fenceValue is the value the caller signals on its fence after this
+	// call; the upload ring is submitted with it. A file that fails to load still gets a
+	// handle, with the reason in Status; the call itself fails only if a command list does.
+	HRESULT LoadTexturesBatch(ID3D12CommandQueue* queue, const std::vector<std::wstring>& fileNames,
+		uint64_t fenceValue, std::vector<uint32_t>& textures);
+
+	// Whether the texture loaded and its copies have completed
+	bool IsReady(uint32_t texture, ID3D12Fence* fence) const;
+
+	inline HRESULT Status(uint32_t texture) const { return m_Textures[texture].Status; }
+	inline ID3D12Resource* Resource(uint32_t texture) const { return m_Textures[texture].Resource.Get(); }
+	inline size_t TextureCount() const { return m_Textures.size(); }
+
+	// Frees the upload heaps of completed batches and lets their command lists be reused
+	void Retire(ID3D12Fence* fence);
+
+private:
+	struct LoadedTexture
+	{
+		Microsoft::WRL::ComPtr<ID3D12Resource> Resource;
+		Microsoft::WRL::ComPtr<ID3D12Resource> UploadHeap;
+		HRESULT Status = E_PENDING;
+		uint64_t FenceValue = 0;
+	};
+
+	struct Recorder
+	{
+		Microsoft::WRL::ComPtr<ID3D12CommandAllocator> Allocator;
+		Microsoft::WRL::ComPtr<ID3D12GraphicsCommandList> CommandList;
+		uint64_t FenceValue = 0;
+	};
+
+	HRESULT AcquireRecorders(size_t count, std::vector<Recorder*>& recorders);
+
+	Microsoft::WRL::ComPtr<ID3D12Device> m_Device;
+	UploadRing12* m_UploadRing = nullptr;
+	TextureHeap12* m_TextureHeap = nullptr;
+	unsigned m_ThreadCount = 0;
+
+	std::vector<LoadedTexture> m_Textures;
+	std::vector<std::unique_ptr<Recorder>> m_Recorders;
+	uint64_t m_CompletedValue = 0;
+	// Textures before this have had their upload heaps released
+	size_t m_FirstPending = 0;
+};
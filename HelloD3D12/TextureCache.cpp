@@ -0,0 +1,67 @@
+#include "TextureCache.h"
+#include "Hash.h"
+
+TextureCacheKey MakeTextureCacheKey(const void* data, size_t size, size_t maxsize, bool forceSrgb)
+{
+	TextureCacheKey key;
+	key.Hash = HashBytes64(data, size);
+	key.Size = size;
+	key.MaxSize = maxsize;
+	key.ForceSrgb = forceSrgb;
+	return key;
+}
+
+uint32_t TextureCache::Find(const TextureCacheKey& key)
+{
+	m_Lookups++;
+	m_HashedBytes += key.Size;
+	auto it = m_SlotByKey.find(key);
+	if (it == m_SlotByKey.end())
+	{
+		return InvalidSlot;
+	}
+	m_Hits++;
+	m_Slots[it->second].References++;
+	return it->second;
+}
+
+uint32_t TextureCache::Insert(const TextureCacheKey& key)
+{
+	uint32_t slot;
+	if (!m_FreeSlots.empty())
+	{
+		slot = m_FreeSlots.back();
+		m_FreeSlots.pop_back();
+	}
+	else
+	{
+		slot = static_cast<uint32_t>(m_Slots.size());
+		m_Slots.emplace_back();
+	}
+	m_Slots[slot].Key = key;
+	m_Slots[slot].References = 1;
+	m_SlotByKey[key] = slot;
+	return slot;
+}
+
+bool TextureCache::Release(uint32_t slot)
+{
+	Slot& entry = m_Slots[slot];
+	if (entry.References == 0 || --entry.References > 0)
+	{
+		return false;
+	}
+	m_SlotByKey.erase(entry.Key);
+	m_FreeSlots.push_back(slot);
+	return true;
+}
+
+TextureCache::Statistics TextureCache::GetStatistics() const
+{
+	Statistics stats;
+	stats.Lookups = m_Lookups;
+	stats.Hits = m_Hits;
+	stats.HashedBytes = m_HashedBytes;
+	stats.LiveSlots = static_cast<uint32_t>(m_SlotByKey.size());
+	return stats;
+}
@@ -0,0 +1,74 @@
+#pragma once
+#include <cstddef>
+#include <cstdint>
+#include <unordered_map>
+#include <vector>
+
+// Identifies what a texture load produces: the file's content and the parameters that
+// change the resource made from it
+struct TextureCacheKey
+{
+	// XXH64 of the whole file, header included
+	uint64_t Hash;
+	uint64_t Size;
+	uint64_t MaxSize;
+	bool ForceSrgb;
+
+	inline bool operator==(const TextureCacheKey& other) const
+	{
+		return Hash == other.Hash && Size == other.Size && MaxSize == other.MaxSize && ForceSrgb == other.ForceSrgb;
+	}
+};
+
+TextureCacheKey MakeTextureCacheKey(const void* data, size_t size, size_t maxsize, bool forceSrgb);
+
+// Maps texture content to the slot it was loaded into, so files with the same content
+// share one texture. Slots are reference counted and reused once released. Nothing
+// here touches the GPU; TextureCache12 keeps the resources.
+class TextureCache
+{
+public:
+	static const uint32_t InvalidSlot = ~0u;
+
+	struct Statistics
+	{
+		uint64_t Lookups;
+		uint64_t Hits;
+		uint64_t HashedBytes;
+		uint32_t LiveSlots;
+	};
+
+	// The slot holding this content with a reference added, or InvalidSlot
+	uint32_t Find(const TextureCacheKey& key);
+	// Records a newly loaded texture, holding one reference
+	uint32_t Insert(const TextureCacheKey& key);
+	// Drops a reference; true when it was the last and the slot is free again
+	bool Release(uint32_t slot);
+
+	inline uint32_t SlotCount() const { return static_cast<uint32_t>(m_Slots.size()); }
+	inline uint32_t References(uint32_t slot) const { return m_Slots[slot].References; }
+	Statistics GetStatistics() const;
+
+private:
+	struct KeyHash
+	{
+		inline size_t operator()(const TextureCacheKey& key) const
+		{
+			// The content hash is already well mixed
+			return static_cast<size_t>(key.Hash ^ (key.MaxSize * 0x9E3779B97F4A7C15ull) ^ (key.ForceSrgb ? 1 : 0));
+		}
+	};
+
+	struct Slot
+	{
+		TextureCacheKey Key;
+		uint32_t References;
+	};
+
+	std::unordered_map<TextureCacheKey, uint32_t, KeyHash> m_SlotByKey;
+	std::vector<Slot> m_Slots;
+	std::vector<uint32_t> m_FreeSlots;
+	uint64_t m_Lookups = 0;
+	uint64_t m_Hits = 0;
+	uint64_t m_HashedBytes = 0;
+};
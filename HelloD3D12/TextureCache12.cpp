@@ -0,0 +1,77 @@
+#include "TextureCache12.h"
+#include "DDSTextureLoader.h"
+#include "MappedFile.h"
+
+void TextureCache12::Create(ID3D12Device* device, D3D12_CPU_DESCRIPTOR_HANDLE firstSrv, uint32_t descriptorCount,
+	UploadRing12* uploadRing, TextureHeap12* textureHeap)
+{
+	m_Device = device;
+	m_UploadRing = uploadRing;
+	m_TextureHeap = textureHeap;
+	m_FirstSrv = firstSrv;
+	m_DescriptorCount = descriptorCount;
+	m_DescriptorSize = device->GetDescriptorHandleIncrementSize(D3D12_DESCRIPTOR_HEAP_TYPE_CBV_SRV_UAV);
+	m_Cache = TextureCache();
+	m_Resources.clear();
+}
+
+HRESULT TextureCache12::Load(ID3D12GraphicsCommandList* cmdList, const wchar_t* fileName, uint32_t& texture,
+	Microsoft::WRL::ComPtr<ID3D12Resource>& textureUploadHeap, size_t maxsize, bool forceSRGB)
+{
+	textureUploadHeap = nullptr;
+	if (!m_Device || !fileName)
+	{
+		return E_INVALIDARG;
+	}
+
+	MappedFile file;
+	if (!file.Open(fileName))
+	{
+		return HRESULT_FROM_WIN32(ERROR_FILE_NOT_FOUND);
+	}
+
+	const TextureCacheKey key = MakeTextureCacheKey(file.Data(), static_cast<size_t>(file.Size()), maxsize, forceSRGB);
+	texture = m_Cache.Find(key);
+	if (texture != TextureCache::InvalidSlot)
+	{
+		return S_OK;
+	}
+
+	// Freed slots are reused first, so only a new one can run past the descriptors
+	if (m_Cache.GetStatistics().LiveSlots >= m_DescriptorCount)
+	{
+		return E_OUTOFMEMORY;
+	}
+
+	Microsoft::WRL::ComPtr<ID3D12Resource> resource;
+	HRESULT hr = DirectX::CreateDDSTextureFromMemory12(m_Device.Get(), cmdList, file.Data(), static_cast<size_t>(file.Size()),
+		resource, textureUploadHeap, maxsize, nullptr, forceSRGB, m_UploadRing, m_TextureHeap);
+	if (FAILED(hr))
+	{
+		return hr;
+	}
+
+	texture = m_Cache.Insert(key);
+	if (texture >= m_Resources.size())
+	{
+		m_Resources.resize(texture + 1);
+	}
+	m_Resources[texture] = resource;
+
+	// The default view covers the whole resource in its own format
+	m_Device->CreateShaderResourceView(resource.Get(), nullptr, Srv(texture));
+	return S_OK;
+}
+
+void TextureCache12::Release(uint32_t texture)
+{
+	if (!m_Cache.Release(texture))
+	{
+		return;
+	}
+	if (m_TextureHeap)
+	{
+		m_TextureHeap->Release(m_Resources[texture].Get());
+	}
+	m_Resources[texture] = nullptr;
+}
@@ -0,0 +1,48 @@
+#pragma once
+#include <d3d12.h>
+#include <wrl.h>
+#include <vector>
+#include "TextureCache.h"
+#include "TextureHeap12.h"
+#include "UploadRing12.h"
+
+// Loads DDS textures once per content. Each file is mapped and hashed with its load
+// parameters; a file whose content was loaded before, under any name, gets the same
+// resource and SRV instead of a new texture. Texture handles are slots in a range of
+// descriptors given at creation, so a handle is also its SRV's offset in that range.
+// Graphics does not use it yet: its one texture goes through TextureStreamer12, which
+// owns the resource so it can swap in finer mips.
+class TextureCache12
+{
+public:
+	// firstSrv is the start of descriptorCount consecutive CBV/SRV/UAV descriptors
+	void Create(ID3D12Device* device, D3D12_CPU_DESCRIPTOR_HANDLE firstSrv, uint32_t descriptorCount,
+		UploadRing12* uploadRing = nullptr, TextureHeap12* textureHeap = nullptr);
+
+	// texture receives the handle; textureUploadHeap is only set when a new texture was
+	// created without the upload ring. Fails with E_OUTOFMEMORY when the descriptors run out.
+	HRESULT Load(ID3D12GraphicsCommandList* cmdList, const wchar_t* fileName, uint32_t& texture,
+		Microsoft::WRL::ComPtr<ID3D12Resource>& textureUploadHeap, size_t maxsize = 0, bool forceSRGB = false);
+
+	// Drops one Load's reference; the last frees the texture, so the GPU must be done with it
+	void Release(uint32_t texture);
+
+	inline ID3D12Resource* Resource(uint32_t texture) const { return m_Resources[texture].Get(); }
+	inline D3D12_CPU_DESCRIPTOR_HANDLE Srv(uint32_t texture) const
+	{
+		return { m_FirstSrv.ptr + static_cast<SIZE_T>(texture) * m_DescriptorSize };
+	}
+	inline TextureCache::Statistics GetStatistics() const { return m_Cache.GetStatistics(); }
+
+private:
+	Microsoft::WRL::ComPtr<ID3D12Device> m_Device;
+	UploadRing12* m_UploadRing = nullptr;
+	TextureHeap12* m_TextureHeap = nullptr;
+	D3D12_CPU_DESCRIPTOR_HANDLE m_FirstSrv = {};
+	uint32_t m_DescriptorCount = 0;
+	UINT m_DescriptorSize = 0;
+
+	TextureCache m_Cache;
+	// Indexed by slot
+	std::vector<Microsoft::WRL::ComPtr<ID3D12Resource>> m_Resources;
+};
@@ -0,0 +1,240 @@
+#include "TextureCompressor.h"
+#include "MappedFile.h"
+#include "MipGenerator.h"
+#include "Parallel.h"
+#include <algorithm>
+#include <chrono>
+#include <cstring>
+
+namespace
+{
+	const uint32_t DdsMagic = 0x20534444; // "DDS "
+
+	// DDS_HEADER and DDS_HEADER_DXT10 from DDSTextureLoader.cpp, without the Windows types
+	struct DdsHeader
+	{
+		uint32_t Size;
+		uint32_t Flags;
+		uint32_t Height;
+		uint32_t Width;
+		uint32_t PitchOrLinearSize;
+		uint32_t Depth;
+		uint32_t MipMapCount;
+		uint32_t Reserved1[11];
+		uint32_t PixelFormatSize;
+		uint32_t PixelFormatFlags;
+		uint32_t FourCC;
+		uint32_t PixelFormatBits[5];
+		uint32_t Caps;
+		uint32_t Caps2;
+		uint32_t Caps3;
+		uint32_t Caps4;
+		uint32_t Reserved2;
+	};
+	static_assert(sizeof(DdsHeader) == 124, "DDS header layout");
+
+	struct DdsHeaderDxt10
+	{
+		uint32_t DxgiFormat;
+		uint32_t ResourceDimension;
+		uint32_t MiscFlag;
+		uint32_t ArraySize;
+		uint32_t MiscFlags2;
+	};
+
+	const uint32_t DdsFlagsTexture = 0x1 | 0x2 | 0x4 | 0x1000 | 0x80000; // CAPS | HEIGHT | WIDTH | PIXELFORMAT | LINEARSIZE
+	const uint32_t DdsFlagMipMapCount = 0x20000;
+	const uint32_t DdsPixelFormatFourCC = 0x4;
+	const uint32_t DdsCapsTexture = 0x1000;
+	const uint32_t DdsCapsMipMap = 0x400000 | 0x8; // MIPMAP | COMPLEX
+	const uint32_t DxgiFormatBC7Unorm = 98;
+	const uint32_t ResourceDimensionTexture2D = 3;
+
+	constexpr uint32_t MakeFourCC(char a, char b, char c, char d)
+	{
+		return static_cast<uint32_t>(static_cast<uint8_t>(a)) | (static_cast<uint32_t>(static_cast<uint8_t>(b)) << 8) |
+			(static_cast<uint32_t>(static_cast<uint8_t>(c)) << 16) | (static_cast<uint32_t>(static_cast<uint8_t>(d)) << 24);
+	}
+
+	uint32_t ReadU32(const uint8_t* p)
+	{
+		return p[0] | (p[1] << 8) | (p[2] << 16) | (static_cast<uint32_t>(p[3]) << 24);
+	}
+
+	uint16_t ReadU16(const uint8_t* p)
+	{
+		return static_cast<uint16_t>(p[0] | (p[1] << 8));
+	}
+
+	size_t SurfaceBytes(BcEncodeFormat format, uint32_t width, uint32_t height)
+	{
+		return static_cast<size_t>(std::max(1u, (width + 3) / 4)) * std::max(1u, (height + 3) / 4) * BcEncodeBlockBytes(format);
+	}
+}
+
+bool LoadBmp(const std::filesystem::path& path, RgbaImage& image)
+{
+	MappedFile file;
+	if (!file.Open(path) || file.Size() < 54)
+	{
+		return false;
+	}
+	const uint8_t* data = file.Data();
+	if (data[0] != 'B' || data[1] != 'M')
+	{
+		return false;
+	}
+
+	const uint32_t pixelOffset = ReadU32(data + 10);
+	const int32_t width = static_cast<int32_t>(ReadU32(data + 18));
+	const int32_t height = static_cast<int32_t>(ReadU32(data + 22));
+	const uint16_t bitCount = ReadU16(data + 28);
+	const uint32_t compression = ReadU32(data + 30);
+
+	// BI_RGB only, or BI_BITFIELDS for 32 bit images in the usual BGRA layout
+	if (width <= 0 || height == 0 || (bitCount != 24 && bitCount != 32) ||
+		!(compression == 0 || (compression == 3 && bitCount == 32)))
+	{
+		return false;
+	}
+
+	// Rows are stored bottom up unless the height is negative
+	const bool topDown = height < 0;
+	image.Width = static_cast<uint32_t>(width);
+	image.Height = static_cast<uint32_t>(topDown ? -height : height);
+	const size_t texelBytes = bitCount / 8;
+	const size_t rowPitch = (image.Width * texelBytes + 3) & ~size_t(3);
+	if (pixelOffset > file.Size() || file.Size() - pixelOffset < rowPitch * image.Height)
+	{
+		return false;
+	}
+
+	image.Rgba.resize(static_cast<size_t>(image.Width) * image.Height * 4);
+	for (uint32_t y = 0; y < image.Height; y++)
+	{
+		const uint8_t* src = data + pixelOffset + (topDown ? y : image.Height - 1 - y) * rowPitch;
+		uint8_t* dest = image.Rgba.data() + static_cast<size_t>(y) * image.Width * 4;
+		for (uint32_t x = 0; x < image.Width; x++, src += texelBytes, dest += 4)
+		{
+			dest[0] = src[2];
+			dest[1] = src[1];
+			dest[2] = src[0];
+			// The alpha byte of a BI_RGB image is unused and often zero
+			dest[3] = (bitCount == 32 && compression == 3) ? src[3] : 255;
+		}
+	}
+	return true;
+}
+
+std::vector<uint8_t> CompressTexture(const RgbaImage& image, const TextureCompressOptions& options,
+	TextureCompressStats* stats)
+{
+	const MipFormat mipFormat = options.Srgb ? MipFormat_RGBA8Srgb : MipFormat_RGBA8;
+	const uint32_t mipCount = options.Mips ? FullMipCount(image.Width, image.Height) : 1;
+	std::vector<uint8_t> chain(MipChainBytes(mipFormat, image.Width, image.Height, mipCount));
+	memcpy(chain.data(), image.Rgba.data(), image.Rgba.size());
+	GenerateMips(mipFormat, options.Filter, image.Width, image.Height, 1, mipCount, chain.data(), chain.size(), options.ThreadCount);
+
+	const bool dx10 = (options.Format == BcEncodeFormat_BC7);
+	size_t headerBytes = sizeof(uint32_t) + sizeof(DdsHeader) + (dx10 ? sizeof(DdsHeaderDxt10) : 0);
+	size_t totalBytes = headerBytes;
+	for (uint32_t level = 0; level < mipCount; level++)
+	{
+		totalBytes += SurfaceBytes(options.Format, std::max(1u, image.Width >> level), std::max(1u, image.Height >> level));
+	}
+	std::vector<uint8_t> dds(totalBytes, 0);
+
+	DdsHeader header = {};
+	header.Size = sizeof(DdsHeader);
+	header.Flags = DdsFlagsTexture | (mipCount > 1 ? DdsFlagMipMapCount : 0);
+	header.Height = image.Height;
+	header.Width = image.Width;
+	header.PitchOrLinearSize = static_cast<uint32_t>(SurfaceBytes(options.Format, image.Width, image.Height));
+	header.MipMapCount = mipCount;
+	header.PixelFormatSize = 32;
+	header.PixelFormatFlags = DdsPixelFormatFourCC;
+	switch (options.Format)
+	{
+	case BcEncodeFormat_BC1: header.FourCC = MakeFourCC('D', 'X', 'T', '1'); break;
+	case BcEncodeFormat_BC3: header.FourCC = MakeFourCC('D', 'X', 'T', '5'); break;
+	case BcEncodeFormat_BC5: header.FourCC = MakeFourCC('B', 'C', '5', 'U'); break;
+	case BcEncodeFormat_BC7: header.FourCC = MakeFourCC('D', 'X', '1', '0'); break;
+	}
+	header.Caps = DdsCapsTexture | (mipCount > 1 ? DdsCapsMipMap : 0);
+
+	memcpy(dds.data(), &DdsMagic, sizeof(DdsMagic));
+	memcpy(dds.data() + sizeof(uint32_t), &header, sizeof(header));
+	if (dx10)
+	{
+		DdsHeaderDxt10 extension = {};
+		extension.DxgiFormat = DxgiFormatBC7Unorm;
+		extension.ResourceDimension = ResourceDimensionTexture2D;
+		extension.ArraySize = 1;
+		memcpy(dds.data() + sizeof(uint32_t) + sizeof(DdsHeader), &extension, sizeof(extension));
+	}
+
+	const auto start = std::chrono::steady_clock::now();
+	uint8_t* blocks = dds.data() + headerBytes;
+	const uint8_t* rgba = chain.data();
+	for (uint32_t level = 0; level < mipCount; level++)
+	{
+		const uint32_t width = std::max(1u, image.Width >> level);
+		const uint32_t height = std::max(1u, image.Height >> level);
+		EncodeBcSurface(options.Format, options.Quality, rgba, static_cast<size_t>(width) * 4,
+			width, height, blocks, options.ThreadCount);
+		rgba += static_cast<size_t>(width) * height * 4;
+		blocks += SurfaceBytes(options.Format, width, height);
+	}
+	const std::chrono::duration<double> elapsed = std::chrono::steady_clock::now() - start;
+
+	if (stats)
+	{
+		stats->Width = image.Width;
+		stats->Height = image.Height;
+		stats->MipCount = mipCount;
+		stats->SourceBytes = chain.size();
+		stats->CompressedBytes = totalBytes - headerBytes;
+		stats->Seconds = elapsed.count();
+		stats->Psnr = BcSurfacePsnr(options.Format, image.Rgba.data(), static_cast<size_t>(image.Width) * 4,
+			image.Width, image.Height, dds.data() + headerBytes);
+	}
+	return dds;
+}
+
+bool CompressTextureFile(const std::filesystem::path& sourcePath, const TextureCompressOptions& options,
+	TextureCompressStats* stats)
+{
+	RgbaImage image;
+	if (!LoadBmp(sourcePath, image))
+	{
+		return false;
+	}
+
+	std::filesystem::path ddsPath = sourcePath;
+	ddsPath.replace_extension(".dds");
+	return WriteFileAtomic(ddsPath, CompressTexture(image, options, stats));
+}
+
+bool CompressTextureFiles(const std::vector<std::filesystem::path>& sourcePaths, const TextureCompressOptions& options,
+	std::vector<TextureCompressStats>* stats, unsigned threadCount)
+{
+	if (stats)
+	{
+		stats->assign(sourcePaths.size(), TextureCompressStats());
+	}
+
+	// Parallel across images, each encoded on its own thread; a single image gets
+	// the whole pool for its blocks instead
+	TextureCompressOptions imageOptions = options;
+	if (sourcePaths.size() > 1)
+	{
+		imageOptions.ThreadCount = 1;
+	}
+	std::vector<char> compressed(sourcePaths.size(), 0);
+	ParallelFor(sourcePaths.size(), threadCount, [&](size_t i)
+	{
+		compressed[i] = CompressTextureFile(sourcePaths[i], imageOptions, stats ? &(*stats)[i] : nullptr) ? 1 : 0;
+	});
+
+	return std::find(compressed.begin(), compressed.end(), 0) == compressed.end();
+}
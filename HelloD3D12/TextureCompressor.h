@@ -0,0 +1,60 @@
+#pragma once
+#include "BcEncode.h"
+#include "MipGenerator.h"
+#include <filesystem>
+#include <vector>
+
+// Offline block compression of source images into DDS files the texture loader can
+// read directly, so no texture has to be uploaded uncompressed.
+
+struct RgbaImage
+{
+	uint32_t Width = 0;
+	uint32_t Height = 0;
+	// Top row first, four bytes per texel, red first
+	std::vector<uint8_t> Rgba;
+};
+
+// Reads an uncompressed 24 or 32 bit BMP. 24 bit images get opaque alpha.
+bool LoadBmp(const std::filesystem::path& path, RgbaImage& image);
+
+struct TextureCompressOptions
+{
+	BcEncodeFormat Format = BcEncodeFormat_BC7;
+	BcQuality Quality = BcQuality_High;
+	// Full mip chain down to 1x1
+	bool Mips = true;
+	MipFilter Filter = MipFilter_Kaiser;
+	// Color channels hold sRGB values and are filtered in linear space; turn off for
+	// normal maps and other data textures
+	bool Srgb = true;
+	// Threads for the blocks of one image (0 picks one per core)
+	unsigned ThreadCount = 0;
+};
+
+struct TextureCompressStats
+{
+	uint32_t Width = 0;
+	uint32_t Height = 0;
+	uint32_t MipCount = 0;
+	uint64_t SourceBytes = 0;
+	uint64_t CompressedBytes = 0;
+	// Time spent encoding blocks, without loading or writing files
+	double Seconds = 0.0;
+	// Of the top mip
+	double Psnr = 0.0;
+};
+
+// Compresses image into an in-memory DDS file. BC1, BC3 and BC5 use the legacy
+// DXT1/DXT5/BC5U headers; BC7 adds the DX10 extension header.
+std::vector<uint8_t> CompressTexture(const RgbaImage& image, const TextureCompressOptions& options,
+	TextureCompressStats* stats = nullptr);
+
+// Compresses a BMP into a DDS file written next to it with a .dds extension
+bool CompressTextureFile(const std::filesystem::path& sourcePath, const TextureCompressOptions& options,
+	TextureCompressStats* stats = nullptr);
+
+// Compresses several files at once, one per thread; stats is resized to match
+// sourcePaths. Returns false if any of them failed.
+bool CompressTextureFiles(const std::vector<std::filesystem::path>& sourcePaths, const TextureCompressOptions& options,
+	std::vector<TextureCompressStats>* stats = nullptr, unsigned threadCount = 0);
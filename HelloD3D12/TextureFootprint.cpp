@@ -0,0 +1,128 @@
+#include "TextureFootprint.h"
+#include <algorithm>
+
+namespace
+{
+	inline uint64_t AlignUp(uint64_t value, uint64_t alignment)
+	{
+		return (value + alignment - 1) & ~(alignment - 1);
+	}
+
+	inline uint64_t SpanBytes(const SubresourceFootprint& footprint)
+	{
+		// The last row is not padded out to the pitch
+		return static_cast<uint64_t>(footprint.RowPitch) * (static_cast<uint64_t>(footprint.NumRows) * footprint.Depth - 1) +
+			footprint.RowSizeInBytes;
+	}
+}
+
+uint64_t ComputeTextureFootprints(const TextureLayoutDesc& desc, uint32_t firstSubresource, uint32_t subresourceCount,
+	uint64_t baseOffset, SubresourceFootprint* footprints)
+{
+	const uint32_t mipLevels = std::max(desc.MipLevels, 1u);
+	const uint32_t arraySize = (desc.Dimension == DdsDimension_Texture3D) ? 1 : std::max(desc.DepthOrArraySize, 1u);
+	if (subresourceCount == 0 || firstSubresource + subresourceCount > mipLevels * arraySize ||
+		DdsBitsPerPixel(desc.Format) == 0 || DdsIsPlanar(desc.Format))
+	{
+		return 0;
+	}
+
+	uint32_t blockWidth, blockHeight;
+	DdsBlockSize(desc.Format, blockWidth, blockHeight);
+
+	uint64_t offset = baseOffset;
+	uint64_t end = baseOffset;
+	for (uint32_t i = 0; i < subresourceCount; ++i)
+	{
+		const uint32_t mip = (firstSubresource + i) % mipLevels;
+		const uint64_t width = std::max<uint64_t>(desc.Width >> mip, 1);
+		const uint32_t height = (desc.Dimension == DdsDimension_Texture1D) ? 1 : std::max(desc.Height >> mip, 1u);
+		const uint32_t depth = (desc.Dimension == DdsDimension_Texture3D) ? std::max(desc.DepthOrArraySize >> mip, 1u) : 1;
+
+		size_t rowBytes, numRows;
+		DdsSurfaceInfo(static_cast<size_t>(width), height, desc.Format, nullptr, &rowBytes, &numRows);
+
+		SubresourceFootprint footprint;
+		footprint.Offset = AlignUp(offset, TexturePlacementAlignment);
+		footprint.Width = static_cast<uint32_t>(AlignUp(width, blockWidth));
+		footprint.Height = static_cast<uint32_t>(AlignUp(height, blockHeight));
+		footprint.Depth = depth;
+		footprint.RowPitch = static_cast<uint32_t>(AlignUp(rowBytes, TexturePitchAlignment));
+		footprint.NumRows = static_cast<uint32_t>(numRows);
+		footprint.RowSizeInBytes = rowBytes;
+		if (footprints)
+		{
+			footprints[i] = footprint;
+		}
+
+		end = footprint.Offset + SpanBytes(footprint);
+		offset = footprint.Offset + static_cast<uint64_t>(footprint.RowPitch) * footprint.NumRows * depth;
+	}
+	return end - baseOffset;
+}
+
+uint64_t FootprintRangeBytes(const SubresourceFootprint* footprints, uint32_t count)
+{
+	const SubresourceFootprint& last = footprints[count - 1];
+	return last.Offset - footprints[0].Offset + SpanBytes(last);
+}
+
+uint64_t TextureFootprintCache::GetFootprints(const TextureLayoutDesc& desc, uint32_t firstSubresource,
+	uint32_t subresourceCount, uint64_t baseOffset, SubresourceFootprint* footprints)
+{
+	uint32_t layoutCount;
+	const SubresourceFootprint* layout = FindLayout(desc, layoutCount);
+	if (!layout || subresourceCount == 0 || firstSubresource + subresourceCount > layoutCount)
+	{
+		return 0;
+	}
+
+	// Placements are multiples of the alignment, so a range starting at one lays out as
+	// the whole texture does, shifted
+	const SubresourceFootprint* source = layout + firstSubresource;
+	if (footprints)
+	{
+		for (uint32_t i = 0; i < subresourceCount; ++i)
+		{
+			footprints[i] = source[i];
+			footprints[i].Offset = source[i].Offset - source[0].Offset + baseOffset;
+		}
+	}
+	return FootprintRangeBytes(source, subresourceCount);
+}
+
+const SubresourceFootprint* TextureFootprintCache::FindLayout(const TextureLayoutDesc& desc, uint32_t& subresourceCount)
+{
+	std::lock_guard<std::mutex> lock(m_Mutex);
+	m_Lookups++;
+	auto it = m_Layouts.find(desc);
+	if (it != m_Layouts.end())
+	{
+		m_Hits++;
+	}
+	else
+	{
+		const uint32_t arraySize = (desc.Dimension == DdsDimension_Texture3D) ? 1 : std::max(desc.DepthOrArraySize, 1u);
+		std::unique_ptr<std::vector<SubresourceFootprint>> layout(new std::vector<SubresourceFootprint>(
+			static_cast<size_t>(std::max(desc.MipLevels, 1u)) * arraySize));
+		if (ComputeTextureFootprints(desc, 0, static_cast<uint32_t>(layout->size()), 0, layout->data()) == 0)
+		{
+			// Unsupported descriptions are remembered too, as empty layouts
+			layout->clear();
+		}
+		it = m_Layouts.emplace(desc, std::move(layout)).first;
+	}
+
+	subresourceCount = static_cast<uint32_t>(it->second->size());
+	return subresourceCount ? it->second->data() : nullptr;
+}
+
+TextureFootprintCache::Statistics TextureFootprintCache::GetStatistics() const
+{
+	std::lock_guard<std::mutex> lock(m_Mutex);
+	Statistics statistics;
+	statistics.Lookups = m_Lookups;
+	statistics.Hits = m_Hits;
+	statistics.Layouts = static_cast<uint32_t>(m_Layouts.size());
+	return statistics;
+}
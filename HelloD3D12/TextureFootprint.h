@@ -0,0 +1,92 @@
+#pragma once
+#include "DdsFormat.h"
+#include <memory>
+#include <mutex>
+#include <unordered_map>
+#include <vector>
+
+// D3D12_TEXTURE_DATA_PITCH_ALIGNMENT and D3D12_TEXTURE_DATA_PLACEMENT_ALIGNMENT
+const uint32_t TexturePitchAlignment = 256;
+const uint64_t TexturePlacementAlignment = 512;
+
+// The parts of a D3D12_RESOURCE_DESC its copyable footprints depend on
+struct TextureLayoutDesc
+{
+	DdsDimension Dimension;
+	uint32_t Format;
+	uint64_t Width;
+	uint32_t Height;
+	// Depth of 3D textures, array size of the others
+	uint32_t DepthOrArraySize;
+	uint32_t MipLevels;
+
+	inline bool operator==(const TextureLayoutDesc& other) const
+	{
+		return Dimension == other.Dimension && Format == other.Format && Width == other.Width && Height == other.Height &&
+			DepthOrArraySize == other.DepthOrArraySize && MipLevels == other.MipLevels;
+	}
+};
+
+// A D3D12_PLACED_SUBRESOURCE_FOOTPRINT with the row count and row size GetCopyableFootprints
+// reports beside it. Width and Height are rounded up to whole blocks.
+struct SubresourceFootprint
+{
+	uint64_t Offset;
+	uint32_t Width;
+	uint32_t Height;
+	uint32_t Depth;
+	uint32_t RowPitch;
+	uint32_t NumRows;
+	uint64_t RowSizeInBytes;
+};
+
+// Lays out subresources first to first + count - 1 in an upload buffer from baseOffset, a
+// multiple of TexturePlacementAlignment, the way ID3D12Device::GetCopyableFootprints does: rows padded to TexturePitchAlignment
+// and subresources placed at TexturePlacementAlignment. Returns the bytes they span,
+// the last row unpadded, or 0 for planar formats and formats DdsBitsPerPixel does not
+// know, which need the device. footprints may be null.
+uint64_t ComputeTextureFootprints(const TextureLayoutDesc& desc, uint32_t firstSubresource, uint32_t subresourceCount,
+	uint64_t baseOffset, SubresourceFootprint* footprints);
+
+// Bytes from the first footprint of a laid out range to the end of its last
+uint64_t FootprintRangeBytes(const SubresourceFootprint* footprints, uint32_t count);
+
+// ComputeTextureFootprints with the layout of every texture description kept, so loading
+// many textures of a few shapes lays each shape out once. Safe to use from several threads.
+class TextureFootprintCache
+{
+public:
+	struct Statistics
+	{
+		uint64_t Lookups;
+		uint64_t Hits;
+		uint32_t Layouts;
+	};
+
+	uint64_t GetFootprints(const TextureLayoutDesc& desc, uint32_t firstSubresource, uint32_t subresourceCount,
+		uint64_t baseOffset, SubresourceFootprint* footprints);
+
+	// Every subresource of the texture laid out from offset 0, or null for formats
+	// ComputeTextureFootprints cannot lay out. Valid for as long as the cache is.
+	const SubresourceFootprint* FindLayout(const TextureLayoutDesc& desc, uint32_t& subresourceCount);
+
+	Statistics GetStatistics() const;
+
+private:
+	struct DescHash
+	{
+		inline size_t operator()(const TextureLayoutDesc& desc) const
+		{
+			uint64_t h = desc.Width * 0x9E3779B97F4A7C15ull;
+			h ^= (static_cast<uint64_t>(desc.Height) << 32 | desc.DepthOrArraySize) * 0xC2B2AE3D27D4EB4Full;
+			h ^= (static_cast<uint64_t>(desc.Format) << 40 | static_cast<uint64_t>(desc.Dimension) << 32 | desc.MipLevels) * 0x165667B19E3779F9ull;
+			return static_cast<size_t>(h ^ (h >> 29));
+		}
+	};
+
+	// Layouts are never removed, so one can be read without the lock once found
+	mutable std::mutex m_Mutex;
+	std::unordered_map<TextureLayoutDesc, std::unique_ptr<std::vector<SubresourceFootprint>>, DescHash> m_Layouts;
+	uint64_t m_Lookups = 0;
+	uint64_t m_Hits = 0;
+};
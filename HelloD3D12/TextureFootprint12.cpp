@@ -0,0 +1,110 @@
+#include "TextureFootprint12.h"
+#include "d3dx12.h"
+#include <cassert>
+#include <vector>
+
+namespace
+{
+#if defined(_DEBUG)
+	// Debug builds compare every cached layout with the device's, so a rule the cache
+	// gets wrong shows up on the first texture of that shape
+	void CheckAgainstDevice(ID3D12Device* device, const D3D12_RESOURCE_DESC& desc, UINT firstSubresource,
+		UINT subresourceCount, const SubresourceFootprint* source, UINT64 totalBytes)
+	{
+		std::vector<D3D12_PLACED_SUBRESOURCE_FOOTPRINT> layouts(subresourceCount);
+		std::vector<UINT> numRows(subresourceCount);
+		std::vector<UINT64> rowSizes(subresourceCount);
+		UINT64 deviceBytes = 0;
+		device->GetCopyableFootprints(&desc, firstSubresource, subresourceCount, 0, layouts.data(), numRows.data(),
+			rowSizes.data(), &deviceBytes);
+		assert(deviceBytes == totalBytes);
+		for (UINT i = 0; i < subresourceCount; ++i)
+		{
+			assert(layouts[i].Offset == source[i].Offset - source[0].Offset);
+			assert(layouts[i].Footprint.Width == source[i].Width && layouts[i].Footprint.Height == source[i].Height);
+			assert(layouts[i].Footprint.Depth == source[i].Depth && layouts[i].Footprint.RowPitch == source[i].RowPitch);
+			assert(numRows[i] == source[i].NumRows && rowSizes[i] == source[i].RowSizeInBytes);
+		}
+		(void)totalBytes;
+	}
+#endif
+}
+
+TextureFootprintCache& SharedTextureFootprints()
+{
+	static TextureFootprintCache cache;
+	return cache;
+}
+
+TextureLayoutDesc MakeTextureLayoutDesc(const D3D12_RESOURCE_DESC& desc)
+{
+	TextureLayoutDesc layout;
+	layout.Dimension = static_cast<DdsDimension>(desc.Dimension);
+	layout.Format = static_cast<uint32_t>(desc.Format);
+	layout.Width = desc.Width;
+	layout.Height = desc.Height;
+	layout.DepthOrArraySize = desc.DepthOrArraySize;
+	layout.MipLevels = desc.MipLevels;
+	return layout;
+}
+
+UINT64 GetCopyableFootprints12(ID3D12Device* device, const D3D12_RESOURCE_DESC& desc, UINT firstSubresource,
+	UINT subresourceCount, UINT64 baseOffset, D3D12_PLACED_SUBRESOURCE_FOOTPRINT* layouts, UINT* numRows,
+	UINT64* rowSizesInBytes)
+{
+	uint32_t layoutCount = 0;
+	const SubresourceFootprint* layout = nullptr;
+	if (desc.Dimension != D3D12_RESOURCE_DIMENSION_BUFFER && desc.Layout == D3D12_TEXTURE_LAYOUT_UNKNOWN)
+	{
+		layout = SharedTextureFootprints().FindLayout(MakeTextureLayoutDesc(desc), layoutCount);
+	}
+	if (!layout || subresourceCount == 0 || firstSubresource + subresourceCount > layoutCount)
+	{
+		UINT64 totalBytes = 0;
+		device->GetCopyableFootprints(&desc, firstSubresource, subresourceCount, baseOffset, layouts, numRows,
+			rowSizesInBytes, &totalBytes);
+		return totalBytes;
+	}
+
+	const SubresourceFootprint* source = layout + firstSubresource;
+#if defined(_DEBUG)
+	CheckAgainstDevice(device, desc, firstSubresource, subresourceCount, source, FootprintRangeBytes(source, subresourceCount));
+#endif
+	for (UINT i = 0; i < subresourceCount; ++i)
+	{
+		if (layouts)
+		{
+			layouts[i].Offset = source[i].Offset - source[0].Offset + baseOffset;
+			layouts[i].Footprint.Format = desc.Format;
+			layouts[i].Footprint.Width = source[i].Width;
+			layouts[i].Footprint.Height = source[i].Height;
+			layouts[i].Footprint.Depth = source[i].Depth;
+			layouts[i].Footprint.RowPitch = source[i].RowPitch;
+		}
+		if (numRows)
+		{
+			numRows[i] = source[i].NumRows;
+		}
+		if (rowSizesInBytes)
+		{
+			rowSizesInBytes[i] = source[i].RowSizeInBytes;
+		}
+	}
+	return FootprintRangeBytes(source, subresourceCount);
+}
+
+UINT64 GetRequiredIntermediateSize12(ID3D12Resource* resource, UINT firstSubresource, UINT subresourceCount)
+{
+	const D3D12_RESOURCE_DESC desc = resource->GetDesc();
+	uint32_t layoutCount = 0;
+	const SubresourceFootprint* layout = nullptr;
+	if (desc.Dimension != D3D12_RESOURCE_DIMENSION_BUFFER && desc.Layout == D3D12_TEXTURE_LAYOUT_UNKNOWN)
+	{
+		layout = SharedTextureFootprints().FindLayout(MakeTextureLayoutDesc(desc), layoutCount);
+	}
+	if (!layout || subresourceCount == 0 || firstSubresource + subresourceCount > layoutCount)
+	{
+		return GetRequiredIntermediateSize(resource, firstSubresource, subresourceCount);
+	}
+	return FootprintRangeBytes(layout + firstSubresource, subresourceCount);
+}
@@ -0,0 +1,18 @@
+#pragma once
+#include <d3d12.h>
+#include "TextureFootprint.h"
+
+// The footprint cache every upload path shares; layouts depend only on the description
+TextureFootprintCache& SharedTextureFootprints();
+
+TextureLayoutDesc MakeTextureLayoutDesc(const D3D12_RESOURCE_DESC& desc);
+
+// ID3D12Device::GetCopyableFootprints answered from SharedTextureFootprints, so it can run
+// on any thread without a device call. Asks device only for descriptions the cache
+// cannot lay out. Any output may be null; returns the total bytes.
+UINT64 GetCopyableFootprints12(ID3D12Device* device, const D3D12_RESOURCE_DESC& desc, UINT firstSubresource,
+	UINT subresourceCount, UINT64 baseOffset, D3D12_PLACED_SUBRESOURCE_FOOTPRINT* layouts, UINT* numRows,
+	UINT64* rowSizesInBytes);
+
+// GetRequiredIntermediateSize in the same way
+UINT64 GetRequiredIntermediateSize12(ID3D12Resource* resource, UINT firstSubresource, UINT subresourceCount);
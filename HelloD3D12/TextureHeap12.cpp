@@ -0,0 +1,136 @@
+#include "TextureHeap12.h"
+#include <algorithm>
+
+HRESULT TextureHeap12::Create(ID3D12Device* device, uint64_t blockSize)
+{
+	if (device == nullptr)
+	{
+		return E_POINTER;
+	}
+	m_Device = device;
+	m_BlockSize = (blockSize + D3D12_DEFAULT_RESOURCE_PLACEMENT_ALIGNMENT - 1) &
+		~static_cast<uint64_t>(D3D12_DEFAULT_RESOURCE_PLACEMENT_ALIGNMENT - 1);
+	m_Blocks.clear();
+	m_Placements.clear();
+	return S_OK;
+}
+
+HRESULT TextureHeap12::AddBlock(uint64_t size, uint32_t& index)
+{
+	D3D12_HEAP_DESC heapDesc = {};
+	heapDesc.SizeInBytes = size;
+	heapDesc.Properties.Type = D3D12_HEAP_TYPE_DEFAULT;
+	heapDesc.Alignment = D3D12_DEFAULT_RESOURCE_PLACEMENT_ALIGNMENT;
+	heapDesc.Flags = D3D12_HEAP_FLAG_ALLOW_ONLY_NON_RT_DS_TEXTURES;
+
+	auto block = std::make_unique<Block>();
+	HRESULT hr = m_Device->CreateHeap(&heapDesc, IID_PPV_ARGS(&block->Heap));
+	if (FAILED(hr))
+	{
+		return hr;
+	}
+	block->Allocator.Reset(size, D3D12_SMALL_RESOURCE_PLACEMENT_ALIGNMENT);
+
+	index = static_cast<uint32_t>(m_Blocks.size());
+	m_Blocks.push_back(std::move(block));
+	return S_OK;
+}
+
+HRESULT TextureHeap12::CreateTexture(const D3D12_RESOURCE_DESC& desc, D3D12_RESOURCE_STATES initialState,
+	Microsoft::WRL::ComPtr<ID3D12Resource>& texture)
+{
+	texture = nullptr;
+	if (!m_Device)
+	{
+		return E_NOT_VALID_STATE;
+	}
+	if (desc.Flags & (D3D12_RESOURCE_FLAG_ALLOW_RENDER_TARGET | D3D12_RESOURCE_FLAG_ALLOW_DEPTH_STENCIL))
+	{
+		return E_INVALIDARG;
+	}
+
+	// Ask for small resource alignment first; the runtime answers with 64KB when the
+	// texture's format or size does not qualify, and then the request must say so
+	D3D12_RESOURCE_DESC placedDesc = desc;
+	placedDesc.Alignment = D3D12_SMALL_RESOURCE_PLACEMENT_ALIGNMENT;
+	D3D12_RESOURCE_ALLOCATION_INFO info = m_Device->GetResourceAllocationInfo(0, 1, &placedDesc);
+	if (info.Alignment != D3D12_SMALL_RESOURCE_PLACEMENT_ALIGNMENT)
+	{
+		placedDesc.Alignment = 0;
+		info = m_Device->GetResourceAllocationInfo(0, 1, &placedDesc);
+	}
+	if (info.SizeInBytes == UINT64_MAX)
+	{
+		return E_INVALIDARG;
+	}
+
+	std::lock_guard<std::mutex> lock(m_Mutex);
+	Placement placement = {};
+	TlsfAllocator::Allocation allocation = {};
+	bool placed = false;
+	for (uint32_t i = 0; i < m_Blocks.size() && !placed; ++i)
+	{
+		if (m_Blocks[i]->Allocator.Allocate(info.SizeInBytes, info.Alignment, allocation))
+		{
+			placement.Block = i;
+			placed = true;
+		}
+	}
+	if (!placed)
+	{
+		// Oversized textures get a block sized to fit; it is reused like any other
+		const uint64_t size = std::max(m_BlockSize, (info.SizeInBytes + D3D12_DEFAULT_RESOURCE_PLACEMENT_ALIGNMENT - 1) &
+			~static_cast<uint64_t>(D3D12_DEFAULT_RESOURCE_PLACEMENT_ALIGNMENT - 1));
+		HRESULT hr = AddBlock(size, placement.Block);
+		if (FAILED(hr))
+		{
+			return hr;
+		}
+		if (!m_Blocks[placement.Block]->Allocator.Allocate(info.SizeInBytes, info.Alignment, allocation))
+		{
+			return E_OUTOFMEMORY;
+		}
+	}
+	placement.Handle = allocation.Handle;
+
+	Block& block = *m_Blocks[placement.Block];
+	HRESULT hr = m_Device->CreatePlacedResource(block.Heap.Get(), allocation.Offset, &placedDesc,
+		initialState, nullptr, IID_PPV_ARGS(&texture));
+	if (FAILED(hr))
+	{
+		block.Allocator.Free(allocation.Handle);
+		texture = nullptr;
+		return hr;
+	}
+
+	m_Placements[texture.Get()] = placement;
+	return S_OK;
+}
+
+void TextureHeap12::Release(ID3D12Resource* texture)
+{
+	std::lock_guard<std::mutex> lock(m_Mutex);
+	auto it = m_Placements.find(texture);
+	if (it == m_Placements.end())
+	{
+		return;
+	}
+	m_Blocks[it->second.Block]->Allocator.Free(it->second.Handle);
+	m_Placements.erase(it);
+}
+
+TlsfAllocator::Statistics TextureHeap12::GetStatistics() const
+{
+	std::lock_guard<std::mutex> lock(m_Mutex);
+	TlsfAllocator::Statistics total = {};
+	for (const auto& block : m_Blocks)
+	{
+		const TlsfAllocator::Statistics stats = block->Allocator.GetStatistics();
+		total.Capacity += stats.Capacity;
+		total.FreeSize += stats.FreeSize;
+		total.LargestFreeBlock = std::max(total.LargestFreeBlock, stats.LargestFreeBlock);
+		total.AllocationCount += stats.AllocationCount;
+		total.FreeBlockCount += stats.FreeBlockCount;
+	}
+	return total;
+}
@@ -0,0 +1,52 @@
+#pragma once
+#include <d3d12.h>
+#include <wrl.h>
+#include <memory>
+#include <mutex>
+#include <unordered_map>
+#include <vector>
+#include "TlsfAllocator.h"
+
+// Places textures in a few large default heaps instead of one committed resource (and
+// one 64KB-aligned heap) each. Small textures use 4KB placement alignment when the
+// format allows it; textures larger than a block get a heap of their own. Safe to use
+// from several threads.
+class TextureHeap12
+{
+public:
+	static const uint64_t DefaultBlockSize = 64 * 1024 * 1024;
+
+	HRESULT Create(ID3D12Device* device, uint64_t blockSize = DefaultBlockSize);
+
+	// desc.Alignment is chosen here; the texture cannot be a render target or depth buffer
+	HRESULT CreateTexture(const D3D12_RESOURCE_DESC& desc, D3D12_RESOURCE_STATES initialState,
+		Microsoft::WRL::ComPtr<ID3D12Resource>& texture);
+
+	// Returns the texture's memory to its heap; the GPU must be done with it
+	void Release(ID3D12Resource* texture);
+
+	// Totals over every block: capacity, free bytes and the largest free range
+	TlsfAllocator::Statistics GetStatistics() const;
+	inline size_t BlockCount() const { return m_Blocks.size(); }
+
+private:
+	struct Block
+	{
+		Microsoft::WRL::ComPtr<ID3D12Heap> Heap;
+		TlsfAllocator Allocator;
+	};
+
+	struct Placement
+	{
+		uint32_t Block;
+		uint32_t Handle;
+	};
+
+	HRESULT AddBlock(uint64_t size, uint32_t& index);
+
+	Microsoft::WRL::ComPtr<ID3D12Device> m_Device;
+	uint64_t m_BlockSize = DefaultBlockSize;
+	std::vector<std::unique_ptr<Block>> m_Blocks;
+	std::unordered_map<ID3D12Resource*, Placement> m_Placements;
+	mutable std::mutex m_Mutex;
+};
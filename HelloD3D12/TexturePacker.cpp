@@ -0,0 +1,350 @@
+#include "TexturePacker.h"
+#include <algorithm>
+#include <cstring>
+#include <map>
+#include <tuple>
+
+namespace
+{
+	// D3D12_REQ_TEXTURE2D_ARRAY_AXIS_DIMENSION
+	const uint32_t MaxArraySlices = 2048;
+
+	uint32_t AlignUp(uint32_t value, uint32_t alignment)
+	{
+		return (value + alignment - 1) / alignment * alignment;
+	}
+
+	uint32_t NextPowerOfTwo(uint32_t value)
+	{
+		uint32_t power = 1;
+		while (power < value)
+		{
+			power *= 2;
+		}
+		return power;
+	}
+
+	// The gutter actually used, rounded so that entries stay aligned
+	uint32_t GutterSize(const TexturePackOptions& options)
+	{
+		return AlignUp(options.Padding, std::max(1u, options.Alignment));
+	}
+
+	struct PackItem
+	{
+		uint32_t Input;
+		// Including the gutter
+		uint32_t Width;
+		uint32_t Height;
+	};
+
+	// Bottom-left skyline packing: each item goes where its top edge ends up lowest,
+	// leftmost on ties. The skyline is the top of the packed area, left to right.
+	class Skyline
+	{
+	public:
+		Skyline(uint32_t width, uint32_t height) : m_Width(width), m_Height(height)
+		{
+			m_Segments.push_back({ 0, 0, width });
+		}
+
+		bool Insert(uint32_t width, uint32_t height, uint32_t& x, uint32_t& y)
+		{
+			size_t bestSegment = m_Segments.size();
+			uint32_t bestY = ~0u;
+			for (size_t i = 0; i < m_Segments.size(); i++)
+			{
+				uint32_t top;
+				if (Fits(i, width, height, top) && top < bestY)
+				{
+					bestSegment = i;
+					bestY = top;
+				}
+			}
+			if (bestSegment == m_Segments.size())
+			{
+				return false;
+			}
+
+			x = m_Segments[bestSegment].X;
+			y = bestY;
+
+			// The new segment replaces everything it covers
+			const Segment added = { x, y + height, width };
+			size_t end = bestSegment;
+			while (end < m_Segments.size() && m_Segments[end].X + m_Segments[end].Width <= x + width)
+			{
+				end++;
+			}
+			if (end < m_Segments.size() && m_Segments[end].X < x + width)
+			{
+				const uint32_t cut = x + width - m_Segments[end].X;
+				m_Segments[end].X += cut;
+				m_Segments[end].Width -= cut;
+			}
+			m_Segments.erase(m_Segments.begin() + bestSegment, m_Segments.begin() + end);
+			m_Segments.insert(m_Segments.begin() + bestSegment, added);
+
+			// Merge neighbours at the same height
+			for (size_t i = 0; i + 1 < m_Segments.size();)
+			{
+				if (m_Segments[i].Y == m_Segments[i + 1].Y)
+				{
+					m_Segments[i].Width += m_Segments[i + 1].Width;
+					m_Segments.erase(m_Segments.begin() + i + 1);
+				}
+				else
+				{
+					i++;
+				}
+			}
+			return true;
+		}
+
+	private:
+		struct Segment
+		{
+			uint32_t X;
+			uint32_t Y;
+			uint32_t Width;
+		};
+
+		// Whether an item fits with its left edge at segment i, and the height it would sit at
+		bool Fits(size_t i, uint32_t width, uint32_t height, uint32_t& top) const
+		{
+			if (m_Segments[i].X + width > m_Width)
+			{
+				return false;
+			}
+			top = 0;
+			uint32_t covered = 0;
+			for (size_t j = i; covered < width; j++)
+			{
+				top = std::max(top, m_Segments[j].Y);
+				if (top + height > m_Height)
+				{
+					return false;
+				}
+				covered += m_Segments[j].Width;
+			}
+			return true;
+		}
+
+		uint32_t m_Width;
+		uint32_t m_Height;
+		std::vector<Segment> m_Segments;
+	};
+
+	// Packs as many items as fit, in order; returns the ones left over
+	std::vector<PackItem> PackInto(const std::vector<PackItem>& items, uint32_t width, uint32_t height,
+		uint32_t gutter, std::vector<TexturePackRect>& rects)
+	{
+		Skyline skyline(width, height);
+		std::vector<PackItem> leftover;
+		rects.clear();
+		for (const PackItem& item : items)
+		{
+			uint32_t x, y;
+			if (skyline.Insert(item.Width, item.Height, x, y))
+			{
+				rects.push_back({ item.Input, x + gutter, y + gutter });
+			}
+			else
+			{
+				leftover.push_back(item);
+			}
+		}
+		return leftover;
+	}
+}
+
+TexturePackPlan PackTextures(const std::vector<TexturePackInput>& inputs, const TexturePackOptions& options)
+{
+	TexturePackPlan plan;
+	plan.Remaps.resize(inputs.size());
+
+	// Same format, size and mip count can share an array
+	std::map<std::tuple<uint32_t, uint32_t, uint32_t, uint32_t>, std::vector<uint32_t>> buckets;
+	for (uint32_t i = 0; i < inputs.size(); i++)
+	{
+		const TexturePackInput& input = inputs[i];
+		buckets[std::make_tuple(input.Format, input.Width, input.Height, input.MipCount)].push_back(i);
+	}
+
+	std::map<uint32_t, std::vector<uint32_t>> atlasCandidates;
+	for (const auto& bucket : buckets)
+	{
+		const std::vector<uint32_t>& members = bucket.second;
+		if (members.size() >= std::max(2u, options.MinArraySlices))
+		{
+			for (size_t first = 0; first < members.size(); first += MaxArraySlices)
+			{
+				TexturePackArray array;
+				const TexturePackInput& input = inputs[members[first]];
+				array.Width = input.Width;
+				array.Height = input.Height;
+				array.MipCount = input.MipCount;
+				array.Format = input.Format;
+				array.Slices.assign(members.begin() + first, members.begin() + std::min(members.size(), first + MaxArraySlices));
+				for (uint32_t slice = 0; slice < array.Slices.size(); slice++)
+				{
+					TextureRemap& remap = plan.Remaps[array.Slices[slice]];
+					remap.Kind = TexturePackKind_Array;
+					remap.Index = static_cast<uint32_t>(plan.Arrays.size());
+					remap.ArraySlice = slice;
+				}
+				plan.Arrays.push_back(std::move(array));
+			}
+			continue;
+		}
+
+		for (uint32_t member : members)
+		{
+			if (inputs[member].Wraps)
+			{
+				plan.Singles.push_back(member);
+			}
+			else
+			{
+				atlasCandidates[inputs[member].Format].push_back(member);
+			}
+		}
+	}
+
+	const uint32_t alignment = std::max(1u, options.Alignment);
+	const uint32_t gutter = GutterSize(options);
+	for (const auto& candidates : atlasCandidates)
+	{
+		std::vector<PackItem> items;
+		for (uint32_t input : candidates.second)
+		{
+			const PackItem item = { input, AlignUp(inputs[input].Width + 2 * gutter, alignment), AlignUp(inputs[input].Height + 2 * gutter, alignment) };
+			if (item.Width > options.MaxAtlasSize || item.Height > options.MaxAtlasSize)
+			{
+				plan.Singles.push_back(input);
+			}
+			else
+			{
+				items.push_back(item);
+			}
+		}
+
+		// Tallest first packs tightest on a skyline
+		std::stable_sort(items.begin(), items.end(), [](const PackItem& a, const PackItem& b)
+		{
+			return (a.Height != b.Height) ? a.Height > b.Height : a.Width > b.Width;
+		});
+
+		while (!items.empty())
+		{
+			if (items.size() == 1)
+			{
+				// An atlas of one saves nothing
+				plan.Singles.push_back(items[0].Input);
+				break;
+			}
+
+			// The smallest power of two atlas that takes everything left, or failing that a
+			// full size one taking what it can
+			uint32_t largest = 0;
+			for (const PackItem& item : items)
+			{
+				largest = std::max(largest, std::max(item.Width, item.Height));
+			}
+			TexturePackAtlas atlas;
+			atlas.Format = candidates.first;
+			std::vector<PackItem> leftover;
+			for (uint32_t size = NextPowerOfTwo(largest); ; size *= 2)
+			{
+				const uint32_t width = std::min(size, options.MaxAtlasSize);
+				bool packed = false;
+				for (uint32_t height : { width / 2, width })
+				{
+					if (height < largest)
+					{
+						continue;
+					}
+					leftover = PackInto(items, width, height, gutter, atlas.Rects);
+					atlas.Width = width;
+					atlas.Height = height;
+					if (leftover.empty())
+					{
+						packed = true;
+						break;
+					}
+				}
+				if (packed || width >= options.MaxAtlasSize)
+				{
+					break;
+				}
+			}
+
+			const uint32_t atlasIndex = static_cast<uint32_t>(plan.Atlases.size());
+			for (const TexturePackRect& rect : atlas.Rects)
+			{
+				const TexturePackInput& input = inputs[rect.Input];
+				TextureRemap& remap = plan.Remaps[rect.Input];
+				remap.Kind = TexturePackKind_Atlas;
+				remap.Index = atlasIndex;
+				remap.ScaleU = static_cast<float>(input.Width) / atlas.Width;
+				remap.ScaleV = static_cast<float>(input.Height) / atlas.Height;
+				remap.BiasU = static_cast<float>(rect.X) / atlas.Width;
+				remap.BiasV = static_cast<float>(rect.Y) / atlas.Height;
+			}
+			plan.Atlases.push_back(std::move(atlas));
+			items.swap(leftover);
+		}
+	}
+
+	std::sort(plan.Singles.begin(), plan.Singles.end());
+	for (uint32_t i = 0; i < plan.Singles.size(); i++)
+	{
+		plan.Remaps[plan.Singles[i]].Index = i;
+	}
+	return plan;
+}
+
+void ApplyTextureRemap(const TextureRemap& remap, float transform[4][4])
+{
+	// transform * [ScaleU 0 0 0; 0 ScaleV 0 0; 0 0 1 0; BiasU BiasV slice 1]
+	const float slice = static_cast<float>(remap.ArraySlice);
+	for (int row = 0; row < 4; row++)
+	{
+		float* m = transform[row];
+		const float w = m[3];
+		m[0] = m[0] * remap.ScaleU + w * remap.BiasU;
+		m[1] = m[1] * remap.ScaleV + w * remap.BiasV;
+		m[2] = m[2] + w * slice;
+	}
+}
+
+RgbaImage BuildAtlasImage(const TexturePackAtlas& atlas, const std::vector<const RgbaImage*>& images,
+	const TexturePackOptions& options)
+{
+	RgbaImage image;
+	image.Width = atlas.Width;
+	image.Height = atlas.Height;
+	image.Rgba.assign(static_cast<size_t>(atlas.Width) * atlas.Height * 4, 0);
+
+	const int64_t gutter = GutterSize(options);
+	for (const TexturePackRect& rect : atlas.Rects)
+	{
+		const RgbaImage& source = *images[rect.Input];
+		for (int64_t y = -gutter; y < source.Height + gutter; y++)
+		{
+			const int64_t sourceY = std::min<int64_t>(std::max<int64_t>(y, 0), source.Height - 1);
+			const uint8_t* sourceRow = source.Rgba.data() + sourceY * source.Width * 4;
+			uint8_t* destRow = image.Rgba.data() + ((rect.Y + y) * atlas.Width + rect.X) * 4;
+			for (int64_t x = -gutter; x < 0; x++)
+			{
+				memcpy(destRow + x * 4, sourceRow, 4);
+			}
+			memcpy(destRow, sourceRow, static_cast<size_t>(source.Width) * 4);
+			for (int64_t x = source.Width; x < source.Width + gutter; x++)
+			{
+				memcpy(destRow + x * 4, sourceRow + (source.Width - 1) * 4, 4);
+			}
+		}
+	}
+	return image;
+}
@@ -0,0 +1,104 @@
+#pragma once
+#include "TextureCompressor.h"
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+
+// Groups small textures into fewer resources so materials that differ only in their
+// textures can share descriptors and be drawn together. Textures with the same format,
+// size and mip count become slices of a Texture2DArray; the rest are packed into
+// atlases with a gutter around each one so bilinear filtering does not pick up the
+// neighbours. Every texture gets a remap that materials apply through
+// MaterialTransform.
+
+struct TexturePackInput
+{
+	uint32_t Width = 0;
+	uint32_t Height = 0;
+	uint32_t MipCount = 1;
+	// Textures only share a resource with others of the same format (a DXGI_FORMAT)
+	uint32_t Format = 0;
+	// Sampled with coordinates outside [0, 1]; such textures cannot go into an atlas
+	bool Wraps = true;
+};
+
+struct TexturePackOptions
+{
+	uint32_t MaxAtlasSize = 4096;
+	// Gutter texels on each side of an atlas entry, filled by repeating its edges. Mips
+	// stay clean down to the level where the gutter shrinks to one texel.
+	uint32_t Padding = 8;
+	// Entries start on multiples of this (4 keeps block compressed data block aligned)
+	uint32_t Alignment = 4;
+	// Fewer textures of one size than this are not worth an array
+	uint32_t MinArraySlices = 2;
+};
+
+enum TexturePackKind : uint32_t
+{
+	TexturePackKind_Array,
+	TexturePackKind_Atlas,
+	// Left in its own resource: it wraps and has no array partners, or does not fit
+	TexturePackKind_Single,
+};
+
+// Where a texture ended up. Its texture coordinates become uv * Scale + Bias, sampled
+// from slice ArraySlice of resource Index of the given kind.
+struct TextureRemap
+{
+	TexturePackKind Kind = TexturePackKind_Single;
+	uint32_t Index = 0;
+	uint32_t ArraySlice = 0;
+	float ScaleU = 1.0f;
+	float ScaleV = 1.0f;
+	float BiasU = 0.0f;
+	float BiasV = 0.0f;
+};
+
+struct TexturePackArray
+{
+	uint32_t Width;
+	uint32_t Height;
+	uint32_t MipCount;
+	uint32_t Format;
+	// Input index of each slice
+	std::vector<uint32_t> Slices;
+};
+
+struct TexturePackRect
+{
+	uint32_t Input;
+	// Top left of the texture itself, inside its gutter
+	uint32_t X;
+	uint32_t Y;
+};
+
+struct TexturePackAtlas
+{
+	uint32_t Width;
+	uint32_t Height;
+	uint32_t Format;
+	std::vector<TexturePackRect> Rects;
+};
+
+struct TexturePackPlan
+{
+	std::vector<TexturePackArray> Arrays;
+	std::vector<TexturePackAtlas> Atlases;
+	// Input index of each single
+	std::vector<uint32_t> Singles;
+	// One per input
+	std::vector<TextureRemap> Remaps;
+};
+
+TexturePackPlan PackTextures(const std::vector<TexturePackInput>& inputs, const TexturePackOptions& options = TexturePackOptions());
+
+// Composes the remap after a material's texture transform: a 4x4 matrix in the row
+// vector convention DirectXMath uses (XMFLOAT4X4::m). The array slice goes in the third
+// coordinate, so a Texture2DArray is sampled with the transformed (u, v, slice).
+void ApplyTextureRemap(const TextureRemap& remap, float transform[4][4]);
+
+// Copies the images of an atlas into one RGBA8 image, repeating each one's edges into
+// its gutter. images holds the RGBA8 contents of every input, by input index.
+RgbaImage BuildAtlasImage(const TexturePackAtlas& atlas, const std::vector<const RgbaImage*>& images,
+	const TexturePackOptions& options = TexturePackOptions());
@@ -0,0 +1,242 @@
+#include "TextureStreamer12.h"
+#include "DDSTextureLoader.h"
+#include "TextureFootprint12.h"
+#include "TextureUpload12.h"
+#include <algorithm>
+
+namespace
+{
+	bool IsBlockCompressed(DXGI_FORMAT format)
+	{
+		return (format >= DXGI_FORMAT_BC1_TYPELESS && format <= DXGI_FORMAT_BC5_SNORM) ||
+			(format >= DXGI_FORMAT_BC6H_TYPELESS && format <= DXGI_FORMAT_BC7_UNORM_SRGB);
+	}
+
+	// Coarsest mip a resource can start at: block-compressed textures need a top level
+	// that is whole blocks across
+	uint32_t TailMip(const D3D12_RESOURCE_DESC& desc)
+	{
+		uint32_t mip = 0;
+		while (mip + 1u < desc.MipLevels)
+		{
+			const UINT64 width = desc.Width >> (mip + 1);
+			const UINT height = desc.Height >> (mip + 1);
+			if (IsBlockCompressed(desc.Format) && (width % 4 != 0 || height % 4 != 0 || width == 0 || height == 0))
+			{
+				break;
+			}
+			mip++;
+		}
+		return mip;
+	}
+}
+
+void TextureStreamer12::Create(ID3D12Device* device, UploadRing12* uploadRing, TextureHeap12* textureHeap)
+{
+	m_Device = device;
+	m_UploadRing = uploadRing;
+	m_TextureHeap = textureHeap;
+	m_Streamer = MipStreamer();
+	m_Residency = ResidencyPolicy();
+	m_Frame = 1;
+	m_Textures.clear();
+	m_Replaced.clear();
+	m_UnsubmittedReplaced = 0;
+}
+
+HRESULT TextureStreamer12::Load(ID3D12GraphicsCommandList* cmdList, const wchar_t* fileName, size_t residentSize,
+	D3D12_CPU_DESCRIPTOR_HANDLE srv, uint32_t& texture,
+	Microsoft::WRL::ComPtr<ID3D12Resource>& textureUploadHeap)
+{
+	StreamedTexture streamed;
+	size_t residentMip = 0;
+	HRESULT hr = DirectX::CreateDDSTextureFromFile12Streaming(m_Device.Get(), cmdList, fileName, residentSize,
+		streamed.File, streamed.Resource, textureUploadHeap, streamed.Mips, residentMip, m_UploadRing, m_TextureHeap);
+	if (FAILED(hr))
+	{
+		return hr;
+	}
+	streamed.Srv = srv;
+	streamed.Desc = streamed.Resource->GetDesc();
+
+	// Budgets are in upload ring bytes, which include the row pitch padding; they stand in
+	// for the memory each mip takes too
+	std::vector<uint64_t> mipBytes(streamed.Mips.size());
+	for (UINT mip = 0; mip < mipBytes.size(); ++mip)
+	{
+		mipBytes[mip] = GetRequiredIntermediateSize12(streamed.Resource.Get(), mip, 1);
+	}
+
+	texture = m_Streamer.AddTexture(static_cast<uint32_t>(mipBytes.size()), static_cast<uint32_t>(residentMip), mipBytes.data());
+	m_Residency.AddTexture(static_cast<uint32_t>(mipBytes.size()), mipBytes.data(), TailMip(streamed.Desc));
+	m_Textures.push_back(std::move(streamed));
+	WriteView(texture, static_cast<uint32_t>(residentMip));
+	return S_OK;
+}
+
+void TextureStreamer12::RequestResolution(uint32_t texture, uint32_t width, uint32_t height)
+{
+	const D3D12_RESOURCE_DESC& desc = m_Textures[texture].Desc;
+	const uint32_t mip = MipStreamer::MipForResolution(static_cast<uint32_t>(desc.Width), desc.Height,
+		desc.MipLevels, width, height);
+	m_Streamer.Request(texture, mip);
+	m_Residency.Touch(texture, m_Frame, mip);
+}
+
+HRESULT TextureStreamer12::Update(ID3D12GraphicsCommandList* cmdList, uint64_t byteBudget)
+{
+	// Resize first, so the copies below go to the resources the textures end up with
+	m_Residency.Update(m_Frame, m_BaseChanges);
+	m_Frame++;
+	for (const ResidencyChange& change : m_BaseChanges)
+	{
+		HRESULT hr = SetBaseMip(cmdList, change.Texture, change.BaseMip);
+		if (FAILED(hr))
+		{
+			return hr;
+		}
+	}
+
+	if (!m_UploadRing)
+	{
+		return S_OK;
+	}
+
+	m_Streamer.Schedule(byteBudget, m_Uploads);
+	for (const MipUpload& upload : m_Uploads)
+	{
+		// Stop at the first upload that does not fit; what is left is scheduled again
+		// next frame, once earlier copies have retired
+		UploadRing12::Allocation staging;
+		if (!m_UploadRing->Allocate(upload.Bytes, D3D12_TEXTURE_DATA_PLACEMENT_ALIGNMENT, staging))
+		{
+			break;
+		}
+		m_Streamer.Start(upload);
+
+		StreamedTexture& texture = m_Textures[upload.Texture];
+		const UINT subresource = upload.Mip - texture.BaseMip;
+		cmdList->ResourceBarrier(1, &CD3DX12_RESOURCE_BARRIER::Transition(texture.Resource.Get(),
+			D3D12_RESOURCE_STATE_PIXEL_SHADER_RESOURCE, D3D12_RESOURCE_STATE_COPY_DEST, subresource));
+
+		// One thread: this runs every frame, and starting threads for a mip would cost
+		// more than it saves and allocate besides
+		UpdateSubresources12(cmdList, texture.Resource.Get(), staging.Resource, staging.Offset, staging.CpuAddress,
+			subresource, 1, &texture.Mips[upload.Mip], ThreadScratchArena(), 1);
+
+		cmdList->ResourceBarrier(1, &CD3DX12_RESOURCE_BARRIER::Transition(texture.Resource.Get(),
+			D3D12_RESOURCE_STATE_COPY_DEST, D3D12_RESOURCE_STATE_PIXEL_SHADER_RESOURCE, subresource));
+	}
+	return S_OK;
+}
+
+void TextureStreamer12::Submit(uint64_t fenceValue)
+{
+	m_Streamer.Submit(fenceValue);
+	for (size_t i = m_Replaced.size() - m_UnsubmittedReplaced; i < m_Replaced.size(); ++i)
+	{
+		m_Replaced[i].FenceValue = fenceValue;
+	}
+	m_UnsubmittedReplaced = 0;
+}
+
+void TextureStreamer12::Retire(ID3D12Fence* fence)
+{
+	const uint64_t completed = fence->GetCompletedValue();
+	m_Streamer.Retire(completed, m_Changes);
+	for (const MipResidencyChange& change : m_Changes)
+	{
+		WriteView(change.Texture, change.ResidentMip);
+	}
+
+	while (m_Replaced.size() > m_UnsubmittedReplaced && m_Replaced.front().FenceValue <= completed)
+	{
+		if (m_TextureHeap)
+		{
+			m_TextureHeap->Release(m_Replaced.front().Resource.Get());
+		}
+		m_Replaced.pop_front();
+	}
+}
+
+HRESULT TextureStreamer12::SetBaseMip(ID3D12GraphicsCommandList* cmdList, uint32_t texture, uint32_t baseMip)
+{
+	StreamedTexture& streamed = m_Textures[texture];
+	const uint32_t mipCount = static_cast<uint32_t>(streamed.Mips.size());
+	baseMip = std::min(baseMip, mipCount);
+	if (baseMip == streamed.BaseMip)
+	{
+		return S_OK;
+	}
+
+	Microsoft::WRL::ComPtr<ID3D12Resource> resource;
+	if (baseMip < mipCount)
+	{
+		D3D12_RESOURCE_DESC desc = streamed.Desc;
+		desc.Alignment = 0;
+		desc.Width = std::max<UINT64>(desc.Width >> baseMip, 1);
+		desc.Height = std::max<UINT>(desc.Height >> baseMip, 1);
+		desc.MipLevels = static_cast<UINT16>(mipCount - baseMip);
+		HRESULT hr = m_TextureHeap
+			? m_TextureHeap->CreateTexture(desc, D3D12_RESOURCE_STATE_COPY_DEST, resource)
+			: m_Device->CreateCommittedResource(&CD3DX12_HEAP_PROPERTIES(D3D12_HEAP_TYPE_DEFAULT), D3D12_HEAP_FLAG_NONE,
+				&desc, D3D12_RESOURCE_STATE_COPY_DEST, nullptr, IID_PPV_ARGS(&resource));
+		if (FAILED(hr))
+		{
+			return hr;
+		}
+	}
+
+	// Mips still being copied in land in the old resource before the copies below run
+	m_Streamer.SetMinMip(texture, baseMip);
+	if (resource && streamed.Resource)
+	{
+		const uint32_t firstMip = std::max(m_Streamer.StartedMip(texture), std::max(streamed.BaseMip, baseMip));
+		if (firstMip < mipCount)
+		{
+			cmdList->ResourceBarrier(1, &CD3DX12_RESOURCE_BARRIER::Transition(streamed.Resource.Get(),
+				D3D12_RESOURCE_STATE_PIXEL_SHADER_RESOURCE, D3D12_RESOURCE_STATE_COPY_SOURCE));
+			for (uint32_t mip = firstMip; mip < mipCount; ++mip)
+			{
+				const CD3DX12_TEXTURE_COPY_LOCATION dest(resource.Get(), mip - baseMip);
+				const CD3DX12_TEXTURE_COPY_LOCATION source(streamed.Resource.Get(), mip - streamed.BaseMip);
+				cmdList->CopyTextureRegion(&dest, 0, 0, 0, &source, nullptr);
+			}
+		}
+	}
+	if (resource)
+	{
+		cmdList->ResourceBarrier(1, &CD3DX12_RESOURCE_BARRIER::Transition(resource.Get(),
+			D3D12_RESOURCE_STATE_COPY_DEST, D3D12_RESOURCE_STATE_PIXEL_SHADER_RESOURCE));
+	}
+
+	if (streamed.Resource)
+	{
+		m_Replaced.push_back({ std::move(streamed.Resource), 0 });
+		m_UnsubmittedReplaced++;
+	}
+	streamed.Resource = std::move(resource);
+	streamed.BaseMip = baseMip;
+	WriteView(texture, m_Streamer.ResidentMip(texture));
+	return S_OK;
+}
+
+void TextureStreamer12::WriteView(uint32_t texture, uint32_t mostDetailedMip)
+{
+	const StreamedTexture& streamed = m_Textures[texture];
+
+	D3D12_SHADER_RESOURCE_VIEW_DESC srvDesc = {};
+	srvDesc.Shader4ComponentMapping = D3D12_DEFAULT_SHADER_4_COMPONENT_MAPPING;
+	srvDesc.Format = streamed.Desc.Format;
+	srvDesc.ViewDimension = D3D12_SRV_DIMENSION_TEXTURE2D;
+	if (!streamed.Resource || mostDetailedMip >= streamed.Desc.MipLevels)
+	{
+		// Evicted, or nothing copied in yet: a null view reads as zero
+		srvDesc.Texture2D.MipLevels = 1;
+		m_Device->CreateShaderResourceView(nullptr, &srvDesc, streamed.Srv);
+		return;
+	}
+	srvDesc.Texture2D.MostDetailedMip = mostDetailedMip - streamed.BaseMip;
+	srvDesc.Texture2D.MipLevels = streamed.Desc.MipLevels - mostDetailedMip;
+	m_Device->CreateShaderResourceView(streamed.Resource.Get(), &srvDesc, streamed.Srv);
+}
@@ -0,0 +1,98 @@
+#pragma once
+#include <d3d12.h>
+#include <wrl.h>
+#include <deque>
+#include <vector>
+#include "MappedFile.h"
+#include "MipStreamer.h"
+#include "ResidencyPolicy.h"
+#include "TextureHeap12.h"
+#include "UploadRing12.h"
+
+// Streams DDS textures in: only the small mips are uploaded at load, the file stays
+// mapped, and finer mips are copied through the upload ring a few per frame as their
+// resolution is requested. Each texture's SRV is rewritten to start at its most
+// detailed resident mip once the copies complete. MipStreamer makes the decisions.
+// Textures are kept within a memory budget by ResidencyPolicy: one not drawn lately
+// is recreated without its finest mips, or released entirely, and grows back when it
+// is requested again.
+class TextureStreamer12
+{
+public:
+	void Create(ID3D12Device* device, UploadRing12* uploadRing, TextureHeap12* textureHeap = nullptr);
+
+	// Loads the mips no larger than residentSize and writes the texture's view to srv,
+	// which must stay valid; texture receives the streamer's index for it
+	HRESULT Load(ID3D12GraphicsCommandList* cmdList, const wchar_t* fileName, size_t residentSize,
+		D3D12_CPU_DESCRIPTOR_HANDLE srv, uint32_t& texture,
+		Microsoft::WRL::ComPtr<ID3D12Resource>& textureUploadHeap);
+
+	// Texels the texture should have across to look sharp; picks the matching mip. Call
+	// every frame the texture is drawn, as it also marks the texture as in use.
+	void RequestResolution(uint32_t texture, uint32_t width, uint32_t height);
+
+	// Memory the textures may take together; the default is unlimited
+	inline void SetMemoryBudget(uint64_t bytes) { m_Residency.SetBudget(bytes); }
+	// Textures with a higher priority keep their mips longest
+	inline void SetPriority(uint32_t texture, uint32_t priority) { m_Residency.SetPriority(texture, priority); }
+
+	// Applies the residency decisions for this frame, then records copies for up to
+	// byteBudget bytes of requested mips
+	HRESULT Update(ID3D12GraphicsCommandList* cmdList, uint64_t byteBudget);
+
+	// Call with the fence value signalled after the command list passed to Update
+	void Submit(uint64_t fenceValue);
+
+	// Moves the views of textures whose copies completed to their new mips and frees the
+	// resources replaced since. The views are rewritten in place, so no frame still using
+	// them may be in flight.
+	void Retire(ID3D12Fence* fence);
+
+	// Null while the texture is evicted; may change on every Update
+	inline ID3D12Resource* Resource(uint32_t texture) const { return m_Textures[texture].Resource.Get(); }
+	inline uint32_t BaseMip(uint32_t texture) const { return m_Textures[texture].BaseMip; }
+	inline const MipStreamer& Streamer() const { return m_Streamer; }
+	inline const ResidencyPolicy& Residency() const { return m_Residency; }
+
+private:
+	struct StreamedTexture
+	{
+		MappedFile File;
+		// Holds mips BaseMip and below, BaseMip being subresource 0
+		Microsoft::WRL::ComPtr<ID3D12Resource> Resource;
+		// The whole mip chain, as in the file
+		D3D12_RESOURCE_DESC Desc;
+		uint32_t BaseMip = 0;
+		std::vector<D3D12_SUBRESOURCE_DATA> Mips;
+		D3D12_CPU_DESCRIPTOR_HANDLE Srv;
+	};
+
+	struct Replaced
+	{
+		Microsoft::WRL::ComPtr<ID3D12Resource> Resource;
+		uint64_t FenceValue;
+	};
+
+	// Recreates the texture with baseMip as its most detailed level (none at all for the
+	// mip count), keeping the mips both resources hold
+	HRESULT SetBaseMip(ID3D12GraphicsCommandList* cmdList, uint32_t texture, uint32_t baseMip);
+	void WriteView(uint32_t texture, uint32_t mostDetailedMip);
+
+	Microsoft::WRL::ComPtr<ID3D12Device> m_Device;
+	UploadRing12* m_UploadRing = nullptr;
+	TextureHeap12* m_TextureHeap = nullptr;
+
+	MipStreamer m_Streamer;
+	ResidencyPolicy m_Residency;
+	// Frames start at 1, as textures count as last used in frame 0
+	uint64_t m_Frame = 1;
+	std::vector<StreamedTexture> m_Textures;
+	std::vector<MipUpload> m_Uploads;
+	std::vector<MipResidencyChange> m_Changes;
+	std::vector<ResidencyChange> m_BaseChanges;
+
+	// Resources replaced by SetBaseMip, freed once the GPU is done with them
+	std::deque<Replaced> m_Replaced;
+	// Entries at the back of m_Replaced not yet tagged with a fence value
+	size_t m_UnsubmittedReplaced = 0;
+};
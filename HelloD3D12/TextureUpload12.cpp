@@ -0,0 +1,167 @@
+#include "TextureUpload12.h"
+#include "SubresourceCopy.h"
+#include "TextureFootprint12.h"
+#include "d3dx12.h"
+#include <atomic>
+#include <new>
+#include <wrl.h>
+
+namespace
+{
+	std::atomic<uint64_t> s_Uploads(0);
+	std::atomic<uint64_t> s_Subresources(0);
+	std::atomic<uint64_t> s_HeapAllocations(0);
+	std::atomic<uint64_t> s_DeviceFootprints(0);
+
+	// Footprints in the layout the device reports them, for formats the calculator skips
+	uint64_t DeviceFootprints(ID3D12Resource* destination, const D3D12_RESOURCE_DESC& desc, UINT firstSubresource,
+		UINT subresourceCount, UINT64 baseOffset, SubresourceFootprint* footprints, ScratchArena& scratch)
+	{
+		s_DeviceFootprints++;
+
+		const size_t bytes = (sizeof(D3D12_PLACED_SUBRESOURCE_FOOTPRINT) + sizeof(UINT) + sizeof(UINT64)) * subresourceCount;
+		std::unique_ptr<uint8_t[]> heap;
+		uint8_t* memory = static_cast<uint8_t*>(AllocateUploadScratch(scratch, bytes, alignof(UINT64), heap));
+		if (!memory)
+		{
+			return 0;
+		}
+		auto layouts = reinterpret_cast<D3D12_PLACED_SUBRESOURCE_FOOTPRINT*>(memory);
+		auto rowSizes = reinterpret_cast<UINT64*>(layouts + subresourceCount);
+		auto numRows = reinterpret_cast<UINT*>(rowSizes + subresourceCount);
+
+		Microsoft::WRL::ComPtr<ID3D12Device> device;
+		if (FAILED(destination->GetDevice(IID_PPV_ARGS(&device))))
+		{
+			return 0;
+		}
+		UINT64 totalBytes = 0;
+		device->GetCopyableFootprints(&desc, firstSubresource, subresourceCount, baseOffset, layouts, numRows, rowSizes, &totalBytes);
+
+		for (UINT i = 0; i < subresourceCount; ++i)
+		{
+			footprints[i].Offset = layouts[i].Offset;
+			footprints[i].Width = layouts[i].Footprint.Width;
+			footprints[i].Height = layouts[i].Footprint.Height;
+			footprints[i].Depth = layouts[i].Footprint.Depth;
+			footprints[i].RowPitch = layouts[i].Footprint.RowPitch;
+			footprints[i].NumRows = numRows[i];
+			footprints[i].RowSizeInBytes = rowSizes[i];
+		}
+		return totalBytes;
+	}
+}
+
+UINT64 UpdateSubresources12(ID3D12GraphicsCommandList* cmdList, ID3D12Resource* destination,
+	ID3D12Resource* intermediate, UINT64 intermediateOffset, uint8_t* cpuAddress, UINT firstSubresource,
+	UINT subresourceCount, const D3D12_SUBRESOURCE_DATA* srcData, ScratchArena& scratch, unsigned copyThreads)
+{
+	const D3D12_RESOURCE_DESC desc = destination->GetDesc();
+	if (desc.Dimension == D3D12_RESOURCE_DIMENSION_BUFFER || subresourceCount == 0)
+	{
+		return 0;
+	}
+
+	ScratchArena::Scope scope(scratch);
+	std::unique_ptr<uint8_t[]> heapFootprints;
+	SubresourceFootprint* footprints = AllocateUploadScratch<SubresourceFootprint>(scratch, subresourceCount, heapFootprints);
+	if (!footprints)
+	{
+		return 0;
+	}
+
+	uint64_t requiredSize = (desc.Layout == D3D12_TEXTURE_LAYOUT_UNKNOWN) ? ComputeTextureFootprints(
+		MakeTextureLayoutDesc(desc), firstSubresource, subresourceCount, intermediateOffset, footprints) : 0;
+	if (requiredSize == 0)
+	{
+		requiredSize = DeviceFootprints(destination, desc, firstSubresource, subresourceCount, intermediateOffset, footprints, scratch);
+	}
+
+	const D3D12_RESOURCE_DESC intermediateDesc = intermediate->GetDesc();
+	if (requiredSize == 0 || intermediateDesc.Dimension != D3D12_RESOURCE_DIMENSION_BUFFER ||
+		intermediateDesc.Width < intermediateOffset + requiredSize)
+	{
+		return 0;
+	}
+
+	bool mapped = false;
+	if (!cpuAddress)
+	{
+		uint8_t* data;
+		if (FAILED(intermediate->Map(0, nullptr, reinterpret_cast<void**>(&data))))
+		{
+			return 0;
+		}
+		cpuAddress = data + intermediateOffset;
+		mapped = true;
+	}
+
+	for (UINT i = 0; i < subresourceCount; ++i)
+	{
+		const SubresourceFootprint& footprint = footprints[i];
+		uint8_t* dest = cpuAddress + (footprint.Offset - intermediateOffset);
+		const uint8_t* source = static_cast<const uint8_t*>(srcData[i].pData);
+		const size_t rowSize = static_cast<size_t>(footprint.RowSizeInBytes);
+		const size_t sourcePitch = static_cast<size_t>(srcData[i].RowPitch);
+
+		// Destination slices follow one another, so source slices that do too are one copy
+		if (footprint.Depth == 1 || static_cast<size_t>(srcData[i].SlicePitch) == sourcePitch * footprint.NumRows)
+		{
+			CopyRowsParallel(dest, footprint.RowPitch, source, sourcePitch, rowSize,
+				static_cast<size_t>(footprint.NumRows) * footprint.Depth, copyThreads);
+			continue;
+		}
+		for (UINT z = 0; z < footprint.Depth; ++z)
+		{
+			CopyRowsParallel(dest + static_cast<size_t>(footprint.RowPitch) * footprint.NumRows * z, footprint.RowPitch,
+				source + srcData[i].SlicePitch * static_cast<LONG_PTR>(z), sourcePitch, rowSize, footprint.NumRows, copyThreads);
+		}
+	}
+
+	if (mapped)
+	{
+		intermediate->Unmap(0, nullptr);
+	}
+
+	for (UINT i = 0; i < subresourceCount; ++i)
+	{
+		D3D12_PLACED_SUBRESOURCE_FOOTPRINT layout;
+		layout.Offset = footprints[i].Offset;
+		layout.Footprint.Format = desc.Format;
+		layout.Footprint.Width = footprints[i].Width;
+		layout.Footprint.Height = footprints[i].Height;
+		layout.Footprint.Depth = footprints[i].Depth;
+		layout.Footprint.RowPitch = footprints[i].RowPitch;
+
+		CD3DX12_TEXTURE_COPY_LOCATION dst(destination, i + firstSubresource);
+		CD3DX12_TEXTURE_COPY_LOCATION src(intermediate, layout);
+		cmdList->CopyTextureRegion(&dst, 0, 0, 0, &src, nullptr);
+	}
+
+	s_Uploads++;
+	s_Subresources += subresourceCount;
+	return requiredSize;
+}
+
+void* AllocateUploadScratch(ScratchArena& scratch, size_t size, size_t alignment, std::unique_ptr<uint8_t[]>& heap)
+{
+	void* memory = scratch.Allocate(size, alignment);
+	if (memory)
+	{
+		return memory;
+	}
+	// new[] aligns for any fundamental type, which covers every table an upload builds
+	s_HeapAllocations++;
+	heap.reset(new (std::nothrow) uint8_t[size]);
+	return heap.get();
+}
+
+TextureUploadStatistics GetTextureUploadStatistics()
+{
+	TextureUploadStatistics statistics;
+	statistics.Uploads = s_Uploads;
+	statistics.Subresources = s_Subresources;
+	statistics.HeapAllocations = s_HeapAllocations;
+	statistics.DeviceFootprints = s_DeviceFootprints;
+	return statistics;
+}
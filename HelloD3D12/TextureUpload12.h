@@ -0,0 +1,37 @@
+#pragma once
+#include <d3d12.h>
+#include "ScratchArena.h"
+
+struct TextureUploadStatistics
+{
+	uint64_t Uploads;
+	uint64_t Subresources;
+	// Tables too large for the scratch arena, which came from the heap instead: footprints
+	// here, and the subresource data of DDS loads through AllocateUploadScratch
+	uint64_t HeapAllocations;
+	// Uploads in formats TextureFootprint cannot lay out, which asked the device
+	uint64_t DeviceFootprints;
+};
+
+// UpdateSubresources for textures that neither allocates from the heap nor calls the
+// device: footprints are computed into scratch, which is left as it was found. cpuAddress
+// is where intermediateOffset is mapped, as UploadRing12 allocations carry it; with null
+// the intermediate buffer is mapped here. Subresources of ParallelCopyMinBytes or more are
+// copied on up to copyThreads threads, started for the call; loader threads and per-frame
+// callers should leave it at 1. Returns the bytes used, or 0 on failure.
+UINT64 UpdateSubresources12(ID3D12GraphicsCommandList* cmdList, ID3D12Resource* destination,
+	ID3D12Resource* intermediate, UINT64 intermediateOffset, uint8_t* cpuAddress, UINT firstSubresource,
+	UINT subresourceCount, const D3D12_SUBRESOURCE_DATA* srcData, ScratchArena& scratch, unsigned copyThreads = 1);
+
+// Counts over every UpdateSubresources12 call so far, from any thread
+TextureUploadStatistics GetTextureUploadStatistics();
+
+// Scratch memory for an upload, from the heap when scratch is full: heap then owns it and
+// the fallback counts in TextureUploadStatistics::HeapAllocations. Null when both fail.
+void* AllocateUploadScratch(ScratchArena& scratch, size_t size, size_t alignment, std::unique_ptr<uint8_t[]>& heap);
+
+template <typename T>
+inline T* AllocateUploadScratch(ScratchArena& scratch, size_t count, std::unique_ptr<uint8_t[]>& heap)
+{
+	return (count <= SIZE_MAX / sizeof(T)) ? static_cast<T*>(AllocateUploadScratch(scratch, count * sizeof(T), alignof(T), heap)) : nullptr;
+}
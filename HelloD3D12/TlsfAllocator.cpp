@@ -0,0 +1,313 @@
+#include "TlsfAllocator.h"
+#include <algorithm>
+
+#ifdef _MSC_VER
+#include <intrin.h>
+#endif
+
+namespace
+{
+	inline uint32_t HighestBit(uint64_t value)
+	{
+#ifdef _MSC_VER
+		unsigned long index;
+		_BitScanReverse64(&index, value);
+		return index;
+#else
+		return 63 - __builtin_clzll(value);
+#endif
+	}
+
+	inline uint32_t LowestBit(uint64_t value)
+	{
+#ifdef _MSC_VER
+		unsigned long index;
+		_BitScanForward64(&index, value);
+		return index;
+#else
+		return __builtin_ctzll(value);
+#endif
+	}
+}
+
+TlsfAllocator::TlsfAllocator(uint64_t capacity, uint64_t granularity)
+{
+	Reset(capacity, granularity);
+}
+
+void TlsfAllocator::Reset(uint64_t capacity, uint64_t granularity)
+{
+	m_Granularity = (granularity == 0) ? 1 : granularity;
+	m_GranularityLog2 = HighestBit(m_Granularity);
+	m_Capacity = (capacity >> m_GranularityLog2) << m_GranularityLog2;
+	m_FreeUnits = 0;
+	m_AllocationCount = 0;
+	m_FreeBlockCount = 0;
+
+	m_FirstLevelBitmap = 0;
+	std::fill(std::begin(m_SecondLevelBitmaps), std::end(m_SecondLevelBitmaps), 0u);
+	for (auto& lists : m_FreeLists)
+	{
+		std::fill(std::begin(lists), std::end(lists), NoBlock);
+	}
+	m_Blocks.clear();
+	m_UnusedBlocks.clear();
+
+	const uint64_t units = m_Capacity >> m_GranularityLog2;
+	if (units == 0)
+	{
+		return;
+	}
+	const uint32_t block = NewBlock();
+	m_Blocks[block] = { 0, units, NoBlock, NoBlock, NoBlock, NoBlock, false };
+	m_FreeUnits = units;
+	InsertFree(block);
+}
+
+void TlsfAllocator::Mapping(uint64_t units, uint32_t& fl, uint32_t& sl)
+{
+	if (units < SecondLevelCount)
+	{
+		// Small sizes get one exact class each
+		fl = 0;
+		sl = static_cast<uint32_t>(units);
+		return;
+	}
+	const uint32_t bit = HighestBit(units);
+	fl = bit - SecondLevelLog2 + 1;
+	sl = static_cast<uint32_t>(units >> (bit - SecondLevelLog2)) - SecondLevelCount;
+}
+
+uint32_t TlsfAllocator::NewBlock()
+{
+	if (!m_UnusedBlocks.empty())
+	{
+		const uint32_t block = m_UnusedBlocks.back();
+		m_UnusedBlocks.pop_back();
+		return block;
+	}
+	m_Blocks.push_back({});
+	return static_cast<uint32_t>(m_Blocks.size() - 1);
+}
+
+void TlsfAllocator::InsertFree(uint32_t block)
+{
+	Block& b = m_Blocks[block];
+	uint32_t fl, sl;
+	Mapping(b.Size, fl, sl);
+
+	b.Free = true;
+	b.PrevFree = NoBlock;
+	b.NextFree = m_FreeLists[fl][sl];
+	if (b.NextFree != NoBlock)
+	{
+		m_Blocks[b.NextFree].PrevFree = block;
+	}
+	m_FreeLists[fl][sl] = block;
+	m_FirstLevelBitmap |= 1ull << fl;
+	m_SecondLevelBitmaps[fl] |= 1u << sl;
+	m_FreeBlockCount++;
+}
+
+void TlsfAllocator::RemoveFree(uint32_t block)
+{
+	Block& b = m_Blocks[block];
+	uint32_t fl, sl;
+	Mapping(b.Size, fl, sl);
+
+	if (b.PrevFree != NoBlock)
+	{
+		m_Blocks[b.PrevFree].NextFree = b.NextFree;
+	}
+	else
+	{
+		m_FreeLists[fl][sl] = b.NextFree;
+		if (b.NextFree == NoBlock)
+		{
+			m_SecondLevelBitmaps[fl] &= ~(1u << sl);
+			if (m_SecondLevelBitmaps[fl] == 0)
+			{
+				m_FirstLevelBitmap &= ~(1ull << fl);
+			}
+		}
+	}
+	if (b.NextFree != NoBlock)
+	{
+		m_Blocks[b.NextFree].PrevFree = b.PrevFree;
+	}
+	b.Free = false;
+	m_FreeBlockCount--;
+}
+
+uint32_t TlsfAllocator::FindFree(uint64_t units) const
+{
+	// Round up to the next class so any block found is large enough
+	if (units >= SecondLevelCount)
+	{
+		units += (1ull << (HighestBit(units) - SecondLevelLog2)) - 1;
+	}
+	uint32_t fl, sl;
+	Mapping(units, fl, sl);
+	if (fl >= FirstLevelCount)
+	{
+		return NoBlock;
+	}
+
+	uint32_t slMap = m_SecondLevelBitmaps[fl] & (~0u << sl);
+	if (slMap == 0)
+	{
+		const uint64_t flMap = (fl + 1 < 64) ? m_FirstLevelBitmap & (~0ull << (fl + 1)) : 0;
+		if (flMap == 0)
+		{
+			return NoBlock;
+		}
+		fl = LowestBit(flMap);
+		slMap = m_SecondLevelBitmaps[fl];
+	}
+	return m_FreeLists[fl][LowestBit(slMap)];
+}
+
+uint32_t TlsfAllocator::Split(uint32_t block, uint64_t units)
+{
+	const uint32_t rest = NewBlock();
+	Block& b = m_Blocks[block];
+	Block& r = m_Blocks[rest];
+	r.Offset = b.Offset + units;
+	r.Size = b.Size - units;
+	r.PrevPhysical = block;
+	r.NextPhysical = b.NextPhysical;
+	r.PrevFree = NoBlock;
+	r.NextFree = NoBlock;
+	r.Free = false;
+	if (r.NextPhysical != NoBlock)
+	{
+		m_Blocks[r.NextPhysical].PrevPhysical = rest;
+	}
+	b.Size = units;
+	b.NextPhysical = rest;
+	return rest;
+}
+
+bool TlsfAllocator::Allocate(uint64_t size, uint64_t alignment, Allocation& allocation)
+{
+	if (alignment == 0 || (alignment & (alignment - 1)) != 0)
+	{
+		return false;
+	}
+	const uint64_t units = std::max<uint64_t>((size + m_Granularity - 1) >> m_GranularityLog2, 1);
+	const uint64_t alignUnits = std::max<uint64_t>(alignment >> m_GranularityLog2, 1);
+	if (units > m_FreeUnits)
+	{
+		return false;
+	}
+
+	auto fits = [&](uint32_t block)
+	{
+		const Block& b = m_Blocks[block];
+		const uint64_t aligned = (b.Offset + alignUnits - 1) & ~(alignUnits - 1);
+		return aligned + units <= b.Offset + b.Size;
+	};
+
+	// Any block of units + alignUnits - 1 fits wherever it starts
+	uint32_t block = FindFree(units + alignUnits - 1);
+	if (block == NoBlock)
+	{
+		// The rounded search skips the class the request falls in; those blocks may still fit
+		uint32_t fl, sl;
+		Mapping(units, fl, sl);
+		for (uint32_t b = m_FreeLists[fl][sl]; b != NoBlock; b = m_Blocks[b].NextFree)
+		{
+			if (fits(b))
+			{
+				block = b;
+				break;
+			}
+		}
+		if (block == NoBlock)
+		{
+			return false;
+		}
+	}
+	RemoveFree(block);
+
+	const uint64_t offset = m_Blocks[block].Offset;
+	const uint64_t padding = ((offset + alignUnits - 1) & ~(alignUnits - 1)) - offset;
+	if (padding)
+	{
+		// Neighbours of a free block are never free, so the pieces need no merging
+		const uint32_t front = block;
+		block = Split(front, padding);
+		InsertFree(front);
+	}
+	if (m_Blocks[block].Size > units)
+	{
+		InsertFree(Split(block, units));
+	}
+
+	m_FreeUnits -= units;
+	m_AllocationCount++;
+	allocation.Offset = m_Blocks[block].Offset << m_GranularityLog2;
+	allocation.Handle = block;
+	return true;
+}
+
+void TlsfAllocator::Free(uint32_t handle)
+{
+	if (handle >= m_Blocks.size() || m_Blocks[handle].Free)
+	{
+		return;
+	}
+	m_FreeUnits += m_Blocks[handle].Size;
+	m_AllocationCount--;
+
+	uint32_t block = handle;
+	const uint32_t prev = m_Blocks[block].PrevPhysical;
+	if (prev != NoBlock && m_Blocks[prev].Free)
+	{
+		RemoveFree(prev);
+		m_Blocks[prev].Size += m_Blocks[block].Size;
+		m_Blocks[prev].NextPhysical = m_Blocks[block].NextPhysical;
+		if (m_Blocks[block].NextPhysical != NoBlock)
+		{
+			m_Blocks[m_Blocks[block].NextPhysical].PrevPhysical = prev;
+		}
+		m_UnusedBlocks.push_back(block);
+		block = prev;
+	}
+
+	const uint32_t next = m_Blocks[block].NextPhysical;
+	if (next != NoBlock && m_Blocks[next].Free)
+	{
+		RemoveFree(next);
+		m_Blocks[block].Size += m_Blocks[next].Size;
+		m_Blocks[block].NextPhysical = m_Blocks[next].NextPhysical;
+		if (m_Blocks[next].NextPhysical != NoBlock)
+		{
+			m_Blocks[m_Blocks[next].NextPhysical].PrevPhysical = block;
+		}
+		m_UnusedBlocks.push_back(next);
+	}
+
+	InsertFree(block);
+}
+
+TlsfAllocator::Statistics TlsfAllocator::GetStatistics() const
+{
+	Statistics stats = {};
+	stats.Capacity = m_Capacity;
+	stats.FreeSize = m_FreeUnits << m_GranularityLog2;
+	stats.AllocationCount = m_AllocationCount;
+	stats.FreeBlockCount = m_FreeBlockCount;
+
+	// The largest free block sits in the highest non-empty class
+	if (m_FirstLevelBitmap != 0)
+	{
+		const uint32_t fl = HighestBit(m_FirstLevelBitmap);
+		const uint32_t sl = HighestBit(m_SecondLevelBitmaps[fl]);
+		for (uint32_t b = m_FreeLists[fl][sl]; b != NoBlock; b = m_Blocks[b].NextFree)
+		{
+			stats.LargestFreeBlock = std::max(stats.LargestFreeBlock, m_Blocks[b].Size << m_GranularityLog2);
+		}
+	}
+	return stats;
+}
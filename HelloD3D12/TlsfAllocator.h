@@ -0,0 +1,81 @@
+#pragma once
+#include <cstdint>
+#include <vector>
+
+// Two-level segregated fit allocator over an address range it never touches (such as
+// a GPU heap). Free blocks are binned by size class, a power of two split into
+// SecondLevelCount linear steps, and found with two bitmap scans, so allocation and
+// freeing take constant time. Neighbouring free blocks are merged on free.
+class TlsfAllocator
+{
+public:
+	static constexpr uint32_t InvalidHandle = ~0u;
+
+	struct Allocation
+	{
+		uint64_t Offset;
+		uint32_t Handle;
+	};
+
+	struct Statistics
+	{
+		uint64_t Capacity;
+		uint64_t FreeSize;
+		uint64_t LargestFreeBlock;
+		uint32_t AllocationCount;
+		uint32_t FreeBlockCount;
+	};
+
+	TlsfAllocator() = default;
+	// granularity (a power of two) is the smallest unit handed out; sizes round up to it
+	TlsfAllocator(uint64_t capacity, uint64_t granularity);
+
+	void Reset(uint64_t capacity, uint64_t granularity);
+
+	// alignment must be a power of two. Returns false when no free block fits.
+	bool Allocate(uint64_t size, uint64_t alignment, Allocation& allocation);
+	void Free(uint32_t handle);
+
+	Statistics GetStatistics() const;
+
+private:
+	static constexpr uint32_t SecondLevelLog2 = 4;
+	static constexpr uint32_t SecondLevelCount = 1 << SecondLevelLog2;
+	static constexpr uint32_t FirstLevelCount = 64 - SecondLevelLog2 + 1;
+	static constexpr uint32_t NoBlock = ~0u;
+
+	struct Block
+	{
+		// In granularity units
+		uint64_t Offset;
+		uint64_t Size;
+		uint32_t PrevPhysical;
+		uint32_t NextPhysical;
+		uint32_t PrevFree;
+		uint32_t NextFree;
+		bool Free;
+	};
+
+	static void Mapping(uint64_t units, uint32_t& fl, uint32_t& sl);
+
+	uint32_t NewBlock();
+	void InsertFree(uint32_t block);
+	void RemoveFree(uint32_t block);
+	uint32_t FindFree(uint64_t units) const;
+	// Cuts the first units of block off into a new block that follows it; returns the new one
+	uint32_t Split(uint32_t block, uint64_t units);
+
+	uint64_t m_Capacity = 0;
+	uint64_t m_Granularity = 1;
+	uint32_t m_GranularityLog2 = 0;
+	uint64_t m_FreeUnits = 0;
+	uint32_t m_AllocationCount = 0;
+	uint32_t m_FreeBlockCount = 0;
+
+	uint64_t m_FirstLevelBitmap = 0;
+	uint32_t m_SecondLevelBitmaps[FirstLevelCount] = {};
+	uint32_t m_FreeLists[FirstLevelCount][SecondLevelCount];
+
+	std::vector<Block> m_Blocks;
+	std::vector<uint32_t> m_UnusedBlocks;
+};
@@ -0,0 +1,75 @@
+#include "UploadRing.h"
+#include <cassert>
+
+UploadRing::UploadRing(uint64_t capacity)
+{
+	Reset(capacity);
+}
+
+void UploadRing::Reset(uint64_t capacity)
+{
+	m_Capacity = capacity;
+	m_Head = 0;
+	m_Used = 0;
+	m_OpenSize = 0;
+	m_Batches.clear();
+}
+
+uint64_t UploadRing::Allocate(uint64_t size, uint64_t alignment)
+{
+	if (alignment == 0 || (alignment & (alignment - 1)) != 0 || size > m_Capacity)
+	{
+		return InvalidOffset;
+	}
+
+	// An empty ring starts over at the beginning, where the largest block is free
+	if (m_Used == 0)
+	{
+		m_Head = 0;
+	}
+
+	uint64_t offset = (m_Head + alignment - 1) & ~(alignment - 1);
+	if (offset + size > m_Capacity)
+	{
+		// Skip the tail end; offset 0 suits any alignment
+		offset = 0;
+	}
+
+	// The padding up to offset is consumed along with the allocation, and the free space
+	// starts at the head, so counting bytes is enough to know the block is free
+	const uint64_t padding = (offset >= m_Head) ? offset - m_Head : m_Capacity - m_Head;
+	if (m_Used + padding + size > m_Capacity)
+	{
+		return InvalidOffset;
+	}
+
+	m_Used += padding + size;
+	m_OpenSize += padding + size;
+	m_Head = offset + size;
+	if (m_Head == m_Capacity)
+	{
+		m_Head = 0;
+	}
+	return offset;
+}
+
+void UploadRing::Submit(uint64_t fenceValue)
+{
+	if (m_OpenSize == 0)
+	{
+		return;
+	}
+	m_Batches.push_back({ fenceValue, m_Head, m_OpenSize });
+	m_OpenSize = 0;
+}
+
+void UploadRing::Retire(uint64_t completedFenceValue)
+{
+	while (!m_Batches.empty() && m_Batches.front().FenceValue <= completedFenceValue)
+	{
+		m_Used -= m_Batches.front().Size;
+		// What is still in use runs from the end of the retired batch to the head
+		assert((m_Head + m_Capacity - m_Batches.front().End) % m_Capacity == m_Used % m_Capacity);
+		m_Batches.pop_front();
+	}
+}
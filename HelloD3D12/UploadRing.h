@@ -0,0 +1,49 @@
+#pragma once
+#include <cstdint>
+#include <deque>
+
+// Suballocates a fixed size staging buffer as a ring. Allocations made between two
+// Submit calls form a batch tagged with the fence value that signals the end of the
+// GPU work reading them; Retire frees every batch whose fence has completed. Only
+// offsets are handed out, so the same logic serves any kind of backing buffer.
+class UploadRing
+{
+public:
+	static const uint64_t InvalidOffset = ~0ull;
+
+	UploadRing() = default;
+	explicit UploadRing(uint64_t capacity);
+
+	// Drops every allocation, submitted or not
+	void Reset(uint64_t capacity);
+
+	// Offset of size bytes aligned to alignment (a power of two), or InvalidOffset when the
+	// free part of the ring is too small. An allocation never wraps around the end.
+	uint64_t Allocate(uint64_t size, uint64_t alignment);
+
+	// Closes the current batch; fenceValue must not decrease between calls
+	void Submit(uint64_t fenceValue);
+
+	// Frees the batches whose fence value is at most completedFenceValue
+	void Retire(uint64_t completedFenceValue);
+
+	inline uint64_t Capacity() const { return m_Capacity; }
+	// Bytes allocated or lost to alignment and wrapping, not yet retired
+	inline uint64_t Used() const { return m_Used; }
+	inline bool HasPendingBatches() const { return !m_Batches.empty(); }
+
+private:
+	struct Batch
+	{
+		uint64_t FenceValue;
+		// Ring position after the batch's last allocation, and its bytes including padding
+		uint64_t End;
+		uint64_t Size;
+	};
+
+	uint64_t m_Capacity = 0;
+	uint64_t m_Head = 0;
+	uint64_t m_Used = 0;
+	uint64_t m_OpenSize = 0;
+	std::deque<Batch> m_Batches;
+};
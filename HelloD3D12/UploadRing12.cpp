@@ -0,0 +1,60 @@
+#include "UploadRing12.h"
+#include "d3dx12.h"
+
+HRESULT UploadRing12::Create(ID3D12Device* device, uint64_t capacity)
+{
+	m_Buffer = nullptr;
+	m_Mapped = nullptr;
+	m_Ring.Reset(0);
+
+	HRESULT hr = device->CreateCommittedResource(
+		&CD3DX12_HEAP_PROPERTIES(D3D12_HEAP_TYPE_UPLOAD),
+		D3D12_HEAP_FLAG_NONE,
+		&CD3DX12_RESOURCE_DESC::Buffer(capacity),
+		D3D12_RESOURCE_STATE_GENERIC_READ,
+		nullptr,
+		IID_PPV_ARGS(&m_Buffer));
+	if (FAILED(hr))
+	{
+		return hr;
+	}
+
+	// Upload heaps may stay mapped for their whole life
+	CD3DX12_RANGE readRange(0, 0);
+	hr = m_Buffer->Map(0, &readRange, reinterpret_cast<void**>(&m_Mapped));
+	if (FAILED(hr))
+	{
+		m_Buffer = nullptr;
+		return hr;
+	}
+
+	m_Ring.Reset(capacity);
+	return S_OK;
+}
+
+bool UploadRing12::Allocate(uint64_t size, uint64_t alignment, Allocation& allocation)
+{
+	std::lock_guard<std::mutex> lock(m_Mutex);
+	const uint64_t offset = m_Ring.Allocate(size, alignment);
+	if (offset == UploadRing::InvalidOffset)
+	{
+		return false;
+	}
+	allocation.Resource = m_Buffer.Get();
+	allocation.Offset = offset;
+	allocation.CpuAddress = m_Mapped + offset;
+	return true;
+}
+
+void UploadRing12::Submit(uint64_t fenceValue)
+{
+	std::lock_guard<std::mutex> lock(m_Mutex);
+	m_Ring.Submit(fenceValue);
+}
+
+void UploadRing12::Retire(ID3D12Fence* fence)
+{
+	const uint64_t completed = fence->GetCompletedValue();
+	std::lock_guard<std::mutex> lock(m_Mutex);
+	m_Ring.Retire(completed);
+}
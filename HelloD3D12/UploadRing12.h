@@ -0,0 +1,39 @@
+#pragma once
+#include <d3d12.h>
+#include <wrl.h>
+#include <mutex>
+#include "UploadRing.h"
+
+// UploadRing over one persistently mapped upload heap buffer, shared by every texture
+// upload instead of a committed upload heap per texture. Safe to use from several
+// threads recording their own command lists.
+class UploadRing12
+{
+public:
+	struct Allocation
+	{
+		ID3D12Resource* Resource;
+		uint64_t Offset;
+		uint8_t* CpuAddress;
+	};
+
+	HRESULT Create(ID3D12Device* device, uint64_t capacity);
+
+	// false when the ring has no room; the caller can retire and retry or fall back to
+	// its own upload heap
+	bool Allocate(uint64_t size, uint64_t alignment, Allocation& allocation);
+
+	// Call after the command list using the current allocations is submitted, with the
+	// value the queue signals once it has executed
+	void Submit(uint64_t fenceValue);
+	void Retire(ID3D12Fence* fence);
+
+	inline ID3D12Resource* Buffer() const { return m_Buffer.Get(); }
+	inline const UploadRing& Ring() const { return m_Ring; }
+
+private:
+	Microsoft::WRL::ComPtr<ID3D12Resource> m_Buffer;
+	uint8_t* m_Mapped = nullptr;
+	UploadRing m_Ring;
+	std::mutex m_Mutex;
+};
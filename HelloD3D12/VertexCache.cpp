@@ -0,0 +1,248 @@
+#include "VertexCache.h"
+#include <algorithm>
+#include <cmath>
+#include <vector>
+
+namespace
+{
+	// Size of the LRU cache modelled while scoring vertices
+	const uint32_t ScoringCacheSize = 32;
+	const uint32_t MaxValence = 32;
+
+	const float CacheDecayPower = 1.5f;
+	const float LastTriangleScore = 0.75f;
+	const float ValenceBoostScale = 2.0f;
+	const float ValenceBoostPower = 0.5f;
+
+	struct ScoreTables
+	{
+		float Cache[ScoringCacheSize];
+		float Valence[MaxValence + 1];
+
+		ScoreTables()
+		{
+			for (uint32_t i = 0; i < ScoringCacheSize; i++)
+			{
+				if (i < 3)
+				{
+					// The three vertices of the last triangle are scored equally so the
+					// winding of the next triangle does not matter
+					Cache[i] = LastTriangleScore;
+				}
+				else
+				{
+					const float scaler = 1.0f / (ScoringCacheSize - 3);
+					Cache[i] = powf(1.0f - (i - 3) * scaler, CacheDecayPower);
+				}
+			}
+
+			Valence[0] = 0.0f;
+			for (uint32_t i = 1; i <= MaxValence; i++)
+			{
+				// Boost vertices with few triangles left so they get finished off
+				Valence[i] = ValenceBoostScale * powf(static_cast<float>(i), -ValenceBoostPower);
+			}
+		}
+	};
+
+	const ScoreTables& GetScoreTables()
+	{
+		static const ScoreTables tables;
+		return tables;
+	}
+
+	inline float VertexScore(const ScoreTables& tables, int cachePosition, uint32_t liveTriangles)
+	{
+		if (liveTriangles == 0)
+		{
+			return 0.0f;
+		}
+		float score = (cachePosition < 0) ? 0.0f : tables.Cache[cachePosition];
+		return score + tables.Valence[std::min(liveTriangles, MaxValence)];
+	}
+}
+
+VertexCacheStatistics AnalyzeVertexCache(const uint32_t* indices, size_t indexCount, size_t vertexCount, uint32_t cacheSize)
+{
+	VertexCacheStatistics stats;
+	if (indexCount < 3 || vertexCount == 0)
+	{
+		return stats;
+	}
+
+	// A vertex is still cached if fewer than cacheSize misses happened since it was loaded
+	std::vector<uint32_t> timestamps(vertexCount, 0);
+	std::vector<char> referenced(vertexCount, 0);
+	uint32_t time = cacheSize + 1;
+	uint32_t uniqueVertices = 0;
+
+	for (size_t i = 0; i < indexCount; i++)
+	{
+		const uint32_t v = indices[i];
+		if (time - timestamps[v] > cacheSize)
+		{
+			timestamps[v] = time++;
+			stats.VerticesTransformed++;
+		}
+		if (!referenced[v])
+		{
+			referenced[v] = 1;
+			uniqueVertices++;
+		}
+	}
+
+	stats.ACMR = static_cast<float>(stats.VerticesTransformed) / static_cast<float>(indexCount / 3);
+	stats.ATVR = static_cast<float>(stats.VerticesTransformed) / static_cast<float>(uniqueVertices);
+	return stats;
+}
+
+void OptimizeVertexCache(uint32_t* destination, const uint32_t* indices, size_t indexCount, size_t vertexCount)
+{
+	const size_t triangleCount = indexCount / 3;
+	if (triangleCount == 0)
+	{
+		return;
+	}
+
+	std::vector<uint32_t> sourceCopy;
+	if (destination == indices)
+	{
+		sourceCopy.assign(indices, indices + indexCount);
+		indices = sourceCopy.data();
+	}
+
+	const ScoreTables& tables = GetScoreTables();
+
+	// Vertex -> triangle adjacency; the live prefix of each list shrinks as triangles are emitted
+	std::vector<uint32_t> liveTriangles(vertexCount, 0);
+	for (size_t i = 0; i < triangleCount * 3; i++)
+	{
+		liveTriangles[indices[i]]++;
+	}
+
+	std::vector<uint32_t> adjacencyOffsets(vertexCount + 1, 0);
+	for (size_t v = 0; v < vertexCount; v++)
+	{
+		adjacencyOffsets[v + 1] = adjacencyOffsets[v] + liveTriangles[v];
+	}
+
+	std::vector<uint32_t> adjacency(triangleCount * 3);
+	{
+		std::vector<uint32_t> cursor(adjacencyOffsets.begin(), adjacencyOffsets.end() - 1);
+		for (size_t i = 0; i < triangleCount * 3; i++)
+		{
+			adjacency[cursor[indices[i]]++] = static_cast<uint32_t>(i / 3);
+		}
+	}
+
+	std::vector<int> cachePositions(vertexCount, -1);
+	std::vector<float> vertexScores(vertexCount);
+	for (size_t v = 0; v < vertexCount; v++)
+	{
+		vertexScores[v] = VertexScore(tables, -1, liveTriangles[v]);
+	}
+
+	std::vector<char> emitted(triangleCount, 0);
+	size_t bestTriangle = 0;
+	float bestInitialScore = -1.0f;
+	for (size_t t = 0; t < triangleCount; t++)
+	{
+		const uint32_t* tri = &indices[t * 3];
+		const float score = vertexScores[tri[0]] + vertexScores[tri[1]] + vertexScores[tri[2]];
+		if (score > bestInitialScore)
+		{
+			bestInitialScore = score;
+			bestTriangle = t;
+		}
+	}
+
+	uint32_t cache[ScoringCacheSize + 3];
+	uint32_t cacheCount = 0;
+	size_t inputCursor = 0;
+	const size_t NoTriangle = ~size_t(0);
+
+	for (size_t out = 0; out < triangleCount; out++)
+	{
+		if (bestTriangle == NoTriangle)
+		{
+			// Nothing adjacent to the cache is left; restart from the next unemitted triangle
+			while (emitted[inputCursor])
+			{
+				inputCursor++;
+			}
+			bestTriangle = inputCursor;
+		}
+
+		const uint32_t tri[3] = { indices[bestTriangle * 3 + 0], indices[bestTriangle * 3 + 1], indices[bestTriangle * 3 + 2] };
+		destination[out * 3 + 0] = tri[0];
+		destination[out * 3 + 1] = tri[1];
+		destination[out * 3 + 2] = tri[2];
+		emitted[bestTriangle] = 1;
+
+		// Remove the triangle from the live adjacency of its vertices
+		for (uint32_t k = 0; k < 3; k++)
+		{
+			const uint32_t v = tri[k];
+			uint32_t* list = &adjacency[adjacencyOffsets[v]];
+			const uint32_t live = liveTriangles[v];
+			for (uint32_t j = 0; j < live; j++)
+			{
+				if (list[j] == bestTriangle)
+				{
+					std::swap(list[j], list[live - 1]);
+					liveTriangles[v]--;
+					break;
+				}
+			}
+		}
+
+		// Move the triangle's vertices to the front of the LRU cache
+		uint32_t newCache[ScoringCacheSize + 3];
+		uint32_t newCount = 0;
+		for (uint32_t k = 0; k < 3; k++)
+		{
+			if (std::find(newCache, newCache + newCount, tri[k]) == newCache + newCount)
+			{
+				newCache[newCount++] = tri[k];
+			}
+		}
+		for (uint32_t i = 0; i < cacheCount; i++)
+		{
+			const uint32_t v = cache[i];
+			if (v != tri[0] && v != tri[1] && v != tri[2])
+			{
+				newCache[newCount++] = v;
+			}
+		}
+
+		for (uint32_t i = 0; i < newCount; i++)
+		{
+			const uint32_t v = newCache[i];
+			cachePositions[v] = (i < ScoringCacheSize) ? static_cast<int>(i) : -1;
+			vertexScores[v] = VertexScore(tables, cachePositions[v], liveTriangles[v]);
+		}
+
+		// Only triangles touching the cache changed score; pick the best of them next
+		bestTriangle = NoTriangle;
+		float bestScore = -1.0f;
+		for (uint32_t i = 0; i < newCount; i++)
+		{
+			const uint32_t v = newCache[i];
+			const uint32_t* list = &adjacency[adjacencyOffsets[v]];
+			for (uint32_t j = 0; j < liveTriangles[v]; j++)
+			{
+				const uint32_t t = list[j];
+				const uint32_t* other = &indices[t * 3];
+				const float score = vertexScores[other[0]] + vertexScores[other[1]] + vertexScores[other[2]];
+				if (score > bestScore)
+				{
+					bestScore = score;
+					bestTriangle = t;
+				}
+			}
+		}
+
+		cacheCount = std::min(newCount, ScoringCacheSize);
+		std::copy(newCache, newCache + cacheCount, cache);
+	}
+}
@@ -0,0 +1,23 @@
+#pragma once
+#include <cstddef>
+#include <cstdint>
+
+// Post-transform vertex cache size the GPU is assumed to have when simulating
+const uint32_t DefaultVertexCacheSize = 16;
+
+struct VertexCacheStatistics
+{
+	uint32_t VerticesTransformed = 0;
+	// Average cache miss ratio: transformed vertices per triangle (0.5 is ideal)
+	float ACMR = 0.0f;
+	// Average transformed vertex ratio: transformed vertices per referenced vertex (1.0 is ideal)
+	float ATVR = 0.0f;
+};
+
+// Simulates a FIFO post-transform cache over a triangle list
+VertexCacheStatistics AnalyzeVertexCache(const uint32_t* indices, size_t indexCount, size_t vertexCount,
+	uint32_t cacheSize = DefaultVertexCacheSize);
+
+// Reorders the triangles of an indexed triangle list for post-transform cache locality
+// using Forsyth's linear-speed vertex cache optimisation. destination may alias indices.
+void OptimizeVertexCache(uint32_t* destination, const uint32_t* indices, size_t indexCount, size_t vertexCount);
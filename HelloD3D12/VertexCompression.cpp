@@ -0,0 +1,249 @@
+#include "VertexCompression.h"
+#include <algorithm>
+#include <cmath>
+#include <cstring>
+#include <limits>
+
+namespace
+{
+	const float UNorm16Max = 65535.0f;
+	const float SNorm16Max = 32767.0f;
+
+	inline float SignNotZero(float value)
+	{
+		return (value >= 0.0f) ? 1.0f : -1.0f;
+	}
+
+	inline uint16_t QuantizeUNorm16(float value)
+	{
+		return static_cast<uint16_t>(std::min(std::max(value, 0.0f), 1.0f) * UNorm16Max + 0.5f);
+	}
+
+	inline int16_t ClampSNorm16(float value)
+	{
+		return static_cast<int16_t>(std::min(std::max(value, -SNorm16Max), SNorm16Max));
+	}
+
+	inline float Dot(const MeshFloat3& a, const MeshFloat3& b)
+	{
+		return a.x * b.x + a.y * b.y + a.z * b.z;
+	}
+}
+
+uint16_t FloatToHalf(float value)
+{
+	uint32_t bits;
+	memcpy(&bits, &value, sizeof(bits));
+
+	const uint16_t sign = static_cast<uint16_t>((bits >> 16) & 0x8000);
+	const uint32_t magnitude = bits & 0x7FFFFFFF;
+
+	if (magnitude >= 0x7F800000)
+	{
+		// Infinity stays infinity, NaN stays a (quiet) NaN
+		return sign | ((magnitude > 0x7F800000) ? 0x7E00 : 0x7C00);
+	}
+	if (magnitude >= 0x477FF000)
+	{
+		// 65520 and above round to infinity
+		return sign | 0x7C00;
+	}
+	if (magnitude < 0x38800000)
+	{
+		// Below the smallest normal half: round to a multiple of 2^-24
+		float absolute;
+		memcpy(&absolute, &magnitude, sizeof(absolute));
+		return sign | static_cast<uint16_t>(std::nearbyint(absolute * 16777216.0f));
+	}
+
+	// Rebias the exponent and round the mantissa to nearest even; a carry correctly
+	// moves into the exponent
+	uint32_t half = (magnitude - 0x38000000) >> 13;
+	const uint32_t remainder = magnitude & 0x1FFF;
+	if (remainder > 0x1000 || (remainder == 0x1000 && (half & 1)))
+	{
+		half++;
+	}
+	return sign | static_cast<uint16_t>(half);
+}
+
+float HalfToFloat(uint16_t value)
+{
+	const uint32_t sign = static_cast<uint32_t>(value & 0x8000) << 16;
+	const uint32_t exponent = (value >> 10) & 0x1F;
+	const uint32_t mantissa = value & 0x3FF;
+
+	if (exponent == 0)
+	{
+		const float magnitude = std::ldexp(static_cast<float>(mantissa), -24);
+		return sign ? -magnitude : magnitude;
+	}
+
+	uint32_t bits;
+	if (exponent == 31)
+	{
+		bits = sign | 0x7F800000 | (mantissa << 13);
+	}
+	else
+	{
+		bits = sign | ((exponent + 112) << 23) | (mantissa << 13);
+	}
+
+	float result;
+	memcpy(&result, &bits, sizeof(result));
+	return result;
+}
+
+void EncodeOctahedral(const MeshFloat3& normal, int16_t encoded[2])
+{
+	const float length = fabsf(normal.x) + fabsf(normal.y) + fabsf(normal.z);
+	if (length == 0.0f)
+	{
+		encoded[0] = 0;
+		encoded[1] = 0;
+		return;
+	}
+
+	// Project onto the octahedron and fold the lower hemisphere over the diagonals
+	float u = normal.x / length;
+	float v = normal.y / length;
+	if (normal.z < 0.0f)
+	{
+		const float foldedU = (1.0f - fabsf(v)) * SignNotZero(u);
+		const float foldedV = (1.0f - fabsf(u)) * SignNotZero(v);
+		u = foldedU;
+		v = foldedV;
+	}
+
+	const float baseU = floorf(u * SNorm16Max);
+	const float baseV = floorf(v * SNorm16Max);
+
+	const float invLength = 1.0f / sqrtf(Dot(normal, normal));
+	const MeshFloat3 unit = { normal.x * invLength, normal.y * invLength, normal.z * invLength };
+
+	float bestDot = -2.0f;
+	for (int corner = 0; corner < 4; corner++)
+	{
+		const int16_t candidate[2] = { ClampSNorm16(baseU + (corner & 1)), ClampSNorm16(baseV + (corner >> 1)) };
+		const float dot = Dot(DecodeOctahedral(candidate), unit);
+		if (dot > bestDot)
+		{
+			bestDot = dot;
+			encoded[0] = candidate[0];
+			encoded[1] = candidate[1];
+		}
+	}
+}
+
+MeshFloat3 DecodeOctahedral(const int16_t encoded[2])
+{
+	// Same arithmetic as DecodeOctahedral in VertexShader.hlsl
+	MeshFloat3 n;
+	n.x = std::max(encoded[0] / SNorm16Max, -1.0f);
+	n.y = std::max(encoded[1] / SNorm16Max, -1.0f);
+	n.z = 1.0f - fabsf(n.x) - fabsf(n.y);
+
+	const float t = std::max(-n.z, 0.0f);
+	n.x += (n.x >= 0.0f) ? -t : t;
+	n.y += (n.y >= 0.0f) ? -t : t;
+
+	const float invLength = 1.0f / sqrtf(Dot(n, n));
+	return { n.x * invLength, n.y * invLength, n.z * invLength };
+}
+
+VertexQuantization ComputeVertexQuantization(const MeshVertex* vertices, size_t vertexCount)
+{
+	VertexQuantization quantization = {};
+	if (vertexCount == 0)
+	{
+		return quantization;
+	}
+
+	MeshFloat3 minP = vertices[0].Position;
+	MeshFloat3 maxP = vertices[0].Position;
+	for (size_t v = 1; v < vertexCount; v++)
+	{
+		const MeshFloat3& p = vertices[v].Position;
+		minP = { std::min(minP.x, p.x), std::min(minP.y, p.y), std::min(minP.z, p.z) };
+		maxP = { std::max(maxP.x, p.x), std::max(maxP.y, p.y), std::max(maxP.z, p.z) };
+	}
+
+	quantization.Offset = minP;
+	quantization.Scale = { maxP.x - minP.x, maxP.y - minP.y, maxP.z - minP.z };
+	return quantization;
+}
+
+MeshFloat3 PositionErrorBound(const VertexQuantization& quantization)
+{
+	// Half a quantization step plus the float rounding of the encode and decode arithmetic
+	const float halfStep = 0.5f / UNorm16Max;
+	const float rounding = 2.0f * std::numeric_limits<float>::epsilon();
+	const MeshFloat3& offset = quantization.Offset;
+	const MeshFloat3& scale = quantization.Scale;
+	return {
+		scale.x * halfStep + rounding * (fabsf(offset.x) + scale.x),
+		scale.y * halfStep + rounding * (fabsf(offset.y) + scale.y),
+		scale.z * halfStep + rounding * (fabsf(offset.z) + scale.z) };
+}
+
+PackedVertex EncodeVertex(const MeshVertex& vertex, const VertexQuantization& quantization)
+{
+	const MeshFloat3& offset = quantization.Offset;
+	const MeshFloat3& scale = quantization.Scale;
+
+	PackedVertex packed;
+	packed.Position[0] = (scale.x > 0.0f) ? QuantizeUNorm16((vertex.Position.x - offset.x) / scale.x) : 0;
+	packed.Position[1] = (scale.y > 0.0f) ? QuantizeUNorm16((vertex.Position.y - offset.y) / scale.y) : 0;
+	packed.Position[2] = (scale.z > 0.0f) ? QuantizeUNorm16((vertex.Position.z - offset.z) / scale.z) : 0;
+	packed.Position[3] = 0;
+	EncodeOctahedral(vertex.Normal, packed.Normal);
+	packed.TexC[0] = FloatToHalf(vertex.TexC.x);
+	packed.TexC[1] = FloatToHalf(vertex.TexC.y);
+	return packed;
+}
+
+MeshVertex DecodeVertex(const PackedVertex& vertex, const VertexQuantization& quantization)
+{
+	const MeshFloat3& offset = quantization.Offset;
+	const MeshFloat3& scale = quantization.Scale;
+
+	MeshVertex decoded;
+	decoded.Position.x = offset.x + vertex.Position[0] / UNorm16Max * scale.x;
+	decoded.Position.y = offset.y + vertex.Position[1] / UNorm16Max * scale.y;
+	decoded.Position.z = offset.z + vertex.Position[2] / UNorm16Max * scale.z;
+	decoded.Normal = DecodeOctahedral(vertex.Normal);
+	decoded.TexC.x = HalfToFloat(vertex.TexC[0]);
+	decoded.TexC.y = HalfToFloat(vertex.TexC[1]);
+	return decoded;
+}
+
+bool NarrowIndices(uint16_t* destination, const uint32_t* indices, size_t indexCount, size_t vertexCount)
+{
+	if (vertexCount > 65536)
+	{
+		return false;
+	}
+
+	for (size_t i = 0; i < indexCount; i++)
+	{
+		destination[i] = static_cast<uint16_t>(indices[i]);
+	}
+	return true;
+}
+
+void CompressMesh(const MeshData& mesh, CompressedMesh& compressed)
+{
+	compressed.Quantization = ComputeVertexQuantization(mesh.Vertices.data(), mesh.Vertices.size());
+
+	compressed.Vertices.resize(mesh.Vertices.size());
+	for (size_t v = 0; v < mesh.Vertices.size(); v++)
+	{
+		compressed.Vertices[v] = EncodeVertex(mesh.Vertices[v], compressed.Quantization);
+	}
+
+	compressed.Indices.resize(mesh.Indices.size());
+	if (!NarrowIndices(compressed.Indices.data(), mesh.Indices.data(), mesh.Indices.size(), mesh.Vertices.size()))
+	{
+		compressed.Indices.clear();
+	}
+}
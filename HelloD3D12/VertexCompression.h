@@ -0,0 +1,57 @@
+#pragma once
+#include "Mesh.h"
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+
+// Compressed GPU vertex (16 bytes instead of 32). Matches the compressed input layout in
+// Graphics::CreatePipelineState and the COMPRESSED_VERTICES path of VertexShader.hlsl.
+struct PackedVertex
+{
+	// DXGI_FORMAT_R16G16B16A16_UNORM: position inside the mesh AABB, w unused
+	uint16_t Position[4];
+	// DXGI_FORMAT_R16G16_SNORM: octahedral encoded unit normal
+	int16_t Normal[2];
+	// DXGI_FORMAT_R16G16_FLOAT
+	uint16_t TexC[2];
+};
+
+static_assert(sizeof(PackedVertex) == 16, "PackedVertex must match the compressed input layout");
+
+// Maps UNORM16 positions back to model space: position = Offset + unorm * Scale
+struct VertexQuantization
+{
+	MeshFloat3 Offset;
+	MeshFloat3 Scale;
+};
+
+struct CompressedMesh
+{
+	VertexQuantization Quantization = {};
+	std::vector<PackedVertex> Vertices;
+	// Empty when the mesh has too many vertices for 16-bit indices
+	std::vector<uint16_t> Indices;
+};
+
+// Worst case reconstruction errors, used to check the encoders
+const float OctahedralMaxAngleError = 2.0e-4f; // radians
+const float HalfMaxRelativeError = 1.0f / 2048.0f;
+
+uint16_t FloatToHalf(float value);
+float HalfToFloat(uint16_t value);
+
+// Picks the closest of the four neighbouring grid points rather than plain rounding
+void EncodeOctahedral(const MeshFloat3& normal, int16_t encoded[2]);
+MeshFloat3 DecodeOctahedral(const int16_t encoded[2]);
+
+VertexQuantization ComputeVertexQuantization(const MeshVertex* vertices, size_t vertexCount);
+// Largest per-axis position error of a round trip (half a UNORM16 step plus float rounding)
+MeshFloat3 PositionErrorBound(const VertexQuantization& quantization);
+
+PackedVertex EncodeVertex(const MeshVertex& vertex, const VertexQuantization& quantization);
+MeshVertex DecodeVertex(const PackedVertex& vertex, const VertexQuantization& quantization);
+
+// Narrows indices to 16 bits; fails when vertexCount does not fit
+bool NarrowIndices(uint16_t* destination, const uint32_t* indices, size_t indexCount, size_t vertexCount);
+
+void CompressMesh(const MeshData& mesh, CompressedMesh& compressed);
@@ -0,0 +1,300 @@
+#include "VertexRemap.h"
+#include <algorithm>
+#include <cmath>
+#include <cstring>
+#include <vector>
+
+// HELLOD3D12_NO_SIMD builds the scalar path on x64 too, for comparison
+#if (defined(_M_X64) || defined(__x86_64__)) && !defined(HELLOD3D12_NO_SIMD)
+#include <emmintrin.h>
+#define VERTEX_REMAP_SSE2 1
+#endif
+
+namespace
+{
+	const size_t VertexWords = sizeof(MeshVertex) / sizeof(uint32_t);
+	static_assert(sizeof(MeshVertex) == 32, "the SIMD hash reads a vertex as two 16-byte lanes");
+
+	const uint64_t HashPrime1 = 0x9E3779B185EBCA87ull;
+	const uint64_t HashPrime2 = 0xC2B2AE3D27D4EB4Full;
+
+	inline uint64_t Rotl64(uint64_t x, int r)
+	{
+		return (x << r) | (x >> (64 - r));
+	}
+
+	inline uint64_t Finalize(uint64_t h)
+	{
+		h ^= h >> 33;
+		h *= HashPrime2;
+		h ^= h >> 29;
+		return h;
+	}
+
+	// Vertices compare as 8 words with -0.0f folded into +0.0f, so welding does not depend
+	// on the sign of zero normals or texture coordinates
+	struct CanonicalVertex
+	{
+		uint32_t Words[VertexWords];
+	};
+
+	inline CanonicalVertex Canonicalize(const MeshVertex& vertex)
+	{
+		CanonicalVertex result;
+		memcpy(result.Words, &vertex, sizeof(MeshVertex));
+		for (size_t i = 0; i < VertexWords; i++)
+		{
+			if ((result.Words[i] << 1) == 0)
+			{
+				result.Words[i] = 0;
+			}
+		}
+		return result;
+	}
+
+	// Hashes the whole vertex with two 16-byte loads; the folding is done on both halves at
+	// once and only the final 64-bit mix is scalar
+	inline uint64_t HashVertex(const MeshVertex& vertex)
+	{
+#if VERTEX_REMAP_SSE2
+		const __m128i zero = _mm_setzero_si128();
+		__m128i a = _mm_loadu_si128(reinterpret_cast<const __m128i*>(&vertex));
+		__m128i b = _mm_loadu_si128(reinterpret_cast<const __m128i*>(&vertex) + 1);
+		a = _mm_andnot_si128(_mm_cmpeq_epi32(_mm_slli_epi32(a, 1), zero), a);
+		b = _mm_andnot_si128(_mm_cmpeq_epi32(_mm_slli_epi32(b, 1), zero), b);
+		const __m128i folded = _mm_xor_si128(a, _mm_shuffle_epi32(b, _MM_SHUFFLE(1, 0, 3, 2)));
+		const uint64_t lo = static_cast<uint64_t>(_mm_cvtsi128_si64(folded));
+		const uint64_t hi = static_cast<uint64_t>(_mm_cvtsi128_si64(_mm_unpackhi_epi64(folded, folded)));
+#else
+		const CanonicalVertex c = Canonicalize(vertex);
+		uint64_t q[4];
+		memcpy(q, c.Words, sizeof(q));
+		const uint64_t lo = q[0] ^ q[3];
+		const uint64_t hi = q[1] ^ q[2];
+#endif
+		return Finalize(lo * HashPrime1 + Rotl64(hi, 31) * HashPrime2);
+	}
+
+	inline bool EqualVertices(const MeshVertex& a, const MeshVertex& b)
+	{
+#if VERTEX_REMAP_SSE2
+		const __m128i zero = _mm_setzero_si128();
+		const __m128i* pa = reinterpret_cast<const __m128i*>(&a);
+		const __m128i* pb = reinterpret_cast<const __m128i*>(&b);
+		__m128i a0 = _mm_loadu_si128(pa), a1 = _mm_loadu_si128(pa + 1);
+		__m128i b0 = _mm_loadu_si128(pb), b1 = _mm_loadu_si128(pb + 1);
+		a0 = _mm_andnot_si128(_mm_cmpeq_epi32(_mm_slli_epi32(a0, 1), zero), a0);
+		a1 = _mm_andnot_si128(_mm_cmpeq_epi32(_mm_slli_epi32(a1, 1), zero), a1);
+		b0 = _mm_andnot_si128(_mm_cmpeq_epi32(_mm_slli_epi32(b0, 1), zero), b0);
+		b1 = _mm_andnot_si128(_mm_cmpeq_epi32(_mm_slli_epi32(b1, 1), zero), b1);
+		const __m128i equal = _mm_and_si128(_mm_cmpeq_epi32(a0, b0), _mm_cmpeq_epi32(a1, b1));
+		return _mm_movemask_epi8(equal) == 0xFFFF;
+#else
+		const CanonicalVertex ca = Canonicalize(a);
+		const CanonicalVertex cb = Canonicalize(b);
+		return memcmp(ca.Words, cb.Words, sizeof(ca.Words)) == 0;
+#endif
+	}
+
+	inline bool NearVertices(const MeshVertex& a, const MeshVertex& b, float epsilon)
+	{
+		const float* fa = &a.Position.x;
+		const float* fb = &b.Position.x;
+		for (size_t i = 0; i < VertexWords; i++)
+		{
+			if (fabsf(fa[i] - fb[i]) > epsilon)
+			{
+				return false;
+			}
+		}
+		return true;
+	}
+
+	// Open addressed table of 64-bit keys -> vertex index, sized to stay at most half full.
+	// Keys and values share a slot so a probe touches one cache line.
+	class WeldTable
+	{
+	public:
+		explicit WeldTable(size_t count)
+		{
+			size_t capacity = 16;
+			while (capacity < count * 2)
+			{
+				capacity *= 2;
+			}
+			m_Mask = capacity - 1;
+			m_Slots.assign(capacity, Slot{ 0, UnusedVertex });
+		}
+
+		// Returns the slot for key starting the probe at the given step; an empty slot ends the chain
+		inline size_t Probe(uint64_t key, size_t& step) const
+		{
+			for (;;)
+			{
+				const size_t slot = static_cast<size_t>(key + step * (step + 1) / 2) & m_Mask;
+				step++;
+				if (m_Slots[slot].Value == UnusedVertex || m_Slots[slot].Key == key)
+				{
+					return slot;
+				}
+			}
+		}
+
+		inline bool Empty(size_t slot) const { return m_Slots[slot].Value == UnusedVertex; }
+		inline uint32_t Value(size_t slot) const { return m_Slots[slot].Value; }
+		inline void Insert(size_t slot, uint64_t key, uint32_t value) { m_Slots[slot] = { key, value }; }
+
+	private:
+		struct Slot
+		{
+			uint64_t Key;
+			uint32_t Value;
+		};
+
+		std::vector<Slot> m_Slots;
+		size_t m_Mask;
+	};
+
+	size_t WeldExact(uint32_t* remap, const MeshVertex* vertices, size_t vertexCount)
+	{
+		WeldTable table(vertexCount);
+		size_t unique = 0;
+
+		for (size_t i = 0; i < vertexCount; i++)
+		{
+			const uint64_t key = HashVertex(vertices[i]);
+
+			// Different vertices can share a hash; keep probing past them
+			size_t step = 0;
+			for (;;)
+			{
+				const size_t slot = table.Probe(key, step);
+				if (table.Empty(slot))
+				{
+					table.Insert(slot, key, static_cast<uint32_t>(i));
+					remap[i] = static_cast<uint32_t>(unique++);
+					break;
+				}
+				const uint32_t other = table.Value(slot);
+				if (EqualVertices(vertices[other], vertices[i]))
+				{
+					remap[i] = remap[other];
+					break;
+				}
+			}
+		}
+		return unique;
+	}
+
+	inline uint64_t CellKey(int64_t x, int64_t y, int64_t z)
+	{
+		return Finalize(static_cast<uint64_t>(x) * HashPrime1 ^ Rotl64(static_cast<uint64_t>(y) * HashPrime2, 21) ^ Rotl64(static_cast<uint64_t>(z) * HashPrime1, 42));
+	}
+
+	// Unique vertices are bucketed on a position grid with cells 2 * epsilon wide. Anything
+	// within epsilon lies in the same cell or the neighbour on the nearer side of each axis,
+	// so 8 cells are searched.
+	size_t WeldNear(uint32_t* remap, const MeshVertex* vertices, size_t vertexCount, float epsilon)
+	{
+		WeldTable table(vertexCount);
+		std::vector<uint32_t> next(vertexCount, UnusedVertex);
+		const float invCell = 0.5f / epsilon;
+		size_t unique = 0;
+
+		for (size_t i = 0; i < vertexCount; i++)
+		{
+			const MeshFloat3& p = vertices[i].Position;
+			const float gx = p.x * invCell;
+			const float gy = p.y * invCell;
+			const float gz = p.z * invCell;
+			const int64_t cx = static_cast<int64_t>(floorf(gx));
+			const int64_t cy = static_cast<int64_t>(floorf(gy));
+			const int64_t cz = static_cast<int64_t>(floorf(gz));
+			const int64_t nx = (gx - cx < 0.5f) ? -1 : 1;
+			const int64_t ny = (gy - cy < 0.5f) ? -1 : 1;
+			const int64_t nz = (gz - cz < 0.5f) ? -1 : 1;
+
+			uint32_t match = UnusedVertex;
+			for (uint32_t corner = 0; corner < 8 && match == UnusedVertex; corner++)
+			{
+				const uint64_t key = CellKey(cx + ((corner & 1) ? nx : 0), cy + ((corner & 2) ? ny : 0), cz + ((corner & 4) ? nz : 0));
+				size_t step = 0;
+				const size_t slot = table.Probe(key, step);
+				if (table.Empty(slot))
+				{
+					continue;
+				}
+				for (uint32_t v = table.Value(slot); v != UnusedVertex; v = next[v])
+				{
+					if (NearVertices(vertices[v], vertices[i], epsilon))
+					{
+						match = v;
+						break;
+					}
+				}
+			}
+
+			if (match != UnusedVertex)
+			{
+				remap[i] = remap[match];
+				continue;
+			}
+
+			// New unique vertex: push it onto the front of its cell's chain. Cell keys are
+			// 64-bit hashes, so two cells sharing a key only makes a chain longer.
+			const uint64_t key = CellKey(cx, cy, cz);
+			size_t step = 0;
+			const size_t slot = table.Probe(key, step);
+			next[i] = table.Empty(slot) ? UnusedVertex : table.Value(slot);
+			table.Insert(slot, key, static_cast<uint32_t>(i));
+			remap[i] = static_cast<uint32_t>(unique++);
+		}
+		return unique;
+	}
+}
+
+size_t GenerateWeldRemap(uint32_t* remap, const MeshVertex* vertices, size_t vertexCount, float epsilon)
+{
+	if (epsilon > 0.0f)
+	{
+		return WeldNear(remap, vertices, vertexCount, epsilon);
+	}
+	return WeldExact(remap, vertices, vertexCount);
+}
+
+size_t GenerateFetchRemap(uint32_t* remap, const uint32_t* indices, size_t indexCount, size_t vertexCount)
+{
+	std::fill(remap, remap + vertexCount, UnusedVertex);
+
+	uint32_t next = 0;
+	for (size_t i = 0; i < indexCount; i++)
+	{
+		const uint32_t v = indices[i];
+		if (remap[v] == UnusedVertex)
+		{
+			remap[v] = next++;
+		}
+	}
+	return next;
+}
+
+void RemapMesh(MeshData& mesh, const uint32_t* remap, size_t remappedVertexCount)
+{
+	std::vector<MeshVertex> vertices(remappedVertexCount);
+	std::vector<char> written(remappedVertexCount, 0);
+	for (size_t i = 0; i < mesh.Vertices.size(); i++)
+	{
+		const uint32_t slot = remap[i];
+		if (slot != UnusedVertex && !written[slot])
+		{
+			vertices[slot] = mesh.Vertices[i];
+			written[slot] = 1;
+		}
+	}
+	mesh.Vertices.swap(vertices);
+
+	for (uint32_t& index : mesh.Indices)
+	{
+		index = remap[index];
+	}
+}
@@ -0,0 +1,22 @@
+#pragma once
+#include "Mesh.h"
+#include <cstddef>
+#include <cstdint>
+
+// Marks vertices that are dropped by a remap (e.g. never referenced by the index buffer)
+const uint32_t UnusedVertex = ~0u;
+
+// Finds duplicate vertices and writes remap[i] = the welded slot of vertex i, with slots
+// numbered in order of first occurrence. With epsilon == 0 vertices weld when they are
+// bitwise equal (treating -0 as 0); otherwise when every component is within epsilon of
+// an earlier unique vertex. Returns the number of unique vertices.
+size_t GenerateWeldRemap(uint32_t* remap, const MeshVertex* vertices, size_t vertexCount, float epsilon = 0.0f);
+
+// Numbers vertices in the order the index buffer first uses them so vertex fetch walks
+// memory forwards. Unreferenced vertices map to UnusedVertex. Returns the number of
+// referenced vertices.
+size_t GenerateFetchRemap(uint32_t* remap, const uint32_t* indices, size_t indexCount, size_t vertexCount);
+
+// Rewrites the vertex and index buffers through a remap produced by the functions above.
+// When several vertices share a slot the first one is kept.
+void RemapMesh(MeshData& mesh, const uint32_t* remap, size_t remappedVertexCount);
@@ -0,0 +1,24 @@
+#include "VideoMemoryBudget12.h"
+
+HRESULT VideoMemoryBudget12::Create(IDXGIFactory1* factory, ID3D12Device* device)
+{
+	m_Adapter = nullptr;
+
+	Microsoft::WRL::ComPtr<IDXGIFactory4> factory4;
+	HRESULT hr = factory->QueryInterface(IID_PPV_ARGS(&factory4));
+	if (FAILED(hr))
+	{
+		return hr;
+	}
+	return factory4->EnumAdapterByLuid(device->GetAdapterLuid(), IID_PPV_ARGS(&m_Adapter));
+}
+
+uint64_t VideoMemoryBudget12::Query(uint64_t fallback) const
+{
+	DXGI_QUERY_VIDEO_MEMORY_INFO info = {};
+	if (!m_Adapter || FAILED(m_Adapter->QueryVideoMemoryInfo(0, DXGI_MEMORY_SEGMENT_GROUP_LOCAL, &info)) || info.Budget == 0)
+	{
+		return fallback;
+	}
+	return info.Budget;
+}
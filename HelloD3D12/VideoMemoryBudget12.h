@@ -0,0 +1,19 @@
+#pragma once
+#include <d3d12.h>
+#include <dxgi1_4.h>
+#include <wrl.h>
+#include <cstdint>
+
+// How much local video memory the OS currently lets this process use on the device's
+// adapter. The figure moves as other applications come and go, so poll it.
+class VideoMemoryBudget12
+{
+public:
+	HRESULT Create(IDXGIFactory1* factory, ID3D12Device* device);
+
+	// The current budget, or fallback when the adapter cannot report one
+	uint64_t Query(uint64_t fallback) const;
+
+private:
+	Microsoft::WRL::ComPtr<IDXGIAdapter3> m_Adapter;
+};